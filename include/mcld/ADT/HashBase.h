@@ -109,10 +109,17 @@ protected:
   //  @return the index of the found bucket
   unsigned int lookUpBucketFor(const key_type& pKey);
 
+  /// lookUpBucketFor - search the index of bucket whose key is pKey with a
+  /// pre-computed hash value
+  unsigned int lookUpBucketFor(const key_type& pKey, unsigned int pHashValue);
+
   /// findKey - finds an element with key pKey
   //  return the index of the element, or -1 when the element does not exist.
   int findKey(const key_type& pKey) const;
 
+  /// findKey - finds an element with key pKey and a pre-computed hash value
+  int findKey(const key_type& pKey, unsigned int pHashValue) const;
+
   /// mayRehash - check the load_factor, compute the new size, and then doRehash
   void mayRehash();
 
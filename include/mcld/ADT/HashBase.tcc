@@ -124,13 +124,23 @@ template<typename HashEntryTy,
 unsigned int
 HashTableImpl<HashEntryTy, HashFunctionTy>::lookUpBucketFor(
   const typename HashTableImpl<HashEntryTy, HashFunctionTy>::key_type& pKey)
+{
+  return lookUpBucketFor(pKey, m_Hasher(pKey));
+}
+
+template<typename HashEntryTy,
+         typename HashFunctionTy>
+unsigned int
+HashTableImpl<HashEntryTy, HashFunctionTy>::lookUpBucketFor(
+  const typename HashTableImpl<HashEntryTy, HashFunctionTy>::key_type& pKey,
+  unsigned int pHashValue)
 {
   if (0 == m_NumOfBuckets) {
     // NumOfBuckets is changed after init(pInitSize)
     init(NumOfInitBuckets);
   }
 
-  unsigned int full_hash = m_Hasher(pKey);
+  unsigned int full_hash = pHashValue;
   unsigned int index = full_hash % m_NumOfBuckets;
 
   const unsigned int probe = 1;
@@ -172,11 +182,23 @@ template<typename HashEntryTy,
 int
 HashTableImpl<HashEntryTy, HashFunctionTy>::findKey(
   const typename HashTableImpl<HashEntryTy, HashFunctionTy>::key_type& pKey) const
+{
+  if (0 == m_NumOfBuckets)
+    return -1;
+  return findKey(pKey, m_Hasher(pKey));
+}
+
+template<typename HashEntryTy,
+         typename HashFunctionTy>
+int
+HashTableImpl<HashEntryTy, HashFunctionTy>::findKey(
+  const typename HashTableImpl<HashEntryTy, HashFunctionTy>::key_type& pKey,
+  unsigned int pHashValue) const
 {
   if (0 == m_NumOfBuckets)
     return -1;
 
-  unsigned int full_hash = m_Hasher(pKey);
+  unsigned int full_hash = pHashValue;
   unsigned int index = full_hash % m_NumOfBuckets;
 
   const unsigned int probe = 1;
@@ -75,6 +75,11 @@ public:
   //  If the element already exists, return the element, and set pExist true.
   entry_type* insert(const key_type& pKey, bool& pExist);
 
+  /// insert - insert a new element with a hash value computed by hash()
+  //  before. Clients that already hashed the key save the second hashing.
+  entry_type* insert(const key_type& pKey, bool& pExist,
+                     unsigned int pHashValue);
+
   /// erase - remove the element with the same key
   size_type erase(const key_type& pKey);
 
@@ -87,6 +92,11 @@ public:
   //  If the element does not exist, return end()
   const_iterator find(const key_type& pKey) const;
 
+  /// find - finds an element with key pKey and a hash value computed by
+  //  hash() before.
+  iterator find(const key_type& pKey, unsigned int pHashValue);
+  const_iterator find(const key_type& pKey, unsigned int pHashValue) const;
+
   size_type count(const key_type& pKey) const;
   
   // -----  hash policy  ----- //
@@ -16,6 +16,7 @@
 #include <llvm/Support/DataTypes.h>
 #include <llvm/Support/ErrorHandling.h>
 #include <cctype>
+#include <cstring>
 #include <functional>
 
 namespace mcld
@@ -34,7 +35,8 @@ enum StringHashType
   BP,
   FNV,
   AP,
-  ES
+  ES,
+  XX
 };
 
 /** \class template<uint32_t TYPE> StringHash
@@ -338,6 +340,84 @@ struct StringHash<ES> : public std::unary_function<const llvm::StringRef&, uint3
   }
 };
 
+/** \class StringHash<XX>
+ *  \brief xxHash32 hash function.
+ *
+ *  XX reads four bytes at a time and mixes all 32 bits of the result, so it
+ *  is fast and spreads long C++ mangled names well. It is the hash function
+ *  of the internal symbol tables.
+ *
+ *  The value depends on the byte order of the host. Never use it for data
+ *  in the output file; .hash and .gnu.hash are built by StringHash<ELF> and
+ *  StringHash<DJB>.
+ */
+template<>
+struct StringHash<XX> : public std::unary_function<const llvm::StringRef&, uint32_t>
+{
+  static const uint32_t Prime1 = 2654435761U;
+  static const uint32_t Prime2 = 2246822519U;
+  static const uint32_t Prime3 = 3266489917U;
+  static const uint32_t Prime4 = 668265263U;
+  static const uint32_t Prime5 = 374761393U;
+
+  static uint32_t rotl(uint32_t pX, unsigned int pR)
+  { return (pX << pR) | (pX >> (32 - pR)); }
+
+  static uint32_t read32(const char* pPtr)
+  {
+    uint32_t value;
+    std::memcpy(&value, pPtr, sizeof(value));
+    return value;
+  }
+
+  static uint32_t round(uint32_t pAcc, uint32_t pInput)
+  { return rotl(pAcc + pInput * Prime2, 13) * Prime1; }
+
+  uint32_t operator()(const llvm::StringRef& pKey) const
+  {
+    const char* ptr = pKey.data();
+    const char* end = ptr + pKey.size();
+    uint32_t hash_val;
+
+    if (pKey.size() >= 16) {
+      const char* limit = end - 16;
+      uint32_t v1 = Prime1 + Prime2;
+      uint32_t v2 = Prime2;
+      uint32_t v3 = 0;
+      uint32_t v4 = 0 - Prime1;
+      do {
+        v1 = round(v1, read32(ptr));
+        v2 = round(v2, read32(ptr + 4));
+        v3 = round(v3, read32(ptr + 8));
+        v4 = round(v4, read32(ptr + 12));
+        ptr += 16;
+      } while (ptr <= limit);
+      hash_val = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+    }
+    else
+      hash_val = Prime5;
+
+    hash_val += static_cast<uint32_t>(pKey.size());
+
+    for (; ptr + 4 <= end; ptr += 4) {
+      hash_val += read32(ptr) * Prime3;
+      hash_val = rotl(hash_val, 17) * Prime4;
+    }
+
+    for (; ptr < end; ++ptr) {
+      hash_val += static_cast<uint8_t>(*ptr) * Prime5;
+      hash_val = rotl(hash_val, 11) * Prime1;
+    }
+
+    hash_val ^= hash_val >> 15;
+    hash_val *= Prime2;
+    hash_val ^= hash_val >> 13;
+    hash_val *= Prime3;
+    hash_val ^= hash_val >> 16;
+    return hash_val;
+  }
+};
+
 /** \class template<uint32_t TYPE> StringCompare
  *  \brief the template StringCompare class, for specification
  */
@@ -30,6 +30,7 @@
 #define MCLD_SECTIONS_PER_INPUT 16
 #define MCLD_SYMBOLS_PER_INPUT 128
 #define MCLD_RELOCATIONS_PER_INPUT 1024
+#define MCLD_NAMEPOOL_SHARDS 16
 
 #endif
 
@@ -18,6 +18,7 @@
 #endif
 
 #include <string>
+#include <vector>
 
 #include <mcld/LinkerConfig.h>
 #include <mcld/LD/LDFileFormat.h>
@@ -53,11 +54,27 @@ public:
   /// data to output file.
   void syncRelocationResult(MemoryArea& pOutput);
 
+public:
+  /// ApplyList - the relocations of one relocation section, classified by
+  /// applyRelocations in the order of the section.
+  struct ApplyList {
+    /// relocations applied by applyAndSyncRelocations into the output
+    std::vector<Relocation*> concurrent;
+    /// relocations applied by applyRelocations. NONE relocations are not
+    /// kept, since their results are never written.
+    std::vector<Relocation*> serial;
+  };
+
 private:
   /// normalSyncRelocationResult - sync relocation result when producing shared
   /// objects or executables
   void normalSyncRelocationResult(MemoryArea& pOutput);
 
+  /// applyAndSyncRelocations - helper function of normalSyncRelocationResult.
+  /// SWAP is true if the host and the target have different byte orders.
+  template<bool SWAP>
+  void applyAndSyncRelocations(uint8_t* pOutput);
+
   /// partialSyncRelocationResult - sync relocation result when doing partial
   /// link
   void partialSyncRelocationResult(MemoryArea& pOutput);
@@ -70,6 +87,9 @@ private:
   const LinkerConfig& m_Config;
   Module& m_Module;
   TargetLDBackend& m_Backend;
+
+  /// m_ApplyLists - one list per non-empty relocation section
+  std::vector<ApplyList*> m_ApplyLists;
 };
 
 } // namespace of mcld
@@ -93,6 +93,7 @@ private:
   friend FragmentRef& NullFragmentRef();
   friend class Chunk<FragmentRef, MCLD_SECTIONS_PER_INPUT>;
   friend class Relocation;
+  friend class LDSymbol;
 
   FragmentRef();
 
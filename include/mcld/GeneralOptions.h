@@ -43,6 +43,12 @@ public:
     Both    = 0x3
   };
 
+  enum ICFMode {
+    ICFNone,
+    ICFAll,
+    ICFSafe
+  };
+
   typedef std::vector<std::string> RpathList;
   typedef RpathList::iterator rpath_iterator;
   typedef RpathList::const_iterator const_rpath_iterator;
@@ -286,6 +292,65 @@ public:
   bool nostdlib() const
   { return m_bNoStdlib; }
 
+  // --gc-sections
+  void setGCSections(bool pEnable = true)
+  { m_bGCSections = pEnable; }
+
+  bool GCSections() const
+  { return m_bGCSections; }
+
+  // --print-gc-sections
+  void setPrintGCSections(bool pEnable = true)
+  { m_bPrintGCSections = pEnable; }
+
+  bool getPrintGCSections() const
+  { return m_bPrintGCSections; }
+
+  // --icf=[none,all,safe]
+  void setICFMode(ICFMode pMode)
+  { m_ICFMode = pMode; }
+
+  ICFMode getICFMode() const
+  { return m_ICFMode; }
+
+  // --threads=N
+  void setNumThreads(unsigned int pNum)
+  { m_NumThreads = pNum; }
+
+  unsigned int numThreads() const
+  { return m_NumThreads; }
+
+  // --map-whole-files, --no-map-whole-files
+  void setMapWholeFiles(bool pEnable = true)
+  { m_bMapWholeFiles = pEnable; }
+
+  bool mapWholeFiles() const
+  { return m_bMapWholeFiles; }
+
+  // --lazy-dynamic-symbols
+  void setLazyDynSymbols(bool pEnable = true)
+  { m_bLazyDynSymbols = pEnable; }
+
+  bool lazyDynSymbols() const
+  { return m_bLazyDynSymbols; }
+
+  // --tail-merge-strings
+  void setTailMergeStrings(bool pEnable = true)
+  { m_bTailMergeStrings = pEnable; }
+
+  bool tailMergeStrings() const
+  { return m_bTailMergeStrings; }
+
+  // --archive-index-cache=DIR
+  void setArchiveIndexCache(const std::string& pDirectory)
+  { m_ArchiveIndexCache = pDirectory; }
+
+  const std::string& archiveIndexCache() const
+  { return m_ArchiveIndexCache; }
+
+  bool hasArchiveIndexCache() const
+  { return !m_ArchiveIndexCache.empty(); }
+
   unsigned int getHashStyle() const { return m_HashStyle; }
 
   void setHashStyle(unsigned int pStyle)
@@ -368,9 +433,17 @@ private:
   bool m_bFatalWarnings : 1; // --fatal-warnings
   bool m_bNewDTags: 1; // --enable-new-dtags
   bool m_bNoStdlib: 1; // -nostdlib
+  bool m_bGCSections: 1; // --gc-sections
+  bool m_bPrintGCSections: 1; // --print-gc-sections
+  bool m_bMapWholeFiles: 1; // --map-whole-files
+  bool m_bLazyDynSymbols: 1; // --lazy-dynamic-symbols
+  bool m_bTailMergeStrings: 1; // --tail-merge-strings
   StripSymbolMode m_StripSymbols;
+  ICFMode m_ICFMode;
   RpathList m_RpathList;
   unsigned int m_HashStyle;
+  unsigned int m_NumThreads;   // --threads=N
+  std::string m_ArchiveIndexCache; // --archive-index-cache=DIR
   std::string m_Filter;
   AuxiliaryList m_AuxiliaryList;
 };
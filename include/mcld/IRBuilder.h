@@ -31,11 +31,14 @@
 #include <mcld/Support/FileHandle.h>
 #include <mcld/Support/raw_mem_ostream.h>
 
+#include <vector>
+
 namespace mcld {
 
 class Module;
 class LinkerConfig;
 class InputTree;
+class LazySymbolTable;
 
 /** \class IRBuilder
  *  \brief IRBuilder provides an uniform API for creating sections and
@@ -298,7 +301,9 @@ public:
   /// @param pLength [in]      The number of bytes of the data
   /// @return If pLength is zero or failing to request a region, return a
   ///         FillFragment.
-  static Fragment* CreateRegion(Input& pInput, size_t pOffset, size_t pLength);
+  static Fragment* CreateRegion(Input& pInput,
+                                uint64_t pOffset,
+                                uint64_t pLength);
 
   /// CreateRegion - To create a region fragment wrapping the given memory.
   /// This function tells MCLinker to create a region fragment by the data
@@ -397,10 +402,14 @@ public:
   ///                           pSection. Keep their pSection be NULL.
   /// @oaram [in]      pVis     The visibility of the symbol
   ///
+  /// If pName is a C string in the whole-file mapping of pInput, such as a
+  /// name in its string table, the symbol borrows the name instead of copying
+  /// it. The name stays valid as long as this IRBuilder.
+  ///
   /// @return The added symbol. If the insertion fails due to the resoluction,
   /// return NULL.
   LDSymbol* AddSymbol(Input& pInput,
-                      const std::string& pName,
+                      const llvm::StringRef& pName,
                       ResolveInfo::Type pType,
                       ResolveInfo::Desc pDesc,
                       ResolveInfo::Binding pBind,
@@ -468,30 +477,57 @@ public:
                                    uint32_t pOffset,
                                    Relocation::Address pAddend = 0);
 
+  /// AddLazySymbols - To add the symbols of an input which are read only when
+  /// they are referred.
+  /// The undefined symbols in mcld::Module are looked up in pTable at once.
+  /// After that, the name of every new undefined symbol is looked up in the
+  /// added tables in the order they are added. IRBuilder does not take over
+  /// pTable, which must outlive the reading of the inputs.
+  ///
+  /// @param [in] pTable The symbols to be added on demand.
+  void AddLazySymbols(LazySymbolTable& pTable);
+
 private:
-  LDSymbol* addSymbolFromObject(const std::string& pName,
+  LDSymbol* addSymbolFromObject(const llvm::StringRef& pName,
                                 ResolveInfo::Type pType,
                                 ResolveInfo::Desc pDesc,
                                 ResolveInfo::Binding pBinding,
                                 ResolveInfo::SizeType pSize,
                                 LDSymbol::ValueType pValue,
                                 FragmentRef* pFragmentRef,
-                                ResolveInfo::Visibility pVisibility);
+                                ResolveInfo::Visibility pVisibility,
+                                bool pStableName = false);
 
   LDSymbol* addSymbolFromDynObj(Input& pInput,
-                                const std::string& pName,
+                                const llvm::StringRef& pName,
                                 ResolveInfo::Type pType,
                                 ResolveInfo::Desc pDesc,
                                 ResolveInfo::Binding pBinding,
                                 ResolveInfo::SizeType pSize,
                                 LDSymbol::ValueType pValue,
-                                ResolveInfo::Visibility pVisibility);
+                                ResolveInfo::Visibility pVisibility,
+                                bool pStableName = false);
+
+  /// addUndefined - record a new undefined symbol, and look it up in the
+  /// lazy symbol tables
+  void addUndefined(ResolveInfo& pInfo);
+
+private:
+  typedef std::vector<LazySymbolTable*> LazySymbolTableList;
+  typedef std::vector<ResolveInfo*> UndefinedList;
 
 private:
   Module& m_Module;
   const LinkerConfig& m_Config;
 
   InputBuilder m_InputBuilder;
+
+  /// m_LazySymbols - the lazy symbol tables, in the order they are added
+  LazySymbolTableList m_LazySymbols;
+
+  /// m_Undefined - the symbols which were undefined when they were inserted.
+  /// Only recorded with --lazy-dynamic-symbols.
+  UndefinedList m_Undefined;
 };
 
 template<> LDSymbol*
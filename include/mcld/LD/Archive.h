@@ -29,6 +29,7 @@ class InputBuilder;
 class AttributeFactory;
 class ContextFactory;
 class MemoryAreaFactory;
+class MemoryRegion;
 
 /** \class Archive
  *  \brief This class define the interfacee to Archive files
@@ -40,6 +41,7 @@ public:
   static const char   THIN_MAGIC[];        ///< magic of thin archive
   static const size_t MAGIC_LEN;           ///< length of magic string
   static const char   SVR4_SYMTAB_NAME[];  ///< SVR4 symtab entry name
+  static const char   SYM64_SYMTAB_NAME[]; ///< 64-bit symtab entry name
   static const char   STRTAB_NAME[];       ///< Name of string table
   static const char   PAD[];               ///< inter-file align padding
   static const char   MEMBER_MAGIC[];      ///< fmag field magic #
@@ -65,20 +67,20 @@ private:
 
   struct MurmurHash3
   {
-    size_t operator()(uint32_t pKey) const
+    size_t operator()(uint64_t pKey) const
     {
-      pKey ^= pKey >> 16;
-      pKey *= 0x85ebca6b;
-      pKey ^= pKey >> 13;
-      pKey *= 0xc2b2ae35;
-      pKey ^= pKey >> 16;
+      pKey ^= pKey >> 33;
+      pKey *= 0xff51afd7ed558ccdULL;
+      pKey ^= pKey >> 33;
+      pKey *= 0xc4ceb9fe1a85ec53ULL;
+      pKey ^= pKey >> 33;
       return pKey;
     }
   };
 
-  typedef HashEntry<uint32_t,
+  typedef HashEntry<uint64_t,
                     InputTree::iterator,
-                    OffsetCompare<uint32_t> > ObjectMemberEntryType;
+                    OffsetCompare<uint64_t> > ObjectMemberEntryType;
 public:
   typedef HashTable<ObjectMemberEntryType,
                     MurmurHash3,
@@ -98,7 +100,7 @@ private:
 
 public:
   typedef HashTable<ArchiveMemberEntryType,
-                    StringHash<ELF>,
+                    StringHash<XX>,
                     EntryFactory<ArchiveMemberEntryType> > ArchiveMemberMapType;
 
   struct Symbol
@@ -111,8 +113,8 @@ public:
       Unknown
     };
 
-    Symbol(const char* pName,
-           uint32_t pOffset,
+    Symbol(const llvm::StringRef& pName,
+           uint64_t pOffset,
            enum Status pStatus)
      : name(pName), fileOffset(pOffset), status(pStatus)
     {}
@@ -121,13 +123,24 @@ public:
     {}
 
   public:
-    std::string name;
-    uint32_t fileOffset;
+    /// name - refers to the symtab region held by the archive
+    llvm::StringRef name;
+    uint64_t fileOffset;
     enum Status status;
   };
 
   typedef std::vector<Symbol*> SymTabType;
 
+private:
+  typedef HashEntry<const llvm::StringRef,
+                    size_t,
+                    StringCompare<llvm::StringRef> > SymbolIndexEntryType;
+
+  /// SymbolIndexType - map a symbol name to its first index in symtab
+  typedef HashTable<SymbolIndexEntryType,
+                    StringHash<XX>,
+                    EntryFactory<SymbolIndexEntryType> > SymbolIndexType;
+
 public:
   Archive(Input& pInputFile, InputBuilder& pBuilder);
 
@@ -157,11 +170,11 @@ public:
   /// addObjectMember - add a object in the object member map
   /// @param pFileOffset - file offset in symtab represents a object file
   /// @param pIter - the iterator in the input tree built from this archive
-  bool addObjectMember(uint32_t pFileOffset, InputTree::iterator pIter);
+  bool addObjectMember(uint64_t pFileOffset, InputTree::iterator pIter);
 
   /// hasObjectMember - check if a object file is included or not
   /// @param pFileOffset - file offset in symtab represents a object file
-  bool hasObjectMember(uint32_t pFileOffset) const;
+  bool hasObjectMember(uint64_t pFileOffset) const;
 
   /// getArchiveMemberMap - get the map that contains the included archive files
   ArchiveMemberMapType& getArchiveMemberMap();
@@ -192,27 +205,35 @@ public:
   const SymTabType& getSymbolTable() const;
 
   /// setSymTabSize - set the memory size of symtab
-  void setSymTabSize(size_t pSize);
+  void setSymTabSize(uint64_t pSize);
 
   /// getSymTabSize - get the memory size of symtab
-  size_t getSymTabSize() const;
+  uint64_t getSymTabSize() const;
+
+  /// setSymTabRegion - keep the region of symtab until the archive is
+  /// destroyed, since the symbol names refer to it
+  void setSymTabRegion(MemoryRegion* pRegion);
 
   /// numOfSymbols - return the number of symbols in symtab
   size_t numOfSymbols() const;
 
   /// addSymbol - add a symtab entry to symtab
-  /// @param pName - symbol name
+  /// @param pName - symbol name, which must be in the symtab region
   /// @param pFileOffset - file offset in symtab represents a object file
   void
-  addSymbol(const char* pName,
-            uint32_t pFileOffset,
+  addSymbol(const llvm::StringRef& pName,
+            uint64_t pFileOffset,
             enum Symbol::Status pStatus = Archive::Symbol::Unknown);
 
+  /// findSymbol - find the first symtab entry with the given name
+  /// @return false if no member of this archive defines pName
+  bool findSymbol(const llvm::StringRef& pName, size_t& pSymIdx) const;
+
   /// getSymbolName - get the symbol name with the given index
-  const std::string& getSymbolName(size_t pSymIdx) const;
+  llvm::StringRef getSymbolName(size_t pSymIdx) const;
 
   /// getObjFileOffset - get the file offset that represent a object file
-  uint32_t getObjFileOffset(size_t pSymIdx) const;
+  uint64_t getObjFileOffset(size_t pSymIdx) const;
 
   /// getSymbolStatus - get the status of a symbol
   enum Symbol::Status getSymbolStatus(size_t pSymIdx) const;
@@ -251,7 +272,9 @@ private:
   ArchiveMemberMapType m_ArchiveMemberMap;
   SymbolFactory m_SymbolFactory;
   SymTabType m_SymTab;
-  size_t m_SymTabSize;
+  SymbolIndexType m_SymbolIndex;
+  MemoryRegion* m_pSymTabRegion;
+  uint64_t m_SymTabSize;
   std::string m_StrTab;
   InputBuilder& m_Builder;
 };
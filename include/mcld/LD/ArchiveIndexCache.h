@@ -0,0 +1,129 @@
+//===- ArchiveIndexCache.h ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_ARCHIVE_INDEX_CACHE_H
+#define MCLD_LD_ARCHIVE_INDEX_CACHE_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+#include <mcld/ADT/Uncopyable.h>
+#include <mcld/Support/Path.h>
+
+#include <llvm/Support/DataTypes.h>
+
+#include <string>
+#include <vector>
+
+namespace mcld {
+
+class Archive;
+class FileHandle;
+class Input;
+
+/** \class ArchiveIndexCache
+ *  \brief ArchiveIndexCache keeps the symbol maps and the extended name
+ *  tables of archives in a directory (--archive-index-cache), so that later
+ *  links map them instead of parsing the archives again.
+ *
+ *  Each cache file is named after the hash of the real path of the archive.
+ *  It records the real path, the size and the modification time in
+ *  nanoseconds of the archive, and it is ignored if any of them does not
+ *  match. The cache files are little-endian on every host, and they start
+ *  with a magic and a format version. A cache file is written to a
+ *  temporary file and renamed, so a concurrent link never sees a partial
+ *  one.
+ */
+class ArchiveIndexCache : private Uncopyable
+{
+public:
+  explicit ArchiveIndexCache(const std::string& pDirectory);
+
+  ~ArchiveIndexCache();
+
+  /// load - set up the symtab, symtab size and strtab of pArchive from the
+  /// cache. The symbol names refer to the cache file, which stays mapped
+  /// until the cache is destroyed.
+  /// @return false if there is no valid cache file for the archive
+  bool load(Archive& pArchive);
+
+  /// store - write the symtab, symtab size and strtab of pArchive into the
+  /// cache
+  bool store(const Archive& pArchive) const;
+
+private:
+  /// Header - the first part of a cache file. It is followed by the entries,
+  /// the archive path, the symbol names and the extended name table. The
+  /// fields are stored in order, little-endian and without padding.
+  struct Header
+  {
+    char magic[8];
+    uint32_t version;
+    uint32_t numOfSymbols;
+    uint64_t archiveSize;
+    uint64_t archiveTime;
+    uint64_t symTabSize;
+    uint64_t pathSize;
+    uint64_t nameSize;
+    uint64_t strTabSize;
+  };
+
+  /// Entry - a symbol of the archive symbol map, stored like Header
+  struct Entry
+  {
+    uint64_t fileOffset;
+    uint32_t nameOffset;
+    uint32_t nameSize;
+  };
+
+  struct Mapping
+  {
+    FileHandle* handle;
+    void* buffer;
+  };
+
+  typedef std::vector<Mapping> MappingList;
+
+  static const char MAGIC[];
+  static const uint32_t VERSION;
+  static const size_t HEADER_SIZE;
+  static const size_t ENTRY_SIZE;
+
+private:
+  /// getStamp - get the real path, the size and the modification time of
+  /// the archive
+  bool getStamp(const Input& pArchive,
+                std::string& pPath,
+                uint64_t& pSize,
+                uint64_t& pTime) const;
+
+  /// getCachePath - get the path of the cache file of the archive
+  sys::fs::Path getCachePath(const std::string& pArchivePath) const;
+
+  /// readHeader - read the header of a cache file and check it against the
+  /// archive
+  bool readHeader(const uint8_t* pData,
+                  size_t pFileSize,
+                  const std::string& pPath,
+                  uint64_t pSize,
+                  uint64_t pTime,
+                  Header& pHeader) const;
+
+  /// readEntry - read the pIdx-th entry of a cache file
+  static void readEntry(const uint8_t* pData, uint32_t pIdx, Entry& pEntry);
+
+private:
+  std::string m_Directory;
+
+  /// m_Mappings - the loaded cache files
+  MappingList m_Mappings;
+};
+
+} // namespace of mcld
+
+#endif
+
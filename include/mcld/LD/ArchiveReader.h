@@ -13,6 +13,8 @@
 #endif
 #include <mcld/LD/LDReader.h>
 
+#include <vector>
+
 namespace mcld
 {
 
@@ -30,11 +32,21 @@ class Archive;
 
 class ArchiveReader : public LDReader
 {
+public:
+  typedef std::vector<Archive*> ArchiveListType;
+
 public:
   ArchiveReader();
   virtual ~ArchiveReader();
 
   virtual bool readArchive(Archive& pArchive) = 0;
+
+  /// readGroup - include more members of the archives in a group after every
+  /// input of the group is read once, until no more members are needed. The
+  /// default implementation reads the archives again and again until the
+  /// number of the included members does not change.
+  /// @param pArchives - the archives in the group, in command line order
+  virtual bool readGroup(const ArchiveListType& pArchives);
 };
 
 } // namespace of mcld
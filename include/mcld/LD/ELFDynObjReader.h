@@ -14,6 +14,8 @@
 #include <mcld/LD/DynObjReader.h>
 #include <llvm/Support/system_error.h>
 
+#include <vector>
+
 namespace mcld {
 
 class Input;
@@ -21,6 +23,7 @@ class LinkerConfig;
 class IRBuilder;
 class GNULDBackend;
 class ELFReaderIF;
+class ELFLazySymbolTable;
 
 /** \class ELFDynObjReader
  *  \brief ELFDynObjReader reads ELF dynamic shared objects.
@@ -42,9 +45,17 @@ public:
 
   bool readSymbols(Input& pInput);
 
+private:
+  typedef std::vector<ELFLazySymbolTable*> LazySymbolTableList;
+
 private:
   ELFReaderIF *m_pELFReader;
   IRBuilder& m_Builder;
+  const LinkerConfig& m_Config;
+
+  /// m_LazySymbols - the symbol tables of the dynamic objects read with
+  /// --lazy-dynamic-symbols. IRBuilder looks them up until the reader dies.
+  LazySymbolTableList m_LazySymbols;
 };
 
 } // namespace of mcld
@@ -0,0 +1,86 @@
+//===- ELFInputTables.h ---------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_ELF_INPUT_TABLES_H
+#define MCLD_LD_ELF_INPUT_TABLES_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+#include <llvm/Support/DataTypes.h>
+
+#include <string>
+#include <vector>
+
+namespace mcld {
+
+/** \class ELFInputTables
+ *  \brief ELFInputTables keeps the section header table and the symbol table
+ *  of an ELF input, decoded into host byte order and 64-bit fields.
+ *
+ *  InputPrefetcher fills it in worker threads. ELFReaderIF creates LDSections
+ *  and LDSymbols from it, so the readers do not decode the tables again.
+ */
+class ELFInputTables
+{
+public:
+  struct Section {
+    std::string name;
+    uint32_t sh_type;
+    uint64_t sh_flags;
+    uint64_t sh_offset;
+    uint64_t sh_size;
+    uint32_t sh_link;
+    uint32_t sh_info;
+    uint64_t sh_addralign;
+    uint64_t sh_entsize;
+  };
+
+  struct Symbol {
+    uint32_t st_name;
+    uint8_t  st_info;
+    uint8_t  st_other;
+    uint16_t st_shndx;
+    uint64_t st_value;
+    uint64_t st_size;
+  };
+
+  typedef std::vector<Section> SectionList;
+  typedef std::vector<Symbol> SymbolList;
+
+public:
+  ELFInputTables()
+    : m_SymTab(0x0) {
+  }
+
+  /// sections - all section headers, including the first NULL one.
+  const SectionList& sections() const { return m_Sections; }
+  SectionList&       sections()       { return m_Sections; }
+
+  /// symbols - all symbols of the symbol table symTab(), including the first
+  /// NULL one.
+  const SymbolList& symbols() const { return m_Symbols; }
+  SymbolList&       symbols()       { return m_Symbols; }
+
+  /// symTab - the section index of the decoded symbol table, or 0 if no
+  /// symbols are decoded.
+  uint32_t symTab() const { return m_SymTab; }
+
+  void setSymTab(uint32_t pIndex) { m_SymTab = pIndex; }
+
+  bool hasSymbols() const { return (0x0 != m_SymTab); }
+
+private:
+  SectionList m_Sections;
+  SymbolList m_Symbols;
+  uint32_t m_SymTab;
+};
+
+} // namespace of mcld
+
+#endif
+
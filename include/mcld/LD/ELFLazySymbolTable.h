@@ -0,0 +1,119 @@
+//===- ELFLazySymbolTable.h -----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_ELF_LAZY_SYMBOL_TABLE_H
+#define MCLD_LD_ELF_LAZY_SYMBOL_TABLE_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+#include <mcld/ADT/Uncopyable.h>
+#include <mcld/LD/LazySymbolTable.h>
+
+#include <llvm/Support/DataTypes.h>
+
+namespace mcld {
+
+class ELFReaderIF;
+class Input;
+class IRBuilder;
+
+/** \class ELFLazySymbolTable
+ *  \brief ELFLazySymbolTable looks up the .dynsym of a dynamic object by its
+ *  .gnu.hash or .hash section, and adds only the referred symbols to
+ *  NamePool.
+ *
+ *  The dynamic object must be mapped as a whole, so .dynsym, .dynstr and the
+ *  hash section stay in memory without holding MemoryRegions. The undefined
+ *  symbols of the dynamic object are not in the hash section, and they are
+ *  added at once by readUnhashed().
+ */
+class ELFLazySymbolTable : public LazySymbolTable, private Uncopyable
+{
+public:
+  /// Create - create the lazy symbol table of pInput
+  /// @param pBitClass - 32 or 64
+  /// @return NULL if pInput is not mapped as a whole or has no valid .dynsym
+  /// and hash section. The caller should read all symbols of pInput then.
+  static ELFLazySymbolTable* Create(Input& pInput,
+                                    const ELFReaderIF& pReader,
+                                    unsigned int pBitClass);
+
+  ~ELFLazySymbolTable();
+
+  /// readUnhashed - add the symbols which can not be looked up by name
+  void readUnhashed(IRBuilder& pBuilder);
+
+  /// materialize - add the defined symbols named pName to NamePool
+  bool materialize(const llvm::StringRef& pName, IRBuilder& pBuilder);
+
+  size_t numOfSymbols() const { return m_NumOfSymbols; }
+
+  size_t numOfMaterialized() const { return m_NumOfMaterialized; }
+
+private:
+  enum HashStyle {
+    SystemV,
+    GNU
+  };
+
+private:
+  ELFLazySymbolTable(Input& pInput,
+                     const ELFReaderIF& pReader,
+                     unsigned int pBitClass);
+
+  /// setUpGNUHash - set up the tables of .gnu.hash
+  bool setUpGNUHash(const uint8_t* pData, size_t pSize);
+
+  /// setUpSysVHash - set up the tables of .hash
+  bool setUpSysVHash(const uint8_t* pData, size_t pSize);
+
+  bool materializeGNU(const llvm::StringRef& pName, IRBuilder& pBuilder);
+
+  bool materializeSysV(const llvm::StringRef& pName, IRBuilder& pBuilder);
+
+  /// materializeSymbol - add the symbol pSymIdx if it is defined and named
+  /// pName
+  bool materializeSymbol(const llvm::StringRef& pName,
+                         uint32_t pSymIdx,
+                         IRBuilder& pBuilder);
+
+  uint32_t getName(uint32_t pSymIdx) const;
+
+  uint16_t getShndx(uint32_t pSymIdx) const;
+
+  uint32_t getWord(const uint8_t* pData, size_t pIdx) const;
+
+private:
+  Input& m_Input;
+  const ELFReaderIF& m_Reader;
+  unsigned int m_BitClass;
+  HashStyle m_Style;
+
+  const uint8_t* m_pSymTab;
+  size_t m_NumOfSymbols;
+  const char* m_pStrTab;
+  size_t m_StrTabSize;
+
+  /// the hash section. m_SymOffset, m_pBloom, m_BloomSize and m_BloomShift
+  /// are only used by .gnu.hash.
+  uint32_t m_NumOfBuckets;
+  const uint8_t* m_pBuckets;
+  const uint8_t* m_pChains;
+  size_t m_NumOfChains;
+  uint32_t m_SymOffset;
+  const uint8_t* m_pBloom;
+  uint32_t m_BloomSize;
+  uint32_t m_BloomShift;
+
+  size_t m_NumOfMaterialized;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -16,6 +16,8 @@
 
 #include <llvm/Support/system_error.h>
 
+#include <vector>
+
 namespace mcld {
 
 class Module;
@@ -29,11 +31,19 @@ class RelocData;
 class Output;
 class MemoryRegion;
 class MemoryArea;
+class EhFrame;
+class ThreadPool;
+class EmitTask;
 
 /** \class ELFObjectWriter
  *  \brief ELFObjectWriter writes the target-independent parts of object files.
  *  ELFObjectWriter reads a MCLDFile and writes into raw_ostream
  *
+ *  An ELF output is preallocated and mapped at once. The data of the regular,
+ *  debugging, note and .gcc_except_table sections are then copied by the
+ *  tasks of a ThreadPool (--threads), a large section being split into
+ *  ranges of fragments. The other sections, the name pools and the headers
+ *  are written by the calling thread meanwhile.
  */
 class ELFObjectWriter : public ObjectWriter
 {
@@ -48,9 +58,23 @@ public:
 
   llvm::error_code writeObject(Module& pModule, MemoryArea& pOutput);
 
+  /// FillPattern - fill pSize bytes at pBuf with the pValueSize-byte pValue
+  /// in the target byte order. pValueSize is 1, 2, 4 or 8.
+  static void FillPattern(uint8_t* pBuf,
+                          size_t pSize,
+                          uint64_t pValue,
+                          unsigned int pValueSize,
+                          bool pIsLittleEndian);
+
 private:
   void writeSection(MemoryArea& pOutput, LDSection *section);
 
+  // enqueueSection - enqueue the tasks to emit the data of pSection
+  void enqueueSection(ThreadPool& pPool,
+                      MemoryArea& pOutput,
+                      const LDSection& pSection,
+                      std::vector<EmitTask*>& pTasks);
+
   GNULDBackend&       target()        { return m_Backend; }
 
   const GNULDBackend& target() const  { return m_Backend; }
@@ -116,8 +140,15 @@ private:
     return 0;
   }
 
+  // getOutputSize - the size of the output file
+  template<size_t SIZE>
+  uint64_t getOutputSize(const Module& pModule) const;
+
   void emitSectionData(const SectionData& pSD, MemoryRegion& pRegion) const;
 
+  /// emitCIEPointers - rewrite the CIE Pointer fields of the FDEs
+  void emitCIEPointers(const EhFrame& pEhFrame, MemoryRegion& pRegion) const;
+
 private:
   GNULDBackend& m_Backend;
 
@@ -80,7 +80,17 @@ public:
   bool readSymbols(Input& pInput,
                    IRBuilder& pBuilder,
                    const MemoryRegion& pRegion,
-                   const char* StrTab) const;
+                   const char* StrTab,
+                   const uint32_t* pShndxTab) const;
+
+  /// readSymbol - read the ELF symbol of the given index in symtab and create
+  /// LDSymbol
+  LDSymbol* readSymbol(Input& pInput,
+                       IRBuilder& pBuilder,
+                       const void* pSymTab,
+                       const char* pStrTab,
+                       const uint32_t* pShndxTab,
+                       size_t pSymIdx) const;
 
   /// readSignature - read a symbol from the given Input and index in symtab
   /// This is used to get the signature of a group section.
@@ -147,7 +157,17 @@ public:
   bool readSymbols(Input& pInput,
                    IRBuilder& pBuilder,
                    const MemoryRegion& pRegion,
-                   const char* StrTab) const;
+                   const char* StrTab,
+                   const uint32_t* pShndxTab) const;
+
+  /// readSymbol - read the ELF symbol of the given index in symtab and create
+  /// LDSymbol
+  LDSymbol* readSymbol(Input& pInput,
+                       IRBuilder& pBuilder,
+                       const void* pSymTab,
+                       const char* pStrTab,
+                       const uint32_t* pShndxTab,
+                       size_t pSymIdx) const;
 
   /// readSignature - read a symbol from the given Input and index in symtab
   /// This is used to get the signature of a group section.
@@ -18,6 +18,7 @@
 
 #include <mcld/Module.h>
 #include <mcld/LinkerConfig.h>
+#include <mcld/LD/ELFInputTables.h>
 #include <mcld/LD/LDContext.h>
 #include <mcld/Target/GNULDBackend.h>
 #include <mcld/Support/MsgHandling.h>
@@ -69,10 +70,21 @@ public:
   virtual bool readRegularSection(Input& pInput, SectionData& pSD) const = 0;
 
   /// readSymbols - read ELF symbols and create LDSymbol
+  /// @param pShndxTab - the contents of SHT_SYMTAB_SHNDX section, or NULL
   virtual bool readSymbols(Input& pInput,
                            IRBuilder& pBuilder,
                            const MemoryRegion& pRegion,
-                           const char* StrTab) const = 0;
+                           const char* StrTab,
+                           const uint32_t* pShndxTab) const = 0;
+
+  /// readSymbol - read the ELF symbol of the given index in symtab and create
+  /// LDSymbol. This is used to read the symbols of a dynamic object on demand.
+  virtual LDSymbol* readSymbol(Input& pInput,
+                               IRBuilder& pBuilder,
+                               const void* pSymTab,
+                               const char* pStrTab,
+                               const uint32_t* pShndxTab,
+                               size_t pSymIdx) const = 0;
 
   /// readSignature - read a symbol from the given Input and index in symtab
   /// This is used to get the signature of a group section.
@@ -93,6 +105,22 @@ public:
   /// readDynamic - read ELF .dynamic in input dynobj
   virtual bool readDynamic(Input& pInput) const = 0;
 
+  /// getSymTabShndx - get the SHT_SYMTAB_SHNDX section of pSymTab. It keeps
+  /// the section indices of the symbols whose st_shndx is SHN_XINDEX.
+  LDSection* getSymTabShndx(Input& pInput, const LDSection& pSymTab) const;
+
+  /// createSections - create LDSections from the decoded section headers
+  bool createSections(Input& pInput,
+                      const ELFInputTables::SectionList& pSections) const;
+
+  /// addSymbols - create LDSymbols from the decoded symbols
+  /// @param pShndxTab - the contents of SHT_SYMTAB_SHNDX section, or NULL
+  bool addSymbols(Input& pInput,
+                  IRBuilder& pBuilder,
+                  const ELFInputTables::SymbolList& pSymbols,
+                  const char* pStrTab,
+                  const uint32_t* pShndxTab) const;
+
 protected:
   /// LinkInfo - some section needs sh_link and sh_info, remember them.
   struct LinkInfo {
@@ -104,9 +132,23 @@ protected:
   typedef std::vector<LinkInfo> LinkInfoList;
 
 protected:
+  /// addSymbol - create the LDSymbol of the decoded symbol of the given index
+  /// in symtab
+  LDSymbol* addSymbol(Input& pInput,
+                      IRBuilder& pBuilder,
+                      const ELFInputTables::Symbol& pSymbol,
+                      const char* pStrTab,
+                      const uint32_t* pShndxTab,
+                      size_t pSymIdx) const;
+
   ResolveInfo::Type getSymType(uint8_t pInfo, uint16_t pShndx) const;
 
-  ResolveInfo::Desc getSymDesc(uint16_t pShndx, const Input& pInput) const;
+  ResolveInfo::Desc getSymDesc(uint16_t pShndx,
+                               const LDSection* pSection) const;
+
+  /// getExtendedShndx - get the section index of the symbol from the
+  /// SHT_SYMTAB_SHNDX section
+  uint32_t getExtendedShndx(const uint32_t* pShndxTab, size_t pSymIdx) const;
 
   ResolveInfo::Binding getSymBinding(uint8_t pBinding,
                                      uint16_t pShndx,
@@ -67,12 +67,20 @@ public:
         const CIE& pCIE,
         uint32_t pDataStart);
 
-    const CIE& getCIE() const { return m_CIE; }
+    const CIE& getCIE() const { return *m_pCIE; }
+
+    /// setCIE - refer to an identical CIE instead when the CIE of this FDE is
+    /// removed
+    void setCIE(const CIE& pCIE) { m_pCIE = &pCIE; }
 
     uint32_t getDataStart() const { return m_DataStart; }
 
+    /// getCIEPointerOffset - the offset of the CIE Pointer field, which
+    /// precedes the PC Begin field
+    uint32_t getCIEPointerOffset() const { return m_DataStart - 4; }
+
   private:
-    const CIE& m_CIE;
+    const CIE* m_pCIE;
     uint32_t m_DataStart;
   };
 
@@ -115,6 +123,22 @@ public:
   /// addFDE - add a FDE entry in EhFrame
   void addFDE(FDE& pFDE);
 
+  /// removeFragment - unlink a CIE or an FDE from the section data. The
+  /// fragment is not deleted, since the symbols of the section may still
+  /// refer to it. The caller also removes it from the CIE or FDE list.
+  void removeFragment(RegionFragment& pFrag);
+
+  /// clear - remove all fragments, CIEs and FDEs
+  void clear();
+
+  /// setUnparsed - the section is read as a single region, so its CIEs and
+  /// FDEs are unknown
+  void setUnparsed() { m_bUnparsed = true; }
+
+  /// isUnparsed - return true if this section or a section merged into it
+  /// is not parsed
+  bool isUnparsed() const { return m_bUnparsed; }
+
   // -----  CIE  ----- //
   const_cie_iterator cie_begin() const { return m_CIEs.begin(); }
   cie_iterator       cie_begin()       { return m_CIEs.begin(); }
@@ -128,6 +152,9 @@ public:
 
   size_t numOfCIEs() const { return m_CIEs.size(); }
 
+  const CIEList& getCIEList() const { return m_CIEs; }
+  CIEList&       getCIEList()       { return m_CIEs; }
+
   // -----  FDE  ----- //
   const_fde_iterator fde_begin() const { return m_FDEs.begin(); }
   fde_iterator       fde_begin()       { return m_FDEs.begin(); }
@@ -141,12 +168,17 @@ public:
 
   size_t numOfFDEs() const { return m_FDEs.size(); }
 
+  const FDEList& getFDEList() const { return m_FDEs; }
+  FDEList&       getFDEList()       { return m_FDEs; }
+
 private:
   LDSection* m_pSection;
   SectionData* m_pSectionData;
 
   CIEList m_CIEs;
   FDEList m_FDEs;
+
+  bool m_bUnparsed;
 };
 
 } // namespace of mcld
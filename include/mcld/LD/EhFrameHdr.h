@@ -34,6 +34,8 @@ class MemoryRegion;
  *  uint32_t : fde_count
  *  __________________________ when fde_count > 0
  *  <uint32_t, uint32_t>+ : binary search table
+ *
+ *  The rows of the binary search table are sdata4 in both ELF32 and ELF64.
  */
 class EhFrameHdr
 {
@@ -45,15 +47,18 @@ public:
   /// sizeOutput - base on the fde count to size output
   void sizeOutput();
 
-  /// emitOutput - write out eh_frame_hdr
+  /// emitOutput - write out eh_frame_hdr. The binary search table is built
+  /// from the emitted .eh_frame and sorted by up to pNumOfThreads threads.
   template<size_t size>
-  void emitOutput(MemoryArea& pOutput)
+  void emitOutput(MemoryArea& pOutput, unsigned int pNumOfThreads = 1)
   { assert(false && "Call invalid EhFrameHdr::emitOutput"); }
 
 private:
-  /// computePCBegin - return the address of FDE's pc
-  /// @ref binutils gold: ehframe.cc:222
-  uint32_t computePCBegin(const EhFrame::FDE& pFDE, const MemoryRegion& pEhFrameRegion);
+  template<size_t SIZE>
+  void emitHeader(MemoryArea& pOutput, unsigned int pNumOfThreads);
+
+  /// hasTable - return true if the binary search table can be built
+  bool hasTable() const;
 
 private:
   /// .eh_frame_hdr section
@@ -68,10 +73,12 @@ private:
 //===----------------------------------------------------------------------===//
 /// emitOutput - write out eh_frame_hdr
 template<>
-void EhFrameHdr::emitOutput<32>(MemoryArea& pOutput);
+void EhFrameHdr::emitOutput<32>(MemoryArea& pOutput,
+                                unsigned int pNumOfThreads);
 
 template<>
-void EhFrameHdr::emitOutput<64>(MemoryArea& pOutput);
+void EhFrameHdr::emitOutput<64>(MemoryArea& pOutput,
+                                unsigned int pNumOfThreads);
 
 } // namespace of mcld
 
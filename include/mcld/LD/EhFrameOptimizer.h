@@ -0,0 +1,141 @@
+//===- EhFrameOptimizer.h -------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_EH_FRAME_OPTIMIZER_H
+#define MCLD_LD_EH_FRAME_OPTIMIZER_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+#include <mcld/ADT/HashEntry.h>
+#include <mcld/ADT/HashTable.h>
+#include <mcld/ADT/StringEntry.h>
+#include <mcld/ADT/StringHash.h>
+#include <mcld/ADT/Uncopyable.h>
+#include <mcld/LD/EhFrame.h>
+
+#include <llvm/Support/DataTypes.h>
+
+#include <string>
+#include <vector>
+
+namespace mcld {
+
+class Fragment;
+class LinkerConfig;
+class Module;
+class RegionFragment;
+class RelocData;
+class Relocation;
+
+/** \class EhFrameOptimizer
+ *  \brief EhFrameOptimizer removes the redundant entries of the input .eh_frame
+ *  sections before they are merged.
+ *
+ *  An FDE is dead if the code it describes is discarded - its PC Begin field
+ *  has no relocation because the referred group section is discarded, or the
+ *  relocation refers to a section removed by --gc-sections or --icf. The CIEs
+ *  without live FDEs are dead, too.
+ *
+ *  A CIE is a duplicate if a former CIE has the same contents and relocations.
+ *  Its FDEs refer to the former CIE, and the writer rewrites their CIE
+ *  Pointer fields by the output offsets.
+ *
+ *  The removed CIEs and FDEs are unlinked from the input section data, and
+ *  their relocations are removed, so they are neither scanned nor applied.
+ */
+class EhFrameOptimizer : private Uncopyable
+{
+public:
+  EhFrameOptimizer(const LinkerConfig& pConfig, Module& pModule);
+
+  ~EhFrameOptimizer();
+
+  /// run - remove the dead FDEs and the dead and duplicate CIEs
+  bool run();
+
+  size_t numOfRemovedCIEs() const { return m_NumOfRemovedCIEs; }
+
+  size_t numOfRemovedFDEs() const { return m_NumOfRemovedFDEs; }
+
+private:
+  typedef std::vector<Relocation*> RelocListType;
+
+  /// RelocEntry - the relocations of a CIE or an FDE
+  struct RelocEntry
+  {
+    RelocData* data;
+    RelocListType relocs;
+  };
+
+  struct PtrCompare
+  {
+    bool operator()(const Fragment* X, const Fragment* Y) const
+    { return (X==Y); }
+  };
+
+  struct PtrHash
+  {
+    size_t operator()(const Fragment* pKey) const
+    {
+      return (unsigned((uintptr_t)pKey) >> 4) ^
+             (unsigned((uintptr_t)pKey) >> 9);
+    }
+  };
+
+  /// HashTable for a CIE or an FDE to its index in m_Relocs
+  typedef HashEntry<const Fragment*, size_t, PtrCompare> FragHashEntryType;
+  typedef HashTable<FragHashEntryType,
+                    PtrHash,
+                    EntryFactory<FragHashEntryType> > FragHashTableType;
+
+  /// HashTable for the key of a CIE to the first CIE with the key
+  typedef HashTable<StringEntry<EhFrame::CIE*>,
+                    StringHash<BKDR>,
+                    StringEntryFactory<EhFrame::CIE*> > CIEHashTableType;
+
+private:
+  /// collectRelocations - group the relocations of .eh_frame by the entries
+  void collectRelocations();
+
+  /// optimize - remove the redundant entries of an input .eh_frame
+  void optimize(EhFrame& pEhFrame);
+
+  /// isDead - return true if the code described by pFDE is discarded
+  bool isDead(const EhFrame::FDE& pFDE) const;
+
+  /// getKey - serialize the contents and the relocations of pCIE
+  /// @return false if pCIE can not be compared
+  bool getKey(const EhFrame& pEhFrame,
+              const EhFrame::CIE& pCIE,
+              std::string& pKey) const;
+
+  /// remove - unlink pFrag and remove its relocations
+  void remove(EhFrame& pEhFrame, RegionFragment& pFrag);
+
+  const RelocEntry* getRelocs(const Fragment& pFrag) const;
+
+private:
+  const LinkerConfig& m_Config;
+  Module& m_Module;
+
+  /// m_RelocIndex - map an entry to its index in m_Relocs
+  FragHashTableType m_RelocIndex;
+
+  std::vector<RelocEntry> m_Relocs;
+
+  /// m_CIEIndex - the kept CIEs, in link order
+  CIEHashTableType m_CIEIndex;
+
+  size_t m_NumOfRemovedCIEs;
+  size_t m_NumOfRemovedFDEs;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -73,10 +73,14 @@ private:
                          MemoryRegion& pRegion,
                          const Token& pToken);
 private:
+  template<size_t BITCLASS>
+  bool readEhFrame(Input& pInput, EhFrame& pEhFrame);
+
   /// scan - scan pData from pHandler for a token.
   template<bool SAME_ENDIAN> Token
   scan(ConstAddress pHandler, uint64_t pOffset, const MemoryRegion& pData) const;
 
+  template<size_t BITCLASS>
   static bool addCIE(EhFrame& pEhFrame,
                      MemoryRegion& pRegion,
                      const Token& pToken);
@@ -98,6 +102,9 @@ private:
 template<> bool
 EhFrameReader::read<32, true>(Input& pInput, EhFrame& pEhFrame);
 
+template<> bool
+EhFrameReader::read<64, true>(Input& pInput, EhFrame& pEhFrame);
+
 template<> EhFrameReader::Token
 EhFrameReader::scan<true>(ConstAddress pHandler,
                           uint64_t pOffset,
@@ -12,9 +12,14 @@
 #include <gtest.h>
 #endif
 
+#include <mcld/ADT/HashEntry.h>
+#include <mcld/ADT/HashTable.h>
+#include <mcld/ADT/StringHash.h>
 #include <mcld/LD/ArchiveReader.h>
 #include <mcld/LD/Archive.h>
 
+#include <vector>
+
 namespace mcld {
 
 class Module;
@@ -22,6 +27,7 @@ class Input;
 class ELFObjectReader;
 class MemoryAreaFactory;
 class Archive;
+class ArchiveIndexCache;
 
 /** \class GNUArchiveReader
  *  \brief GNUArchiveReader reads GNU archive files.
@@ -40,6 +46,44 @@ public:
   /// isMyFormat
   bool isMyFormat(Input& input) const;
 
+  /// readGroup - include the members of the archives in a group which define
+  /// the symbols referred by the inputs read after them
+  bool readGroup(const ArchiveListType& pArchives);
+
+  /// setIndexCache - use pCache to skip parsing the symtab and strtab of the
+  /// archives. The reader takes over the cache.
+  void setIndexCache(ArchiveIndexCache* pCache);
+
+  /// parseSize - parse the decimal size field of a member header
+  /// @return false if the field is not a number padded with spaces, or the
+  ///         number does not fit in a file offset
+  static bool parseSize(const char* pField, size_t pLength, uint64_t& pSize);
+
+private:
+  typedef std::vector<Input*> MemberListType;
+
+  /// GroupSymbol - an armap symbol of an archive in a group
+  struct GroupSymbol
+  {
+    /// the position of the archive in the group
+    size_t archive;
+    size_t index;
+  };
+
+  /// GroupSymbolListType - the armap symbols with a name, one per archive,
+  /// in command line order
+  typedef std::vector<GroupSymbol> GroupSymbolListType;
+
+  typedef HashEntry<const llvm::StringRef,
+                    GroupSymbolListType,
+                    StringCompare<llvm::StringRef> > GroupIndexEntryType;
+
+  /// GroupIndexType - map a symbol name to the archives in a group which
+  /// define it
+  typedef HashTable<GroupIndexEntryType,
+                    StringHash<XX>,
+                    EntryFactory<GroupIndexEntryType> > GroupIndexType;
+
 private:
   /// isArchive
   bool isArchive(const char* pStr) const;
@@ -61,9 +105,9 @@ private:
   /// @param pMemberSize   - the file size of this member
   Input* readMemberHeader(Archive& pArchiveRoot,
                           Input& pArchiveFile,
-                          uint32_t pFileOffset,
-                          uint32_t& pNestedOffset,
-                          size_t& pMemberSize);
+                          uint64_t pFileOffset,
+                          uint64_t& pNestedOffset,
+                          uint64_t& pMemberSize);
 
   /// readSymbolTable - read the archive symbol map (armap)
   bool readSymbolTable(Archive& pArchive);
@@ -76,11 +120,33 @@ private:
   enum Archive::Symbol::Status
   shouldIncludeSymbol(const llvm::StringRef& pSymName) const;
 
+  /// scanSymbol - decide whether to include the member which defines the
+  /// armap symbol, and push the included member into the worklist
+  void scanSymbol(Archive& pArchive,
+                  size_t pSymIdx,
+                  MemberListType& pWorkList);
+
+  /// PendingListType - the armap symbols of each archive in a group to
+  /// examine when the scan reaches the archive
+  typedef std::vector<std::vector<size_t> > PendingListType;
+
+  /// scanGroupMembers - hand the undefined symbols of the members in
+  /// pWorkList to the archives which are scanned next, and drain pWorkList
+  /// @return the number of the armap symbols added to pPending
+  size_t scanGroupMembers(const GroupIndexType& pIndex,
+                          size_t pArchive,
+                          MemberListType& pWorkList,
+                          PendingListType& pPending);
+
   /// includeMember - include the object member in the given file offset, and
-  /// return the size of the object
+  /// get the size of the object
   /// @param pArchiveRoot - the archive root
   /// @param pFileOffset  - file offset of the member header in the archive
-  size_t includeMember(Archive& pArchiveRoot, uint32_t pFileOffset);
+  /// @param pSize        - the size of the object
+  /// @return false if the member header is malformed
+  bool includeMember(Archive& pArchiveRoot,
+                     uint64_t pFileOffset,
+                     uint64_t& pSize);
 
   /// includeAllMembers - include all object members. This is called if
   /// --whole-archive is the attribute for this archive file.
@@ -89,6 +155,7 @@ private:
 private:
   Module& m_Module;
   ELFObjectReader& m_ELFObjectReader;
+  ArchiveIndexCache* m_pIndexCache;
 };
 
 } // namespace of mcld
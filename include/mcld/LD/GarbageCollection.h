@@ -0,0 +1,145 @@
+//===- GarbageCollection.h ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_GARBAGE_COLLECTION_H
+#define MCLD_LD_GARBAGE_COLLECTION_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+#include <mcld/ADT/HashEntry.h>
+#include <mcld/ADT/HashTable.h>
+#include <mcld/ADT/Uncopyable.h>
+
+#include <llvm/Support/DataTypes.h>
+
+#include <vector>
+
+namespace mcld {
+
+class LDSection;
+class LDSymbol;
+class LinkerConfig;
+class Module;
+class ResolveInfo;
+class TargetLDBackend;
+
+/** \class GarbageCollection
+ *  \brief GarbageCollection removes the unused input sections (--gc-sections).
+ *
+ *  The nodes of the reference graph are the allocatable regular and BSS input
+ *  sections, and the edges are the relocations from a section to the sections
+ *  which define the referred symbols. The sections which are not reachable
+ *  from the roots - the entry symbol, the symbols exported to .dynsym and the
+ *  sections kept by name (such as .init and .ctors) - are changed to
+ *  LDFileFormat::Ignore together with their relocation sections, so the later
+ *  passes do not merge them, scan or apply their relocations.
+ *
+ *  GarbageCollection runs after all relocations are read and before the input
+ *  sections are merged.
+ */
+class GarbageCollection : private Uncopyable
+{
+public:
+  GarbageCollection(const LinkerConfig& pConfig,
+                    const TargetLDBackend& pBackend,
+                    Module& pModule);
+
+  ~GarbageCollection();
+
+  /// run - do garbage collection
+  bool run();
+
+  size_t numOfSections() const { return m_Sections.size(); }
+
+  size_t numOfStrippedSections() const { return m_NumOfStripped; }
+
+private:
+  typedef std::vector<LDSection*> SectionListType;
+  typedef std::vector<size_t> IndexListType;
+
+  struct PtrCompare
+  {
+    bool operator()(const LDSection* X, const LDSection* Y) const
+    { return (X==Y); }
+  };
+
+  struct PtrHash
+  {
+    size_t operator()(const LDSection* pKey) const
+    {
+      return (unsigned((uintptr_t)pKey) >> 4) ^
+             (unsigned((uintptr_t)pKey) >> 9);
+    }
+  };
+
+  /// HashTable for LDSection* to its index in m_Sections
+  typedef HashEntry<const LDSection*, size_t, PtrCompare> SectHashEntryType;
+  typedef HashTable<SectHashEntryType,
+                    PtrHash,
+                    EntryFactory<SectHashEntryType> > SectHashTableType;
+
+private:
+  /// setUpNodes - collect the sections which may be garbage collected
+  void setUpNodes();
+
+  /// setUpEdges - traverse all relocations to connect the sections
+  void setUpEdges();
+
+  /// setUpRoots - push the sections which must be kept into the worklist
+  void setUpRoots(IndexListType& pWorkList);
+
+  /// findReachedSections - mark all sections reachable from the worklist
+  void findReachedSections(IndexListType& pWorkList);
+
+  /// stripSections - set the unreached sections and their relocation
+  /// sections to Ignore
+  void stripSections();
+
+  /// clearIfStripped - make a symbol defined in a stripped section absolute
+  /// zero
+  void clearIfStripped(LDSymbol& pSymbol);
+
+  /// getIndex - get the node index of the section which defines pSymbol
+  /// @return false if pSymbol is not defined in a node
+  bool getIndex(const ResolveInfo& pSymbol, size_t& pIndex) const;
+  bool getIndex(const LDSection& pSection, size_t& pIndex) const;
+
+  /// markReached - mark a node reached and push it into the worklist
+  void markReached(size_t pIndex, IndexListType& pWorkList);
+
+  /// mayProcess - return true if the input section is a node
+  static bool mayProcess(const LDSection& pSection);
+
+  /// shouldKeep - return true if the input section should be kept even if
+  /// nothing refers to it
+  static bool shouldKeep(const LDSection& pSection);
+
+private:
+  const LinkerConfig& m_Config;
+  const TargetLDBackend& m_Backend;
+  Module& m_Module;
+
+  /// m_Sections - the nodes
+  SectionListType m_Sections;
+
+  /// m_SectionIndex - map a node to its index in m_Sections
+  SectHashTableType m_SectionIndex;
+
+  /// m_Edges - m_Edges[i] lists the nodes referred by the node i
+  std::vector<IndexListType> m_Edges;
+
+  /// m_Reached - m_Reached[i] is true if the node i is reachable from roots
+  std::vector<bool> m_Reached;
+
+  size_t m_NumOfStripped;
+};
+
+} // namespace of mcld
+
+#endif
+
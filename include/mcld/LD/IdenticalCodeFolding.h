@@ -0,0 +1,188 @@
+//===- IdenticalCodeFolding.h ---------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_IDENTICAL_CODE_FOLDING_H
+#define MCLD_LD_IDENTICAL_CODE_FOLDING_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+#include <mcld/ADT/HashEntry.h>
+#include <mcld/ADT/HashTable.h>
+#include <mcld/ADT/Uncopyable.h>
+
+#include <llvm/Support/DataTypes.h>
+
+#include <string>
+#include <vector>
+
+namespace mcld {
+
+class Fragment;
+class LDSection;
+class LDSymbol;
+class LinkerConfig;
+class Module;
+class RegionFragment;
+class ResolveInfo;
+class TargetLDBackend;
+
+/** \class IdenticalCodeFolding
+ *  \brief IdenticalCodeFolding merges the identical read-only executable
+ *  input sections (--icf).
+ *
+ *  Two sections are identical if they have the same contents, flags and
+ *  alignment, and their relocations have the same offsets, types and addends
+ *  and refer to the same symbols. When a relocation refers to a symbol
+ *  defined in another foldable section, it is enough that the two referred
+ *  sections are identical at the same offset. The equivalence classes are
+ *  first split by contents and then refined until they do not change any
+ *  more, so mutually recursive functions are folded, too.
+ *
+ *  In each class, the first section in link order is kept. The symbols of
+ *  the other sections are moved to the fragments of the kept section, and the
+ *  other sections and their relocation sections become LDFileFormat::Ignore.
+ *
+ *  With --icf=safe, a section is folded only if it is a constructor or a
+ *  destructor, whose address can not be taken, or if no symbol defined in it
+ *  is exported to .dynsym and TargetLDBackend::mayTakeFunctionAddress()
+ *  returns false for every relocation which refers to it.
+ */
+class IdenticalCodeFolding : private Uncopyable
+{
+public:
+  IdenticalCodeFolding(const LinkerConfig& pConfig,
+                       const TargetLDBackend& pBackend,
+                       Module& pModule);
+
+  ~IdenticalCodeFolding();
+
+  /// foldIdenticalCode - fold the identical sections
+  bool foldIdenticalCode();
+
+  size_t numOfCandidates() const { return m_Sections.size(); }
+
+  size_t numOfFoldedSections() const { return m_NumOfFolded; }
+
+  /// isCtorOrDtor - return true if pSectionName is .text.<name>, or
+  /// .text.<prefix>.<name> such as .text.unlikely.<name>, and <name> is the
+  /// Itanium C++ ABI mangled name of a constructor or destructor.
+  static bool isCtorOrDtor(const std::string& pSectionName);
+
+private:
+  /// RelocKey - what a relocation contributes to the identity of a section
+  struct RelocKey
+  {
+    uint64_t offset;
+    uint32_t type;
+    uint64_t addend;
+
+    /// symbol - the referred symbol if it is not defined in a candidate
+    const ResolveInfo* symbol;
+
+    /// target, target_offset - the referred candidate and the offset of the
+    /// symbol in it. target is npos if the symbol is not in a candidate.
+    size_t target;
+    uint64_t target_offset;
+
+    bool operator<(const RelocKey& pOther) const
+    { return offset < pOther.offset; }
+  };
+
+  typedef std::vector<RelocKey> RelocKeyListType;
+  typedef std::vector<LDSection*> SectionListType;
+  typedef std::vector<size_t> IndexListType;
+
+  struct PtrCompare
+  {
+    bool operator()(const LDSection* X, const LDSection* Y) const
+    { return (X==Y); }
+  };
+
+  struct PtrHash
+  {
+    size_t operator()(const LDSection* pKey) const
+    {
+      return (unsigned((uintptr_t)pKey) >> 4) ^
+             (unsigned((uintptr_t)pKey) >> 9);
+    }
+  };
+
+  /// HashTable for LDSection* to its index in m_Sections
+  typedef HashEntry<const LDSection*, size_t, PtrCompare> SectHashEntryType;
+  typedef HashTable<SectHashEntryType,
+                    PtrHash,
+                    EntryFactory<SectHashEntryType> > SectHashTableType;
+
+  static const size_t npos = static_cast<size_t>(-1);
+
+private:
+  /// findCandidates - collect the sections which may be folded
+  void findCandidates();
+
+  /// dropUnsafeCandidates - remove the candidates whose address may be taken
+  /// (--icf=safe)
+  void dropUnsafeCandidates();
+
+  /// collectRelocations - build the RelocKeys of every candidate
+  void collectRelocations();
+
+  /// initClasses - split the candidates by contents and relocations
+  /// @return the number of classes
+  size_t initClasses();
+
+  /// refineClasses - split the classes by the classes of the referred
+  /// candidates
+  /// @return the number of classes
+  size_t refineClasses();
+
+  /// fold - keep the first section of each class and drop the others
+  void fold();
+
+  /// redirect - move pSymbol to the kept section if it is defined in a
+  /// folded section
+  void redirect(LDSymbol& pSymbol, const IndexListType& pKept);
+
+  bool isCandidate(const LDSection& pSection) const;
+
+  /// isStaticallyEqual - compare everything but the classes of the referred
+  /// candidates
+  bool isStaticallyEqual(size_t pX, size_t pY) const;
+
+  uint32_t hashOf(size_t pIndex) const;
+
+  bool getIndex(const LDSection& pSection, size_t& pIndex) const;
+
+  /// getIndex - get the candidate which defines pSymbol
+  bool getIndex(const ResolveInfo& pSymbol, size_t& pIndex) const;
+
+  const RegionFragment& getRegion(size_t pIndex) const;
+
+private:
+  const LinkerConfig& m_Config;
+  const TargetLDBackend& m_Backend;
+  Module& m_Module;
+
+  /// m_Sections - the candidates, in link order
+  SectionListType m_Sections;
+
+  /// m_SectionIndex - map a candidate to its index in m_Sections
+  SectHashTableType m_SectionIndex;
+
+  /// m_Relocs - m_Relocs[i] is the sorted RelocKeys of the candidate i
+  std::vector<RelocKeyListType> m_Relocs;
+
+  /// m_Class - m_Class[i] is the equivalence class of the candidate i
+  IndexListType m_Class;
+
+  size_t m_NumOfFolded;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -0,0 +1,83 @@
+//===- InputPrefetcher.h --------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_INPUT_PREFETCHER_H
+#define MCLD_LD_INPUT_PREFETCHER_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+#include <mcld/Support/ThreadPool.h>
+#include <mcld/ADT/Uncopyable.h>
+
+#include <sys/types.h>
+#include <cstddef>
+#include <map>
+#include <vector>
+
+namespace mcld {
+
+class Input;
+class MemoryArea;
+class MemoryRegion;
+
+/** \class InputPrefetcher
+ *  \brief InputPrefetcher decodes the section tables and the symbol tables
+ *  of ELF inputs on a pool of threads.
+ *
+ *  For every ELF relocatable object and shared object in the host byte order,
+ *  a worker decodes the section header table, the section names and the
+ *  symbol table into an ELFInputTables. load() attaches the tables to the
+ *  inputs, and the ELF readers create LDSections and LDSymbols from them
+ *  instead of decoding the file again.
+ *
+ *  If the input is mapped as a whole, the workers read the mapping in place
+ *  and advise the system to read the sections of relocatable objects ahead.
+ *  Otherwise the parts they read are handed to the MemoryArea of the input,
+ *  so the readers find them there.
+ *
+ *  Creating sections and inserting symbols still run in one thread in the
+ *  order of the command line, so the result of symbol resolution does not
+ *  depend on the number of threads.
+ */
+class InputPrefetcher : private Uncopyable
+{
+public:
+  explicit InputPrefetcher(unsigned int pNumOfThreads);
+
+  ~InputPrefetcher();
+
+  /// add - schedule an input. The inputs of the same file share the tables.
+  void add(Input& pInput);
+
+  /// load - decode all scheduled inputs and attach the tables to them.
+  void load();
+
+  /// release - detach the tables from the inputs and give up the loaded
+  /// spaces which are not used by readers.
+  void release();
+
+  size_t numOfInputs() const { return m_Tasks.size(); }
+
+private:
+  class Task;
+
+  typedef std::vector<Task*> TaskList;
+  typedef std::map<std::pair<const MemoryArea*, off_t>, Task*> TaskMap;
+  typedef std::vector<std::pair<MemoryArea*, MemoryRegion*> > PinList;
+
+private:
+  ThreadPool m_Pool;
+  TaskList m_Tasks;
+  TaskMap m_TaskMap;
+  PinList m_Pins;
+};
+
+} // namespace of mcld
+
+#endif
+
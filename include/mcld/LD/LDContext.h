@@ -72,6 +72,12 @@ public:
   void addSymbol(LDSymbol* pSym)
   { m_SymTab.push_back(pSym); }
 
+  void reserveSymbols(size_t pNum)
+  { m_SymTab.reserve(m_SymTab.size() + pNum); }
+
+  size_t numOfSymbols() const
+  { return m_SymTab.size(); }
+
   // -----  relocations  ----- //
   const_sect_iterator relocSectBegin() const { return m_RelocSections.begin(); }
   sect_iterator       relocSectBegin()       { return m_RelocSections.begin(); }
@@ -129,6 +129,11 @@ public:
   size_t getInfo() const
   { return m_Info; }
 
+  /// entSize - the size of the entries of a table section, or the size of
+  /// the pieces of a SHF_MERGE section. Zero if the section is not a table.
+  uint64_t entSize() const
+  { return m_EntSize; }
+
   void setKind(LDFileFormat::Kind pKind)
   { m_Kind = pKind; }
 
@@ -182,6 +187,9 @@ public:
   void setInfo(size_t pInfo)
   { m_Info = pInfo; }
 
+  void setEntSize(uint64_t pEntSize)
+  { m_EntSize = pEntSize; }
+
   void setIndex(size_t pIndex)
   { m_Index = pIndex; }
 
@@ -207,6 +215,7 @@ private:
 
   size_t m_Info;
   LDSection* m_pLink;
+  uint64_t m_EntSize;
 
   /// m_Data - the SectionData or RelocData of this section
   SectOrRelocData m_Data;
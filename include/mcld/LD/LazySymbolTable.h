@@ -0,0 +1,41 @@
+//===- LazySymbolTable.h --------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_LAZY_SYMBOL_TABLE_H
+#define MCLD_LD_LAZY_SYMBOL_TABLE_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+#include <llvm/ADT/StringRef.h>
+
+namespace mcld {
+
+class IRBuilder;
+
+/** \class LazySymbolTable
+ *  \brief LazySymbolTable keeps the symbols of an input out of NamePool until
+ *  they are referred.
+ *
+ *  IRBuilder asks every LazySymbolTable for the name of each new undefined
+ *  symbol, in the order the LazySymbolTables are added.
+ */
+class LazySymbolTable
+{
+public:
+  virtual ~LazySymbolTable() { }
+
+  /// materialize - add the symbols defined with the name pName to NamePool
+  /// @return true if any symbol is added
+  virtual bool materialize(const llvm::StringRef& pName,
+                           IRBuilder& pBuilder) = 0;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -0,0 +1,238 @@
+//===- MergeableSectionOptimizer.h ----------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LD_MERGEABLE_SECTION_OPTIMIZER_H
+#define MCLD_LD_MERGEABLE_SECTION_OPTIMIZER_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+#include <mcld/ADT/HashEntry.h>
+#include <mcld/ADT/HashTable.h>
+#include <mcld/ADT/StringEntry.h>
+#include <mcld/ADT/StringHash.h>
+#include <mcld/ADT/Uncopyable.h>
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/DataTypes.h>
+
+#include <vector>
+
+namespace mcld {
+
+class Fragment;
+class FragmentRef;
+class LDSection;
+class LDSymbol;
+class LinkerConfig;
+class Module;
+class RegionFragment;
+class Relocation;
+class ResolveInfo;
+
+/** \class MergeableSectionOptimizer
+ *  \brief MergeableSectionOptimizer removes the duplicate strings and
+ *  constants of the input SHF_MERGE sections before they are merged.
+ *
+ *  The input sections with the same name, flags and entry size form a group.
+ *  A section is split into pieces - the null-terminated strings of a
+ *  SHF_STRINGS section, or the entries of the others - and only the first
+ *  piece with the same contents in a group is kept. With --tail-merge-strings
+ *  a string which is the tail of another string in the group is removed, too.
+ *
+ *  The kept pieces of a section become fragments of the input region, so the
+ *  contents are not copied. The symbols defined in the removed pieces are
+ *  moved to the kept ones, and so are the relocations which refer to a piece
+ *  by the section symbol and the addend.
+ *
+ *  A section is left as is if it is the target of relocations, if a REL
+ *  relocation refers to it by the section symbol, or if it is malformed.
+ */
+class MergeableSectionOptimizer : private Uncopyable
+{
+public:
+  MergeableSectionOptimizer(const LinkerConfig& pConfig, Module& pModule);
+
+  ~MergeableSectionOptimizer();
+
+  /// run - remove the duplicate pieces of the mergeable sections
+  bool run();
+
+  size_t numOfRemovedPieces() const { return m_NumOfRemovedPieces; }
+
+  uint64_t numOfRemovedBytes() const { return m_NumOfRemovedBytes; }
+
+private:
+  class PieceTask;
+  friend class PieceTask;
+
+  /// Piece - a string or an entry of a mergeable section
+  struct Piece
+  {
+    uint64_t offset;
+    uint64_t size;
+    uint32_t hash;
+    /// the index of the piece contents in Group::uniques
+    size_t unique;
+  };
+
+  typedef std::vector<Piece> PieceListType;
+
+  /// Run - the consecutive kept pieces of a section, which are a fragment.
+  /// The offset is in the rewritten section.
+  struct Run
+  {
+    uint64_t offset;
+    Fragment* frag;
+  };
+
+  typedef std::vector<Run> RunListType;
+
+  struct Member
+  {
+    LDSection* section;
+    RegionFragment* frag;
+    size_t group;
+    /// false if the section is left as is
+    bool merged;
+    PieceListType pieces;
+    RunListType runs;
+    ResolveInfo* symbol;
+  };
+
+  /// Unique - the first piece with the contents in a group. A tail merged
+  /// string is at the offset delta of its root string.
+  struct Unique
+  {
+    size_t member;
+    size_t piece;
+    size_t root;
+    uint64_t delta;
+    uint64_t offset;
+  };
+
+  typedef std::vector<Unique> UniqueListType;
+
+  struct Group
+  {
+    uint64_t entsize;
+    bool strings;
+    std::vector<size_t> members;
+    UniqueListType uniques;
+  };
+
+  /// SectionReloc - a relocation which refers to a member by the section
+  /// symbol
+  struct SectionReloc
+  {
+    Relocation* reloc;
+    size_t member;
+    /// the offset in the input section, which is the symbol value plus the
+    /// addend
+    uint64_t offset;
+  };
+
+  struct PtrCompare
+  {
+    bool operator()(const Fragment* X, const Fragment* Y) const
+    { return (X==Y); }
+  };
+
+  struct PtrHash
+  {
+    size_t operator()(const Fragment* pKey) const
+    {
+      return (unsigned((uintptr_t)pKey) >> 4) ^
+             (unsigned((uintptr_t)pKey) >> 9);
+    }
+  };
+
+  /// HashTable for the region fragment of a member to its index
+  typedef HashEntry<const Fragment*, size_t, PtrCompare> FragHashEntryType;
+  typedef HashTable<FragHashEntryType,
+                    PtrHash,
+                    EntryFactory<FragHashEntryType> > FragHashTableType;
+
+  /// HashTable for the key of a group to its index
+  typedef HashTable<StringEntry<size_t>,
+                    StringHash<XX>,
+                    StringEntryFactory<size_t> > GroupHashTableType;
+
+  /// HashTable for the contents of a piece to its index in Group::uniques
+  typedef HashEntry<llvm::StringRef,
+                    size_t,
+                    StringCompare<llvm::StringRef> > PieceHashEntryType;
+  typedef HashTable<PieceHashEntryType,
+                    StringHash<XX>,
+                    EntryFactory<PieceHashEntryType> > PieceHashTableType;
+
+private:
+  /// collectSections - collect the mergeable sections and group them
+  void collectSections();
+
+  /// collectRelocations - leave the relocated sections and the sections
+  /// referred by REL section symbols as they are
+  void collectRelocations();
+
+  /// splitMember - split a member into pieces. This runs in a worker thread.
+  void splitMember(size_t pIdx);
+
+  /// mergeGroup - find the unique pieces of a group and lay them out. This
+  /// runs in a worker thread, and a group is merged by one thread.
+  void mergeGroup(size_t pIdx);
+
+  /// tailMerge - put the strings which are the tails of others into them
+  void tailMerge(Group& pGroup);
+
+  /// rewrite - replace the region of a member by the kept pieces
+  void rewrite(size_t pIdx);
+
+  /// redirect - move a symbol defined in a removed piece to the kept piece
+  void redirect(LDSymbol& pSymbol);
+
+  /// redirect - move a relocation to the section symbol of the kept piece
+  void redirect(const SectionReloc& pReloc);
+
+  const llvm::StringRef getContents(const Member& pMember,
+                                    const Piece& pPiece) const;
+
+  /// getPiece - get the piece at the offset of the input section
+  size_t getPiece(const Member& pMember, uint64_t pOffset) const;
+
+  /// getLocation - get the kept member and the offset in it of a piece
+  void getLocation(const Member& pMember,
+                   size_t pPiece,
+                   size_t& pKept,
+                   uint64_t& pOffset) const;
+
+  /// getFragmentRef - get the fragment at the offset of a rewritten member
+  FragmentRef* getFragmentRef(const Member& pMember, uint64_t pOffset) const;
+
+  /// getSectionSymbol - get the section symbol of a member, or create one
+  ResolveInfo* getSectionSymbol(Member& pMember);
+
+  bool getMember(const Fragment* pFrag, size_t& pIdx) const;
+
+private:
+  const LinkerConfig& m_Config;
+  Module& m_Module;
+
+  std::vector<Member> m_Members;
+  std::vector<Group> m_Groups;
+  std::vector<SectionReloc> m_Relocs;
+
+  /// m_MemberIndex - map the region fragment of a member to its index
+  FragHashTableType m_MemberIndex;
+
+  size_t m_NumOfRemovedPieces;
+  uint64_t m_NumOfRemovedBytes;
+};
+
+} // namespace of mcld
+
+#endif
+
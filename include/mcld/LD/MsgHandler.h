@@ -102,6 +102,15 @@ operator<<(const MsgHandler& pHandler, unsigned long pValue)
   return pHandler;
 }
 
+/// 64-bit offsets and sizes do not fit in a tagged value of a 32-bit host.
+/// They are printed as strings.
+inline const MsgHandler &
+operator<<(const MsgHandler& pHandler, unsigned long long pValue)
+{
+  pHandler.addString(llvm::Twine(pValue).str());
+  return pHandler;
+}
+
 inline const MsgHandler &
 operator<<(const MsgHandler& pHandler, bool pValue)
 {
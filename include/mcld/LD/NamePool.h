@@ -19,10 +19,12 @@
 #include <mcld/LD/Resolver.h>
 #include <mcld/LD/ResolveInfo.h>
 #include <mcld/Support/GCFactory.h>
+#include <mcld/Support/Mutex.h>
 
 #include <utility>
 
 #include <llvm/ADT/StringRef.h>
+#include <llvm/Support/DataTypes.h>
 
 namespace mcld {
 
@@ -34,11 +36,64 @@ class SectionData;
  *  \brief Store symbol and search symbol by name. Can help symbol resolution.
  *
  *  - MCLinker is responsed for creating NamePool.
+ *
+ *  NamePool is split into MCLD_NAMEPOOL_SHARDS shards. A name always goes to
+ *  the same shard, and every shard has its own lock, so the modifiers and the
+ *  lookups can be called from several threads at once.
+ *
+ *  Symbol resolution depends on the order of insertSymbol() calls of the same
+ *  name. Clients which want the same result as a serial link must insert the
+ *  symbols of the same name in the order of the command line. Names can be
+ *  inserted by insertString() in any order; that does not change the result.
+ *
+ *  A name is copied into its ResolveInfo unless the caller says it is stable,
+ *  i.e., it is a C string which outlives the pool, such as a name in the
+ *  string table of an input mapped as a whole. Such ResolveInfos only keep
+ *  a pointer to the name and are allocated from the arena of the shard.
  */
 class NamePool : private Uncopyable
 {
 public:
-  typedef HashTable<ResolveInfo, StringHash<ELF> > Table;
+  /// InfoSlot - the storage of a ResolveInfo which borrows its name
+  union InfoSlot
+  {
+    char data[sizeof(ResolveInfo)];
+    void* align_ptr;
+    uint64_t align_u64;
+  };
+
+  typedef GCFactory<InfoSlot, 256> InfoArena;
+
+  /** \class InfoFactory
+   *  \brief InfoFactory produces the entries of a shard table.
+   *
+   *  The entries with stable names are constructed in the arena and are
+   *  released along with it. The others are produced by ResolveInfo::Create.
+   */
+  class InfoFactory
+  {
+  public:
+    typedef ResolveInfo entry_type;
+    typedef ResolveInfo::key_type key_type;
+
+  public:
+    InfoFactory() : m_bStableName(false) { }
+
+    /// setStableName - whether the keys given to the next produce() calls
+    /// are stable names
+    void setStableName(bool pStable)
+    { m_bStableName = pStable; }
+
+    entry_type* produce(const key_type& pKey);
+
+    void destroy(entry_type*& pEntry);
+
+  private:
+    InfoArena m_Arena;
+    bool m_bStableName;
+  };
+
+  typedef HashTable<ResolveInfo, StringHash<XX>, InfoFactory> Table;
   typedef size_t size_type;
 
 public:
@@ -49,18 +104,21 @@ public:
   // -----  modifiers  ----- //
   /// createSymbol - create a symbol but do not insert into the pool.
   /// The created symbol did not go through the path of symbol resolution.
+  /// @param pStableName - pName is a stable name, so it is not copied
   ResolveInfo* createSymbol(const llvm::StringRef& pName,
                             bool pIsDyn,
                             ResolveInfo::Type pType,
                             ResolveInfo::Desc pDesc,
                             ResolveInfo::Binding pBinding,
                             ResolveInfo::SizeType pSize,
-                            ResolveInfo::Visibility pVisibility = ResolveInfo::Default);
-  
+                            ResolveInfo::Visibility pVisibility = ResolveInfo::Default,
+                            bool pStableName = false);
+
   /// insertSymbol - insert a symbol and resolve the symbol immediately
   /// @param pOldInfo - if pOldInfo is not NULL, the old ResolveInfo being
   ///                   overriden is kept in pOldInfo.
   /// @param pResult the result of symbol resultion.
+  /// @param pStableName - pName is a stable name, so it is not copied
   /// @note pResult.override is true if the output LDSymbol also need to be
   ///       overriden
   void insertSymbol(const llvm::StringRef& pName,
@@ -71,7 +129,8 @@ public:
                     ResolveInfo::SizeType pSize,
                     ResolveInfo::Visibility pVisibility,
                     ResolveInfo* pOldInfo,
-                    Resolver::Result& pResult);
+                    Resolver::Result& pResult,
+                    bool pStableName = false);
 
   /// findSymbol - find the resolved output LDSymbol
   const LDSymbol* findSymbol(const llvm::StringRef& pName) const;
@@ -87,11 +146,9 @@ public:
   llvm::StringRef insertString(const llvm::StringRef& pString);
 
   // -----  observers  ----- //
-  size_type size() const
-  { return m_Table.numOfEntries(); }
+  size_type size() const;
 
-  bool empty() const
-  { return m_Table.empty(); }
+  bool empty() const;
 
   // -----  capacity  ----- //
   void reserve(size_type pN);
@@ -101,10 +158,23 @@ public:
 private:
   typedef GCFactory<ResolveInfo*, 128> FreeInfoSet;
 
+  struct Shard
+  {
+    Table table;
+    mutable Mutex lock;
+  };
+
+private:
+  /// getShard - get the shard holding the name whose hash value is pHash
+  Shard&       getShard(unsigned int pHash);
+  const Shard& getShard(unsigned int pHash) const;
+
 private:
   Resolver* m_pResolver;
-  Table m_Table;
+  Shard m_Shards[MCLD_NAMEPOOL_SHARDS];
   FreeInfoSet m_FreeInfoSet;
+  InfoArena m_FreeInfoArena;
+  Mutex m_FreeInfoLock;
 };
 
 } // namespace of mcld
@@ -47,6 +47,18 @@ public:
   /// apply - general apply function
   virtual Result applyRelocation(Relocation& pRelocation) = 0;
 
+  /// mayApplyConcurrently - return true if applying pRelocation writes
+  /// nothing but the target data of pRelocation. Such relocations are applied
+  /// after the output is emitted, on worker threads, and their results are
+  /// written into the output directly. The relocations which may consume GOT
+  /// or PLT entries, emit dynamic relocations or update the side tables of the
+  /// relocator must return false.
+  virtual bool mayApplyConcurrently(const Relocation& pRelocation) const
+  { return false; }
+
+  /// report - report the result of applyRelocation
+  void report(Result pResult, const Relocation& pRelocation) const;
+
   // ------ observers -----//
   virtual TargetLDBackend& getTarget() = 0;
 
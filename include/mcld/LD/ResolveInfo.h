@@ -96,6 +96,11 @@ public:
   // -----  factory method  ----- //
   static ResolveInfo* Create(const key_type& pKey);
 
+  /// Create - construct a ResolveInfo at pPlace, which has sizeof(ResolveInfo)
+  /// bytes. The name is not copied, so pKey must be NUL-terminated and
+  /// outlive the ResolveInfo. Such ResolveInfos must not be passed to Destroy.
+  static ResolveInfo* Create(void* pPlace, const key_type& pKey);
+
   static void Destroy(ResolveInfo*& pInfo);
 
   static ResolveInfo* Null();
@@ -197,7 +202,11 @@ public:
   { return m_Size; }
 
   const char* name() const
-  { return m_Name; }
+  { return m_pName; }
+
+  /// isNameBorrowed - whether the name is not copied into the ResolveInfo
+  bool isNameBorrowed() const
+  { return (m_pName != m_Name); }
 
   unsigned int nameSize() const
   { return (m_BitField >> NAME_LENGTH_OFFSET); }
@@ -279,6 +288,9 @@ private:
    * |length of m_Name|reserved|Symbol|Type |ELF visibility|Local|Com|Def|Dyn|Weak|
    */
   uint32_t m_BitField;
+
+  /// m_pName - points to m_Name, or to the borrowed name
+  const char* m_pName;
   char m_Name[];
 };
 
@@ -0,0 +1,106 @@
+//===- LinkContext.h ------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_LINK_CONTEXT_H
+#define MCLD_LINK_CONTEXT_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+#include <mcld/Config/Config.h>
+#include <mcld/ADT/Uncopyable.h>
+#include <mcld/Support/GCFactory.h>
+
+namespace mcld {
+
+class EhFrame;
+class FragmentRef;
+class LDSection;
+class LDSymbol;
+class RelocData;
+class RelocationFactory;
+class SectionData;
+
+/** \class LinkContext
+ *  \brief LinkContext owns the factories of the IR objects of one link:
+ *  LDSymbol, LDSection, SectionData, RelocData, EhFrame, FragmentRef and
+ *  Relocation.
+ *
+ *  The static Create() functions of those classes allocate from the current
+ *  context of the calling thread. mcld::Linker activates its own context in
+ *  config(), so every IR object created by the thread afterwards belongs to
+ *  that link, and deleting the Linker frees all of them at once. Different
+ *  threads can run different links in the same process; each of them reports
+ *  to its own diagnostic engine. A thread without an active context uses the
+ *  default context of the process.
+ *
+ *  The null symbol and its ResolveInfo are shared by all links. They are
+ *  created by mcld::Initialize() and never changed afterwards.
+ *
+ *  A context must be deactivated on every thread that activated it before it
+ *  is destroyed.
+ */
+class LinkContext : private Uncopyable
+{
+public:
+  typedef GCFactory<LDSymbol, MCLD_SYMBOLS_PER_INPUT> LDSymbolFactory;
+  typedef GCFactory<LDSection, MCLD_SECTIONS_PER_INPUT> SectionFactory;
+  typedef GCFactory<SectionData, MCLD_SECTIONS_PER_INPUT> SectDataFactory;
+  typedef GCFactory<RelocData, MCLD_SECTIONS_PER_INPUT> RelocDataFactory;
+  typedef GCFactory<EhFrame, MCLD_SECTIONS_PER_INPUT> EhFrameFactory;
+  typedef GCFactory<FragmentRef, MCLD_SECTIONS_PER_INPUT> FragRefFactory;
+
+public:
+  LinkContext();
+
+  ~LinkContext();
+
+  /// SetUp - construct the default context and the current contexts of all
+  /// threads. mcld::Initialize() calls it before any link runs.
+  static void SetUp();
+
+  /// current - the context activated on the calling thread, or the default
+  /// context if there is none
+  static LinkContext& current();
+
+  /// activate - make this context current on the calling thread
+  void activate();
+
+  /// deactivate - let the calling thread use the default context again if
+  /// this context is current on it
+  void deactivate();
+
+  /// clearContents - destroy all SectionData, RelocData and EhFrames.
+  /// Because llvm::iplist touches the removed nodes, the contents must be
+  /// destroyed before the target backend.
+  void clearContents();
+
+  /// clear - destroy all IR objects of the link
+  void clear();
+
+  LDSymbolFactory&   getLDSymbolFactory()   { return *m_pLDSymbolFactory; }
+  SectionFactory&    getSectionFactory()    { return *m_pSectionFactory; }
+  SectDataFactory&   getSectDataFactory()   { return *m_pSectDataFactory; }
+  RelocDataFactory&  getRelocDataFactory()  { return *m_pRelocDataFactory; }
+  EhFrameFactory&    getEhFrameFactory()    { return *m_pEhFrameFactory; }
+  FragRefFactory&    getFragRefFactory()    { return *m_pFragRefFactory; }
+  RelocationFactory& getRelocationFactory() { return *m_pRelocationFactory; }
+
+private:
+  LDSymbolFactory* m_pLDSymbolFactory;
+  SectionFactory* m_pSectionFactory;
+  SectDataFactory* m_pSectDataFactory;
+  RelocDataFactory* m_pRelocDataFactory;
+  EhFrameFactory* m_pEhFrameFactory;
+  FragRefFactory* m_pFragRefFactory;
+  RelocationFactory* m_pRelocationFactory;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -27,9 +27,18 @@ class ObjectLinker;
 
 class FileHandle;
 class MemoryArea;
+class LinkContext;
 
 /** \class Linker
 *  \brief Linker is a modular linker.
+*
+*  Each Linker owns a LinkContext. config() makes it current on the calling
+*  thread, so the IR objects created by that thread belong to this link until
+*  reset() frees all of them.
+*
+*  Each thread may run its own Linker after mcld::Initialize() has returned.
+*  The LinkerConfig of a link must be created on the thread which runs it,
+*  because it sets up the diagnostic engine of that thread.
 */
 class Linker
 {
@@ -62,6 +71,9 @@ public:
 
   bool reset();
 
+  /// context - the owner of the IR objects of this link
+  LinkContext& context() { return *m_pContext; }
+
 private:
   bool initTarget();
 
@@ -78,6 +90,7 @@ private:
   const Target* m_pTarget;
   TargetLDBackend* m_pBackend;
   ObjectLinker* m_pObjLinker;
+  LinkContext* m_pContext;
 };
 
 } // namespace of MC Linker
@@ -11,6 +11,9 @@
 #ifdef ENABLE_UNITTEST
 #include <gtest.h>
 #endif
+#include "mcld/ADT/HashEntry.h"
+#include "mcld/ADT/HashTable.h"
+#include "mcld/ADT/StringHash.h"
 #include "mcld/Support/Directory.h"
 #include "mcld/Support/FileSystem.h"
 #include <llvm/ADT/StringRef.h>
@@ -22,6 +25,8 @@ namespace mcld
 /** \class MCLDDirectory
  *  \brief MCLDDirectory is an directory entry for library search.
  *
+ *  The first find() reads the whole directory and indexes the entries by
+ *  their file names, so later look-ups are single hash probes.
  */
 class MCLDDirectory : public sys::fs::Directory
 {
@@ -42,9 +47,31 @@ public:
   const std::string& name() const
   { return m_Name; }
 
+  /// find - find the entry whose file name is pFileName
+  /// @return NULL if the directory has no such entry
+  sys::fs::Path* find(const llvm::StringRef& pFileName);
+
+private:
+  /// HashTable for a file name to its path in the cache of the directory
+  typedef HashEntry<llvm::StringRef,
+                    sys::fs::Path*,
+                    StringCompare<llvm::StringRef> > IndexEntryType;
+  typedef HashTable<IndexEntryType,
+                    StringHash<BKDR>,
+                    EntryFactory<IndexEntryType> > IndexType;
+
+private:
+  /// buildIndex - read all entries and index them by the file names
+  void buildIndex();
+
+  /// resetIndex - drop the index when the path changes
+  void resetIndex();
+
 private:
   std::string m_Name;
   bool m_bInSysroot;
+  IndexType m_Index;
+  bool m_bIndexed;
 };
 
 } // namespace of mcld
@@ -25,6 +25,7 @@ class AttributeProxy;
 class Attribute;
 class InputFactory;
 class LDContext;
+class ELFInputTables;
 
 /** \class Input
  *  \brief Input provides the information of a input file.
@@ -122,6 +123,16 @@ public:
   const LDContext* context() const { return m_pContext; }
   LDContext*       context()       { return m_pContext; }
 
+  // -----  prefetched ELF tables  ----- //
+  // The tables are owned by InputPrefetcher and valid until it is released.
+  void setELFTables(const ELFInputTables* pTables)
+  { m_pELFTables = pTables; }
+
+  bool hasELFTables() const
+  { return (NULL != m_pELFTables); }
+
+  const ELFInputTables* elfTables() const { return m_pELFTables; }
+
 private:
   unsigned int m_Type;
   std::string m_Name;
@@ -131,6 +142,7 @@ private:
   off_t m_fileOffset;
   MemoryArea* m_pMemArea;
   LDContext* m_pContext;
+  const ELFInputTables* m_pELFTables;
 };
 
 } // namespace of mcld
@@ -11,6 +11,9 @@
 #ifdef ENABLE_UNITTEST
 #include <gtest.h>
 #endif
+#include <mcld/ADT/HashTable.h>
+#include <mcld/ADT/StringEntry.h>
+#include <mcld/ADT/StringHash.h>
 #include <mcld/LD/LDFileFormat.h>
 #include <mcld/LD/EhFrame.h>
 
@@ -92,9 +95,27 @@ public:
   static uint64_t AppendFragment(Fragment& pFrag, SectionData& pSD,
                                  uint32_t pAlignConstraint = 1);
 
+private:
+  /// HashTable for a section name to an output section
+  typedef HashTable<StringEntry<LDSection*>,
+                    StringHash<BKDR>,
+                    StringEntryFactory<LDSection*> > SectionIndexType;
+
+private:
+  /// getOutputSection - get the output section named pName in mcld::Module
+  LDSection* getOutputSection(const std::string& pName);
+
 private:
   const LinkerConfig& m_Config;
   Module& m_Module;
+
+  /// m_InputIndex - the output sections of the merged input section names
+  SectionIndexType m_InputIndex;
+
+  /// m_OutputIndex - the output sections of mcld::Module by names. The first
+  /// m_NumOfIndexed sections of mcld::Module are indexed.
+  SectionIndexType m_OutputIndex;
+  size_t m_NumOfIndexed;
 };
 
 } // namespace of mcld
@@ -69,6 +69,10 @@ public:
   /// readRelocations - read all relocation entries
   bool readRelocations();
 
+  /// dataStrippingOpt - remove the unused input sections (--gc-sections) and
+  /// fold the identical ones (--icf)
+  bool dataStrippingOpt();
+
   /// mergeSections - put allinput sections into output sections
   bool mergeSections();
 
@@ -22,6 +22,10 @@ namespace mcld {
 /** \class SectionMap
  *  \brief descirbe the mappings of input section's name (or prefix) to
  *         its associated output section's name and offset
+ *
+ *  The prefixes of the mappings are kept in a trie, so finding the mapping of
+ *  an input section walks its name once instead of comparing it with every
+ *  mapping. The first appended mapping which matches the name wins.
  */
 class SectionMap
 {
@@ -50,6 +54,8 @@ public:
   static NamePair NullName;
 
 public:
+  SectionMap();
+
   // get the possible output section name based on the mapping table
   // return NullPair if not found
   const NamePair& find(const std::string& pFrom) const;
@@ -76,12 +82,38 @@ public:
 
   static unsigned int hash(const std::string& pString);
 
+private:
+  /// TrieNode - a character of the prefixes. The children of a node are
+  /// linked by their sibling indices. Index 0 is the root, so 0 also means
+  /// no child or sibling.
+  struct TrieNode
+  {
+    char ch;
+    size_t child;
+    size_t sibling;
+    /// the index of the first mapping whose prefix ends here
+    size_t pair;
+  };
+
+  typedef std::vector<TrieNode> TrieType;
+
 private:
   bool matched(const NamePair& pNamePair,
                const std::string& pInput,
                unsigned int pHash) const;
+
+  /// lookup - get the index of the first mapping matching pFrom
+  size_t lookup(const std::string& pFrom) const;
+
+  /// addPrefix - add the prefix of the mapping pIdx to the trie
+  void addPrefix(const std::string& pPrefix, size_t pIdx);
+
 private:
   NamePairList m_NamePairList;
+  TrieType m_Trie;
+
+  /// the first mapping whose input is a wildcard
+  size_t m_Wildcard;
 };
 
 } // namespace of mcld
@@ -13,6 +13,7 @@
 #endif
 #include <mcld/Support/Path.h>
 #include <mcld/ADT/Flags.h>
+#include <llvm/Support/DataTypes.h>
 
 #include <sys/stat.h>
 #include <errno.h>
@@ -90,13 +91,20 @@ public:
   void cleanState(IOState pState = GoodBit);
 
   // truncate - truncate the file up to the pSize.
-  bool truncate(size_t pSize);
+  bool truncate(uint64_t pSize);
 
-  bool read(void* pMemBuffer, size_t pStartOffset, size_t pLength);
+  // allocate - set the size of the file to pSize and reserve its blocks if
+  // the file system supports it.
+  bool allocate(uint64_t pSize);
 
-  bool write(const void* pMemBuffer, size_t pStartOffset, size_t pLength);
+  // The offsets are 64-bit even in 32-bit hosts, so large files and members
+  // far in large archives can be read. An offset which does not fit in off_t
+  // fails.
+  bool read(void* pMemBuffer, uint64_t pStartOffset, size_t pLength);
 
-  bool mmap(void*& pMemBuffer, size_t pStartOffset, size_t pLength);
+  bool write(const void* pMemBuffer, uint64_t pStartOffset, size_t pLength);
+
+  bool mmap(void*& pMemBuffer, uint64_t pStartOffset, size_t pLength);
 
   bool munmap(void* pMemBuffer, size_t pLength);
 
@@ -104,7 +112,7 @@ public:
   const sys::fs::Path& path() const
   { return m_Path; }
 
-  size_t size() const
+  uint64_t size() const
   { return m_Size; }
 
   int handler() const
@@ -134,7 +142,7 @@ public:
 private:
   sys::fs::Path m_Path;
   int m_Handler;
-  unsigned int m_Size;
+  uint64_t m_Size;
   uint16_t m_State;
   OpenMode m_OpenMode;
 };
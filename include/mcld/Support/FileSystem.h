@@ -19,6 +19,7 @@
 
 #include "mcld/Support/PathCache.h"
 #include <mcld/Config/Config.h>
+#include <llvm/Support/DataTypes.h>
 #include <string>
 #include <iosfwd>
 #include <locale>
@@ -109,9 +110,13 @@ void get_pwd(std::string& pPWD);
 
 int open(const Path& pPath, int pOFlag);
 int open(const Path& pPath, int pOFlag, int pPermission);
-ssize_t pread(int pFD, void* pBuf, size_t pCount, size_t pOffset);
-ssize_t pwrite(int pFD, const void* pBuf, size_t pCount, size_t pOffset);
-int ftruncate(int pFD, size_t pLength);
+ssize_t pread(int pFD, void* pBuf, size_t pCount, off_t pOffset);
+ssize_t pwrite(int pFD, const void* pBuf, size_t pCount, off_t pOffset);
+int ftruncate(int pFD, off_t pLength);
+int fallocate(int pFD, off_t pLength);
+bool last_write_time(int pFD, uint64_t& pTime);
+bool real_path(const Path& pPath, std::string& pRealPath);
+int rename(const Path& pFrom, const Path& pTo);
 
 } // namespace of detail
 } // namespace of fs
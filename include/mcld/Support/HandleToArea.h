@@ -13,9 +13,14 @@
 #endif
 #include <mcld/ADT/Uncopyable.h>
 #include <mcld/ADT/TypeTraits.h>
+#include <mcld/ADT/HashEntry.h>
+#include <mcld/ADT/HashTable.h>
+#include <mcld/ADT/StringEntry.h>
 #include <mcld/ADT/StringHash.h>
 #include <mcld/Support/Path.h>
 #include <mcld/Support/FileHandle.h>
+#include <llvm/Support/DataTypes.h>
+#include <string>
 #include <vector>
 
 namespace mcld
@@ -28,8 +33,13 @@ class MemoryArea;
  *  Special double-key associative container. Keys are Path and file handler,
  *  associative value is MemoryArea.
  *
- *  For high performance, HandleToArea is not designed to contain unique
- *  <key, value> pair. The key and value may be duplicated.
+ *  The pairs are looked up by a hash table keyed by the real path of the
+ *  file, so the relative paths and the symbolic links to the same file share
+ *  one MemoryArea. The pairs of a file may be duplicated; findFirst()
+ *  returns the first one pushed. A MemoryArea is in one pair at most.
+ *
+ *  erase() moves the last pair into the erased one, so it takes constant
+ *  time, and the iterators do not keep the order of push_back().
  *
  *  Like FileHandle, HandleToArea should neither throw exception nor call
  *  expressive diagnostic.
@@ -38,17 +48,52 @@ class HandleToArea : private Uncopyable
 {
 private:
   struct Bucket {
-    unsigned int hash_value;
     FileHandle* handle;
     MemoryArea* area;
+    /// the key of the file, see getKey()
+    std::string key;
+    /// the positions of the previous and the next pairs of the same file
+    /// in the order of push_back(), or npos
+    size_t prev;
+    size_t next;
+  };
+
+  /// Chain - the positions of the first and the last pairs of a file
+  struct Chain {
+    size_t first;
+    size_t last;
   };
 
-  // the best data structure is a binary search tree.
-  // However, by the shrinking time-to-market constraint, I used
-  // vector and sequential search here.
+  // all pairs
   typedef std::vector<Bucket> HandleToAreaMap;
 
-  typedef StringHash<BKDR> HashFunction;
+  // the key of a file to its pairs
+  typedef HashTable<StringEntry<Chain>,
+                    StringHash<BKDR>,
+                    StringEntryFactory<Chain> > PathIndex;
+
+  struct PtrCompare
+  {
+    bool operator()(const MemoryArea* X, const MemoryArea* Y) const
+    { return (X==Y); }
+  };
+
+  struct PtrHash
+  {
+    size_t operator()(const MemoryArea* pKey) const
+    {
+      return (unsigned((uintptr_t)pKey) >> 4) ^
+             (unsigned((uintptr_t)pKey) >> 9);
+    }
+  };
+
+  // MemoryArea to the position of its pair
+  typedef HashEntry<const MemoryArea*, size_t, PtrCompare> AreaEntryType;
+  typedef HashTable<AreaEntryType,
+                    PtrHash,
+                    EntryFactory<AreaEntryType> > AreaIndex;
+
+  static const size_t npos = static_cast<size_t>(-1);
 
 public:
   typedef HandleToAreaMap::iterator iterator;
@@ -105,12 +150,28 @@ public:
   size_t size() const
   { return m_AreaMap.size(); }
 
-  HandleToArea() : m_AreaMap() { }
+  HandleToArea();
 
-  ~HandleToArea() { }
+  ~HandleToArea();
+
+private:
+  /// erase - remove the pair at pPos and promote the next pair of the same
+  /// file
+  void erase(size_t pPos);
+
+  /// move - move the pair at pFrom to pTo
+  void move(size_t pFrom, size_t pTo);
+
+  /// getKey - get the real path of pPath
+  void getKey(const sys::fs::Path& pPath, std::string& pKey) const;
 
 private:
   HandleToAreaMap m_AreaMap;
+  PathIndex m_PathIndex;
+  AreaIndex m_AreaIndex;
+
+  /// m_PWD - the working directory for the relative paths
+  std::string m_PWD;
 };
 
 } // namespace of mcld
@@ -13,6 +13,7 @@
 #endif
 
 #include <mcld/ADT/Uncopyable.h>
+#include <llvm/Support/DataTypes.h>
 #include <cstddef>
 #include <map>
 
@@ -43,6 +44,14 @@ class MemoryRegion;
  *  If the part a file being loaded is larger than 3/4 pages, MemoryArea uses
  *  memory mapped I/O to load the file. Otherwise, MemoryArea uses dynamic
  *  memory to read the content of file into the memory space.
+ *
+ *  A read-only file can also be loaded at once by mapWholeFile(). After that,
+ *  every request within the file is a MemoryRegion of the whole file space,
+ *  and neither looks up nor creates spaces.
+ *
+ *  A writable file whose size is known can be preallocated and mapped at once
+ *  by mapWholeOutput(). Since the requests within it do not change the
+ *  MemoryArea, they can be made from several threads.
  */
 class MemoryArea : private Uncopyable
 {
@@ -66,7 +75,14 @@ public:
   // find an existing space to hold the MemoryRegion.
   // if MemoryArea does not find such space, then it creates a new space and
   // assign a MemoryRegion into the space.
-  MemoryRegion* request(size_t pOffset, size_t pLength);
+  // The offset and the length are 64-bit even in 32-bit hosts. A region
+  // which does not fit in the address space of the host is a fatal error.
+  MemoryRegion* request(uint64_t pOffset, uint64_t pLength);
+
+  // adopt - take over a Space which was loaded out of this MemoryArea, and
+  // return a MemoryRegion covering the whole space. Later requests within the
+  // space reuse it. The space is released along with its last region.
+  MemoryRegion* adopt(Space& pSpace);
 
   // release - release a MemoryRegion.
   // release a MemoryRegion does not cause
@@ -75,26 +91,52 @@ public:
   // clear - release all memory regions.
   void clear();
 
+  // mapWholeFile - load the whole read-only file into one space, which lives
+  // until clear(). Later requests within the file use the space.
+  // @return false if the file is not read-only or can not be loaded at once,
+  //         e.g. it is larger than the address space of the host.
+  bool mapWholeFile();
+
+  // mapWholeOutput - preallocate the empty writable file to pSize bytes and
+  // map it into one space, which lives until clear(). clear() writes it back.
+  // The bytes which are never written read as zeros. The blocks are reserved
+  // up front, so writing into the mapping does not fail for lack of space,
+  // and the output is not sparse.
+  // @return false if the file is not writable or not empty, or some regions
+  //         are requested already.
+  bool mapWholeOutput(uint64_t pSize);
+
+  bool isWholeFileMapped() const { return (NULL != m_pWholeFile); }
+
+  // wholeFile - the space of the whole file, or NULL if it is not mapped.
+  // The space does not change until clear(), so it can be read from several
+  // threads.
+  const Space* wholeFile() const { return m_pWholeFile; }
+
+  // isInWholeFile - whether the pSize bytes at pData lie in the whole file
+  // space, which means they stay valid until clear().
+  bool isInWholeFile(const void* pData, size_t pSize) const;
+
   const FileHandle* handler() const { return m_pFileHandle; }
   FileHandle*       handler()       { return m_pFileHandle; }
 
   bool hasHandler() const { return (NULL != m_pFileHandle); }
 
   // -----  space list methods  ----- //
-  Space* find(size_t pOffset, size_t pLength);
+  Space* find(uint64_t pOffset, uint64_t pLength);
 
-  const Space* find(size_t pOffset, size_t pLength) const;
+  const Space* find(uint64_t pOffset, uint64_t pLength) const;
 
 private:
   class Key {
   public:
-    Key(size_t pOffset, size_t pLength)
+    Key(uint64_t pOffset, uint64_t pLength)
     : m_Offset(pOffset), m_Length(pLength)
     { }
 
-    size_t offset() const { return m_Offset; }
+    uint64_t offset() const { return m_Offset; }
 
-    size_t length() const { return m_Length; }
+    uint64_t length() const { return m_Length; }
 
     struct Compare {
       bool operator()(const Key& KEY1, const Key& KEY2) const
@@ -106,8 +148,8 @@ private:
     };
 
   private:
-    size_t m_Offset;
-    size_t m_Length;
+    uint64_t m_Offset;
+    uint64_t m_Length;
   };
 
   typedef std::multimap<Key, Space*, Key::Compare> SpaceMapType;
@@ -115,6 +157,7 @@ private:
 private:
   SpaceMapType m_SpaceMap;
   FileHandle* m_pFileHandle;
+  Space* m_pWholeFile;
 };
 
 } // namespace of mcld
@@ -54,6 +54,10 @@ private:
   void setParent(Space& pSpace) { m_pParent = &pSpace; }
 
 public:
+  /// SetUp - construct the region factory shared by all threads.
+  /// mcld::Initialize() calls it before any link runs.
+  static void SetUp();
+
   /// Create - To wrap a piece of memory and to create a new region.
   /// This function wraps a piece of memory and to create a new region. Region
   /// is just a wraper, it is not responsible for deallocate the given memory.
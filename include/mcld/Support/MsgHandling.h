@@ -19,6 +19,12 @@ class LinkerConfig;
 class DiagnosticPrinter;
 class DiagnosticLineInfo;
 
+/// SetUpDiagnosticEngines - construct the registry of the diagnostic engines
+/// of all threads. mcld::Initialize() calls it before any link runs.
+void SetUpDiagnosticEngines();
+
+/// InitializeDiagnosticEngine - set up the diagnostic engine of the calling
+/// thread for a link
 void InitializeDiagnosticEngine(const LinkerConfig& pConfig,
                                 DiagnosticPrinter* pPrinter = NULL);
 
@@ -26,6 +32,10 @@ void FinalizeDiagnosticEngine();
 
 bool Diagnose();
 
+/// getDiagnosticEngine - the diagnostic engine of the calling thread. The
+/// workers of a ThreadPool must not report; they hand the failures over to
+/// the thread which runs the link. The engine is destroyed when the thread
+/// exits.
 DiagnosticEngine& getDiagnosticEngine();
 
 MsgHandler unreachable(unsigned int pID);
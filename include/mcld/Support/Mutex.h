@@ -0,0 +1,57 @@
+//===- Mutex.h ------------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_SUPPORT_MUTEX_H
+#define MCLD_SUPPORT_MUTEX_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+#include <mcld/ADT/Uncopyable.h>
+
+namespace mcld {
+
+/** \class Mutex
+ *  \brief Mutex is a non-recursive mutual exclusion lock.
+ */
+class Mutex : private Uncopyable
+{
+public:
+  /** \class Guard
+   *  \brief Guard holds a Mutex during its lifetime.
+   */
+  class Guard : private Uncopyable
+  {
+  public:
+    explicit Guard(Mutex& pMutex)
+      : m_Mutex(pMutex) {
+      m_Mutex.lock();
+    }
+
+    ~Guard() { m_Mutex.unlock(); }
+
+  private:
+    Mutex& m_Mutex;
+  };
+
+public:
+  Mutex();
+
+  ~Mutex();
+
+  void lock();
+
+  void unlock();
+
+private:
+  void* m_pData;
+};
+
+} // namespace of mcld
+
+#endif
+
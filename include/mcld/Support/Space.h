@@ -46,7 +46,7 @@ private:
   Space(Type pType, void* pMemBuffer, size_t pSize);
 
 public:
-  void setStart(size_t pOffset)
+  void setStart(uint64_t pOffset)
   { m_StartOffset = pOffset; }
 
   Address memory()
@@ -55,7 +55,9 @@ public:
   ConstAddress memory() const
   { return m_Data; }
 
-  size_t start() const
+  /// start - the offset of the space in the file. It is 64-bit even in
+  /// 32-bit hosts, so spaces can be loaded from large files.
+  uint64_t start() const
   { return m_StartOffset; }
 
   size_t size() const
@@ -77,7 +79,14 @@ public:
   static Space* Create(void* pMemBuffer, size_t pSize);
 
   /// Create - Create a Space from FileHandler
-  static Space* Create(FileHandle& pHandler, size_t pOffset, size_t pSize);
+  static Space* Create(FileHandle& pHandler, uint64_t pOffset, size_t pSize);
+
+  /// TryCreate - Create a Space of a range inside the file. Unlike
+  /// Create, it emits no diagnostic and returns NULL if the range is out of
+  /// the file or can not be read, so it is safe to call in worker threads.
+  static Space* TryCreate(FileHandle& pHandler,
+                          uint64_t pOffset,
+                          size_t pSize);
 
   static void Destroy(Space*& pSpace);
   
@@ -85,11 +94,16 @@ public:
 
   static void Sync(Space* pSpace, FileHandle& pHandler);
 
+  /// WillNeed - tell the system that the bytes of the file in [pOffset,
+  /// pOffset+pSize) are going to be read from the mapped space soon, so it
+  /// can start reading them ahead. It does nothing for unmapped spaces.
+  static void WillNeed(const Space& pSpace, uint64_t pOffset, size_t pSize);
+
 private:
   Address m_Data;
-  uint32_t m_StartOffset;
-  uint32_t m_Size;
-  uint16_t m_RegionCount;
+  uint64_t m_StartOffset;
+  size_t m_Size;
+  uint32_t m_RegionCount;
   Type m_Type : 2;
 };
 
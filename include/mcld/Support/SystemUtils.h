@@ -26,6 +26,11 @@ typedef off_t Offset;
  */
 char *strerror(int pErrnum);
 
+/** \fn GetProcessID
+ *  \brief the process id of the linker
+ */
+unsigned int GetProcessID();
+
 } // namespace of sys
 } // namespace of mcld
 
@@ -0,0 +1,49 @@
+//===- ThreadLocal.h ------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_SUPPORT_THREAD_LOCAL_H
+#define MCLD_SUPPORT_THREAD_LOCAL_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+#include <mcld/ADT/Uncopyable.h>
+
+#include <cstddef>
+
+namespace mcld {
+
+/** \class ThreadLocal
+ *  \brief ThreadLocal holds one pointer for each thread. A thread sees NULL
+ *  until it sets its own value.
+ *
+ *  If a destructor is given, it is called with the value of a thread when
+ *  the thread exits and the value is not NULL. The values left when the
+ *  ThreadLocal itself is destroyed are not passed to the destructor.
+ */
+class ThreadLocal : private Uncopyable
+{
+public:
+  typedef void (*Destructor)(void* pValue);
+
+public:
+  explicit ThreadLocal(Destructor pDestructor = NULL);
+
+  ~ThreadLocal();
+
+  void* get() const;
+
+  void set(void* pValue);
+
+private:
+  void* m_pData;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -0,0 +1,68 @@
+//===- ThreadPool.h -------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_SUPPORT_THREAD_POOL_H
+#define MCLD_SUPPORT_THREAD_POOL_H
+#ifdef ENABLE_UNITTEST
+#include <gtest.h>
+#endif
+#include <mcld/ADT/Uncopyable.h>
+
+namespace mcld {
+
+/** \class ThreadPool
+ *  \brief ThreadPool runs independent tasks on a fixed set of worker threads.
+ *
+ *  ThreadPool does not own the tasks. Clients enqueue tasks and call wait()
+ *  before they touch the results. A pool with only one thread, or a pool on
+ *  a host without thread support, runs every task in enqueue() directly.
+ *
+ *  Tasks must not modify the IR (symbols, sections, fragments) shared with
+ *  other tasks and must not emit diagnostics, since neither is protected by
+ *  a lock.
+ */
+class ThreadPool : private Uncopyable
+{
+public:
+  /** \class Task
+   *  \brief Task is the unit of work of ThreadPool.
+   */
+  class Task
+  {
+  public:
+    virtual ~Task() { }
+
+    virtual void run() = 0;
+  };
+
+public:
+  explicit ThreadPool(unsigned int pNumOfThreads);
+
+  ~ThreadPool();
+
+  /// enqueue - schedule a task. The task must be alive until wait() returns.
+  void enqueue(Task& pTask);
+
+  /// wait - block until all enqueued tasks are done.
+  void wait();
+
+  /// numOfThreads - the number of worker threads
+  unsigned int numOfThreads() const { return m_NumOfThreads; }
+
+private:
+  struct Impl;
+
+private:
+  Impl* m_pImpl;
+  unsigned int m_NumOfThreads;
+};
+
+} // namespace of mcld
+
+#endif
+
@@ -125,6 +125,11 @@ public:
   virtual uint64_t emitSectionData(const LDSection& pSection,
                                    MemoryRegion& pRegion) const = 0;
 
+  /// emitNops - fill the pSize bytes of alignment padding at pBuf in an
+  /// executable section with no-operation instructions. Writers may call it
+  /// from several threads. By default, the padding is zeros.
+  virtual void emitNops(uint8_t* pBuf, size_t pSize) const;
+
   /// emitRegNamePools - emit regular name pools - .symtab, .strtab
   virtual void emitRegNamePools(const Module& pModule, MemoryArea& pOutput);
 
@@ -235,6 +240,9 @@ public:
   /// Target can override this function if needed.
   virtual uint64_t maxBranchOffset() { return (uint64_t)-1; }
 
+  /// isExported - the dynamic symbols of a dynamically linked output
+  bool isExported(const ResolveInfo& pSymbol) const;
+
 protected:
   uint64_t getSymbolSize(const LDSymbol& pSymbol) const;
 
@@ -257,11 +265,11 @@ protected:
 
   /// isDynamicSymbol
   /// @ref Google gold linker: symtab.cc:311
-  bool isDynamicSymbol(const LDSymbol& pSymbol);
+  bool isDynamicSymbol(const LDSymbol& pSymbol) const;
 
   /// isDynamicSymbol
   /// @ref Google gold linker: symtab.cc:311
-  bool isDynamicSymbol(const ResolveInfo& pResolveInfo);
+  bool isDynamicSymbol(const ResolveInfo& pResolveInfo) const;
 
   /// symbolNeedsPLT - return whether the symbol needs a PLT entry
   /// @ref Google gold linker, symtab.h:596
@@ -12,6 +12,11 @@
 #include <gtest.h>
 #endif
 
+#include <mcld/ADT/HashEntry.h>
+#include <mcld/ADT/HashTable.h>
+
+#include <llvm/Support/DataTypes.h>
+
 #include <vector>
 
 namespace mcld {
@@ -20,6 +25,9 @@ class ResolveInfo;
 
 /** \class SymbolEntryMap
  *  \brief SymbolEntryMap is a <const ResolveInfo*, ENTRY*> map.
+ *
+ *  The mappings are kept in the order of record() for iteration, and indexed
+ *  by a hash table for lookUp().
  */
 template<typename ENTRY>
 class SymbolEntryMap
@@ -35,6 +43,26 @@ private:
 
   typedef std::vector<Mapping> SymbolEntryPool;
 
+  struct PtrCompare
+  {
+    bool operator()(const ResolveInfo* X, const ResolveInfo* Y) const
+    { return (X==Y); }
+  };
+
+  struct PtrHash
+  {
+    size_t operator()(const ResolveInfo* pKey) const
+    {
+      return (unsigned((uintptr_t)pKey) >> 4) ^
+             (unsigned((uintptr_t)pKey) >> 9);
+    }
+  };
+
+  typedef HashEntry<const ResolveInfo*, EntryType*, PtrCompare> IndexEntryType;
+  typedef HashTable<IndexEntryType,
+                    PtrHash,
+                    EntryFactory<IndexEntryType> > IndexType;
+
 public:
   typedef typename SymbolEntryPool::iterator iterator;
   typedef typename SymbolEntryPool::const_iterator const_iterator;
@@ -53,10 +81,14 @@ public:
   const_iterator end  () const { return m_Pool.end();   }
   iterator       end  ()       { return m_Pool.end();   }
 
-  void reserve(size_t pSize) { m_Pool.reserve(pSize); }
+  void reserve(size_t pSize) {
+    m_Pool.reserve(pSize);
+    m_Index.rehash(pSize);
+  }
 
 private:
   SymbolEntryPool m_Pool;
+  IndexType m_Index;
 
 };
 
@@ -64,28 +96,20 @@ template<typename EntryType>
 const EntryType*
 SymbolEntryMap<EntryType>::lookUp(const ResolveInfo& pSymbol) const
 {
-  const_iterator mapping, mEnd = m_Pool.end();
-  for (mapping = m_Pool.begin(); mapping != mEnd; ++mapping) {
-    if (mapping->symbol == &pSymbol) {
-      return mapping->entry;
-    }
-  }
-
-  return NULL;
+  typename IndexType::const_iterator it = m_Index.find(&pSymbol);
+  if (it == m_Index.end())
+    return NULL;
+  return it.getEntry()->value();
 }
 
 template<typename EntryType>
 EntryType*
 SymbolEntryMap<EntryType>::lookUp(const ResolveInfo& pSymbol)
 {
-  iterator mapping, mEnd = m_Pool.end();
-  for (mapping = m_Pool.begin(); mapping != mEnd; ++mapping) {
-    if (mapping->symbol == &pSymbol) {
-      return mapping->entry;
-    }
-  }
-
-  return NULL;
+  typename IndexType::iterator it = m_Index.find(&pSymbol);
+  if (it == m_Index.end())
+    return NULL;
+  return it.getEntry()->value();
 }
 
 template<typename EntryType>
@@ -96,6 +120,12 @@ SymbolEntryMap<EntryType>::record(const ResolveInfo& pSymbol, EntryType& pEntry)
   mapping.symbol = &pSymbol;
   mapping.entry = &pEntry;
   m_Pool.push_back(mapping);
+
+  // lookUp() returns the first recorded entry of a symbol.
+  bool exist = false;
+  IndexEntryType* index = m_Index.insert(&pSymbol, exist);
+  if (!exist)
+    index->setValue(&pEntry);
 }
 
 } // namespace of mcld
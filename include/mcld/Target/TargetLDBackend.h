@@ -30,6 +30,7 @@ class ExecWriter;
 class BinaryWriter;
 class LDFileFormat;
 class LDSymbol;
+class ResolveInfo;
 class LDSection;
 class SectionData;
 class Input;
@@ -144,6 +145,20 @@ public:
   virtual bool updateSectionFlags(LDSection& pTo, const LDSection& pFrom)
   { return true; }
 
+  /// mayTakeFunctionAddress - return false if pReloc can only call or jump
+  /// to the referred function. --icf=safe folds a function only if no
+  /// relocation may take its address. Targets which can tell a call from an
+  /// address computation by the relocation type and the instruction may
+  /// override this.
+  virtual bool mayTakeFunctionAddress(const Relocation& pReloc) const
+  { return true; }
+
+  /// isExported - return true if pSymbol goes to the dynamic symbol table of
+  /// the output, so the outside world may refer to it. --gc-sections keeps
+  /// the sections which define such symbols.
+  virtual bool isExported(const ResolveInfo& pSymbol) const
+  { return false; }
+
   /// readSection - read a target dependent section
   virtual bool readSection(Input& pInput, SectionData& pSD)
   { return true; }
@@ -7,6 +7,7 @@ mcld_core_SRC_FILES := \
   GeneralOptions.cpp \
   IRBuilder.cpp \
   InputTree.cpp \
+  LinkContext.cpp \
   LinkerConfig.cpp  \
   Linker.cpp \
   Module.cpp \
@@ -7,6 +7,10 @@
 //
 //===----------------------------------------------------------------------===//
 #include <mcld/Environment.h>
+#include <mcld/LinkContext.h>
+#include <mcld/LD/LDSymbol.h>
+#include <mcld/Support/MemoryRegion.h>
+#include <mcld/Support/MsgHandling.h>
 #include <mcld/Support/TargetSelect.h>
 
 #include <llvm/Support/TargetSelect.h>
@@ -23,6 +27,14 @@ void mcld::Initialize()
   mcld::InitializeAllEmulations();
   mcld::InitializeAllDiagnostics();
 
+  // the null symbol and the ManagedStatics are shared by all links. Create
+  // them before any of them runs, so that the links only read them and no two
+  // threads race to construct them.
+  mcld::LDSymbol::Null();
+  mcld::LinkContext::SetUp();
+  mcld::SetUpDiagnosticEngines();
+  mcld::MemoryRegion::SetUp();
+
   is_initialized = true;
 }
 
@@ -52,8 +52,15 @@ GeneralOptions::GeneralOptions()
     m_bFatalWarnings(false),
     m_bNewDTags(false),
     m_bNoStdlib(false),
+    m_bGCSections(false),
+    m_bPrintGCSections(false),
+    m_bMapWholeFiles(true),
+    m_bLazyDynSymbols(false),
+    m_bTailMergeStrings(false),
     m_StripSymbols(KeepAllSymbols),
-    m_HashStyle(SystemV) {
+    m_ICFMode(ICFNone),
+    m_HashStyle(SystemV),
+    m_NumThreads(1) {
 }
 
 GeneralOptions::~GeneralOptions()
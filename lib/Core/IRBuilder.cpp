@@ -11,7 +11,9 @@
 #include <mcld/Object/ObjectBuilder.h>
 #include <mcld/LD/SectionData.h>
 #include <mcld/LD/EhFrame.h>
+#include <mcld/LD/LazySymbolTable.h>
 #include <mcld/LD/RelocData.h>
+#include <mcld/Support/MemoryArea.h>
 #include <mcld/Support/MsgHandling.h>
 #include <mcld/Fragment/FragmentRef.h>
 
@@ -53,6 +55,7 @@ LDFileFormat::Kind GetELFSectionKind(uint32_t pType, const char* pName)
   case llvm::ELF::SHT_PROGBITS:
     return LDFileFormat::Regular;
   case llvm::ELF::SHT_SYMTAB:
+  case llvm::ELF::SHT_SYMTAB_SHNDX:
   case llvm::ELF::SHT_DYNSYM:
   case llvm::ELF::SHT_STRTAB:
   case llvm::ELF::SHT_HASH:
@@ -99,6 +102,16 @@ bool ShouldForceLocal(const ResolveInfo& pInfo, const LinkerConfig& pConfig)
   return false;
 }
 
+/// IsStableName - whether pName is a C string in the whole-file mapping of
+/// pInput
+static bool IsStableName(const Input& pInput, const llvm::StringRef& pName)
+{
+  if (!pInput.hasMemArea() ||
+      !pInput.memArea()->isInWholeFile(pName.data(), pName.size() + 1))
+    return false;
+  return ('\0' == pName.data()[pName.size()]);
+}
+
 //===----------------------------------------------------------------------===//
 // IRBuilder
 //===----------------------------------------------------------------------===//
@@ -355,7 +368,8 @@ SectionData* IRBuilder::CreateBSS(LDSection& pSection)
 }
 
 /// CreateRegion - To create a region fragment in the input file.
-Fragment* IRBuilder::CreateRegion(Input& pInput, size_t pOffset, size_t pLength)
+Fragment*
+IRBuilder::CreateRegion(Input& pInput, uint64_t pOffset, uint64_t pLength)
 {
   if (!pInput.hasMemArea()) {
     fatal(diag::fatal_cannot_read_input) << pInput.path();
@@ -431,7 +445,7 @@ uint64_t IRBuilder::AppendEhFrame(EhFrame::CIE& pCIE, EhFrame& pEhFrame)
 /// AddSymbol - To add a symbol in the input file and resolve the symbol
 /// immediately
 LDSymbol* IRBuilder::AddSymbol(Input& pInput,
-                               const std::string& pName,
+                               const llvm::StringRef& pName,
                                ResolveInfo::Type pType,
                                ResolveInfo::Desc pDesc,
                                ResolveInfo::Binding pBind,
@@ -441,7 +455,7 @@ LDSymbol* IRBuilder::AddSymbol(Input& pInput,
                                ResolveInfo::Visibility pVis)
 {
   // rename symbols
-  std::string name = pName;
+  llvm::StringRef name = pName;
   if (!m_Config.scripts().renameMap().empty() &&
       ResolveInfo::Undefined == pDesc) {
     // If the renameMap is not empty, some symbols should be renamed.
@@ -452,6 +466,10 @@ LDSymbol* IRBuilder::AddSymbol(Input& pInput,
       name = renameSym.getEntry()->value();
   }
 
+  // the names in the string tables of the whole-file mapped inputs live as
+  // long as the mappings, so NamePool need not copy them.
+  bool stable = IsStableName(pInput, name);
+
   switch (pInput.type()) {
     case Input::Object: {
 
@@ -466,12 +484,15 @@ LDSymbol* IRBuilder::AddSymbol(Input& pInput,
       else
         frag = FragmentRef::Create(*pSection, pValue);
 
-      LDSymbol* input_sym = addSymbolFromObject(name, pType, pDesc, pBind, pSize, pValue, frag, pVis);
+      LDSymbol* input_sym = addSymbolFromObject(name, pType, pDesc, pBind,
+                                                pSize, pValue, frag, pVis,
+                                                stable);
       pInput.context()->addSymbol(input_sym);
       return input_sym;
     }
     case Input::DynObj: {
-      return addSymbolFromDynObj(pInput, name, pType, pDesc, pBind, pSize, pValue, pVis);
+      return addSymbolFromDynObj(pInput, name, pType, pDesc, pBind, pSize,
+                                 pValue, pVis, stable);
     }
     default: {
       return NULL;
@@ -481,14 +502,15 @@ LDSymbol* IRBuilder::AddSymbol(Input& pInput,
   return NULL;
 }
 
-LDSymbol* IRBuilder::addSymbolFromObject(const std::string& pName,
+LDSymbol* IRBuilder::addSymbolFromObject(const llvm::StringRef& pName,
                                          ResolveInfo::Type pType,
                                          ResolveInfo::Desc pDesc,
                                          ResolveInfo::Binding pBinding,
                                          ResolveInfo::SizeType pSize,
                                          LDSymbol::ValueType pValue,
                                          FragmentRef* pFragmentRef,
-                                         ResolveInfo::Visibility pVisibility)
+                                         ResolveInfo::Visibility pVisibility,
+                                         bool pStableName)
 {
   // Step 1. calculate a Resolver::Result
   // resolved_result is a triple <resolved_info, existent, override>
@@ -504,7 +526,8 @@ LDSymbol* IRBuilder::addSymbolFromObject(const std::string& pName,
                                                                    pDesc,
                                                                    pBinding,
                                                                    pSize,
-                                                                   pVisibility);
+                                                                   pVisibility,
+                                                                   pStableName);
 
     // No matter if there is a symbol with the same name, insert the symbol
     // into output symbol table. So, we let the existent false.
@@ -515,7 +538,8 @@ LDSymbol* IRBuilder::addSymbolFromObject(const std::string& pName,
     // if the symbol is not local, insert and resolve it immediately
     m_Module.getNamePool().insertSymbol(pName, false, pType, pDesc, pBinding,
                                         pSize, pVisibility,
-                                        &old_info, resolved_result);
+                                        &old_info, resolved_result,
+                                        pStableName);
   }
 
   // the return ResolveInfo should not NULL
@@ -583,17 +607,23 @@ LDSymbol* IRBuilder::addSymbolFromObject(const std::string& pName,
     }
   }
 
+  // Step 5. A new undefined symbol may be defined in a lazy symbol table.
+  if (pBinding != ResolveInfo::Local &&
+      !resolved_result.existent && resolved_result.info->isUndef())
+    addUndefined(*resolved_result.info);
+
   return input_sym;
 }
 
 LDSymbol* IRBuilder::addSymbolFromDynObj(Input& pInput,
-                                         const std::string& pName,
+                                         const llvm::StringRef& pName,
                                          ResolveInfo::Type pType,
                                          ResolveInfo::Desc pDesc,
                                          ResolveInfo::Binding pBinding,
                                          ResolveInfo::SizeType pSize,
                                          LDSymbol::ValueType pValue,
-                                         ResolveInfo::Visibility pVisibility)
+                                         ResolveInfo::Visibility pVisibility,
+                                         bool pStableName)
 {
   // We don't need sections of dynamic objects. So we ignore section symbols.
   if (pType == ResolveInfo::Section)
@@ -616,7 +646,7 @@ LDSymbol* IRBuilder::addSymbolFromDynObj(Input& pInput,
   Resolver::Result resolved_result;
   m_Module.getNamePool().insertSymbol(pName, true, pType, pDesc,
                                       pBinding, pSize, pVisibility,
-                                      NULL, resolved_result);
+                                      NULL, resolved_result, pStableName);
 
   // the return ResolveInfo should not NULL
   assert(NULL != resolved_result.info);
@@ -648,9 +678,52 @@ LDSymbol* IRBuilder::addSymbolFromDynObj(Input& pInput,
     }
   }
 
+  if (!resolved_result.existent && resolved_result.info->isUndef())
+    addUndefined(*resolved_result.info);
+
   return input_sym;
 }
 
+/// AddLazySymbols - To add the symbols of an input which are read only when
+/// they are referred.
+void IRBuilder::AddLazySymbols(LazySymbolTable& pTable)
+{
+  // look up the symbols which are still undefined, and drop the others from
+  // the list since a defined symbol never becomes undefined again.
+  size_t live = 0;
+  for (size_t i = 0; i < m_Undefined.size(); ++i) {
+    ResolveInfo* info = m_Undefined[i];
+    if (info->isUndef())
+      pTable.materialize(llvm::StringRef(info->name(), info->nameSize()),
+                         *this);
+    if (info->isUndef())
+      m_Undefined[live++] = info;
+  }
+  m_Undefined.resize(live);
+
+  m_LazySymbols.push_back(&pTable);
+}
+
+/// addUndefined - record a new undefined symbol, and look it up in the lazy
+/// symbol tables
+void IRBuilder::addUndefined(ResolveInfo& pInfo)
+{
+  if (!m_Config.options().lazyDynSymbols() || 0 == pInfo.nameSize())
+    return;
+
+  // the first table which defines the symbol wins, as if all symbols of the
+  // tables were added in order.
+  llvm::StringRef name(pInfo.name(), pInfo.nameSize());
+  LazySymbolTableList::iterator table, tEnd = m_LazySymbols.end();
+  for (table = m_LazySymbols.begin(); table != tEnd; ++table) {
+    if ((*table)->materialize(name, *this) && !pInfo.isUndef())
+      return;
+  }
+
+  if (pInfo.isUndef())
+    m_Undefined.push_back(&pInfo);
+}
+
 /// AddRelocation - add a relocation entry
 ///
 /// All symbols should be read and resolved before calling this function.
@@ -0,0 +1,94 @@
+//===- LinkContext.cpp ----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LinkContext.h>
+#include <mcld/Fragment/FragmentRef.h>
+#include <mcld/LD/EhFrame.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/RelocData.h>
+#include <mcld/LD/RelocationFactory.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/Support/ThreadLocal.h>
+
+#include <llvm/Support/ManagedStatic.h>
+
+using namespace mcld;
+
+static llvm::ManagedStatic<LinkContext> g_DefaultContext;
+static llvm::ManagedStatic<ThreadLocal> g_CurrentContext;
+
+//===----------------------------------------------------------------------===//
+// LinkContext
+//===----------------------------------------------------------------------===//
+LinkContext::LinkContext()
+  : m_pLDSymbolFactory(new LDSymbolFactory()),
+    m_pSectionFactory(new SectionFactory()),
+    m_pSectDataFactory(new SectDataFactory()),
+    m_pRelocDataFactory(new RelocDataFactory()),
+    m_pEhFrameFactory(new EhFrameFactory()),
+    m_pFragRefFactory(new FragRefFactory()),
+    m_pRelocationFactory(new RelocationFactory()) {
+}
+
+LinkContext::~LinkContext()
+{
+  if (g_CurrentContext.isConstructed())
+    deactivate();
+  clear();
+
+  delete m_pRelocDataFactory;
+  delete m_pSectDataFactory;
+  delete m_pEhFrameFactory;
+  delete m_pSectionFactory;
+  delete m_pLDSymbolFactory;
+  delete m_pFragRefFactory;
+  delete m_pRelocationFactory;
+}
+
+void LinkContext::SetUp()
+{
+  *g_DefaultContext;
+  *g_CurrentContext;
+}
+
+LinkContext& LinkContext::current()
+{
+  LinkContext* context = static_cast<LinkContext*>(g_CurrentContext->get());
+  if (NULL == context)
+    return *g_DefaultContext;
+  return *context;
+}
+
+void LinkContext::activate()
+{
+  g_CurrentContext->set(this);
+}
+
+void LinkContext::deactivate()
+{
+  if (this == g_CurrentContext->get())
+    g_CurrentContext->set(NULL);
+}
+
+void LinkContext::clearContents()
+{
+  m_pRelocDataFactory->clear();
+  m_pSectDataFactory->clear();
+  m_pEhFrameFactory->clear();
+}
+
+void LinkContext::clear()
+{
+  clearContents();
+  m_pSectionFactory->clear();
+  m_pLDSymbolFactory->clear();
+  m_pFragRefFactory->clear();
+  m_pRelocationFactory->clear();
+}
+
@@ -7,6 +7,7 @@
 //
 //===----------------------------------------------------------------------===//
 #include <mcld/Linker.h>
+#include <mcld/LinkContext.h>
 #include <mcld/LinkerConfig.h>
 #include <mcld/Module.h>
 #include <mcld/IRBuilder.h>
@@ -20,12 +21,7 @@
 #include <mcld/Object/ObjectLinker.h>
 #include <mcld/MC/InputBuilder.h>
 #include <mcld/Target/TargetLDBackend.h>
-#include <mcld/LD/LDSection.h>
-#include <mcld/LD/LDSymbol.h>
-#include <mcld/LD/SectionData.h>
-#include <mcld/LD/RelocData.h>
 #include <mcld/Fragment/Relocation.h>
-#include <mcld/Fragment/FragmentRef.h>
 
 #include <cassert>
 
@@ -33,18 +29,23 @@ using namespace mcld;
 
 Linker::Linker()
   : m_pConfig(NULL), m_pIRBuilder(NULL),
-    m_pTarget(NULL), m_pBackend(NULL), m_pObjLinker(NULL) {
+    m_pTarget(NULL), m_pBackend(NULL), m_pObjLinker(NULL),
+    m_pContext(new LinkContext()) {
 }
 
 Linker::~Linker()
 {
   reset();
+  delete m_pContext;
 }
 
 bool Linker::config(LinkerConfig& pConfig)
 {
   m_pConfig = &pConfig;
 
+  // the IR objects created by this thread from now on belong to this link
+  m_pContext->activate();
+
   if (!initTarget())
     return false;
 
@@ -151,6 +152,12 @@ bool Linker::resolve(Module& pModule, IRBuilder& pBuilder)
   //   initiate their reloc entries in SectOrRelocData of LDSection.
   m_pObjLinker->readRelocations();
 
+  //   Remove the input sections which are not referred (--gc-sections) and
+  //   fold the identical ones (--icf), so they are not merged, and their
+  //   relocations are not scanned or applied.
+  if (!m_pObjLinker->dataStrippingOpt())
+    return false;
+
   // 7. - merge all sections
   //   Push sections into Module's SectionTable.
   //   Merge sections that have the same name.
@@ -263,9 +270,7 @@ bool Linker::reset()
 
   // Because llvm::iplist will touch the removed node, we must clear
   // RelocData before deleting target backend.
-  RelocData::Clear();
-  SectionData::Clear();
-  EhFrame::Clear();
+  m_pContext->clearContents();
 
   delete m_pBackend;
   m_pBackend = NULL;
@@ -273,10 +278,8 @@ bool Linker::reset()
   delete m_pObjLinker;
   m_pObjLinker = NULL;
 
-  LDSection::Clear();
-  LDSymbol::Clear();
-  FragmentRef::Clear();
-  Relocation::Clear();
+  m_pContext->clear();
+  m_pContext->deactivate();
   return true;
 }
 
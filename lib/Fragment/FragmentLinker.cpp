@@ -29,11 +29,139 @@
 #include <mcld/Support/MemoryArea.h>
 #include <mcld/Support/FileHandle.h>
 #include <mcld/Support/MsgHandling.h>
+#include <mcld/Support/ThreadPool.h>
 #include <mcld/Target/TargetLDBackend.h>
 #include <mcld/Fragment/Relocation.h>
+#include <mcld/LD/Relocator.h>
+
+#include <cstring>
+#include <vector>
 
 using namespace mcld;
 
+namespace {
+
+//===----------------------------------------------------------------------===//
+// RelocWriter
+//===----------------------------------------------------------------------===//
+/// RelocWriter - write the result of a relocation into the output. SWAP is
+/// true if the host and the target have different byte orders, so the check
+/// is done once for all relocations.
+template<bool SWAP>
+struct RelocWriter
+{
+  static void write(const Relocation& pReloc,
+                    Relocation::Size pSize,
+                    uint8_t* pOutput)
+  {
+    // get output file offset
+    uint8_t* target_addr = pOutput +
+                 pReloc.targetRef().frag()->getParent()->getSection().offset() +
+                 pReloc.targetRef().getOutputOffset();
+
+    switch (pSize) {
+      case 8u: {
+        uint8_t data = pReloc.target();
+        std::memcpy(target_addr, &data, 1);
+        break;
+      }
+      case 16u: {
+        uint16_t data = pReloc.target();
+        if (SWAP)
+          data = mcld::bswap16(data);
+        std::memcpy(target_addr, &data, 2);
+        break;
+      }
+      case 32u: {
+        uint32_t data = pReloc.target();
+        if (SWAP)
+          data = mcld::bswap32(data);
+        std::memcpy(target_addr, &data, 4);
+        break;
+      }
+      case 64u: {
+        uint64_t data = pReloc.target();
+        if (SWAP)
+          data = mcld::bswap64(data);
+        std::memcpy(target_addr, &data, 8);
+        break;
+      }
+      default:
+        break;
+    }
+  }
+};
+
+//===----------------------------------------------------------------------===//
+// ApplyTask
+//===----------------------------------------------------------------------===//
+/// ApplyTask - write the results of the relocations of one relocation
+/// section which are applied before, and apply the others directly into the
+/// output. The task runs on a worker thread, so the failures are kept in
+/// order and finish() reports them in the main thread.
+template<bool SWAP>
+class ApplyTask : public ThreadPool::Task
+{
+public:
+  ApplyTask(const FragmentLinker::ApplyList& pList,
+            Relocator& pRelocator,
+            uint8_t* pOutput)
+    : m_List(pList), m_Relocator(pRelocator), m_pOutput(pOutput) {
+  }
+
+  void run();
+
+  /// finish - report the failures in the order of the relocation section
+  void finish();
+
+private:
+  typedef std::vector<std::pair<Relocation*, Relocator::Result> > FailureList;
+
+private:
+  const FragmentLinker::ApplyList& m_List;
+  Relocator& m_Relocator;
+  uint8_t* m_pOutput;
+  FailureList m_Failures;
+};
+
+template<bool SWAP>
+void ApplyTask<SWAP>::run()
+{
+  typedef std::vector<Relocation*>::const_iterator iterator;
+
+  // the results of FragmentLinker::applyRelocations
+  iterator reloc, rEnd = m_List.serial.end();
+  for (reloc = m_List.serial.begin(); reloc != rEnd; ++reloc)
+    RelocWriter<SWAP>::write(**reloc, (*reloc)->size(m_Relocator), m_pOutput);
+
+  rEnd = m_List.concurrent.end();
+  for (reloc = m_List.concurrent.begin(); reloc != rEnd; ++reloc) {
+    Relocator::Result result = m_Relocator.applyRelocation(**reloc);
+    if (Relocator::OK != result)
+      m_Failures.push_back(std::make_pair(*reloc, result));
+
+    // bypass the relocation with NONE type. This is to avoid overwrite the
+    // target result by NONE type relocation if there is a place which has
+    // two relocations to apply to, and one of it is NONE type. The result
+    // we want is the value of the other relocation result. For example,
+    // in .exidx, there are usually an R_ARM_NONE and R_ARM_PREL31 apply to
+    // the same place
+    if (0x0 == (*reloc)->type())
+      continue;
+    RelocWriter<SWAP>::write(**reloc, (*reloc)->size(m_Relocator), m_pOutput);
+  }
+}
+
+template<bool SWAP>
+void ApplyTask<SWAP>::finish()
+{
+  typename FailureList::iterator failure, fEnd = m_Failures.end();
+  for (failure = m_Failures.begin(); failure != fEnd; ++failure)
+    m_Relocator.report(failure->second, *failure->first);
+}
+
+} // anonymous namespace
+
 //===----------------------------------------------------------------------===//
 // FragmentLinker
 //===----------------------------------------------------------------------===//
@@ -50,6 +178,9 @@ FragmentLinker::FragmentLinker(const LinkerConfig& pConfig,
 /// Destructor
 FragmentLinker::~FragmentLinker()
 {
+  std::vector<ApplyList*>::iterator list, lEnd = m_ApplyLists.end();
+  for (list = m_ApplyLists.begin(); list != lEnd; ++list)
+    delete *list;
 }
 
 bool FragmentLinker::finalizeSymbols()
@@ -94,7 +225,12 @@ bool FragmentLinker::applyRelocations()
   if (LinkerConfig::Object == m_Config.codeGenType())
     return true;
 
-  // apply all relocations of all inputs
+  // Apply the relocations which consume GOT or PLT entries or emit dynamic
+  // relocations here, in the order of inputs. The others only depend on the
+  // layout, and normalSyncRelocationResult applies them directly into the
+  // output. Each relocation is classified once, and the lists are kept for
+  // normalSyncRelocationResult.
+  Relocator& relocator = *m_Backend.getRelocator();
   Module::obj_iterator input, inEnd = m_Module.obj_end();
   for (input = m_Module.obj_begin(); input != inEnd; ++input) {
     LDContext::sect_iterator rs, rsEnd = (*input)->context()->relocSectEnd();
@@ -106,11 +242,19 @@ bool FragmentLinker::applyRelocations()
       // discarded group sections)
       if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
         continue;
+      ApplyList* list = new ApplyList();
       RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
       for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
         Relocation* relocation = llvm::cast<Relocation>(reloc);
-        relocation->apply(*m_Backend.getRelocator());
+        if (relocator.mayApplyConcurrently(*relocation)) {
+          list->concurrent.push_back(relocation);
+          continue;
+        }
+        relocation->apply(relocator);
+        if (0x0 != relocation->type())
+          list->serial.push_back(relocation);
       } // for all relocations
+      m_ApplyLists.push_back(list);
     } // for all relocation section
   } // for all inputs
 
@@ -121,7 +265,7 @@ bool FragmentLinker::applyRelocations()
     BranchIsland& island = *facIter;
     BranchIsland::reloc_iterator iter, iterEnd = island.reloc_end();
     for (iter = island.reloc_begin(); iter != iterEnd; ++iter)
-      (*iter)->apply(*m_Backend.getRelocator());
+      (*iter)->apply(relocator);
   }
   return true;
 }
@@ -142,34 +286,46 @@ void FragmentLinker::normalSyncRelocationResult(MemoryArea& pOutput)
 
   uint8_t* data = region->getBuffer();
 
+  if (llvm::sys::isLittleEndianHost() == m_Config.targets().isLittleEndian())
+    applyAndSyncRelocations<false>(data);
+  else
+    applyAndSyncRelocations<true>(data);
+
+  pOutput.clear();
+}
+
+/// applyAndSyncRelocations - The sections are emitted already. Apply the
+/// relocations left by applyRelocations and write the results of all
+/// relocations into pOutput in one pass. The lists of the relocation
+/// sections are processed on a pool of threads (--threads). They write to
+/// different places of the output, since each one refers to its own input
+/// section. Within a section, the results of applyRelocations are written
+/// before the others are applied.
+template<bool SWAP>
+void FragmentLinker::applyAndSyncRelocations(uint8_t* pOutput)
+{
+  Relocator& relocator = *m_Backend.getRelocator();
+  std::vector<ApplyTask<SWAP>*> tasks;
+
   // sync all relocations of all inputs
-  Module::obj_iterator input, inEnd = m_Module.obj_end();
-  for (input = m_Module.obj_begin(); input != inEnd; ++input) {
-    LDContext::sect_iterator rs, rsEnd = (*input)->context()->relocSectEnd();
-    for (rs = (*input)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
-      // bypass the reloc section if
-      // 1. its section kind is changed to Ignore. (The target section is a
-      // discarded group section.)
-      // 2. it has no reloc data. (All symbols in the input relocs are in the
-      // discarded group sections)
-      if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
-        continue;
-      RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
-      for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
-        Relocation* relocation = llvm::cast<Relocation>(reloc);
+  std::vector<ApplyList*>::iterator list, lEnd = m_ApplyLists.end();
+  for (list = m_ApplyLists.begin(); list != lEnd; ++list)
+    tasks.push_back(new ApplyTask<SWAP>(**list, relocator, pOutput));
+
+  ThreadPool pool(m_Config.options().numThreads());
+  typename std::vector<ApplyTask<SWAP>*>::iterator task, tEnd = tasks.end();
+  for (task = tasks.begin(); task != tEnd; ++task)
+    pool.enqueue(**task);
+  pool.wait();
+
+  for (task = tasks.begin(); task != tEnd; ++task) {
+    (*task)->finish();
+    delete *task;
+  }
 
-        // bypass the relocation with NONE type. This is to avoid overwrite the
-        // target result by NONE type relocation if there is a place which has
-        // two relocations to apply to, and one of it is NONE type. The result
-        // we want is the value of the other relocation result. For example,
-        // in .exidx, there are usually an R_ARM_NONE and R_ARM_PREL31 apply to
-        // the same place
-        if (0x0 == relocation->type())
-          continue;
-        writeRelocationResult(*relocation, data);
-      } // for all relocations
-    } // for all relocation section
-  } // for all inputs
+  for (list = m_ApplyLists.begin(); list != lEnd; ++list)
+    delete *list;
+  m_ApplyLists.clear();
 
   // sync relocations created by relaxation
   BranchIslandFactory* br_factory = m_Backend.getBRIslandFactory();
@@ -179,11 +335,9 @@ void FragmentLinker::normalSyncRelocationResult(MemoryArea& pOutput)
     BranchIsland::reloc_iterator iter, iterEnd = island.reloc_end();
     for (iter = island.reloc_begin(); iter != iterEnd; ++iter) {
       Relocation* reloc = *iter;
-      writeRelocationResult(*reloc, data);
+      RelocWriter<SWAP>::write(*reloc, reloc->size(relocator), pOutput);
     }
   }
-
-  pOutput.clear();
 }
 
 void FragmentLinker::partialSyncRelocationResult(MemoryArea& pOutput)
@@ -220,42 +374,10 @@ void FragmentLinker::partialSyncRelocationResult(MemoryArea& pOutput)
 
 void FragmentLinker::writeRelocationResult(Relocation& pReloc, uint8_t* pOutput)
 {
-  // get output file offset
-  size_t out_offset =
-                 pReloc.targetRef().frag()->getParent()->getSection().offset() +
-                 pReloc.targetRef().getOutputOffset();
-
-  uint8_t* target_addr = pOutput + out_offset;
   // byte swapping if target and host has different endian, and then write back
-  if(llvm::sys::isLittleEndianHost() != m_Config.targets().isLittleEndian()) {
-     uint64_t tmp_data = 0;
-
-     switch(pReloc.size(*m_Backend.getRelocator())) {
-       case 8u:
-         std::memcpy(target_addr, &pReloc.target(), 1);
-         break;
-
-       case 16u:
-         tmp_data = mcld::bswap16(pReloc.target());
-         std::memcpy(target_addr, &tmp_data, 2);
-         break;
-
-       case 32u:
-         tmp_data = mcld::bswap32(pReloc.target());
-         std::memcpy(target_addr, &tmp_data, 4);
-         break;
-
-       case 64u:
-         tmp_data = mcld::bswap64(pReloc.target());
-         std::memcpy(target_addr, &tmp_data, 8);
-         break;
-
-       default:
-         break;
-    }
-  }
+  Relocation::Size size = pReloc.size(*m_Backend.getRelocator());
+  if(llvm::sys::isLittleEndianHost() != m_Config.targets().isLittleEndian())
+    RelocWriter<true>::write(pReloc, size, pOutput);
   else
-    std::memcpy(target_addr, &pReloc.target(),
-                                      pReloc.size(*m_Backend.getRelocator())/8);
+    RelocWriter<false>::write(pReloc, size, pOutput);
 }
-
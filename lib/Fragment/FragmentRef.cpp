@@ -12,23 +12,18 @@
 #include <cassert>
 
 #include <llvm/Support/Casting.h>
-#include <llvm/Support/ManagedStatic.h>
 
 #include <mcld/Fragment/Fragment.h>
 #include <mcld/LD/LDSection.h>
 #include <mcld/LD/SectionData.h>
 #include <mcld/LD/EhFrame.h>
-#include <mcld/Support/GCFactory.h>
+#include <mcld/LinkContext.h>
 #include <mcld/Support/MemoryRegion.h>
 #include <mcld/Fragment/RegionFragment.h>
 #include <mcld/Fragment/Stub.h>
 
 using namespace mcld;
 
-typedef GCFactory<FragmentRef, MCLD_SECTIONS_PER_INPUT> FragRefFactory;
-
-static llvm::ManagedStatic<FragRefFactory> g_FragRefFactory;
-
 FragmentRef FragmentRef::g_NullFragmentRef;
 
 //===----------------------------------------------------------------------===//
@@ -66,7 +61,7 @@ FragmentRef* FragmentRef::Create(Fragment& pFrag, uint64_t pOffset)
   if (NULL == frag)
     return Null();
 
-  FragmentRef* result = g_FragRefFactory->allocate();
+  FragmentRef* result = LinkContext::current().getFragRefFactory().allocate();
   new (result) FragmentRef(*frag, offset + frag->size());
 
   return result;
@@ -97,7 +92,7 @@ FragmentRef* FragmentRef::Create(LDSection& pSection, uint64_t pOffset)
 
 void FragmentRef::Clear()
 {
-  g_FragRefFactory->clear();
+  LinkContext::current().getFragRefFactory().clear();
 }
 
 FragmentRef* FragmentRef::Null()
@@ -12,34 +12,30 @@
 #include <mcld/LD/LDSymbol.h>
 #include <mcld/LD/LDSection.h>
 #include <mcld/LD/SectionData.h>
-#include <mcld/Support/MsgHandling.h>
 #include <mcld/LD/RelocationFactory.h>
-
-#include <llvm/Support/ManagedStatic.h>
+#include <mcld/LinkContext.h>
 
 using namespace mcld;
 
-static llvm::ManagedStatic<RelocationFactory> g_RelocationFactory;
-
 //===----------------------------------------------------------------------===//
 // Relocation Factory Methods
 //===----------------------------------------------------------------------===//
 /// Initialize - set up the relocation factory
 void Relocation::SetUp(const LinkerConfig& pConfig)
 {
-  g_RelocationFactory->setConfig(pConfig);
+  LinkContext::current().getRelocationFactory().setConfig(pConfig);
 }
 
 /// Clear - Clean up the relocation factory
 void Relocation::Clear()
 {
-  g_RelocationFactory->clear();
+  LinkContext::current().getRelocationFactory().clear();
 }
 
 /// Create - produce an empty relocation entry
 Relocation* Relocation::Create()
 {
-  return g_RelocationFactory->produceEmptyEntry();
+  return LinkContext::current().getRelocationFactory().produceEmptyEntry();
 }
 
 /// Create - produce a relocation entry
@@ -48,13 +44,15 @@ Relocation* Relocation::Create()
 /// @param pAddend  [in] the addend of the relocation entry
 Relocation* Relocation::Create(Type pType, FragmentRef& pFragRef, Address pAddend)
 {
-  return g_RelocationFactory->produce(pType, pFragRef, pAddend);
+  return LinkContext::current().getRelocationFactory().produce(pType,
+                                                               pFragRef,
+                                                               pAddend);
 }
 
 /// Destroy - destroy a relocation entry
 void Relocation::Destroy(Relocation*& pRelocation)
 {
-  g_RelocationFactory->destroy(pRelocation);
+  LinkContext::current().getRelocationFactory().destroy(pRelocation);
   pRelocation = NULL;
 }
 
@@ -99,33 +97,7 @@ Relocation::Address Relocation::symValue() const
 
 void Relocation::apply(Relocator& pRelocator)
 {
-  Relocator::Result result = pRelocator.applyRelocation(*this);
-
-  switch (result) {
-    case Relocator::OK: {
-      // do nothing
-      return;
-    }
-    case Relocator::Overflow: {
-      error(diag::result_overflow) << pRelocator.getName(type())
-                                   << symInfo()->name();
-      return;
-    }
-    case Relocator::BadReloc: {
-      error(diag::result_badreloc) << pRelocator.getName(type())
-                                   << symInfo()->name();
-      return;
-    }
-    case Relocator::Unsupport: {
-      fatal(diag::unsupported_relocation) << type()
-                                          << "mclinker@googlegroups.com";
-      return;
-    }
-    case Relocator::Unknown: {
-      fatal(diag::unknown_relocation) << type() << symInfo()->name();
-      return;
-    }
-  } // end of switch
+  pRelocator.report(pRelocator.applyRelocation(*this), *this);
 }
 
 void Relocation::setType(Type pType)
@@ -6,6 +6,7 @@ LOCAL_PATH:= $(call my-dir)
 
 mcld_ld_SRC_FILES := \
   Archive.cpp \
+  ArchiveIndexCache.cpp \
   ArchiveReader.cpp \
   BranchIsland.cpp  \
   BranchIslandFactory.cpp  \
@@ -21,13 +22,18 @@ mcld_ld_SRC_FILES := \
   ELFSegmentFactory.cpp \
   EhFrame.cpp \
   EhFrameHdr.cpp  \
+  EhFrameOptimizer.cpp \
   EhFrameReader.cpp  \
+  GarbageCollection.cpp \
   GroupReader.cpp \
+  IdenticalCodeFolding.cpp \
+  InputPrefetcher.cpp \
   LDContext.cpp \
   LDFileFormat.cpp  \
   LDReader.cpp  \
   LDSection.cpp \
   LDSymbol.cpp  \
+  MergeableSectionOptimizer.cpp \
   MsgHandler.cpp  \
   NamePool.cpp  \
   ObjectWriter.cpp  \
@@ -78,6 +84,7 @@ mcld_ld_variant_SRC_FILES := \
   ELFDynObjReader.cpp \
   ELFExecFileFormat.cpp \
   ELFFileFormat.cpp \
+  ELFLazySymbolTable.cpp \
   ELFObjectReader.cpp \
   ELFObjectWriter.cpp \
   ELFReader.cpp \
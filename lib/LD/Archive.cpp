@@ -12,6 +12,7 @@
 #include <mcld/MC/AttributeSet.h>
 #include <mcld/MC/ContextFactory.h>
 #include <llvm/ADT/StringRef.h>
+#include <mcld/Support/MemoryArea.h>
 #include <mcld/Support/MemoryAreaFactory.h>
 #include <mcld/Support/MsgHandling.h>
 
@@ -23,6 +24,7 @@ const char   Archive::MAGIC[]            = "!<arch>\n";
 const char   Archive::THIN_MAGIC[]       = "!<thin>\n";
 const size_t Archive::MAGIC_LEN          = sizeof(Archive::MAGIC) - 1;
 const char   Archive::SVR4_SYMTAB_NAME[] = "/               ";
+const char   Archive::SYM64_SYMTAB_NAME[] = "/SYM64/         ";
 const char   Archive::STRTAB_NAME[]      = "//              ";
 const char   Archive::PAD[]              = "\n";
 const char   Archive::MEMBER_MAGIC[]     = "`\n";
@@ -31,6 +33,8 @@ Archive::Archive(Input& pInputFile, InputBuilder& pBuilder)
  : m_ArchiveFile(pInputFile),
    m_pInputTree(NULL),
    m_SymbolFactory(32),
+   m_pSymTabRegion(NULL),
+   m_SymTabSize(0),
    m_Builder(pBuilder)
 {
   // FIXME: move creation of input tree out of Archive.
@@ -39,6 +43,8 @@ Archive::Archive(Input& pInputFile, InputBuilder& pBuilder)
 
 Archive::~Archive()
 {
+  if (NULL != m_pSymTabRegion)
+    m_ArchiveFile.memArea()->release(m_pSymTabRegion);
   delete m_pInputTree;
 }
 
@@ -87,7 +93,7 @@ size_t Archive::numOfObjectMember() const
 /// addObjectMember - add a object in the object member map
 /// @param pFileOffset - file offset in symtab represents a object file
 /// @param pIter - the iterator in the input tree built from this archive
-bool Archive::addObjectMember(uint32_t pFileOffset, InputTree::iterator pIter)
+bool Archive::addObjectMember(uint64_t pFileOffset, InputTree::iterator pIter)
 {
   bool exist;
   ObjectMemberEntryType* entry = m_ObjectMemberMap.insert(pFileOffset, exist);
@@ -98,7 +104,7 @@ bool Archive::addObjectMember(uint32_t pFileOffset, InputTree::iterator pIter)
 
 /// hasObjectMember - check if a object file is included or not
 /// @param pFileOffset - file offset in symtab represents a object file
-bool Archive::hasObjectMember(uint32_t pFileOffset) const
+bool Archive::hasObjectMember(uint64_t pFileOffset) const
 {
   return (m_ObjectMemberMap.find(pFileOffset) != m_ObjectMemberMap.end());
 }
@@ -167,17 +173,26 @@ const Archive::SymTabType& Archive::getSymbolTable() const
 }
 
 /// setSymTabSize - set the memory size of symtab
-void Archive::setSymTabSize(size_t pSize)
+void Archive::setSymTabSize(uint64_t pSize)
 {
   m_SymTabSize = pSize;
 }
 
 /// getSymTabSize - get the memory size of symtab
-size_t Archive::getSymTabSize() const
+uint64_t Archive::getSymTabSize() const
 {
   return m_SymTabSize;
 }
 
+/// setSymTabRegion - keep the region of symtab until the archive is
+/// destroyed, since the symbol names refer to it
+void Archive::setSymTabRegion(MemoryRegion* pRegion)
+{
+  if (NULL != m_pSymTabRegion)
+    m_ArchiveFile.memArea()->release(m_pSymTabRegion);
+  m_pSymTabRegion = pRegion;
+}
+
 /// numOfSymbols - return the number of symbols in symtab
 size_t Archive::numOfSymbols() const
 {
@@ -185,26 +200,44 @@ size_t Archive::numOfSymbols() const
 }
 
 /// addSymbol - add a symtab entry to symtab
-/// @param pName - symbol name
+/// @param pName - symbol name, which must be in the symtab region
 /// @param pFileOffset - file offset in symtab represents a object file
-void Archive::addSymbol(const char* pName,
-                        uint32_t pFileOffset,
+void Archive::addSymbol(const llvm::StringRef& pName,
+                        uint64_t pFileOffset,
                         enum Archive::Symbol::Status pStatus)
 {
   Symbol* entry = m_SymbolFactory.allocate();
   new (entry) Symbol(pName, pFileOffset, pStatus);
+
+  // the same name may appear more than once if several members define it.
+  // Only the first one is indexed, as the first member wins.
+  bool exist = false;
+  SymbolIndexEntryType* index = m_SymbolIndex.insert(pName, exist);
+  if (!exist)
+    index->setValue(m_SymTab.size());
+
   m_SymTab.push_back(entry);
 }
 
+/// findSymbol - find the first symtab entry with the given name
+bool Archive::findSymbol(const llvm::StringRef& pName, size_t& pSymIdx) const
+{
+  SymbolIndexType::const_iterator entry = m_SymbolIndex.find(pName);
+  if (entry == m_SymbolIndex.end())
+    return false;
+  pSymIdx = entry.getEntry()->value();
+  return true;
+}
+
 /// getSymbolName - get the symbol name with the given index
-const std::string& Archive::getSymbolName(size_t pSymIdx) const
+llvm::StringRef Archive::getSymbolName(size_t pSymIdx) const
 {
   assert(pSymIdx < numOfSymbols());
   return m_SymTab[pSymIdx]->name;
 }
 
 /// getObjFileOffset - get the file offset that represent a object file
-uint32_t Archive::getObjFileOffset(size_t pSymIdx) const
+uint64_t Archive::getObjFileOffset(size_t pSymIdx) const
 {
   assert(pSymIdx < numOfSymbols());
   return m_SymTab[pSymIdx]->fileOffset;
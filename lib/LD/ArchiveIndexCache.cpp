@@ -0,0 +1,285 @@
+//===- ArchiveIndexCache.cpp ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/ArchiveIndexCache.h>
+#include <mcld/ADT/StringHash.h>
+#include <mcld/LD/Archive.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Support/FileHandle.h>
+#include <mcld/Support/FileSystem.h>
+#include <mcld/Support/MemoryArea.h>
+#include <mcld/Support/MsgHandling.h>
+#include <mcld/Support/SystemUtils.h>
+
+#include <llvm/ADT/StringRef.h>
+
+#include <cstdio>
+#include <cstring>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// non-member functions
+//===----------------------------------------------------------------------===//
+/// the fields of the cache files are little-endian on every host
+static uint32_t read32(const uint8_t* pData)
+{
+  return uint32_t(pData[0]) | (uint32_t(pData[1]) << 8) |
+         (uint32_t(pData[2]) << 16) | (uint32_t(pData[3]) << 24);
+}
+
+static uint64_t read64(const uint8_t* pData)
+{
+  return uint64_t(read32(pData)) | (uint64_t(read32(pData + 4)) << 32);
+}
+
+static void append32(std::string& pImage, uint32_t pValue)
+{
+  for (size_t i = 0; i < sizeof(uint32_t); ++i)
+    pImage.push_back(static_cast<char>((pValue >> (8 * i)) & 0xff));
+}
+
+static void append64(std::string& pImage, uint64_t pValue)
+{
+  append32(pImage, static_cast<uint32_t>(pValue));
+  append32(pImage, static_cast<uint32_t>(pValue >> 32));
+}
+
+//===----------------------------------------------------------------------===//
+// ArchiveIndexCache
+//===----------------------------------------------------------------------===//
+const char ArchiveIndexCache::MAGIC[] = "MCLDAIX\n";
+const uint32_t ArchiveIndexCache::VERSION = 2;
+
+// magic, version, numOfSymbols and six 64-bit fields
+const size_t ArchiveIndexCache::HEADER_SIZE = 8 + 4 + 4 + 6 * 8;
+
+// fileOffset, nameOffset and nameSize
+const size_t ArchiveIndexCache::ENTRY_SIZE = 8 + 4 + 4;
+
+ArchiveIndexCache::ArchiveIndexCache(const std::string& pDirectory)
+  : m_Directory(pDirectory) {
+}
+
+ArchiveIndexCache::~ArchiveIndexCache()
+{
+  MappingList::iterator map, mapEnd = m_Mappings.end();
+  for (map = m_Mappings.begin(); map != mapEnd; ++map) {
+    map->handle->munmap(map->buffer, map->handle->size());
+    delete map->handle;
+  }
+}
+
+bool ArchiveIndexCache::load(Archive& pArchive)
+{
+  std::string ar_path;
+  uint64_t size = 0, time = 0;
+  if (!getStamp(pArchive.getARFile(), ar_path, size, time))
+    return false;
+
+  sys::fs::Path path = getCachePath(ar_path);
+  if (!sys::fs::exists(path))
+    return false;
+
+  FileHandle* handle = new FileHandle();
+  void* buffer = NULL;
+  if (!handle->open(path, FileHandle::ReadOnly) ||
+      handle->size() < HEADER_SIZE ||
+      !handle->mmap(buffer, 0, handle->size())) {
+    delete handle;
+    return false;
+  }
+
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(buffer);
+  Header header;
+  if (!readHeader(data, handle->size(), ar_path, size, time, header)) {
+    handle->munmap(buffer, handle->size());
+    delete handle;
+    return false;
+  }
+
+  const char* names = reinterpret_cast<const char*>(data) + HEADER_SIZE +
+                      header.numOfSymbols * ENTRY_SIZE +
+                      header.pathSize;
+  const char* strtab = names + header.nameSize;
+
+  for (uint32_t i = 0; i < header.numOfSymbols; ++i) {
+    Entry entry;
+    readEntry(data, i, entry);
+    pArchive.addSymbol(llvm::StringRef(names + entry.nameOffset,
+                                       entry.nameSize),
+                       entry.fileOffset);
+  }
+  pArchive.setSymTabSize(header.symTabSize);
+  pArchive.getStrTable().assign(strtab, header.strTabSize);
+
+  Mapping mapping;
+  mapping.handle = handle;
+  mapping.buffer = buffer;
+  m_Mappings.push_back(mapping);
+  return true;
+}
+
+bool ArchiveIndexCache::store(const Archive& pArchive) const
+{
+  std::string ar_path;
+  uint64_t size = 0, time = 0;
+  if (!getStamp(pArchive.getARFile(), ar_path, size, time))
+    return false;
+
+  // the names are not terminated; each entry records its own size.
+  std::string names;
+  for (size_t i = 0; i < pArchive.numOfSymbols(); ++i) {
+    llvm::StringRef name = pArchive.getSymbolName(i);
+    names.append(name.data(), name.size());
+  }
+
+  std::string image;
+  image.reserve(HEADER_SIZE + pArchive.numOfSymbols() * ENTRY_SIZE +
+                ar_path.size() + names.size() +
+                pArchive.getStrTable().size());
+  image.append(MAGIC, 8);
+  append32(image, VERSION);
+  append32(image, pArchive.numOfSymbols());
+  append64(image, size);
+  append64(image, time);
+  append64(image, pArchive.getSymTabSize());
+  append64(image, ar_path.size());
+  append64(image, names.size());
+  append64(image, pArchive.getStrTable().size());
+
+  uint32_t name_offset = 0;
+  for (size_t i = 0; i < pArchive.numOfSymbols(); ++i) {
+    uint32_t name_size = pArchive.getSymbolName(i).size();
+    append64(image, pArchive.getObjFileOffset(i));
+    append32(image, name_offset);
+    append32(image, name_size);
+    name_offset += name_size;
+  }
+  image.append(ar_path);
+  image.append(names);
+  image.append(pArchive.getStrTable());
+
+  // write a temporary file and rename it, so that the other links reading
+  // the same archive never see a partial cache file.
+  sys::fs::Path path = getCachePath(ar_path);
+  char suffix[32];
+  snprintf(suffix, sizeof(suffix), ".%u.tmp", sys::GetProcessID());
+  sys::fs::Path temp(path.native() + suffix);
+
+  FileHandle file;
+  FileHandle::Permission permission = 0644;
+  if (!file.open(temp,
+                 FileHandle::WriteOnly |
+                 FileHandle::Create |
+                 FileHandle::Truncate,
+                 permission) ||
+      !file.write(image.data(), 0, image.size()) ||
+      !file.close() ||
+      0 != sys::fs::detail::rename(temp, path)) {
+    warning(diag::warn_cannot_write_archive_cache) << path.native();
+    return false;
+  }
+  return true;
+}
+
+/// getStamp - only the archives given on the command line have a cache
+/// file; the nested archives in an archive do not. The archive is known by
+/// its real path, so the different paths to it share one cache file.
+bool ArchiveIndexCache::getStamp(const Input& pArchive,
+                                 std::string& pPath,
+                                 uint64_t& pSize,
+                                 uint64_t& pTime) const
+{
+  if (0 != pArchive.fileOffset() || NULL == pArchive.memArea())
+    return false;
+
+  const FileHandle* handle = pArchive.memArea()->handler();
+  if (NULL == handle || !handle->isOpened())
+    return false;
+
+  pSize = handle->size();
+  return (sys::fs::detail::real_path(pArchive.path(), pPath) &&
+          sys::fs::detail::last_write_time(handle->handler(), pTime));
+}
+
+sys::fs::Path
+ArchiveIndexCache::getCachePath(const std::string& pArchivePath) const
+{
+  StringHash<XX> hash_func;
+  char name[32];
+  snprintf(name, sizeof(name), "%08x.aidx", hash_func(pArchivePath));
+
+  sys::fs::Path path(m_Directory);
+  path.append(name);
+  return path;
+}
+
+bool ArchiveIndexCache::readHeader(const uint8_t* pData,
+                                   size_t pFileSize,
+                                   const std::string& pPath,
+                                   uint64_t pSize,
+                                   uint64_t pTime,
+                                   Header& pHeader) const
+{
+  memcpy(pHeader.magic, pData, sizeof(pHeader.magic));
+  pHeader.version = read32(pData + 8);
+  pHeader.numOfSymbols = read32(pData + 12);
+  pHeader.archiveSize = read64(pData + 16);
+  pHeader.archiveTime = read64(pData + 24);
+  pHeader.symTabSize = read64(pData + 32);
+  pHeader.pathSize = read64(pData + 40);
+  pHeader.nameSize = read64(pData + 48);
+  pHeader.strTabSize = read64(pData + 56);
+
+  if (0 != memcmp(pHeader.magic, MAGIC, sizeof(pHeader.magic)) ||
+      VERSION != pHeader.version ||
+      pSize != pHeader.archiveSize ||
+      pTime != pHeader.archiveTime)
+    return false;
+
+  // every part must lie in the file, and nothing may follow them
+  uint64_t rest = pFileSize - HEADER_SIZE;
+  if (uint64_t(pHeader.numOfSymbols) * ENTRY_SIZE > rest)
+    return false;
+  rest -= uint64_t(pHeader.numOfSymbols) * ENTRY_SIZE;
+  if (pHeader.pathSize > rest)
+    return false;
+  rest -= pHeader.pathSize;
+  if (pHeader.nameSize > rest)
+    return false;
+  rest -= pHeader.nameSize;
+  if (pHeader.strTabSize != rest)
+    return false;
+
+  // different archives may have the same hash value
+  const char* path = reinterpret_cast<const char*>(pData) + HEADER_SIZE +
+                     pHeader.numOfSymbols * ENTRY_SIZE;
+  if (pPath.size() != pHeader.pathSize ||
+      0 != memcmp(path, pPath.data(), pPath.size()))
+    return false;
+
+  // a corrupted cache file must not refer out of the names
+  for (uint32_t i = 0; i < pHeader.numOfSymbols; ++i) {
+    Entry entry;
+    readEntry(pData, i, entry);
+    if (uint64_t(entry.nameOffset) + entry.nameSize > pHeader.nameSize)
+      return false;
+  }
+  return true;
+}
+
+void ArchiveIndexCache::readEntry(const uint8_t* pData,
+                                  uint32_t pIdx,
+                                  Entry& pEntry)
+{
+  const uint8_t* entry = pData + HEADER_SIZE + pIdx * ENTRY_SIZE;
+  pEntry.fileOffset = read64(entry);
+  pEntry.nameOffset = read32(entry + 8);
+  pEntry.nameSize = read32(entry + 12);
+}
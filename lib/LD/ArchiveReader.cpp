@@ -7,6 +7,9 @@
 //
 //===----------------------------------------------------------------------===//
 #include "mcld/LD/ArchiveReader.h"
+#include <mcld/LD/Archive.h>
+#include <mcld/MC/Attribute.h>
+#include <mcld/MC/MCLDInput.h>
 
 using namespace mcld;
 
@@ -19,4 +22,25 @@ ArchiveReader::ArchiveReader()
 ArchiveReader::~ArchiveReader()
 {
 }
+
+bool ArchiveReader::readGroup(const ArchiveListType& pArchives)
+{
+  size_t cur_obj_cnt = 0;
+  size_t last_obj_cnt = 0;
+  ArchiveListType::const_iterator ar, arEnd = pArchives.end();
+  for (ar = pArchives.begin(); ar != arEnd; ++ar)
+    cur_obj_cnt += (*ar)->numOfObjectMember();
+
+  while (cur_obj_cnt != last_obj_cnt) {
+    last_obj_cnt = cur_obj_cnt;
+    cur_obj_cnt = 0;
+    for (ar = pArchives.begin(); ar != arEnd; ++ar) {
+      // if --whole-archive is given to this archive, no need to read it again
+      if (!(*ar)->getARFile().attribute()->isWholeArchive())
+        readArchive(**ar);
+      cur_obj_cnt += (*ar)->numOfObjectMember();
+    }
+  }
+  return true;
+}
  
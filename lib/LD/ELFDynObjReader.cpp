@@ -10,6 +10,7 @@
 
 #include <mcld/LinkerConfig.h>
 #include <mcld/IRBuilder.h>
+#include <mcld/LD/ELFLazySymbolTable.h>
 #include <mcld/LD/ELFReader.h>
 #include <mcld/MC/MCLDInput.h>
 #include <mcld/Support/MemoryRegion.h>
@@ -31,7 +32,8 @@ ELFDynObjReader::ELFDynObjReader(GNULDBackend& pBackend,
                                  const LinkerConfig& pConfig)
   : DynObjReader(),
     m_pELFReader(0),
-    m_Builder(pBuilder) {
+    m_Builder(pBuilder),
+    m_Config(pConfig) {
   if (pConfig.targets().is32Bits() && pConfig.targets().isLittleEndian())
     m_pELFReader = new ELFReader<32, true>(pBackend);
   else if (pConfig.targets().is64Bits() && pConfig.targets().isLittleEndian())
@@ -40,6 +42,9 @@ ELFDynObjReader::ELFDynObjReader(GNULDBackend& pBackend,
 
 ELFDynObjReader::~ELFDynObjReader()
 {
+  LazySymbolTableList::iterator table, tEnd = m_LazySymbols.end();
+  for (table = m_LazySymbols.begin(); table != tEnd; ++table)
+    delete *table;
   delete m_pELFReader;
 }
 
@@ -78,7 +83,14 @@ bool ELFDynObjReader::readHeader(Input& pInput)
                                                    hdr_size);
   uint8_t* ELF_hdr = region->start();
 
-  bool shdr_result = m_pELFReader->readSectionHeaders(pInput, ELF_hdr);
+  // InputPrefetcher may have decoded the section headers already
+  bool shdr_result = true;
+  if (pInput.hasELFTables()) {
+    shdr_result = m_pELFReader->createSections(pInput,
+                                               pInput.elfTables()->sections());
+  }
+  else
+    shdr_result = m_pELFReader->readSectionHeaders(pInput, ELF_hdr);
   pInput.memArea()->release(region);
 
   // read .dynamic to get the correct SONAME
@@ -100,6 +112,21 @@ bool ELFDynObjReader::readSymbols(Input& pInput)
     return true;
   }
 
+  // with --lazy-dynamic-symbols, a defined symbol is read only when an
+  // undefined symbol with the same name is added
+  if (m_Config.options().lazyDynSymbols()) {
+    unsigned int bitclass = m_Config.targets().is32Bits() ? 32 : 64;
+    ELFLazySymbolTable* table =
+      ELFLazySymbolTable::Create(pInput, *m_pELFReader, bitclass);
+    if (NULL != table) {
+      m_LazySymbols.push_back(table);
+      pInput.context()->addSymbol(LDSymbol::Null());
+      table->readUnhashed(m_Builder);
+      m_Builder.AddLazySymbols(*table);
+      return true;
+    }
+  }
+
   LDSection* strtab_shdr = symtab_shdr->getLink();
   if (NULL == strtab_shdr) {
     fatal(diag::fatal_cannot_read_strtab) << pInput.name()
@@ -108,15 +135,25 @@ bool ELFDynObjReader::readSymbols(Input& pInput)
     return false;
   }
 
-  MemoryRegion* symtab_region = pInput.memArea()->request(
-              pInput.fileOffset() + symtab_shdr->offset(), symtab_shdr->size());
-
   MemoryRegion* strtab_region = pInput.memArea()->request(
               pInput.fileOffset() + strtab_shdr->offset(), strtab_shdr->size());
   char* strtab = reinterpret_cast<char*>(strtab_region->start());
-  bool result = m_pELFReader->readSymbols(pInput, m_Builder,
-                                          *symtab_region, strtab);
-  pInput.memArea()->release(symtab_region);
+
+  bool result = true;
+  const ELFInputTables* tables = pInput.elfTables();
+  if (NULL != tables && tables->hasSymbols() &&
+      symtab_shdr == pInput.context()->getSection(tables->symTab())) {
+    // InputPrefetcher has decoded the symbols already
+    result = m_pELFReader->addSymbols(pInput, m_Builder,
+                                      tables->symbols(), strtab, NULL);
+  }
+  else {
+    MemoryRegion* symtab_region = pInput.memArea()->request(
+              pInput.fileOffset() + symtab_shdr->offset(), symtab_shdr->size());
+    result = m_pELFReader->readSymbols(pInput, m_Builder,
+                                       *symtab_region, strtab, NULL);
+    pInput.memArea()->release(symtab_region);
+  }
   pInput.memArea()->release(strtab_region);
 
   return result;
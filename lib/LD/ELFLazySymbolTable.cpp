@@ -0,0 +1,323 @@
+//===- ELFLazySymbolTable.cpp ---------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/ELFLazySymbolTable.h>
+#include <mcld/ADT/SizeTraits.h>
+#include <mcld/LD/ELFReaderIf.h>
+#include <mcld/LD/LDContext.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Support/MemoryArea.h>
+#include <mcld/Support/MemoryRegion.h>
+
+#include <llvm/Support/ELF.h>
+#include <llvm/Support/Host.h>
+
+#include <cstddef>
+#include <cstring>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// non-member functions
+//===----------------------------------------------------------------------===//
+/// GNUHash - the hash function of .gnu.hash
+static uint32_t GNUHash(const llvm::StringRef& pName)
+{
+  uint32_t hash = 5381;
+  for (size_t i = 0; i < pName.size(); ++i)
+    hash = (hash << 5) + hash + static_cast<unsigned char>(pName[i]);
+  return hash;
+}
+
+/// SysVHash - the hash function of .hash
+static uint32_t SysVHash(const llvm::StringRef& pName)
+{
+  uint32_t hash = 0;
+  for (size_t i = 0; i < pName.size(); ++i) {
+    hash = (hash << 4) + static_cast<unsigned char>(pName[i]);
+    uint32_t high = hash & 0xF0000000;
+    if (0 != high)
+      hash ^= high >> 24;
+    hash &= ~high;
+  }
+  return hash;
+}
+
+/// GetData - get the contents of pSection in the whole-file mapping of
+/// pInput. The contents stay valid after the region is released.
+static const uint8_t* GetData(Input& pInput, const LDSection& pSection)
+{
+  MemoryRegion* region =
+    pInput.memArea()->request(pInput.fileOffset() + pSection.offset(),
+                              pSection.size());
+  if (NULL == region)
+    return NULL;
+
+  const uint8_t* data = region->start();
+  if (!pInput.memArea()->isInWholeFile(data, pSection.size()))
+    data = NULL;
+  pInput.memArea()->release(region);
+  return data;
+}
+
+//===----------------------------------------------------------------------===//
+// ELFLazySymbolTable
+//===----------------------------------------------------------------------===//
+ELFLazySymbolTable::ELFLazySymbolTable(Input& pInput,
+                                       const ELFReaderIF& pReader,
+                                       unsigned int pBitClass)
+  : m_Input(pInput), m_Reader(pReader), m_BitClass(pBitClass),
+    m_Style(GNU), m_pSymTab(NULL), m_NumOfSymbols(0), m_pStrTab(NULL),
+    m_StrTabSize(0), m_NumOfBuckets(0), m_pBuckets(NULL), m_pChains(NULL),
+    m_NumOfChains(0), m_SymOffset(0), m_pBloom(NULL), m_BloomSize(0),
+    m_BloomShift(0), m_NumOfMaterialized(0) {
+}
+
+ELFLazySymbolTable::~ELFLazySymbolTable()
+{
+}
+
+ELFLazySymbolTable* ELFLazySymbolTable::Create(Input& pInput,
+                                               const ELFReaderIF& pReader,
+                                               unsigned int pBitClass)
+{
+  if (!pInput.hasMemArea() || !pInput.memArea()->isWholeFileMapped())
+    return NULL;
+
+  LDSection* dynsym = pInput.context()->getSection(".dynsym");
+  if (NULL == dynsym || NULL == dynsym->getLink())
+    return NULL;
+
+  HashStyle style = GNU;
+  LDSection* hash = pInput.context()->getSection(".gnu.hash");
+  if (NULL == hash) {
+    style = SystemV;
+    hash = pInput.context()->getSection(".hash");
+    if (NULL == hash)
+      return NULL;
+  }
+
+  const uint8_t* symtab = GetData(pInput, *dynsym);
+  const uint8_t* strtab = GetData(pInput, *dynsym->getLink());
+  const uint8_t* hashtab = GetData(pInput, *hash);
+  if (NULL == symtab || NULL == strtab || NULL == hashtab)
+    return NULL;
+
+  ELFLazySymbolTable* result =
+    new ELFLazySymbolTable(pInput, pReader, pBitClass);
+  result->m_Style = style;
+  result->m_pSymTab = symtab;
+  if (32 == pBitClass)
+    result->m_NumOfSymbols = dynsym->size() / sizeof(llvm::ELF::Elf32_Sym);
+  else
+    result->m_NumOfSymbols = dynsym->size() / sizeof(llvm::ELF::Elf64_Sym);
+  result->m_pStrTab = reinterpret_cast<const char*>(strtab);
+  result->m_StrTabSize = dynsym->getLink()->size();
+
+  bool valid = false;
+  if (GNU == style)
+    valid = result->setUpGNUHash(hashtab, hash->size());
+  else
+    valid = result->setUpSysVHash(hashtab, hash->size());
+
+  if (!valid) {
+    delete result;
+    return NULL;
+  }
+  return result;
+}
+
+/// setUpGNUHash - .gnu.hash is nbuckets, symoffset, bloom_size, bloom_shift,
+/// the bloom filter of ELFCLASS words, the buckets and the hash values of the
+/// symbols from symoffset.
+bool ELFLazySymbolTable::setUpGNUHash(const uint8_t* pData, size_t pSize)
+{
+  if (pSize < 16)
+    return false;
+
+  m_NumOfBuckets = getWord(pData, 0);
+  m_SymOffset = getWord(pData, 1);
+  m_BloomSize = getWord(pData, 2);
+  m_BloomShift = getWord(pData, 3);
+
+  size_t word_size = m_BitClass / 8;
+  size_t rest = pSize - 16;
+  if (0 == m_NumOfBuckets || 0 == m_BloomSize || m_BloomShift >= 32 ||
+      m_SymOffset > m_NumOfSymbols || m_BloomSize > rest / word_size)
+    return false;
+  rest -= m_BloomSize * word_size;
+
+  if (m_NumOfBuckets > rest / 4)
+    return false;
+  rest -= m_NumOfBuckets * 4;
+
+  m_pBloom = pData + 16;
+  m_pBuckets = m_pBloom + m_BloomSize * word_size;
+  m_pChains = m_pBuckets + m_NumOfBuckets * 4;
+  m_NumOfChains = rest / 4;
+  return true;
+}
+
+/// setUpSysVHash - .hash is nbucket, nchain, the buckets and the chains.
+bool ELFLazySymbolTable::setUpSysVHash(const uint8_t* pData, size_t pSize)
+{
+  if (pSize < 8)
+    return false;
+
+  m_NumOfBuckets = getWord(pData, 0);
+  m_NumOfChains = getWord(pData, 1);
+
+  // every symbol must be in a chain to be found
+  size_t rest = pSize - 8;
+  if (0 == m_NumOfBuckets || m_NumOfChains < m_NumOfSymbols ||
+      m_NumOfBuckets > rest / 4 || m_NumOfChains > rest / 4 - m_NumOfBuckets)
+    return false;
+
+  m_pBuckets = pData + 8;
+  m_pChains = m_pBuckets + m_NumOfBuckets * 4;
+  return true;
+}
+
+/// readUnhashed - the symbols before symoffset of .gnu.hash and the undefined
+/// symbols are not looked up by name. The undefined symbols are the
+/// references of the dynamic object, which must be resolved, too.
+void ELFLazySymbolTable::readUnhashed(IRBuilder& pBuilder)
+{
+  for (uint32_t idx = 1; idx < m_NumOfSymbols; ++idx) {
+    bool hashed = (SystemV == m_Style || idx >= m_SymOffset);
+    if (hashed && llvm::ELF::SHN_UNDEF != getShndx(idx))
+      continue;
+    m_Reader.readSymbol(m_Input, pBuilder, m_pSymTab, m_pStrTab, NULL, idx);
+  }
+}
+
+/// materialize - add the defined symbols named pName to NamePool
+bool ELFLazySymbolTable::materialize(const llvm::StringRef& pName,
+                                     IRBuilder& pBuilder)
+{
+  if (GNU == m_Style)
+    return materializeGNU(pName, pBuilder);
+  return materializeSysV(pName, pBuilder);
+}
+
+bool ELFLazySymbolTable::materializeGNU(const llvm::StringRef& pName,
+                                        IRBuilder& pBuilder)
+{
+  uint32_t hash = GNUHash(pName);
+
+  // the bloom filter rejects most of the names not in the dynamic object
+  uint64_t word = 0;
+  uint32_t word_idx = (hash / m_BitClass) % m_BloomSize;
+  if (32 == m_BitClass)
+    word = getWord(m_pBloom, word_idx);
+  else
+    word = getWord(m_pBloom, 2 * word_idx) |
+           (static_cast<uint64_t>(getWord(m_pBloom, 2 * word_idx + 1)) << 32);
+
+  uint64_t mask = (1ULL << (hash % m_BitClass)) |
+                  (1ULL << ((hash >> m_BloomShift) % m_BitClass));
+  if (mask != (word & mask))
+    return false;
+
+  // the chain of a bucket is the consecutive symbols from the bucket, and
+  // the lowest bit of the hash value marks the end of the chain.
+  uint32_t idx = getWord(m_pBuckets, hash % m_NumOfBuckets);
+  if (idx < m_SymOffset)
+    return false;
+
+  bool result = false;
+  for (; idx < m_NumOfSymbols && (idx - m_SymOffset) < m_NumOfChains; ++idx) {
+    uint32_t chain = getWord(m_pChains, idx - m_SymOffset);
+    if ((chain | 1) == (hash | 1) && materializeSymbol(pName, idx, pBuilder))
+      result = true;
+    if (0x0 != (chain & 1))
+      break;
+  }
+  return result;
+}
+
+bool ELFLazySymbolTable::materializeSysV(const llvm::StringRef& pName,
+                                         IRBuilder& pBuilder)
+{
+  uint32_t idx = getWord(m_pBuckets, SysVHash(pName) % m_NumOfBuckets);
+
+  // a broken chain may be a loop, so visit at most nchain symbols
+  bool result = false;
+  for (size_t count = 0;
+       llvm::ELF::STN_UNDEF != idx && idx < m_NumOfSymbols &&
+       count < m_NumOfChains;
+       ++count) {
+    if (materializeSymbol(pName, idx, pBuilder))
+      result = true;
+    idx = getWord(m_pChains, idx);
+  }
+  return result;
+}
+
+bool ELFLazySymbolTable::materializeSymbol(const llvm::StringRef& pName,
+                                           uint32_t pSymIdx,
+                                           IRBuilder& pBuilder)
+{
+  // the undefined symbols are added by readUnhashed()
+  if (llvm::ELF::SHN_UNDEF == getShndx(pSymIdx))
+    return false;
+
+  uint32_t st_name = getName(pSymIdx);
+  if (st_name >= m_StrTabSize || pName.size() >= m_StrTabSize - st_name)
+    return false;
+
+  const char* name = m_pStrTab + st_name;
+  if (0 != memcmp(name, pName.data(), pName.size()) ||
+      '\0' != name[pName.size()])
+    return false;
+
+  if (NULL == m_Reader.readSymbol(m_Input, pBuilder, m_pSymTab, m_pStrTab,
+                                  NULL, pSymIdx))
+    return false;
+
+  ++m_NumOfMaterialized;
+  return true;
+}
+
+uint32_t ELFLazySymbolTable::getName(uint32_t pSymIdx) const
+{
+  // st_name is the first field of both Elf32_Sym and Elf64_Sym
+  if (32 == m_BitClass)
+    return getWord(m_pSymTab + pSymIdx * sizeof(llvm::ELF::Elf32_Sym), 0);
+  return getWord(m_pSymTab + pSymIdx * sizeof(llvm::ELF::Elf64_Sym), 0);
+}
+
+uint16_t ELFLazySymbolTable::getShndx(uint32_t pSymIdx) const
+{
+  const uint8_t* data = NULL;
+  if (32 == m_BitClass)
+    data = m_pSymTab + pSymIdx * sizeof(llvm::ELF::Elf32_Sym) +
+           offsetof(llvm::ELF::Elf32_Sym, st_shndx);
+  else
+    data = m_pSymTab + pSymIdx * sizeof(llvm::ELF::Elf64_Sym) +
+           offsetof(llvm::ELF::Elf64_Sym, st_shndx);
+
+  uint16_t shndx = 0;
+  memcpy(&shndx, data, sizeof(shndx));
+  if (llvm::sys::isLittleEndianHost())
+    return shndx;
+  return mcld::bswap16(shndx);
+}
+
+/// getWord - read the pIdx-th 32-bit word from pData. The hash sections are
+/// not always aligned in the mapping of an input.
+uint32_t ELFLazySymbolTable::getWord(const uint8_t* pData, size_t pIdx) const
+{
+  uint32_t word = 0;
+  memcpy(&word, pData + pIdx * 4, sizeof(word));
+  if (llvm::sys::isLittleEndianHost())
+    return word;
+  return mcld::bswap32(word);
+}
+
@@ -86,6 +86,12 @@ bool ELFObjectReader::readHeader(Input& pInput)
 {
   assert(pInput.hasMemArea());
 
+  // InputPrefetcher may have decoded the section headers already
+  if (pInput.hasELFTables()) {
+    return m_pELFReader->createSections(pInput,
+                                        pInput.elfTables()->sections());
+  }
+
   size_t hdr_size = m_pELFReader->getELFHeaderSize();
   MemoryRegion* region = pInput.memArea()->request(pInput.fileOffset(),
                                                      hdr_size);
@@ -185,17 +191,27 @@ bool ELFObjectReader::readSections(Input& pInput)
       case LDFileFormat::EhFrame: {
         EhFrame* eh_frame = IRBuilder::CreateEhFrame(**section);
 
-        if (m_Config.options().hasEhFrameHdr() &&
+        // parse .eh_frame if --eh-frame-hdr option is given, or the CIEs and
+        // FDEs may be optimized when merging. The output of -r keeps them.
+        bool parsed = false;
+        if ((m_Config.options().hasEhFrameHdr() ||
+             LinkerConfig::Object != m_Config.codeGenType()) &&
             (m_ReadFlag & ParseEhFrame)) {
-
-          // if --eh-frame-hdr option is given, parse .eh_frame.
-          if (!m_pEhFrameReader->read<32, true>(pInput, *eh_frame)) {
+          if (m_Config.targets().is32Bits())
+            parsed = m_pEhFrameReader->read<32, true>(pInput, *eh_frame);
+          else
+            parsed = m_pEhFrameReader->read<64, true>(pInput, *eh_frame);
+          if (!parsed) {
             // if we failed to parse a .eh_frame, we should not parse the rest
-            // .eh_frame.
+            // .eh_frame. Drop the entries read so far and read it as a whole.
             m_ReadFlag ^= ParseEhFrame;
+            eh_frame->clear();
           }
         }
-        else {
+
+        if (!parsed) {
+          // .eh_frame_hdr can not index the FDEs of this section
+          eh_frame->setUnparsed();
           if (!m_pELFReader->readRegularSection(pInput,
                                                 eh_frame->getSectionData())) {
             fatal(diag::err_cannot_read_section) << (*section)->name();
@@ -257,17 +273,50 @@ bool ELFObjectReader::readSymbols(Input& pInput)
     return false;
   }
 
-  MemoryRegion* symtab_region = pInput.memArea()->request(
-             pInput.fileOffset() + symtab_shdr->offset(), symtab_shdr->size());
   MemoryRegion* strtab_region = pInput.memArea()->request(
              pInput.fileOffset() + strtab_shdr->offset(), strtab_shdr->size());
   char* strtab = reinterpret_cast<char*>(strtab_region->start());
-  bool result = m_pELFReader->readSymbols(pInput,
-                                          m_Builder,
-                                          *symtab_region,
-                                          strtab);
-  pInput.memArea()->release(symtab_region);
+
+  // the objects with more than SHN_LORESERVE sections keep the section
+  // indices of the symbols in .symtab_shndx
+  MemoryRegion* shndx_region = NULL;
+  const uint32_t* shndx = NULL;
+  LDSection* shndx_shdr = m_pELFReader->getSymTabShndx(pInput, *symtab_shdr);
+  if (NULL != shndx_shdr) {
+    size_t sym_size = sizeof(llvm::ELF::Elf64_Sym);
+    if (m_Config.targets().is32Bits())
+      sym_size = sizeof(llvm::ELF::Elf32_Sym);
+    if (shndx_shdr->size() / sizeof(uint32_t) < symtab_shdr->size() / sym_size)
+      fatal(diag::err_cannot_read_section) << shndx_shdr->name();
+    shndx_region = pInput.memArea()->request(
+               pInput.fileOffset() + shndx_shdr->offset(), shndx_shdr->size());
+    shndx = reinterpret_cast<const uint32_t*>(shndx_region->start());
+  }
+
+  bool result = true;
+  const ELFInputTables* tables = pInput.elfTables();
+  if (NULL != tables && tables->hasSymbols() &&
+      symtab_shdr == pInput.context()->getSection(tables->symTab())) {
+    // InputPrefetcher has decoded the symbols already
+    result = m_pELFReader->addSymbols(pInput,
+                                      m_Builder,
+                                      tables->symbols(),
+                                      strtab,
+                                      shndx);
+  }
+  else {
+    MemoryRegion* symtab_region = pInput.memArea()->request(
+             pInput.fileOffset() + symtab_shdr->offset(), symtab_shdr->size());
+    result = m_pELFReader->readSymbols(pInput,
+                                       m_Builder,
+                                       *symtab_region,
+                                       strtab,
+                                       shndx);
+    pInput.memArea()->release(symtab_region);
+  }
   pInput.memArea()->release(strtab_region);
+  if (NULL != shndx_region)
+    pInput.memArea()->release(shndx_region);
   return result;
 }
 
@@ -281,8 +330,8 @@ bool ELFObjectReader::readRelocations(Input& pInput)
     if (LDFileFormat::Ignore == (*rs)->kind())
       continue;
 
-    uint32_t offset = pInput.fileOffset() + (*rs)->offset();
-    uint32_t size = (*rs)->size();
+    uint64_t offset = pInput.fileOffset() + (*rs)->offset();
+    uint64_t size = (*rs)->size();
     MemoryRegion* region = mem->request(offset, size);
     IRBuilder::CreateRelocData(**rs); ///< create relocation data for the header
     switch ((*rs)->type()) {
@@ -14,6 +14,7 @@
 #include <mcld/Support/MemoryArea.h>
 #include <mcld/Support/MemoryRegion.h>
 #include <mcld/Support/MsgHandling.h>
+#include <mcld/Support/ThreadPool.h>
 #include <mcld/ADT/SizeTraits.h>
 #include <mcld/Fragment/FragmentLinker.h>
 #include <mcld/Fragment/AlignFragment.h>
@@ -33,10 +34,167 @@
 #include <llvm/Support/ELF.h>
 #include <llvm/Support/Casting.h>
 
+#include <vector>
+
 using namespace llvm;
 using namespace llvm::ELF;
 using namespace mcld;
 
+//===----------------------------------------------------------------------===//
+// Non-member functions
+//===----------------------------------------------------------------------===//
+static bool isValidValueSize(unsigned int pValueSize)
+{
+  return (1u == pValueSize || 2u == pValueSize ||
+          4u == pValueSize || 8u == pValueSize);
+}
+
+/// EmitFragments - emit the fragments [pBegin, pEnd) at pOffset of pRegion.
+/// If pZeroFilled, pRegion is known to be zeros, and the zero fillments are
+/// not written.
+static void EmitFragments(SectionData::const_iterator pBegin,
+                          SectionData::const_iterator pEnd,
+                          MemoryRegion& pRegion,
+                          size_t pOffset,
+                          const GNULDBackend& pBackend,
+                          bool pIsLittleEndian,
+                          bool pZeroFilled)
+{
+  SectionData::const_iterator fragIter;
+  size_t cur_offset = pOffset;
+  for (fragIter = pBegin; fragIter != pEnd; ++fragIter) {
+    size_t size = fragIter->size();
+    switch(fragIter->getKind()) {
+      case Fragment::Region: {
+        const RegionFragment& region_frag = llvm::cast<RegionFragment>(*fragIter);
+        const uint8_t* from = region_frag.getRegion().start();
+        memcpy(pRegion.getBuffer(cur_offset), from, size);
+        break;
+      }
+      case Fragment::Alignment: {
+        const AlignFragment& align_frag = llvm::cast<AlignFragment>(*fragIter);
+        if (0 == size)
+          break;
+
+        if (align_frag.hasEmitNops()) {
+          pBackend.emitNops(pRegion.getBuffer(cur_offset), size);
+          break;
+        }
+
+        if (!isValidValueSize(align_frag.getValueSize()))
+          llvm::report_fatal_error("unsupported value size for align fragment emission yet.\n");
+
+        if (pZeroFilled && 0x0 == align_frag.getValue())
+          break;
+
+        ELFObjectWriter::FillPattern(pRegion.getBuffer(cur_offset),
+                                     size,
+                                     align_frag.getValue(),
+                                     align_frag.getValueSize(),
+                                     pIsLittleEndian);
+        break;
+      }
+      case Fragment::Fillment: {
+        const FillFragment& fill_frag = llvm::cast<FillFragment>(*fragIter);
+        if (0 == size ||
+            0 == fill_frag.getValueSize() ||
+            0 == fill_frag.size()) {
+          // ignore virtual fillment
+          break;
+        }
+
+        if (!isValidValueSize(fill_frag.getValueSize()))
+          llvm::report_fatal_error("unsupported value size for fill fragment emission yet.\n");
+
+        if (pZeroFilled && 0x0 == fill_frag.getValue())
+          break;
+
+        ELFObjectWriter::FillPattern(pRegion.getBuffer(cur_offset),
+                                     size,
+                                     fill_frag.getValue(),
+                                     fill_frag.getValueSize(),
+                                     pIsLittleEndian);
+        break;
+      }
+      case Fragment::Stub: {
+        const Stub& stub_frag = llvm::cast<Stub>(*fragIter);
+        memcpy(pRegion.getBuffer(cur_offset), stub_frag.getContent(), size);
+        break;
+      }
+      case Fragment::Null: {
+        assert(0x0 == size);
+        break;
+      }
+      case Fragment::Target:
+        llvm::report_fatal_error("Target fragment should not be in a regular section.\n");
+        break;
+      default:
+        llvm::report_fatal_error("invalid fragment should not be in a regular section.\n");
+        break;
+    }
+    cur_offset += size;
+  }
+}
+
+
+/// GetSectionData - the fragments of a section whose data is emitted by
+/// ELFObjectWriter::emitSectionData. .eh_frame is emitted by writeSection,
+/// since its CIE pointers are rewritten after the fragments are copied.
+static const SectionData* GetSectionData(const LDSection& pSection)
+{
+  switch (pSection.kind()) {
+    case LDFileFormat::GCCExceptTable:
+    case LDFileFormat::Regular:
+    case LDFileFormat::Debug:
+    case LDFileFormat::Note:
+      return pSection.getSectionData();
+    default:
+      return NULL;
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// EmitTask
+//===----------------------------------------------------------------------===//
+/// EmitTask - emit a range of the fragments of an output section. The ranges
+/// of the tasks do not overlap, and the region is requested by the main
+/// thread.
+namespace mcld {
+
+class EmitTask : public ThreadPool::Task
+{
+public:
+  EmitTask(SectionData::const_iterator pBegin,
+           SectionData::const_iterator pEnd,
+           MemoryRegion& pRegion,
+           size_t pOffset,
+           const GNULDBackend& pBackend,
+           bool pIsLittleEndian)
+    : m_Begin(pBegin), m_End(pEnd), m_Region(pRegion), m_Offset(pOffset),
+      m_Backend(pBackend), m_bLittleEndian(pIsLittleEndian) {
+  }
+
+  /// the whole output is mapped, and the untouched bytes are zeros
+  void run()
+  {
+    EmitFragments(m_Begin, m_End, m_Region, m_Offset,
+                  m_Backend, m_bLittleEndian, true);
+  }
+
+private:
+  SectionData::const_iterator m_Begin;
+  SectionData::const_iterator m_End;
+  MemoryRegion& m_Region;
+  size_t m_Offset;
+  const GNULDBackend& m_Backend;
+  bool m_bLittleEndian;
+};
+
+} // namespace of mcld
+
+/// EmitChunkSize - a large section is split into the tasks of about this size
+static const size_t EmitChunkSize = 1024 * 1024;
+
 //===----------------------------------------------------------------------===//
 // ELFObjectWriter
 //===----------------------------------------------------------------------===//
@@ -50,6 +208,37 @@ ELFObjectWriter::~ELFObjectWriter()
 {
 }
 
+/// FillPattern - the first tile is written byte by byte, and then the
+/// filled prefix is doubled by memcpy, which copies with the widest stores
+/// of the host.
+void ELFObjectWriter::FillPattern(uint8_t* pBuf,
+                                  size_t pSize,
+                                  uint64_t pValue,
+                                  unsigned int pValueSize,
+                                  bool pIsLittleEndian)
+{
+  uint8_t tile[8];
+  bool is_splat = true;
+  for (unsigned int i = 0; i < pValueSize; ++i) {
+    unsigned int shift = pIsLittleEndian ? i : (pValueSize - 1 - i);
+    tile[i] = static_cast<uint8_t>(pValue >> (shift * 8));
+    is_splat = is_splat && (tile[i] == tile[0]);
+  }
+
+  if (is_splat) {
+    std::memset(pBuf, tile[0], pSize);
+    return;
+  }
+
+  size_t filled = (pSize < pValueSize) ? pSize : pValueSize;
+  std::memcpy(pBuf, tile, filled);
+  while (filled < pSize) {
+    size_t count = (filled < pSize - filled) ? filled : (pSize - filled);
+    std::memcpy(pBuf + filled, pBuf, count);
+    filled += count;
+  }
+}
+
 void ELFObjectWriter::writeSection(MemoryArea& pOutput, LDSection *section)
 {
   MemoryRegion* region;
@@ -123,6 +312,25 @@ llvm::error_code ELFObjectWriter::writeObject(Module& pModule,
 
   assert(is_dynobj || is_exec || is_binary || is_object);
 
+  // The layout is done, so the size of an ELF output is known. Map the whole
+  // output at once, then copy the section data on the thread pool while the
+  // name pools and the headers are generated here.
+  bool is_mapped = false;
+  if (!is_binary) {
+    if (m_Config.targets().is32Bits())
+      is_mapped = pOutput.mapWholeOutput(getOutputSize<32>(pModule));
+    else if (m_Config.targets().is64Bits())
+      is_mapped = pOutput.mapWholeOutput(getOutputSize<64>(pModule));
+  }
+
+  ThreadPool pool(is_mapped ? m_Config.options().numThreads() : 1);
+  std::vector<EmitTask*> tasks;
+  if (is_mapped) {
+    Module::iterator sect, sectEnd = pModule.end();
+    for (sect = pModule.begin(); sect != sectEnd; ++sect)
+      enqueueSection(pool, pOutput, **sect, tasks);
+  }
+
   if (is_dynobj || is_exec) {
     // Write out the interpreter section: .interp
     target().emitInterp(pOutput);
@@ -148,10 +356,12 @@ llvm::error_code ELFObjectWriter::writeObject(Module& pModule,
       }
     }
   } else {
-    // Write out regular ELF sections
+    // Write out regular ELF sections. The ones in the tasks are skipped.
     Module::iterator sect, sectEnd = pModule.end();
-    for (sect = pModule.begin(); sect != sectEnd; ++sect)
-      writeSection(pOutput, *sect);
+    for (sect = pModule.begin(); sect != sectEnd; ++sect) {
+      if (!is_mapped || NULL == GetSectionData(**sect))
+        writeSection(pOutput, *sect);
+    }
 
     emitShStrTab(target().getOutputFormat()->getShStrTab(), pModule, pOutput);
 
@@ -177,10 +387,56 @@ llvm::error_code ELFObjectWriter::writeObject(Module& pModule,
       return make_error_code(errc::not_supported);
   }
 
+  pool.wait();
+  std::vector<EmitTask*>::iterator task, tEnd = tasks.end();
+  for (task = tasks.begin(); task != tEnd; ++task)
+    delete *task;
+
   pOutput.clear();
   return llvm::make_error_code(llvm::errc::success);
 }
 
+/// enqueueSection - split the data of pSection into the ranges of fragments
+/// and enqueue a task for each range
+void ELFObjectWriter::enqueueSection(ThreadPool& pPool,
+                                     MemoryArea& pOutput,
+                                     const LDSection& pSection,
+                                     std::vector<EmitTask*>& pTasks)
+{
+  const SectionData* sd = GetSectionData(pSection);
+  if (NULL == sd || 0 == pSection.size())
+    return;
+
+  MemoryRegion* region = pOutput.request(pSection.offset(), pSection.size());
+  if (NULL == region) {
+    llvm::report_fatal_error(llvm::Twine("cannot get enough memory region for output section `") +
+                             llvm::Twine(pSection.name()) +
+                             llvm::Twine("'.\n"));
+  }
+
+  bool is_little_endian = m_Config.targets().isLittleEndian();
+  SectionData::const_iterator begin = sd->begin(), frag, fragEnd = sd->end();
+  size_t begin_offset = 0, offset = 0;
+  for (frag = sd->begin(); frag != fragEnd; ++frag) {
+    offset += frag->size();
+    if (offset - begin_offset >= EmitChunkSize) {
+      SectionData::const_iterator end = frag;
+      ++end;
+      pTasks.push_back(new EmitTask(begin, end, *region, begin_offset,
+                                    target(), is_little_endian));
+      pPool.enqueue(*pTasks.back());
+      begin = end;
+      begin_offset = offset;
+    }
+  }
+
+  if (begin != fragEnd) {
+    pTasks.push_back(new EmitTask(begin, fragEnd, *region, begin_offset,
+                                  target(), is_little_endian));
+    pPool.enqueue(*pTasks.back());
+  }
+}
+
 // writeELFHeader - emit ElfXX_Ehdr
 template<size_t SIZE>
 void ELFObjectWriter::writeELFHeader(const LinkerConfig& pConfig,
@@ -381,8 +637,9 @@ ELFObjectWriter::emitSectionData(const LDSection& pSection,
       return;
     case LDFileFormat::EhFrame:
       assert(pSection.hasEhFrame());
-      sd = &pSection.getEhFrame()->getSectionData();
-      break;
+      emitSectionData(pSection.getEhFrame()->getSectionData(), pRegion);
+      emitCIEPointers(*pSection.getEhFrame(), pRegion);
+      return;
     default:
       assert(pSection.hasSectionData());
       sd = pSection.getSectionData();
@@ -391,6 +648,27 @@ ELFObjectWriter::emitSectionData(const LDSection& pSection,
   emitSectionData(*sd, pRegion);
 }
 
+/// emitCIEPointers - the CIE Pointer of an FDE is the distance from the field
+/// to its CIE. EhFrameOptimizer removes CIEs and FDEs, and points FDEs at the
+/// CIEs of the other inputs, so the fields are computed by the output offsets.
+void ELFObjectWriter::emitCIEPointers(const EhFrame& pEhFrame,
+                                      MemoryRegion& pRegion) const
+{
+  bool is_little_endian = m_Config.targets().isLittleEndian();
+  EhFrame::const_fde_iterator fde, fdeEnd = pEhFrame.fde_end();
+  for (fde = pEhFrame.fde_begin(); fde != fdeEnd; ++fde) {
+    uint64_t field = (*fde)->getOffset() + (*fde)->getCIEPointerOffset();
+    assert((*fde)->getCIE().getOffset() < field);
+    uint32_t value = field - (*fde)->getCIE().getOffset();
+
+    uint8_t* data = pRegion.getBuffer(field);
+    for (unsigned int i = 0; i < 4; ++i) {
+      unsigned int shift = is_little_endian ? i : (3 - i);
+      data[i] = static_cast<uint8_t>(value >> (shift * 8));
+    }
+  }
+}
+
 /// emitRelocation
 void ELFObjectWriter::emitRelocation(const LinkerConfig& pConfig,
                                      const LDSection& pSection,
@@ -593,71 +871,19 @@ uint64_t ELFObjectWriter::getLastStartOffset<64>(const Module& pModule) const
   return Align<64>(lastSect->offset() + lastSect->size());
 }
 
+/// getOutputSize - the section header table is at the end of the output
+template<size_t SIZE>
+uint64_t ELFObjectWriter::getOutputSize(const Module& pModule) const
+{
+  typedef typename ELFSizeTraits<SIZE>::Shdr ElfXX_Shdr;
+  return getLastStartOffset<SIZE>(pModule) +
+         sizeof(ElfXX_Shdr) * pModule.size();
+}
+
 /// emitSectionData
 void ELFObjectWriter::emitSectionData(const SectionData& pSD,
                                       MemoryRegion& pRegion) const
 {
-  SectionData::const_iterator fragIter, fragEnd = pSD.end();
-  size_t cur_offset = 0;
-  for (fragIter = pSD.begin(); fragIter != fragEnd; ++fragIter) {
-    size_t size = fragIter->size();
-    switch(fragIter->getKind()) {
-      case Fragment::Region: {
-        const RegionFragment& region_frag = llvm::cast<RegionFragment>(*fragIter);
-        const uint8_t* from = region_frag.getRegion().start();
-        memcpy(pRegion.getBuffer(cur_offset), from, size);
-        break;
-      }
-      case Fragment::Alignment: {
-        // TODO: emit values with different sizes (> 1 byte), and emit nops
-        const AlignFragment& align_frag = llvm::cast<AlignFragment>(*fragIter);
-        uint64_t count = size / align_frag.getValueSize();
-        switch (align_frag.getValueSize()) {
-          case 1u:
-            std::memset(pRegion.getBuffer(cur_offset),
-                        align_frag.getValue(),
-                        count);
-            break;
-          default:
-            llvm::report_fatal_error("unsupported value size for align fragment emission yet.\n");
-            break;
-        }
-        break;
-      }
-      case Fragment::Fillment: {
-        const FillFragment& fill_frag = llvm::cast<FillFragment>(*fragIter);
-        if (0 == size ||
-            0 == fill_frag.getValueSize() ||
-            0 == fill_frag.size()) {
-          // ignore virtual fillment
-          break;
-        }
-
-        uint64_t num_tiles = fill_frag.size() / fill_frag.getValueSize();
-        for (uint64_t i = 0; i != num_tiles; ++i) {
-          std::memset(pRegion.getBuffer(cur_offset),
-                      fill_frag.getValue(),
-                      fill_frag.getValueSize());
-        }
-        break;
-      }
-      case Fragment::Stub: {
-        const Stub& stub_frag = llvm::cast<Stub>(*fragIter);
-        memcpy(pRegion.getBuffer(cur_offset), stub_frag.getContent(), size);
-        break;
-      }
-      case Fragment::Null: {
-        assert(0x0 == size);
-        break;
-      }
-      case Fragment::Target:
-        llvm::report_fatal_error("Target fragment should not be in a regular section.\n");
-        break;
-      default:
-        llvm::report_fatal_error("invalid fragment should not be in a regular section.\n");
-        break;
-    }
-    cur_offset += size;
-  }
+  EmitFragments(pSD.begin(), pSD.end(), pRegion, 0, target(),
+                m_Config.targets().isLittleEndian(), false);
 }
-
@@ -55,8 +55,8 @@ bool ELFReader<32, true>::isELF(void* pELFHeader) const
 bool
 ELFReader<32, true>::readRegularSection(Input& pInput, SectionData& pSD) const
 {
-  uint32_t offset = pInput.fileOffset() + pSD.getSection().offset();
-  uint32_t size = pSD.getSection().size();
+  uint64_t offset = pInput.fileOffset() + pSD.getSection().offset();
+  uint64_t size = pSD.getSection().size();
 
   Fragment* frag = IRBuilder::CreateRegion(pInput, offset, size);
   ObjectBuilder::AppendFragment(*frag, pSD);
@@ -67,90 +67,57 @@ ELFReader<32, true>::readRegularSection(Input& pInput, SectionData& pSD) const
 bool ELFReader<32, true>::readSymbols(Input& pInput,
                                       IRBuilder& pBuilder,
                                       const MemoryRegion& pRegion,
-                                      const char* pStrTab) const
+                                      const char* pStrTab,
+                                      const uint32_t* pShndxTab) const
 {
   // get number of symbols
   size_t entsize = pRegion.size()/sizeof(llvm::ELF::Elf32_Sym);
-  const llvm::ELF::Elf32_Sym* symtab =
-                 reinterpret_cast<const llvm::ELF::Elf32_Sym*>(pRegion.start());
-
-  uint32_t st_name  = 0x0;
-  uint32_t st_value = 0x0;
-  uint32_t st_size  = 0x0;
-  uint8_t  st_info  = 0x0;
-  uint8_t  st_other = 0x0;
-  uint16_t st_shndx = 0x0;
 
   // skip the first NULL symbol
+  pInput.context()->reserveSymbols(entsize);
   pInput.context()->addSymbol(LDSymbol::Null());
 
-  for (size_t idx = 1; idx < entsize; ++idx) {
-    st_info  = symtab[idx].st_info;
-    st_other = symtab[idx].st_other;
-
-    if (llvm::sys::isLittleEndianHost()) {
-      st_name  = symtab[idx].st_name;
-      st_value = symtab[idx].st_value;
-      st_size  = symtab[idx].st_size;
-      st_shndx = symtab[idx].st_shndx;
-    }
-    else {
-      st_name  = mcld::bswap32(symtab[idx].st_name);
-      st_value = mcld::bswap32(symtab[idx].st_value);
-      st_size  = mcld::bswap32(symtab[idx].st_size);
-      st_shndx = mcld::bswap16(symtab[idx].st_shndx);
-    }
-
-    // If the section should not be included, set the st_shndx SHN_UNDEF
-    // - A section in interrelated groups are not included.
-    if (pInput.type() == Input::Object &&
-        st_shndx < llvm::ELF::SHN_LORESERVE &&
-        st_shndx != llvm::ELF::SHN_UNDEF) {
-      if (NULL == pInput.context()->getSection(st_shndx))
-        st_shndx = llvm::ELF::SHN_UNDEF;
-    }
-
-    // get ld_type
-    ResolveInfo::Type ld_type = getSymType(st_info, st_shndx);
-
-    // get ld_desc
-    ResolveInfo::Desc ld_desc = getSymDesc(st_shndx, pInput);
-
-    // get ld_binding
-    ResolveInfo::Binding ld_binding = getSymBinding((st_info >> 4), st_shndx, st_other);
-
-    // get ld_value - ld_value must be section relative.
-    uint64_t ld_value = getSymValue(st_value, st_shndx, pInput);
+  for (size_t idx = 1; idx < entsize; ++idx)
+    ELFReader<32, true>::readSymbol(pInput, pBuilder, pRegion.start(), pStrTab,
+                                   pShndxTab, idx);
+  return true;
+}
 
-    // get ld_vis
-    ResolveInfo::Visibility ld_vis = getSymVisibility(st_other);
+/// readSymbol - read the ELF symbol of the given index in symtab and create
+/// LDSymbol
+LDSymbol* ELFReader<32, true>::readSymbol(Input& pInput,
+                                          IRBuilder& pBuilder,
+                                          const void* pSymTab,
+                                          const char* pStrTab,
+                                          const uint32_t* pShndxTab,
+                                          size_t pSymIdx) const
+{
+  const llvm::ELF::Elf32_Sym& symbol =
+    reinterpret_cast<const llvm::ELF::Elf32_Sym*>(pSymTab)[pSymIdx];
 
-    // get section
-    LDSection* section = NULL;
-    if (st_shndx < llvm::ELF::SHN_LORESERVE) // including ABS and COMMON
-      section = pInput.context()->getSection(st_shndx);
+  uint32_t st_name  = 0x0;
+  uint32_t st_value = 0x0;
+  uint32_t st_size  = 0x0;
+  uint8_t  st_info  = symbol.st_info;
+  uint8_t  st_other = symbol.st_other;
+  uint16_t st_shndx = 0x0;
 
-    // get ld_name
-    std::string ld_name;
-    if (ResolveInfo::Section == ld_type) {
-      // Section symbol's st_name is the section index.
-      assert(NULL != section && "get a invalid section");
-      ld_name = section->name();
-    }
-    else {
-      ld_name = std::string(pStrTab + st_name);
-    }
+  if (llvm::sys::isLittleEndianHost()) {
+    st_name  = symbol.st_name;
+    st_value = symbol.st_value;
+    st_size  = symbol.st_size;
+    st_shndx = symbol.st_shndx;
+  }
+  else {
+    st_name  = mcld::bswap32(symbol.st_name);
+    st_value = mcld::bswap32(symbol.st_value);
+    st_size  = mcld::bswap32(symbol.st_size);
+    st_shndx = mcld::bswap16(symbol.st_shndx);
+  }
 
-    pBuilder.AddSymbol(pInput,
-                       ld_name,
-                       ld_type,
-                       ld_desc,
-                       ld_binding,
-                       st_size,
-                       ld_value,
-                       section, ld_vis);
-  } // end of for loop
-  return true;
+  ELFInputTables::Symbol sym = { st_name, st_info, st_other, st_shndx,
+                                 st_value, st_size };
+  return addSymbol(pInput, pBuilder, sym, pStrTab, pShndxTab, pSymIdx);
 }
 
 //===----------------------------------------------------------------------===//
@@ -313,6 +280,7 @@ ELFReader<32, true>::readSectionHeaders(Input& pInput, void* pELFHeader) const
   uint32_t sh_link      = 0x0;
   uint32_t sh_info      = 0x0;
   uint32_t sh_addralign = 0x0;
+  uint32_t sh_entsize   = 0x0;
 
   // if shnum and shstrtab overflow, the actual values are in the 1st shdr
   if (shnum == llvm::ELF::SHN_UNDEF || shstrtab == llvm::ELF::SHN_XINDEX) {
@@ -334,8 +302,6 @@ ELFReader<32, true>::readSectionHeaders(Input& pInput, void* pELFHeader) const
       shnum = sh_size;
     if (shstrtab == llvm::ELF::SHN_XINDEX)
       shstrtab = sh_link;
-
-    shoff += shentsize;
   }
 
   shdr_region = pInput.memArea()->request(pInput.fileOffset() + shoff,
@@ -359,9 +325,8 @@ ELFReader<32, true>::readSectionHeaders(Input& pInput, void* pELFHeader) const
   const char* sect_name =
                        reinterpret_cast<const char*>(sect_name_region->start());
 
-  LinkInfoList link_info_list;
-
-  // create all LDSections, including first NULL section.
+  // decode all section headers, including first NULL section.
+  ELFInputTables::SectionList sections(shnum);
   for (size_t idx = 0; idx < shnum; ++idx) {
     if (llvm::sys::isLittleEndianHost()) {
       sh_name      = shdrTab[idx].sh_name;
@@ -372,6 +337,7 @@ ELFReader<32, true>::readSectionHeaders(Input& pInput, void* pELFHeader) const
       sh_link      = shdrTab[idx].sh_link;
       sh_info      = shdrTab[idx].sh_info;
       sh_addralign = shdrTab[idx].sh_addralign;
+      sh_entsize   = shdrTab[idx].sh_entsize;
     }
     else {
       sh_name      = mcld::bswap32(shdrTab[idx].sh_name);
@@ -382,42 +348,25 @@ ELFReader<32, true>::readSectionHeaders(Input& pInput, void* pELFHeader) const
       sh_link      = mcld::bswap32(shdrTab[idx].sh_link);
       sh_info      = mcld::bswap32(shdrTab[idx].sh_info);
       sh_addralign = mcld::bswap32(shdrTab[idx].sh_addralign);
-    }
-
-    LDSection* section = IRBuilder::CreateELFHeader(pInput,
-                                                    sect_name+sh_name,
-                                                    sh_type,
-                                                    sh_flags,
-                                                    sh_addralign);
-    section->setSize(sh_size);
-    section->setOffset(sh_offset);
-    section->setInfo(sh_info);
-
-    if (sh_link != 0x0 || sh_info != 0x0) {
-      LinkInfo link_info = { section, sh_link, sh_info };
-      link_info_list.push_back(link_info);
-    }
+      sh_entsize   = mcld::bswap32(shdrTab[idx].sh_entsize);
+    }
+
+    ELFInputTables::Section& section = sections[idx];
+    section.name         = sect_name + sh_name;
+    section.sh_type      = sh_type;
+    section.sh_flags     = sh_flags;
+    section.sh_offset    = sh_offset;
+    section.sh_size      = sh_size;
+    section.sh_link      = sh_link;
+    section.sh_info      = sh_info;
+    section.sh_addralign = sh_addralign;
+    section.sh_entsize   = sh_entsize;
   } // end of for
 
-  // set up InfoLink
-  LinkInfoList::iterator info, infoEnd = link_info_list.end();
-  for (info = link_info_list.begin(); info != infoEnd; ++info) {
-    if (LDFileFormat::NamePool == info->section->kind() ||
-        LDFileFormat::Group == info->section->kind() ||
-        LDFileFormat::Note == info->section->kind()) {
-      info->section->setLink(pInput.context()->getSection(info->sh_link));
-      continue;
-    }
-    if (LDFileFormat::Relocation == info->section->kind()) {
-      info->section->setLink(pInput.context()->getSection(info->sh_info));
-      continue;
-    }
-  }
-
   pInput.memArea()->release(shdr_region);
   pInput.memArea()->release(sect_name_region);
 
-  return true;
+  return createSections(pInput, sections);
 }
 
 /// readSignature - read a symbol from the given Input and index in symtab
@@ -430,7 +379,7 @@ ResolveInfo* ELFReader<32, true>::readSignature(Input& pInput,
   LDSection* strtab = symtab->getLink();
   assert(NULL != symtab && NULL != strtab);
 
-  uint32_t offset = pInput.fileOffset() + symtab->offset() +
+  uint64_t offset = pInput.fileOffset() + symtab->offset() +
                       sizeof(llvm::ELF::Elf32_Sym) * pSymIdx;
   MemoryRegion* symbol_region =
                 pInput.memArea()->request(offset, sizeof(llvm::ELF::Elf32_Sym));
@@ -452,6 +401,23 @@ ResolveInfo* ELFReader<32, true>::readSignature(Input& pInput,
     st_shndx = mcld::bswap16(entry->st_shndx);
   }
 
+  // get section. If st_shndx is SHN_XINDEX, the section index is in the
+  // SHT_SYMTAB_SHNDX section.
+  LDSection* section = NULL;
+  if (st_shndx < llvm::ELF::SHN_LORESERVE)
+    section = pInput.context()->getSection(st_shndx);
+  else if (st_shndx == llvm::ELF::SHN_XINDEX) {
+    LDSection* shndx = getSymTabShndx(pInput, pSymTab);
+    if (NULL != shndx) {
+      MemoryRegion* shndx_region = pInput.memArea()->request(
+          pInput.fileOffset() + shndx->offset() + sizeof(uint32_t) * pSymIdx,
+          sizeof(uint32_t));
+      section = pInput.context()->getSection(getExtendedShndx(
+                reinterpret_cast<const uint32_t*>(shndx_region->start()), 0));
+      pInput.memArea()->release(shndx_region);
+    }
+  }
+
   MemoryRegion* strtab_region = pInput.memArea()->request(
                        pInput.fileOffset() + strtab->offset(), strtab->size());
 
@@ -462,7 +428,7 @@ ResolveInfo* ELFReader<32, true>::readSignature(Input& pInput,
   ResolveInfo* result = ResolveInfo::Create(ld_name);
   result->setSource(pInput.type() == Input::DynObj);
   result->setType(static_cast<ResolveInfo::Type>(st_info & 0xF));
-  result->setDesc(getSymDesc(st_shndx, pInput));
+  result->setDesc(getSymDesc(st_shndx, section));
   result->setBinding(getSymBinding((st_info >> 4), st_shndx, st_other));
   result->setVisibility(getSymVisibility(st_other));
 
@@ -576,90 +542,57 @@ ELFReader<64, true>::readRegularSection(Input& pInput, SectionData& pSD) const
 bool ELFReader<64, true>::readSymbols(Input& pInput,
                                       IRBuilder& pBuilder,
                                       const MemoryRegion& pRegion,
-                                      const char* pStrTab) const
+                                      const char* pStrTab,
+                                      const uint32_t* pShndxTab) const
 {
   // get number of symbols
   size_t entsize = pRegion.size()/sizeof(llvm::ELF::Elf64_Sym);
-  const llvm::ELF::Elf64_Sym* symtab =
-                 reinterpret_cast<const llvm::ELF::Elf64_Sym*>(pRegion.start());
-
-  uint32_t st_name  = 0x0;
-  uint64_t st_value = 0x0;
-  uint64_t st_size  = 0x0;
-  uint8_t  st_info  = 0x0;
-  uint8_t  st_other = 0x0;
-  uint16_t st_shndx = 0x0;
 
   // skip the first NULL symbol
+  pInput.context()->reserveSymbols(entsize);
   pInput.context()->addSymbol(LDSymbol::Null());
 
-  for (size_t idx = 1; idx < entsize; ++idx) {
-    st_info  = symtab[idx].st_info;
-    st_other = symtab[idx].st_other;
-
-    if (llvm::sys::isLittleEndianHost()) {
-      st_name  = symtab[idx].st_name;
-      st_value = symtab[idx].st_value;
-      st_size  = symtab[idx].st_size;
-      st_shndx = symtab[idx].st_shndx;
-    }
-    else {
-      st_name  = mcld::bswap32(symtab[idx].st_name);
-      st_value = mcld::bswap64(symtab[idx].st_value);
-      st_size  = mcld::bswap64(symtab[idx].st_size);
-      st_shndx = mcld::bswap16(symtab[idx].st_shndx);
-    }
-
-    // If the section should not be included, set the st_shndx SHN_UNDEF
-    // - A section in interrelated groups are not included.
-    if (pInput.type() == Input::Object &&
-        st_shndx < llvm::ELF::SHN_LORESERVE &&
-        st_shndx != llvm::ELF::SHN_UNDEF) {
-      if (NULL == pInput.context()->getSection(st_shndx))
-        st_shndx = llvm::ELF::SHN_UNDEF;
-    }
-
-    // get ld_type
-    ResolveInfo::Type ld_type = getSymType(st_info, st_shndx);
-
-    // get ld_desc
-    ResolveInfo::Desc ld_desc = getSymDesc(st_shndx, pInput);
-
-    // get ld_binding
-    ResolveInfo::Binding ld_binding = getSymBinding((st_info >> 4), st_shndx, st_other);
-
-    // get ld_value - ld_value must be section relative.
-    uint64_t ld_value = getSymValue(st_value, st_shndx, pInput);
+  for (size_t idx = 1; idx < entsize; ++idx)
+    ELFReader<64, true>::readSymbol(pInput, pBuilder, pRegion.start(), pStrTab,
+                                   pShndxTab, idx);
+  return true;
+}
 
-    // get ld_vis
-    ResolveInfo::Visibility ld_vis = getSymVisibility(st_other);
+/// readSymbol - read the ELF symbol of the given index in symtab and create
+/// LDSymbol
+LDSymbol* ELFReader<64, true>::readSymbol(Input& pInput,
+                                          IRBuilder& pBuilder,
+                                          const void* pSymTab,
+                                          const char* pStrTab,
+                                          const uint32_t* pShndxTab,
+                                          size_t pSymIdx) const
+{
+  const llvm::ELF::Elf64_Sym& symbol =
+    reinterpret_cast<const llvm::ELF::Elf64_Sym*>(pSymTab)[pSymIdx];
 
-    // get section
-    LDSection* section = NULL;
-    if (st_shndx < llvm::ELF::SHN_LORESERVE) // including ABS and COMMON
-      section = pInput.context()->getSection(st_shndx);
+  uint32_t st_name  = 0x0;
+  uint64_t st_value = 0x0;
+  uint64_t st_size  = 0x0;
+  uint8_t  st_info  = symbol.st_info;
+  uint8_t  st_other = symbol.st_other;
+  uint16_t st_shndx = 0x0;
 
-    // get ld_name
-    std::string ld_name;
-    if (ResolveInfo::Section == ld_type) {
-      // Section symbol's st_name is the section index.
-      assert(NULL != section && "get a invalid section");
-      ld_name = section->name();
-    }
-    else {
-      ld_name = std::string(pStrTab + st_name);
-    }
+  if (llvm::sys::isLittleEndianHost()) {
+    st_name  = symbol.st_name;
+    st_value = symbol.st_value;
+    st_size  = symbol.st_size;
+    st_shndx = symbol.st_shndx;
+  }
+  else {
+    st_name  = mcld::bswap32(symbol.st_name);
+    st_value = mcld::bswap64(symbol.st_value);
+    st_size  = mcld::bswap64(symbol.st_size);
+    st_shndx = mcld::bswap16(symbol.st_shndx);
+  }
 
-    pBuilder.AddSymbol(pInput,
-                       ld_name,
-                       ld_type,
-                       ld_desc,
-                       ld_binding,
-                       st_size,
-                       ld_value,
-                       section, ld_vis);
-  } // end of for loop
-  return true;
+  ELFInputTables::Symbol sym = { st_name, st_info, st_other, st_shndx,
+                                 st_value, st_size };
+  return addSymbol(pInput, pBuilder, sym, pStrTab, pShndxTab, pSymIdx);
 }
 
 //===----------------------------------------------------------------------===//
@@ -822,6 +755,7 @@ ELFReader<64, true>::readSectionHeaders(Input& pInput, void* pELFHeader) const
   uint32_t sh_link      = 0x0;
   uint32_t sh_info      = 0x0;
   uint64_t sh_addralign = 0x0;
+  uint64_t sh_entsize   = 0x0;
 
   // if shnum and shstrtab overflow, the actual values are in the 1st shdr
   if (shnum == llvm::ELF::SHN_UNDEF || shstrtab == llvm::ELF::SHN_XINDEX) {
@@ -843,8 +777,6 @@ ELFReader<64, true>::readSectionHeaders(Input& pInput, void* pELFHeader) const
       shnum = sh_size;
     if (shstrtab == llvm::ELF::SHN_XINDEX)
       shstrtab = sh_link;
-
-    shoff += shentsize;
   }
 
   shdr_region = pInput.memArea()->request(pInput.fileOffset() + shoff,
@@ -868,9 +800,8 @@ ELFReader<64, true>::readSectionHeaders(Input& pInput, void* pELFHeader) const
   const char* sect_name =
                        reinterpret_cast<const char*>(sect_name_region->start());
 
-  LinkInfoList link_info_list;
-
-  // create all LDSections, including first NULL section.
+  // decode all section headers, including first NULL section.
+  ELFInputTables::SectionList sections(shnum);
   for (size_t idx = 0; idx < shnum; ++idx) {
     if (llvm::sys::isLittleEndianHost()) {
       sh_name      = shdrTab[idx].sh_name;
@@ -881,6 +812,7 @@ ELFReader<64, true>::readSectionHeaders(Input& pInput, void* pELFHeader) const
       sh_link      = shdrTab[idx].sh_link;
       sh_info      = shdrTab[idx].sh_info;
       sh_addralign = shdrTab[idx].sh_addralign;
+      sh_entsize   = shdrTab[idx].sh_entsize;
     }
     else {
       sh_name      = mcld::bswap32(shdrTab[idx].sh_name);
@@ -891,42 +823,25 @@ ELFReader<64, true>::readSectionHeaders(Input& pInput, void* pELFHeader) const
       sh_link      = mcld::bswap32(shdrTab[idx].sh_link);
       sh_info      = mcld::bswap32(shdrTab[idx].sh_info);
       sh_addralign = mcld::bswap64(shdrTab[idx].sh_addralign);
-    }
-
-    LDSection* section = IRBuilder::CreateELFHeader(pInput,
-                                                    sect_name+sh_name,
-                                                    sh_type,
-                                                    sh_flags,
-                                                    sh_addralign);
-    section->setSize(sh_size);
-    section->setOffset(sh_offset);
-    section->setInfo(sh_info);
-
-    if (sh_link != 0x0 || sh_info != 0x0) {
-      LinkInfo link_info = { section, sh_link, sh_info };
-      link_info_list.push_back(link_info);
-    }
+      sh_entsize   = mcld::bswap64(shdrTab[idx].sh_entsize);
+    }
+
+    ELFInputTables::Section& section = sections[idx];
+    section.name         = sect_name + sh_name;
+    section.sh_type      = sh_type;
+    section.sh_flags     = sh_flags;
+    section.sh_offset    = sh_offset;
+    section.sh_size      = sh_size;
+    section.sh_link      = sh_link;
+    section.sh_info      = sh_info;
+    section.sh_addralign = sh_addralign;
+    section.sh_entsize   = sh_entsize;
   } // end of for
 
-  // set up InfoLink
-  LinkInfoList::iterator info, infoEnd = link_info_list.end();
-  for (info = link_info_list.begin(); info != infoEnd; ++info) {
-    if (LDFileFormat::NamePool == info->section->kind() ||
-        LDFileFormat::Group == info->section->kind() ||
-        LDFileFormat::Note == info->section->kind()) {
-      info->section->setLink(pInput.context()->getSection(info->sh_link));
-      continue;
-    }
-    if (LDFileFormat::Relocation == info->section->kind()) {
-      info->section->setLink(pInput.context()->getSection(info->sh_info));
-      continue;
-    }
-  }
-
   pInput.memArea()->release(shdr_region);
   pInput.memArea()->release(sect_name_region);
 
-  return true;
+  return createSections(pInput, sections);
 }
 
 /// readSignature - read a symbol from the given Input and index in symtab
@@ -961,6 +876,23 @@ ResolveInfo* ELFReader<64, true>::readSignature(Input& pInput,
     st_shndx = mcld::bswap16(entry->st_shndx);
   }
 
+  // get section. If st_shndx is SHN_XINDEX, the section index is in the
+  // SHT_SYMTAB_SHNDX section.
+  LDSection* section = NULL;
+  if (st_shndx < llvm::ELF::SHN_LORESERVE)
+    section = pInput.context()->getSection(st_shndx);
+  else if (st_shndx == llvm::ELF::SHN_XINDEX) {
+    LDSection* shndx = getSymTabShndx(pInput, pSymTab);
+    if (NULL != shndx) {
+      MemoryRegion* shndx_region = pInput.memArea()->request(
+          pInput.fileOffset() + shndx->offset() + sizeof(uint32_t) * pSymIdx,
+          sizeof(uint32_t));
+      section = pInput.context()->getSection(getExtendedShndx(
+                reinterpret_cast<const uint32_t*>(shndx_region->start()), 0));
+      pInput.memArea()->release(shndx_region);
+    }
+  }
+
   MemoryRegion* strtab_region = pInput.memArea()->request(
                        pInput.fileOffset() + strtab->offset(), strtab->size());
 
@@ -971,7 +903,7 @@ ResolveInfo* ELFReader<64, true>::readSignature(Input& pInput,
   ResolveInfo* result = ResolveInfo::Create(ld_name);
   result->setSource(pInput.type() == Input::DynObj);
   result->setType(static_cast<ResolveInfo::Type>(st_info & 0xF));
-  result->setDesc(getSymDesc(st_shndx, pInput));
+  result->setDesc(getSymDesc(st_shndx, section));
   result->setBinding(getSymBinding((st_info >> 4), st_shndx, st_other));
   result->setVisibility(getSymVisibility(st_other));
 
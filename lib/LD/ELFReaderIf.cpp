@@ -9,6 +9,7 @@
 #include <mcld/LD/ELFReaderIf.h>
 
 #include <mcld/IRBuilder.h>
+#include <mcld/ADT/SizeTraits.h>
 #include <mcld/Fragment/FillFragment.h>
 #include <mcld/LD/EhFrame.h>
 #include <mcld/LD/SectionData.h>
@@ -45,18 +46,19 @@ ResolveInfo::Type ELFReaderIF::getSymType(uint8_t pInfo, uint16_t pShndx) const
   return result;
 }
 
-/// getSymDesc
-ResolveInfo::Desc ELFReaderIF::getSymDesc(uint16_t pShndx, const Input& pInput) const
+/// getSymDesc - pSection is the section of the symbol if its st_shndx is a
+/// regular index or SHN_XINDEX.
+ResolveInfo::Desc ELFReaderIF::getSymDesc(uint16_t pShndx,
+                                          const LDSection* pSection) const
 {
   if (pShndx == llvm::ELF::SHN_UNDEF)
     return ResolveInfo::Undefined;
 
-  if (pShndx < llvm::ELF::SHN_LORESERVE) {
+  if (pShndx < llvm::ELF::SHN_LORESERVE || pShndx == llvm::ELF::SHN_XINDEX) {
     // an ELF symbol defined in a section which we are not including
     // must be treated as an Undefined.
     // @ref Google gold linker: symtab.cc: 1086
-    if (NULL == pInput.context()->getSection(pShndx) ||
-        LDFileFormat::Ignore == pInput.context()->getSection(pShndx)->kind())
+    if (NULL == pSection || LDFileFormat::Ignore == pSection->kind())
       return ResolveInfo::Undefined;
     return ResolveInfo::Define;
   }
@@ -75,6 +77,15 @@ ResolveInfo::Desc ELFReaderIF::getSymDesc(uint16_t pShndx, const Input& pInput)
   return ResolveInfo::NoneDesc;
 }
 
+/// getExtendedShndx
+uint32_t ELFReaderIF::getExtendedShndx(const uint32_t* pShndxTab,
+                                       size_t pSymIdx) const
+{
+  if (llvm::sys::isLittleEndianHost())
+    return pShndxTab[pSymIdx];
+  return mcld::bswap32(pShndxTab[pSymIdx]);
+}
+
 /// getSymBinding
 ResolveInfo::Binding
 ELFReaderIF::getSymBinding(uint8_t pBinding, uint16_t pShndx, uint8_t pVis) const
@@ -162,3 +173,140 @@ uint64_t ELFReaderIF::getSymValue(uint64_t pValue,
   return 0x0;
 }
 
+
+/// getSymTabShndx - get the SHT_SYMTAB_SHNDX section of the symbol table
+LDSection* ELFReaderIF::getSymTabShndx(Input& pInput,
+                                       const LDSection& pSymTab) const
+{
+  LDContext::sect_iterator sect, sectEnd = pInput.context()->sectEnd();
+  for (sect = pInput.context()->sectBegin(); sect != sectEnd; ++sect) {
+    if (llvm::ELF::SHT_SYMTAB_SHNDX == (*sect)->type() &&
+        &pSymTab == (*sect)->getLink())
+      return *sect;
+  }
+  return NULL;
+}
+
+/// createSections - create LDSections from the decoded section headers
+bool
+ELFReaderIF::createSections(Input& pInput,
+                            const ELFInputTables::SectionList& pSections) const
+{
+  LinkInfoList link_info_list;
+
+  // create all LDSections, including first NULL section.
+  ELFInputTables::SectionList::const_iterator shdr, shdrEnd = pSections.end();
+  for (shdr = pSections.begin(); shdr != shdrEnd; ++shdr) {
+    LDSection* section = IRBuilder::CreateELFHeader(pInput,
+                                                    shdr->name,
+                                                    shdr->sh_type,
+                                                    shdr->sh_flags,
+                                                    shdr->sh_addralign);
+    section->setSize(shdr->sh_size);
+    section->setOffset(shdr->sh_offset);
+    section->setInfo(shdr->sh_info);
+    section->setEntSize(shdr->sh_entsize);
+
+    if (shdr->sh_link != 0x0 || shdr->sh_info != 0x0) {
+      LinkInfo link_info = { section, shdr->sh_link, shdr->sh_info };
+      link_info_list.push_back(link_info);
+    }
+  } // end of for
+
+  // set up InfoLink
+  LinkInfoList::iterator info, infoEnd = link_info_list.end();
+  for (info = link_info_list.begin(); info != infoEnd; ++info) {
+    if (LDFileFormat::NamePool == info->section->kind() ||
+        LDFileFormat::Group == info->section->kind() ||
+        LDFileFormat::Note == info->section->kind()) {
+      info->section->setLink(pInput.context()->getSection(info->sh_link));
+      continue;
+    }
+    if (LDFileFormat::Relocation == info->section->kind()) {
+      info->section->setLink(pInput.context()->getSection(info->sh_info));
+      continue;
+    }
+  }
+  return true;
+}
+
+/// addSymbols - create LDSymbols from the decoded symbols
+bool ELFReaderIF::addSymbols(Input& pInput,
+                             IRBuilder& pBuilder,
+                             const ELFInputTables::SymbolList& pSymbols,
+                             const char* pStrTab,
+                             const uint32_t* pShndxTab) const
+{
+  // skip the first NULL symbol
+  pInput.context()->reserveSymbols(pSymbols.size());
+  pInput.context()->addSymbol(LDSymbol::Null());
+
+  for (size_t idx = 1; idx < pSymbols.size(); ++idx)
+    addSymbol(pInput, pBuilder, pSymbols[idx], pStrTab, pShndxTab, idx);
+  return true;
+}
+
+/// addSymbol - create the LDSymbol of the decoded symbol of the given index
+LDSymbol* ELFReaderIF::addSymbol(Input& pInput,
+                                 IRBuilder& pBuilder,
+                                 const ELFInputTables::Symbol& pSymbol,
+                                 const char* pStrTab,
+                                 const uint32_t* pShndxTab,
+                                 size_t pSymIdx) const
+{
+  uint16_t st_shndx = pSymbol.st_shndx;
+
+  // get section. If st_shndx is SHN_XINDEX, the section index is in the
+  // SHT_SYMTAB_SHNDX section.
+  LDSection* section = NULL;
+  if (st_shndx < llvm::ELF::SHN_LORESERVE)
+    section = pInput.context()->getSection(st_shndx);
+  else if (st_shndx == llvm::ELF::SHN_XINDEX && NULL != pShndxTab)
+    section = pInput.context()->getSection(
+                                    getExtendedShndx(pShndxTab, pSymIdx));
+
+  // If the section should not be included, set the st_shndx SHN_UNDEF
+  // - A section in interrelated groups are not included.
+  if (pInput.type() == Input::Object &&
+      NULL == section &&
+      (st_shndx < llvm::ELF::SHN_LORESERVE ||
+       st_shndx == llvm::ELF::SHN_XINDEX))
+    st_shndx = llvm::ELF::SHN_UNDEF;
+
+  // get ld_type
+  ResolveInfo::Type ld_type = getSymType(pSymbol.st_info, st_shndx);
+
+  // get ld_desc
+  ResolveInfo::Desc ld_desc = getSymDesc(st_shndx, section);
+
+  // get ld_binding
+  ResolveInfo::Binding ld_binding =
+    getSymBinding((pSymbol.st_info >> 4), st_shndx, pSymbol.st_other);
+
+  // get ld_value - ld_value must be section relative.
+  uint64_t ld_value = getSymValue(pSymbol.st_value, st_shndx, pInput);
+
+  // get ld_vis
+  ResolveInfo::Visibility ld_vis = getSymVisibility(pSymbol.st_other);
+
+  // get ld_name. The name points into the string table, so IRBuilder need
+  // not copy it if the input is mapped as a whole.
+  llvm::StringRef ld_name;
+  if (ResolveInfo::Section == ld_type) {
+    // Section symbol's st_name is the section index.
+    assert(NULL != section && "get a invalid section");
+    ld_name = section->name();
+  }
+  else {
+    ld_name = llvm::StringRef(pStrTab + pSymbol.st_name);
+  }
+
+  return pBuilder.AddSymbol(pInput,
+                            ld_name,
+                            ld_type,
+                            ld_desc,
+                            ld_binding,
+                            pSymbol.st_size,
+                            ld_value,
+                            section, ld_vis);
+}
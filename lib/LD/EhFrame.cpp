@@ -11,16 +11,10 @@
 #include <mcld/LD/SectionData.h>
 #include <mcld/Object/ObjectBuilder.h>
 #include <mcld/Support/MemoryRegion.h>
-#include <mcld/Support/GCFactory.h>
-
-#include <llvm/Support/ManagedStatic.h>
+#include <mcld/LinkContext.h>
 
 using namespace mcld;
 
-typedef GCFactory<EhFrame, MCLD_SECTIONS_PER_INPUT> EhFrameFactory;
-
-static llvm::ManagedStatic<EhFrameFactory> g_EhFrameFactory;
-
 //===----------------------------------------------------------------------===//
 // EhFrame::CIE
 //===----------------------------------------------------------------------===//
@@ -35,7 +29,7 @@ EhFrame::FDE::FDE(MemoryRegion& pRegion,
                   const EhFrame::CIE& pCIE,
                   uint32_t pDataStart)
   : RegionFragment(pRegion),
-    m_CIE(pCIE),
+    m_pCIE(&pCIE),
     m_DataStart(pDataStart) {
 }
 
@@ -43,12 +37,13 @@ EhFrame::FDE::FDE(MemoryRegion& pRegion,
 // EhFrame
 //===----------------------------------------------------------------------===//
 EhFrame::EhFrame()
-  : m_pSection(NULL), m_pSectionData(NULL) {
+  : m_pSection(NULL), m_pSectionData(NULL), m_bUnparsed(false) {
 }
 
 EhFrame::EhFrame(LDSection& pSection)
   : m_pSection(&pSection),
-    m_pSectionData(NULL) {
+    m_pSectionData(NULL),
+    m_bUnparsed(false) {
   m_pSectionData = SectionData::Create(pSection);
 }
 
@@ -60,7 +55,7 @@ EhFrame::~EhFrame()
 
 EhFrame* EhFrame::Create(LDSection& pSection)
 {
-  EhFrame* result = g_EhFrameFactory->allocate();
+  EhFrame* result = LinkContext::current().getEhFrameFactory().allocate();
   new (result) EhFrame(pSection);
   return result;
 }
@@ -68,13 +63,13 @@ EhFrame* EhFrame::Create(LDSection& pSection)
 void EhFrame::Destroy(EhFrame*& pSection)
 {
   pSection->~EhFrame();
-  g_EhFrameFactory->deallocate(pSection);
+  LinkContext::current().getEhFrameFactory().deallocate(pSection);
   pSection = NULL;
 }
 
 void EhFrame::Clear()
 {
-  g_EhFrameFactory->clear();
+  LinkContext::current().getEhFrameFactory().clear();
 }
 
 const LDSection& EhFrame::getSection() const
@@ -111,6 +106,19 @@ void EhFrame::addFDE(EhFrame::FDE& pFDE)
   addFragment(pFDE);
 }
 
+void EhFrame::removeFragment(RegionFragment& pFrag)
+{
+  SectionData::iterator frag(&pFrag);
+  m_pSectionData->getFragmentList().remove(frag);
+}
+
+void EhFrame::clear()
+{
+  m_CIEs.clear();
+  m_FDEs.clear();
+  m_pSectionData->getFragmentList().clear();
+}
+
 EhFrame& EhFrame::merge(EhFrame& pOther)
 {
   ObjectBuilder::MoveSectionData(pOther.getSectionData(), *m_pSectionData);
@@ -123,6 +131,9 @@ EhFrame& EhFrame::merge(EhFrame& pOther)
   for (fde_iterator fde = pOther.fde_begin(); fde != pOther.fde_end(); ++fde)
     m_FDEs.push_back(*fde);
 
+  if (pOther.isUnparsed())
+    m_bUnparsed = true;
+
   pOther.m_CIEs.clear();
   pOther.m_FDEs.clear();
   return *this;
@@ -12,12 +12,14 @@
 #include <mcld/Support/MemoryRegion.h>
 #include <mcld/LD/EhFrame.h>
 #include <mcld/LD/LDSection.h>
+#include <mcld/Support/ThreadPool.h>
 
 #include <llvm/Support/Dwarf.h>
 #include <llvm/Support/DataTypes.h>
 
 #include <algorithm>
 #include <cstring>
+#include <vector>
 
 using namespace mcld;
 using namespace llvm::dwarf;
@@ -25,104 +27,165 @@ using namespace llvm::dwarf;
 //===----------------------------------------------------------------------===//
 // Helper Function
 //===----------------------------------------------------------------------===//
-namespace bit32 {
+namespace {
 
-typedef std::pair<SizeTraits<32>::Address, SizeTraits<32>::Address> Entry;
+/// Entry - a row of the binary search table, (initial location, FDE address)
+typedef std::pair<uint64_t, uint64_t> Entry;
 
 bool EntryCompare(const Entry& pX, const Entry& pY)
 { return (pX.first < pY.first); }
 
-} // bit32 namespace
-
-//===----------------------------------------------------------------------===//
-// Template Specification Functions
-//===----------------------------------------------------------------------===//
-/// emitOutput<32> - write out eh_frame_hdr
-template<>
-void EhFrameHdr::emitOutput<32>(MemoryArea& pOutput)
+/// PCBegin - get the address of FDE's pc. The field is in the byte order of
+/// the host, which is the one of the target.
+/// @ref binutils gold: ehframe.cc:222
+/// @return false if the encoding is not supported, and then the table is
+/// omitted
+template<size_t SIZE>
+bool PCBegin(const EhFrame::FDE& pFDE,
+             const uint8_t* pEhFrame,
+             uint64_t pEhFrameAddr,
+             uint64_t& pPC)
 {
-  MemoryRegion* ehframehdr_region =
-    pOutput.request(m_EhFrameHdr.offset(), m_EhFrameHdr.size());
-
-  MemoryRegion* ehframe_region =
-    pOutput.request(m_EhFrame.offset(),
-                    m_EhFrame.size());
+  uint8_t fde_encoding = pFDE.getCIE().getFDEEncode();
+  if (DW_EH_PE_omit == fde_encoding ||
+      0x0 != (fde_encoding & DW_EH_PE_indirect))
+    return false;
 
-  uint8_t* data = (uint8_t*)ehframehdr_region->start();
-  // version
-  data[0] = 1;
-  // eh_frame_ptr_enc
-  data[1] = DW_EH_PE_pcrel | DW_EH_PE_sdata4;
+  unsigned int eh_value = fde_encoding & 0x7;
 
-  // eh_frame_ptr
-  uint32_t* eh_frame_ptr = (uint32_t*)(data + 4);
-  *eh_frame_ptr = m_EhFrame.addr() - (m_EhFrameHdr.addr() + 4);
+  // check the size to read in
+  if (eh_value == DW_EH_PE_absptr) {
+    if (32 == SIZE)
+      eh_value = DW_EH_PE_udata4;
+    else
+      eh_value = DW_EH_PE_udata8;
+  }
 
-  // fde_count
-  uint32_t* fde_count = (uint32_t*)(data + 8);
-  if (m_EhFrame.hasEhFrame())
-    *fde_count = 0;
-  else
-    *fde_count = m_EhFrame.getEhFrame()->numOfFDEs();
+  size_t pc_size = 0x0;
+  switch (eh_value) {
+    case DW_EH_PE_udata2:
+      pc_size = 2;
+      break;
+    case DW_EH_PE_udata4:
+      pc_size = 4;
+      break;
+    case DW_EH_PE_udata8:
+      pc_size = 8;
+      break;
+    default:
+      return false;
+  }
 
-  if (0 != *fde_count) {
-    // fde_count_enc
-    data[2] = DW_EH_PE_udata4;
-    // table_enc
-    data[3] = DW_EH_PE_datarel | DW_EH_PE_sdata4;
+  if (pFDE.getDataStart() + pc_size > pFDE.size())
+    return false;
 
+  uint64_t field = pFDE.getOffset() + pFDE.getDataStart();
+  uint64_t pc = 0x0;
+  switch (pc_size) {
+    case 2: {
+      uint16_t value;
+      std::memcpy(&value, pEhFrame + field, 2);
+      pc = value;
+      break;
+    }
+    case 4: {
+      uint32_t value;
+      std::memcpy(&value, pEhFrame + field, 4);
+      pc = value;
+      break;
+    }
+    default:
+      std::memcpy(&pc, pEhFrame + field, 8);
+      break;
   }
-  else {
-    // fde_count_enc
-    data[2] = DW_EH_PE_omit;
-    // table_enc
-    data[3] = DW_EH_PE_omit;
+
+  // adjust the signed value
+  bool is_signed = (fde_encoding & DW_EH_PE_signed) != 0x0;
+  if (is_signed && pc_size < 8) {
+    uint64_t sign = 1ULL << (pc_size * 8 - 1);
+    pc = (pc ^ sign) - sign;
   }
 
-  if (0 != *fde_count) {
+  // handle eh application. The others need the addresses which the linker
+  // does not know, such as the start of the function or the data segment.
+  switch (fde_encoding & 0x70)
+  {
+    case DW_EH_PE_absptr:
+      break;
+    case DW_EH_PE_pcrel:
+      pc += pEhFrameAddr + field;
+      break;
+    default:
+      return false;
+  }
 
-    // prepare the binary search table
-    typedef std::vector<bit32::Entry> SearchTableType;
-    SearchTableType search_table;
-    MemoryRegion* ehframe_region =
-      pOutput.request(m_EhFrame.offset(), m_EhFrame.size());
-    EhFrame::const_fde_iterator fde, fde_end = m_EhFrame.getEhFrame()->fde_end();
-    for(fde = m_EhFrame.getEhFrame()->fde_begin(); fde != fde_end; ++fde) {
-      assert(*fde != NULL);
-      SizeTraits<32>::Offset offset;
-      SizeTraits<32>::Address fde_pc;
-      SizeTraits<32>::Address fde_addr;
-      offset = (*fde)->getOffset();
-      fde_pc = computePCBegin(**fde, *ehframe_region);
-      fde_addr = m_EhFrame.addr() + offset;
-      search_table.push_back(std::make_pair(fde_pc, fde_addr));
-    }
-    pOutput.release(ehframe_region);
+  if (32 == SIZE)
+    pc &= 0xFFFFFFFFULL;
+  pPC = pc;
+  return true;
+}
 
-    std::sort(search_table.begin(), search_table.end(), bit32::EntryCompare);
+/// SortTask - compute the rows of a range of FDEs and sort them
+template<size_t SIZE>
+class SortTask : public ThreadPool::Task
+{
+public:
+  SortTask(EhFrame::const_fde_iterator pBegin,
+           EhFrame::const_fde_iterator pEnd,
+           const uint8_t* pEhFrame,
+           uint64_t pEhFrameAddr,
+           Entry* pRows)
+    : m_Begin(pBegin), m_End(pEnd), m_pEhFrame(pEhFrame),
+      m_EhFrameAddr(pEhFrameAddr), m_pRows(pRows), m_bSupported(true) {
+  }
 
-    // write out the binary search table
-    uint32_t* bst = (uint32_t*)(data + 12);
-    SearchTableType::const_iterator entry, entry_end = search_table.end();
-    size_t id = 0;
-    for (entry = search_table.begin(); entry != entry_end; ++entry) {
-      bst[id++] = (*entry).first - m_EhFrameHdr.addr();
-      bst[id++] = (*entry).second - m_EhFrameHdr.addr();
+  void run()
+  {
+    Entry* row = m_pRows;
+    EhFrame::const_fde_iterator fde;
+    for (fde = m_Begin; fde != m_End; ++fde, ++row) {
+      if (!PCBegin<SIZE>(**fde, m_pEhFrame, m_EhFrameAddr, row->first)) {
+        m_bSupported = false;
+        return;
+      }
+      row->second = m_EhFrameAddr + (*fde)->getOffset();
     }
+    std::sort(m_pRows, row, EntryCompare);
   }
-  pOutput.release(ehframehdr_region);
-  pOutput.release(ehframe_region);
-}
 
-/// emitOutput<64> - write out eh_frame_hdr
-template<>
-void EhFrameHdr::emitOutput<64>(MemoryArea& pOutput)
-{
-}
+  /// isSupported - return false if an FDE has an unsupported encoding
+  bool isSupported() const { return m_bSupported; }
+
+private:
+  EhFrame::const_fde_iterator m_Begin;
+  EhFrame::const_fde_iterator m_End;
+  const uint8_t* m_pEhFrame;
+  uint64_t m_EhFrameAddr;
+  Entry* m_pRows;
+  bool m_bSupported;
+};
+
+/// MinRowsPerTask - a smaller table is sorted by the calling thread
+const size_t MinRowsPerTask = 4096;
+
+} // anonymous namespace
 
 //===----------------------------------------------------------------------===//
 // EhFrameHdr
 //===----------------------------------------------------------------------===//
+template<>
+void EhFrameHdr::emitOutput<32>(MemoryArea& pOutput,
+                                unsigned int pNumOfThreads)
+{
+  emitHeader<32>(pOutput, pNumOfThreads);
+}
+
+template<>
+void EhFrameHdr::emitOutput<64>(MemoryArea& pOutput,
+                                unsigned int pNumOfThreads)
+{
+  emitHeader<64>(pOutput, pNumOfThreads);
+}
 
 EhFrameHdr::EhFrameHdr(LDSection& pEhFrameHdr, const LDSection& pEhFrame)
   : m_EhFrameHdr(pEhFrameHdr), m_EhFrame(pEhFrame) {
@@ -146,65 +209,131 @@ EhFrameHdr::~EhFrameHdr()
 void EhFrameHdr::sizeOutput()
 {
   size_t size = 12;
-  if (m_EhFrame.hasEhFrame())
+  if (hasTable())
     size += 8 * m_EhFrame.getEhFrame()->numOfFDEs();
   m_EhFrameHdr.setSize(size);
 }
 
-/// computePCBegin - return the address of FDE's pc
-/// @ref binutils gold: ehframe.cc:222
-uint32_t EhFrameHdr::computePCBegin(const EhFrame::FDE& pFDE,
-                                    const MemoryRegion& pEhFrameRegion)
+/// hasTable - the FDEs of an unparsed .eh_frame are unknown, and a table
+/// without them makes the unwinders miss their functions
+bool EhFrameHdr::hasTable() const
 {
-  uint8_t fde_encoding = pFDE.getCIE().getFDEEncode();
-  unsigned int eh_value = fde_encoding & 0x7;
+  return (m_EhFrame.hasEhFrame() && !m_EhFrame.getEhFrame()->isUnparsed());
+}
 
-  // check the size to read in
-  if (eh_value == llvm::dwarf::DW_EH_PE_absptr) {
-    eh_value = DW_EH_PE_udata4;
-  }
+/// emitHeader - the table rows are sdata4 offsets from .eh_frame_hdr in both
+/// ELF32 and ELF64. The table is omitted and unwinders search .eh_frame
+/// linearly if an input .eh_frame is not parsed, an FDE encoding is not
+/// supported, or a row does not fit.
+template<size_t SIZE>
+void EhFrameHdr::emitHeader(MemoryArea& pOutput, unsigned int pNumOfThreads)
+{
+  MemoryRegion* ehframehdr_region =
+    pOutput.request(m_EhFrameHdr.offset(), m_EhFrameHdr.size());
 
-  size_t pc_size = 0x0;
-  switch (eh_value) {
-    case DW_EH_PE_udata2:
-      pc_size = 2;
-      break;
-    case DW_EH_PE_udata4:
-      pc_size = 4;
-      break;
-    case DW_EH_PE_udata8:
-      pc_size = 8;
-      break;
-    default:
-      // TODO
-      break;
-  }
+  uint8_t* data = (uint8_t*)ehframehdr_region->start();
+  // version
+  data[0] = 1;
+  // eh_frame_ptr_enc
+  data[1] = DW_EH_PE_pcrel | DW_EH_PE_sdata4;
 
-  SizeTraits<32>::Address pc = 0x0;
-  const uint8_t* offset = (const uint8_t*) pEhFrameRegion.start() +
-                          pFDE.getOffset() +
-                          pFDE.getDataStart();
-  std::memcpy(&pc, offset, pc_size);
+  // eh_frame_ptr
+  uint32_t* eh_frame_ptr = (uint32_t*)(data + 4);
+  *eh_frame_ptr = m_EhFrame.addr() - (m_EhFrameHdr.addr() + 4);
 
-  // adjust the signed value
-  bool is_signed = (fde_encoding & llvm::dwarf::DW_EH_PE_signed) != 0x0;
-  if (DW_EH_PE_udata2 == eh_value && is_signed)
-    pc = (pc ^ 0x8000) - 0x8000;
+  // fde_count
+  uint32_t* fde_count = (uint32_t*)(data + 8);
+  if (hasTable())
+    *fde_count = m_EhFrame.getEhFrame()->numOfFDEs();
+  else
+    *fde_count = 0;
 
-  // handle eh application
-  switch (fde_encoding & 0x70)
-  {
-    case DW_EH_PE_absptr:
-      break;
-    case DW_EH_PE_pcrel:
-      pc += m_EhFrame.addr() + pFDE.getOffset() + pFDE.getDataStart();
-      break;
-    case DW_EH_PE_datarel:
-      // TODO
-      break;
-    default:
-      // TODO
-      break;
+  std::vector<Entry> search_table;
+  if (0 != *fde_count) {
+    // prepare the binary search table. Each task computes the rows of a range
+    // of FDEs from the output and sorts them, and then the ranges are merged.
+    search_table.resize(*fde_count);
+    MemoryRegion* ehframe_region =
+      pOutput.request(m_EhFrame.offset(), m_EhFrame.size());
+    const EhFrame& eh_frame = *m_EhFrame.getEhFrame();
+
+    size_t num_of_tasks = *fde_count / MinRowsPerTask;
+    if (num_of_tasks > pNumOfThreads)
+      num_of_tasks = pNumOfThreads;
+    if (0 == num_of_tasks)
+      num_of_tasks = 1;
+    size_t rows_per_task = (*fde_count + num_of_tasks - 1) / num_of_tasks;
+
+    ThreadPool pool(num_of_tasks);
+    std::vector<SortTask<SIZE>*> tasks;
+    std::vector<size_t> bounds;
+    for (size_t begin = 0; begin < *fde_count; begin += rows_per_task) {
+      size_t end = std::min<size_t>(begin + rows_per_task, *fde_count);
+      tasks.push_back(new SortTask<SIZE>(eh_frame.fde_begin() + begin,
+                                         eh_frame.fde_begin() + end,
+                                         ehframe_region->start(),
+                                         m_EhFrame.addr(),
+                                         &search_table[begin]));
+      pool.enqueue(*tasks.back());
+      bounds.push_back(begin);
+    }
+    pool.wait();
+    bounds.push_back(*fde_count);
+
+    bool is_supported = true;
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      is_supported = is_supported && tasks[i]->isSupported();
+      delete tasks[i];
+    }
+    pOutput.release(ehframe_region);
+
+    if (is_supported) {
+      // merge the sorted ranges pairwise
+      for (size_t step = 1; step + 1 < bounds.size(); step *= 2) {
+        for (size_t i = 0; i + step + 1 < bounds.size(); i += 2 * step) {
+          size_t last = std::min(i + 2 * step, bounds.size() - 1);
+          std::inplace_merge(search_table.begin() + bounds[i],
+                             search_table.begin() + bounds[i + step],
+                             search_table.begin() + bounds[last],
+                             EntryCompare);
+        }
+      }
+
+      // every row must be reachable by an sdata4 offset
+      std::vector<Entry>::const_iterator entry, entry_end = search_table.end();
+      for (entry = search_table.begin(); entry != entry_end; ++entry) {
+        int64_t pc = (*entry).first - m_EhFrameHdr.addr();
+        int64_t fde = (*entry).second - m_EhFrameHdr.addr();
+        if (pc != (int32_t)pc || fde != (int32_t)fde) {
+          *fde_count = 0;
+          break;
+        }
+      }
+    }
+    else
+      *fde_count = 0;
   }
-  return pc;
+
+  if (0 != *fde_count) {
+    // fde_count_enc
+    data[2] = DW_EH_PE_udata4;
+    // table_enc
+    data[3] = DW_EH_PE_datarel | DW_EH_PE_sdata4;
+
+    // write out the binary search table
+    uint32_t* bst = (uint32_t*)(data + 12);
+    std::vector<Entry>::const_iterator entry, entry_end = search_table.end();
+    size_t id = 0;
+    for (entry = search_table.begin(); entry != entry_end; ++entry) {
+      bst[id++] = (*entry).first - m_EhFrameHdr.addr();
+      bst[id++] = (*entry).second - m_EhFrameHdr.addr();
+    }
+  }
+  else {
+    // fde_count_enc
+    data[2] = DW_EH_PE_omit;
+    // table_enc
+    data[3] = DW_EH_PE_omit;
+  }
+  pOutput.release(ehframehdr_region);
 }
@@ -0,0 +1,273 @@
+//===- EhFrameOptimizer.cpp -----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/EhFrameOptimizer.h>
+#include <mcld/Fragment/Fragment.h>
+#include <mcld/Fragment/FragmentRef.h>
+#include <mcld/Fragment/RegionFragment.h>
+#include <mcld/Fragment/Relocation.h>
+#include <mcld/LD/LDContext.h>
+#include <mcld/LD/LDFileFormat.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/RelocData.h>
+#include <mcld/LD/ResolveInfo.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/LinkerConfig.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Module.h>
+#include <mcld/Support/MemoryRegion.h>
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Casting.h>
+
+#include <cassert>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// non-member functions
+//===----------------------------------------------------------------------===//
+template<typename T>
+static void append(std::string& pKey, T pValue)
+{
+  pKey.append(reinterpret_cast<const char*>(&pValue), sizeof(T));
+}
+
+//===----------------------------------------------------------------------===//
+// EhFrameOptimizer
+//===----------------------------------------------------------------------===//
+EhFrameOptimizer::EhFrameOptimizer(const LinkerConfig& pConfig,
+                                   Module& pModule)
+  : m_Config(pConfig), m_Module(pModule), m_RelocIndex(1024),
+    m_CIEIndex(64), m_NumOfRemovedCIEs(0), m_NumOfRemovedFDEs(0) {
+}
+
+EhFrameOptimizer::~EhFrameOptimizer()
+{
+}
+
+bool EhFrameOptimizer::run()
+{
+  // the output of -r keeps all entries, since it may be linked again.
+  if (LinkerConfig::Object == m_Config.codeGenType())
+    return true;
+
+  collectRelocations();
+
+  // the sections are visited in the order of ObjectLinker::mergeSections, so
+  // a kept CIE always precedes the FDEs referring to it in the output.
+  Module::obj_iterator obj, objEnd = m_Module.obj_end();
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    LDContext::sect_iterator sect, sectEnd = (*obj)->context()->sectEnd();
+    for (sect = (*obj)->context()->sectBegin(); sect != sectEnd; ++sect) {
+      if (LDFileFormat::EhFrame == (*sect)->kind() && (*sect)->hasEhFrame())
+        optimize(*(*sect)->getEhFrame());
+    }
+  }
+  return true;
+}
+
+void EhFrameOptimizer::collectRelocations()
+{
+  Module::obj_iterator obj, objEnd = m_Module.obj_end();
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    LDContext::sect_iterator rs, rsEnd = (*obj)->context()->relocSectEnd();
+    for (rs = (*obj)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
+        continue;
+
+      const LDSection* target = (*rs)->getLink();
+      if (NULL == target || LDFileFormat::EhFrame != target->kind() ||
+          !target->hasEhFrame())
+        continue;
+
+      RelocData* data = (*rs)->getRelocData();
+      RelocData::iterator reloc, rEnd = data->end();
+      for (reloc = data->begin(); reloc != rEnd; ++reloc) {
+        Relocation* relocation = llvm::cast<Relocation>(reloc);
+        const Fragment* frag = relocation->targetRef().frag();
+        if (NULL == frag)
+          continue;
+
+        bool exist = false;
+        FragHashEntryType* entry = m_RelocIndex.insert(frag, exist);
+        if (!exist) {
+          entry->setValue(m_Relocs.size());
+          m_Relocs.push_back(RelocEntry());
+          m_Relocs.back().data = data;
+        }
+        m_Relocs[entry->value()].relocs.push_back(relocation);
+      }
+    }
+  }
+}
+
+void EhFrameOptimizer::optimize(EhFrame& pEhFrame)
+{
+  EhFrame::CIEList& cies = pEhFrame.getCIEList();
+  EhFrame::FDEList& fdes = pEhFrame.getFDEList();
+  if (cies.empty())
+    return;
+
+  // 1. remove the dead FDEs, and count the live FDEs of each CIE. The reader
+  // puts an FDE after its CIE, so both lists are walked once.
+  std::vector<size_t> num_of_fdes(cies.size(), 0);
+  size_t cie_idx = 0, live = 0;
+  EhFrame::fde_iterator fde, fdeEnd = fdes.end();
+  for (fde = fdes.begin(); fde != fdeEnd; ++fde) {
+    while (cie_idx < cies.size() && &(*fde)->getCIE() != cies[cie_idx])
+      ++cie_idx;
+    assert(cie_idx < cies.size() && "FDE precedes its CIE");
+
+    if (isDead(**fde)) {
+      remove(pEhFrame, **fde);
+      ++m_NumOfRemovedFDEs;
+      continue;
+    }
+    ++num_of_fdes[cie_idx];
+    fdes[live++] = *fde;
+  }
+  fdes.resize(live);
+
+  // 2. remove the CIEs without live FDEs and the duplicate CIEs
+  EhFrame::CIEList kept(cies.size(), NULL);
+  live = 0;
+  for (cie_idx = 0; cie_idx < cies.size(); ++cie_idx) {
+    EhFrame::CIE* cie = cies[cie_idx];
+    if (0 == num_of_fdes[cie_idx]) {
+      remove(pEhFrame, *cie);
+      ++m_NumOfRemovedCIEs;
+      continue;
+    }
+
+    kept[cie_idx] = cie;
+    std::string key;
+    if (!getKey(pEhFrame, *cie, key))
+      continue;
+
+    bool exist = false;
+    CIEHashTableType::entry_type* entry = m_CIEIndex.insert(key, exist);
+    if (exist) {
+      kept[cie_idx] = entry->value();
+      remove(pEhFrame, *cie);
+      ++m_NumOfRemovedCIEs;
+      continue;
+    }
+    entry->setValue(cie);
+  }
+
+  // 3. the FDEs of the duplicate CIEs refer to the kept ones
+  cie_idx = 0;
+  fdeEnd = fdes.end();
+  for (fde = fdes.begin(); fde != fdeEnd; ++fde) {
+    while (&(*fde)->getCIE() != cies[cie_idx])
+      ++cie_idx;
+    (*fde)->setCIE(*kept[cie_idx]);
+  }
+
+  for (cie_idx = 0; cie_idx < cies.size(); ++cie_idx) {
+    if (kept[cie_idx] == cies[cie_idx])
+      cies[live++] = cies[cie_idx];
+  }
+  cies.resize(live);
+
+  // the fragments are laid out again when they are merged
+  uint64_t size = 0;
+  SectionData::iterator frag, fragEnd = pEhFrame.getSectionData().end();
+  for (frag = pEhFrame.getSectionData().begin(); frag != fragEnd; ++frag) {
+    frag->setOffset(size);
+    size += frag->size();
+  }
+  pEhFrame.getSection().setSize(size);
+}
+
+/// isDead - the relocation of PC Begin is not read if it refers to a
+/// discarded group section. --gc-sections and --icf change the removed
+/// sections to Ignore, and --gc-sections also clears the fragment references
+/// of their symbols.
+bool EhFrameOptimizer::isDead(const EhFrame::FDE& pFDE) const
+{
+  const RelocEntry* entry = getRelocs(pFDE);
+  if (NULL == entry)
+    return true;
+
+  const Relocation* pc_begin = NULL;
+  RelocListType::const_iterator reloc, rEnd = entry->relocs.end();
+  for (reloc = entry->relocs.begin(); reloc != rEnd; ++reloc) {
+    if (pFDE.getDataStart() == (*reloc)->targetRef().offset()) {
+      pc_begin = *reloc;
+      break;
+    }
+  }
+  if (NULL == pc_begin)
+    return true;
+
+  const ResolveInfo* info = pc_begin->symInfo();
+  if (NULL == info || NULL == info->outSymbol())
+    return false;
+
+  const LDSymbol* symbol = info->outSymbol();
+  if (!symbol->hasFragRef())
+    return (info->isDefine() && !info->isAbsolute());
+
+  const Fragment* frag = symbol->fragRef()->frag();
+  if (NULL == frag || NULL == frag->getParent())
+    return false;
+  return (LDFileFormat::Ignore == frag->getParent()->getSection().kind());
+}
+
+/// getKey - the key is the section name, the contents and the relocations.
+/// The relocations are compared by the resolved symbols, so the CIEs whose
+/// personality routines are referred by local symbols are never merged.
+bool EhFrameOptimizer::getKey(const EhFrame& pEhFrame,
+                              const EhFrame::CIE& pCIE,
+                              std::string& pKey) const
+{
+  const std::string& name = pEhFrame.getSection().name();
+  const MemoryRegion& region = pCIE.getRegion();
+
+  pKey.reserve(name.size() + 1 + region.size());
+  pKey.append(name);
+  pKey.push_back('\0');
+  pKey.append(reinterpret_cast<const char*>(region.start()), region.size());
+
+  const RelocEntry* entry = getRelocs(pCIE);
+  if (NULL != entry) {
+    RelocListType::const_iterator reloc, rEnd = entry->relocs.end();
+    for (reloc = entry->relocs.begin(); reloc != rEnd; ++reloc) {
+      append(pKey, (*reloc)->targetRef().offset());
+      append(pKey, (*reloc)->type());
+      append(pKey, (*reloc)->symInfo());
+      append(pKey, (*reloc)->addend());
+    }
+  }
+
+  // StringEntry keeps a 16-bit length
+  return (pKey.size() < 0xFFFF);
+}
+
+void EhFrameOptimizer::remove(EhFrame& pEhFrame, RegionFragment& pFrag)
+{
+  const RelocEntry* entry = getRelocs(pFrag);
+  if (NULL != entry) {
+    RelocListType::const_iterator reloc, rEnd = entry->relocs.end();
+    for (reloc = entry->relocs.begin(); reloc != rEnd; ++reloc)
+      entry->data->getRelocationList().erase(RelocData::iterator(*reloc));
+  }
+  pEhFrame.removeFragment(pFrag);
+}
+
+const EhFrameOptimizer::RelocEntry*
+EhFrameOptimizer::getRelocs(const Fragment& pFrag) const
+{
+  FragHashTableType::const_iterator entry = m_RelocIndex.find(&pFrag);
+  if (entry == m_RelocIndex.end())
+    return NULL;
+  return &m_Relocs[entry.getEntry()->value()];
+}
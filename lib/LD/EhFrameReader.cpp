@@ -50,6 +50,15 @@ EhFrameReader::scan<true>(ConstAddress pHandler,
   Token result;
   result.file_off = pOffset;
 
+  // an entry which does not fit in the section is an unknown token, which
+  // covers the rest of the section
+  uint64_t remain = pData.end() - pHandler;
+  result.kind = Unknown;
+  result.data_off = 0;
+  result.size = remain;
+  if (remain < 4)
+    return result;
+
   const uint32_t* data = (const uint32_t*)pHandler;
   size_t cur_idx = 0;
 
@@ -66,13 +75,20 @@ EhFrameReader::scan<true>(ConstAddress pHandler,
   // Extended Field
   uint64_t extended = 0x0;
   if (0xFFFFFFFF == length) {
-    extended = data[cur_idx++];
-    extended <<= 32;
-    extended |= data[cur_idx++];
+    if (remain < 16)
+      return result;
+    // the 64-bit length is in the byte order of the target
+    uint64_t low = data[cur_idx++];
+    uint64_t high = data[cur_idx++];
+    extended = (high << 32) | low;
+    if (extended < 4 || extended > remain - 12)
+      return result;
     result.size = extended + 12;
     result.data_off = 16;
   }
   else {
+    if (length < 4 || length > remain - 4)
+      return result;
     result.size = length + 4;
     result.data_off = 8;
   }
@@ -89,6 +105,20 @@ EhFrameReader::scan<true>(ConstAddress pHandler,
 
 template<>
 bool EhFrameReader::read<32, true>(Input& pInput, EhFrame& pEhFrame)
+{
+  return readEhFrame<32>(pInput, pEhFrame);
+}
+
+template<>
+bool EhFrameReader::read<64, true>(Input& pInput, EhFrame& pEhFrame)
+{
+  return readEhFrame<64>(pInput, pEhFrame);
+}
+
+/// readEhFrame - the format of .eh_frame is the same in ELF32 and ELF64, but
+/// the size of an absolute pointer in a CIE augmentation
+template<size_t BITCLASS>
+bool EhFrameReader::readEhFrame(Input& pInput, EhFrame& pEhFrame)
 {
   // Alphabet:
   //   {CIE, FDE, CIEt}
@@ -116,12 +146,15 @@ bool EhFrameReader::read<32, true>(Input& pInput, EhFrame& pEhFrame)
 
   const Action transition[NumOfStates][NumOfTokenKinds] = {
    /*    CIE     FDE     Term Unknown */
-    { addCIE, reject, addTerm, reject}, // Q0
-    { addCIE, addFDE, addTerm, reject}, // Q1
+    { addCIE<BITCLASS>, reject, addTerm, reject}, // Q0
+    { addCIE<BITCLASS>, addFDE, addTerm, reject}, // Q1
   };
 
   // get file offset and address
   LDSection& section = pEhFrame.getSection();
+  if (0 == section.size())
+    return true;
+
   uint64_t file_off = pInput.fileOffset() + section.offset();
   MemoryRegion* sect_reg =
                        pInput.memArea()->request(file_off, section.size());
@@ -142,13 +175,10 @@ bool EhFrameReader::read<32, true>(Input& pInput, EhFrame& pEhFrame)
     file_off += token.size;
     handler += token.size;
 
-    if (handler == sect_reg->end())
+    // scan() keeps the tokens in the section
+    cur_state = autometa[cur_state][token.kind];
+    if (Reject != cur_state && handler == sect_reg->end())
       cur_state = Accept;
-    else if (handler > sect_reg->end()) {
-      cur_state = Reject;
-    }
-    else
-      cur_state = autometa[cur_state][token.kind];
   } // end of while
 
   if (Reject == cur_state) {
@@ -159,11 +189,14 @@ bool EhFrameReader::read<32, true>(Input& pInput, EhFrame& pEhFrame)
   return true;
 }
 
+template<size_t BITCLASS>
 bool EhFrameReader::addCIE(EhFrame& pEhFrame,
                            MemoryRegion& pRegion,
                            const EhFrameReader::Token& pToken)
 {
   // skip Length, Extended Length and CIE ID.
+  if (pToken.data_off >= pRegion.size())
+    return false;
   ConstAddress handler = pRegion.start() + pToken.data_off;
   ConstAddress cie_end = pRegion.end();
 
@@ -202,13 +235,13 @@ bool EhFrameReader::addCIE(EhFrame& pEhFrame,
 
   // the Augmentation String start with 'eh' is a CIE from gcc before 3.0,
   // in LSB Core Spec 3.0RC1. We do not support it.
-  if (augment[0] == 'e' && augment[1] == 'h') {
+  if (augment.startswith("eh")) {
     return false;
   }
 
   // parse the Augmentation String to get the FDE encodeing if 'z' existed
   uint8_t fde_encoding = llvm::dwarf::DW_EH_PE_absptr;
-  if ('z' == augment[0]) {
+  if (augment.startswith("z")) {
 
     // skip the Augumentation Data Length
     if (!skip_LEB128(&handler, cie_end)) {
@@ -254,14 +287,15 @@ bool EhFrameReader::addCIE(EhFrame& pEhFrame,
               per_length = 8;
               break;
             case llvm::dwarf::DW_EH_PE_absptr:
-              per_length = 4; // pPkg.bitclass / 8;
+              per_length = BITCLASS / 8;
               break;
           }
           // skip the alignment
           if (llvm::dwarf::DW_EH_PE_aligned == (per_encode & 0xf0)) {
-            uint32_t per_align = handler - cie_end;
-            per_align += per_length - 1;
-            per_align &= ~(per_length -1);
+            uint32_t per_offset = handler - pRegion.start();
+            uint32_t per_align = (per_offset + per_length - 1) &
+                                 ~(per_length - 1);
+            per_align -= per_offset;
             if (static_cast<uint32_t>(cie_end - handler) < per_align) {
               return false;
             }
@@ -293,6 +327,9 @@ bool EhFrameReader::addCIE(EhFrame& pEhFrame,
           ++handler;
           break;
         }
+        // signal frame, no argument
+        case 'S':
+          break;
         default:
           return false;
       } // end switch
@@ -12,7 +12,10 @@
 #include <mcld/InputTree.h>
 #include <mcld/MC/Attribute.h>
 #include <mcld/MC/MCLDInput.h>
+#include <mcld/LD/LDContext.h>
+#include <mcld/LD/LDSymbol.h>
 #include <mcld/LD/ResolveInfo.h>
+#include <mcld/LD/ArchiveIndexCache.h>
 #include <mcld/LD/ELFObjectReader.h>
 #include <mcld/Support/FileSystem.h>
 #include <mcld/Support/FileHandle.h>
@@ -20,25 +23,78 @@
 #include <mcld/Support/MemoryRegion.h>
 #include <mcld/Support/MsgHandling.h>
 #include <mcld/Support/Path.h>
-#include <mcld/ADT/SizeTraits.h>
 
 #include <llvm/ADT/StringRef.h>
-#include <llvm/Support/Host.h>
 
 #include <cstring>
 #include <cstdlib>
+#include <limits>
 
 using namespace mcld;
 
+//===----------------------------------------------------------------------===//
+// non-member functions
+//===----------------------------------------------------------------------===//
+/// readWord - read a big-endian word of the armap. The words are 4 bytes in
+/// the SVR4 armap, and 8 bytes in the /SYM64/ armap.
+static uint64_t readWord(const uint8_t* pData, size_t pWordSize)
+{
+  uint64_t result = 0;
+  for (size_t i = 0; i < pWordSize; ++i)
+    result = (result << 8) | pData[i];
+  return result;
+}
+
+//===----------------------------------------------------------------------===//
+// GNUArchiveReader
+//===----------------------------------------------------------------------===//
 GNUArchiveReader::GNUArchiveReader(Module& pModule,
                                    ELFObjectReader& pELFObjectReader)
  : m_Module(pModule),
-   m_ELFObjectReader(pELFObjectReader)
+   m_ELFObjectReader(pELFObjectReader),
+   m_pIndexCache(NULL)
 {
 }
 
 GNUArchiveReader::~GNUArchiveReader()
 {
+  delete m_pIndexCache;
+}
+
+/// setIndexCache - use pCache to skip parsing the symtab and strtab of the
+/// archives. The reader takes over the cache.
+void GNUArchiveReader::setIndexCache(ArchiveIndexCache* pCache)
+{
+  delete m_pIndexCache;
+  m_pIndexCache = pCache;
+}
+
+/// parseSize - parse the decimal size field of a member header. The field
+/// has ten digits, so a member may be larger than 4GB.
+bool GNUArchiveReader::parseSize(const char* pField,
+                                 size_t pLength,
+                                 uint64_t& pSize)
+{
+  const uint64_t max = std::numeric_limits<int64_t>::max();
+  uint64_t result = 0;
+  size_t i = 0;
+  for (; i < pLength && '0' <= pField[i] && pField[i] <= '9'; ++i) {
+    uint64_t digit = pField[i] - '0';
+    if (result > (max - digit) / 10)
+      return false;
+    result = result * 10 + digit;
+  }
+
+  // the digits are padded with spaces
+  if (0 == i)
+    return false;
+  for (; i < pLength; ++i) {
+    if (' ' != pField[i])
+      return false;
+  }
+
+  pSize = result;
+  return true;
 }
 
 /// isMyFormat
@@ -98,50 +154,191 @@ bool GNUArchiveReader::readArchive(Archive& pArchive)
 
   // if this is the first time read this archive, setup symtab and strtab
   if (pArchive.getSymbolTable().empty()) {
-  // read the symtab of the archive
-  readSymbolTable(pArchive);
+    if (NULL == m_pIndexCache || !m_pIndexCache->load(pArchive)) {
+      // read the symtab and the strtab of the archive
+      if (!readSymbolTable(pArchive) || !readStringTable(pArchive))
+        return false;
 
-  // read the strtab of the archive
-  readStringTable(pArchive);
+      if (NULL != m_pIndexCache)
+        m_pIndexCache->store(pArchive);
+    }
 
-  // add root archive to ArchiveMemberMap
-  pArchive.addArchiveMember(pArchive.getARFile().name(),
-                            pArchive.inputs().root(),
-                            &InputTree::Downward);
+    // add root archive to ArchiveMemberMap
+    pArchive.addArchiveMember(pArchive.getARFile().name(),
+                              pArchive.inputs().root(),
+                              &InputTree::Downward);
   }
 
-  // include the needed members in the archive and build up the input tree
-  bool willSymResolved;
-  do {
-    willSymResolved = false;
-    for (size_t idx = 0; idx < pArchive.numOfSymbols(); ++idx) {
-      // bypass if we already decided to include this symbol or not
-      if (Archive::Symbol::Unknown != pArchive.getSymbolStatus(idx))
+  // include the needed members in the archive and build up the input tree.
+  // Every undecided armap symbol is examined once. After that, only the
+  // undefined symbols of the newly included members can pull in more
+  // members, so they are looked up in the armap index instead of scanning
+  // the whole armap again until nothing changes.
+  MemberListType work_list;
+  for (size_t idx = 0; idx < pArchive.numOfSymbols(); ++idx)
+    scanSymbol(pArchive, idx, work_list);
+
+  for (size_t i = 0; i < work_list.size(); ++i) {
+    LDContext* context = work_list[i]->context();
+    for (size_t sym = 0; sym < context->numOfSymbols(); ++sym) {
+      const ResolveInfo* info = context->getSymbol(sym)->resolveInfo();
+      if (NULL == info || 0 == info->nameSize() || !info->isUndef())
         continue;
 
-      // bypass if another symbol with the same object file offset is included
-      if (pArchive.hasObjectMember(pArchive.getObjFileOffset(idx))) {
-        pArchive.setSymbolStatus(idx, Archive::Symbol::Include);
-        continue;
-      }
+      size_t idx = 0;
+      llvm::StringRef name(info->name(), info->nameSize());
+      if (pArchive.findSymbol(name, idx))
+        scanSymbol(pArchive, idx, work_list);
+    }
+  }
+
+  return true;
+}
 
-      // check if we should include this defined symbol
-      Archive::Symbol::Status status =
-        shouldIncludeSymbol(pArchive.getSymbolName(idx));
-      if (Archive::Symbol::Unknown != status)
-        pArchive.setSymbolStatus(idx, status);
+/// readGroup - after every input of a group is read once, only the undefined
+/// symbols referred after an archive was read may include more members of
+/// it. As GNU ld does, the archives are scanned again and again in command
+/// line order, and the members are included from the archive being scanned
+/// until it needs no more. So the undefined symbol of a member is resolved
+/// by the first archive which defines it, beginning with the archive of the
+/// member and wrapping around the group.
+///
+/// Instead of rescanning every armap in every round, the armaps of the group
+/// are indexed together. The first round examines every undecided armap
+/// symbol, and after that, an archive only examines the symbols which the
+/// members included since its last scan refer to.
+bool GNUArchiveReader::readGroup(const ArchiveListType& pArchives)
+{
+  GroupIndexType index(1024);
+  for (size_t ar = 0; ar < pArchives.size(); ++ar) {
+    // the members of --whole-archive are all included already
+    if (pArchives[ar]->getARFile().attribute()->isWholeArchive())
+      continue;
+
+    for (size_t idx = 0; idx < pArchives[ar]->numOfSymbols(); ++idx) {
+      bool exist = false;
+      GroupIndexEntryType* entry =
+        index.insert(pArchives[ar]->getSymbolName(idx), exist);
+      if (!exist)
+        entry->setValue(GroupSymbolListType());
+
+      // only the first symbol with the name in an archive is examined
+      GroupSymbolListType& symbols = entry->value();
+      if (symbols.empty() || symbols.back().archive != ar) {
+        GroupSymbol symbol = { ar, idx };
+        symbols.push_back(symbol);
+      }
+    }
+  }
 
-      if (Archive::Symbol::Include == status) {
-        // include the object member from the given offset
-        includeMember(pArchive, pArchive.getObjFileOffset(idx));
-        willSymResolved = true;
-      } // end of if
-    } // end of for
-  } while (willSymResolved);
+  // scan the archives around the group until no armap symbol is pending
+  MemberListType work_list;
+  PendingListType pending(pArchives.size());
+  size_t num_of_pending = 0;
+  for (size_t visit = 0; visit < pArchives.size() || 0 != num_of_pending;
+       ++visit) {
+    size_t ar = visit % pArchives.size();
+    Archive& archive = *pArchives[ar];
+
+    // the first round, every undecided armap symbol is examined
+    if (visit < pArchives.size() &&
+        !archive.getARFile().attribute()->isWholeArchive()) {
+      for (size_t idx = 0; idx < archive.numOfSymbols(); ++idx)
+        scanSymbol(archive, idx, work_list);
+      num_of_pending += scanGroupMembers(index, ar, work_list, pending);
+    }
 
+    // the symbols referred by the members of this archive may be pending
+    // here, too, so this archive is drained before the scan goes on
+    for (size_t i = 0; i < pending[ar].size(); ++i) {
+      scanSymbol(archive, pending[ar][i], work_list);
+      num_of_pending += scanGroupMembers(index, ar, work_list, pending);
+    }
+    num_of_pending -= pending[ar].size();
+    pending[ar].clear();
+  }
   return true;
 }
 
+/// scanGroupMembers - hand the undefined symbols of the members in pWorkList
+/// to the archives which are scanned next, and drain pWorkList
+/// @param pIndex    - the armap index of the group
+/// @param pArchive  - the position of the archive being scanned
+/// @param pWorkList - the included members whose symbols are not examined yet
+/// @param pPending  - the armap symbols to examine of each archive
+/// @return the number of the armap symbols added to pPending
+size_t GNUArchiveReader::scanGroupMembers(const GroupIndexType& pIndex,
+                                          size_t pArchive,
+                                          MemberListType& pWorkList,
+                                          PendingListType& pPending)
+{
+  size_t result = 0;
+  for (size_t i = 0; i < pWorkList.size(); ++i) {
+    LDContext* context = pWorkList[i]->context();
+    for (size_t sym = 0; sym < context->numOfSymbols(); ++sym) {
+      const ResolveInfo* info = context->getSymbol(sym)->resolveInfo();
+      if (NULL == info || 0 == info->nameSize() || !info->isUndef())
+        continue;
+
+      llvm::StringRef name(info->name(), info->nameSize());
+      GroupIndexType::const_iterator entry = pIndex.find(name);
+      if (entry == pIndex.end())
+        continue;
+
+      // the first archive at or after pArchive, or else the first one
+      const GroupSymbolListType& symbols = entry.getEntry()->value();
+      GroupSymbolListType::const_iterator symbol = symbols.begin();
+      while (symbol != symbols.end() && symbol->archive < pArchive)
+        ++symbol;
+      if (symbol == symbols.end())
+        symbol = symbols.begin();
+      pPending[symbol->archive].push_back(symbol->index);
+      ++result;
+    }
+  }
+  pWorkList.clear();
+  return result;
+}
+
+/// scanSymbol - decide whether to include the member which defines the armap
+/// symbol, and push the included member into the worklist
+/// @param pArchive  - the archive root
+/// @param pSymIdx   - the index of the symbol in armap
+/// @param pWorkList - the included members whose symbols are not examined yet
+void GNUArchiveReader::scanSymbol(Archive& pArchive,
+                                  size_t pSymIdx,
+                                  MemberListType& pWorkList)
+{
+  // bypass if we already decided to include this symbol or not
+  if (Archive::Symbol::Unknown != pArchive.getSymbolStatus(pSymIdx))
+    return;
+
+  // bypass if another symbol with the same object file offset is included
+  uint64_t file_offset = pArchive.getObjFileOffset(pSymIdx);
+  if (pArchive.hasObjectMember(file_offset)) {
+    pArchive.setSymbolStatus(pSymIdx, Archive::Symbol::Include);
+    return;
+  }
+
+  // check if we should include this defined symbol
+  Archive::Symbol::Status status =
+    shouldIncludeSymbol(pArchive.getSymbolName(pSymIdx));
+  if (Archive::Symbol::Unknown != status)
+    pArchive.setSymbolStatus(pSymIdx, status);
+
+  if (Archive::Symbol::Include != status)
+    return;
+
+  // include the object member from the given offset
+  uint64_t size = 0;
+  if (!includeMember(pArchive, file_offset, size))
+    return;
+  Archive::ObjectMemberMapType::iterator member =
+    pArchive.getObjectMemberMap().find(file_offset);
+  if (member != pArchive.getObjectMemberMap().end())
+    pWorkList.push_back(*(member.getEntry()->value()));
+}
+
 /// readMemberHeader - read the header of a member in a archive file and then
 /// return the corresponding archive member (it may be an input object or
 /// another archive)
@@ -153,9 +350,9 @@ bool GNUArchiveReader::readArchive(Archive& pArchive)
 /// @param pMemberSize   - the file size of this member
 Input* GNUArchiveReader::readMemberHeader(Archive& pArchiveRoot,
                                           Input& pArchiveFile,
-                                          uint32_t pFileOffset,
-                                          uint32_t& pNestedOffset,
-                                          size_t& pMemberSize)
+                                          uint64_t pFileOffset,
+                                          uint64_t& pNestedOffset,
+                                          uint64_t& pMemberSize)
 {
   assert(pArchiveFile.hasMemArea());
 
@@ -167,7 +364,16 @@ Input* GNUArchiveReader::readMemberHeader(Archive& pArchiveRoot,
 
   assert(0 == memcmp(header->fmag, Archive::MEMBER_MAGIC, sizeof(header->fmag)));
 
-  pMemberSize = atoi(header->size);
+  bool isThinAR = isThinArchive(pArchiveFile);
+  uint64_t end = pArchiveFile.fileOffset() + pFileOffset +
+                 sizeof(Archive::MemberHeader);
+  if (!parseSize(header->size, sizeof(header->size), pMemberSize) ||
+      (!isThinAR && pArchiveFile.memArea()->handler()->size() - end <
+                    pMemberSize)) {
+    error(diag::err_malformed_archive) << pArchiveFile.path();
+    pArchiveFile.memArea()->release(header_region);
+    return NULL;
+  }
 
   // parse the member name and nested offset if any
   std::string member_name;
@@ -200,7 +406,6 @@ Input* GNUArchiveReader::readMemberHeader(Archive& pArchiveRoot,
   }
 
   Input* member = NULL;
-  bool isThinAR = isThinArchive(pArchiveFile);
   if (!isThinAR) {
     // this is an object file in an archive
     member = pArchiveRoot.getMemberFile(pArchiveFile,
@@ -250,60 +455,94 @@ bool GNUArchiveReader::readSymbolTable(Archive& pArchive)
     reinterpret_cast<const Archive::MemberHeader*>(header_region->getBuffer());
   assert(0 == memcmp(header->fmag, Archive::MEMBER_MAGIC, sizeof(header->fmag)));
 
-  int symtab_size = atoi(header->size);
+  // the armap must lie in the archive
+  Input& ar_file = pArchive.getARFile();
+  uint64_t symtab_offset = ar_file.fileOffset() +
+                           Archive::MAGIC_LEN +
+                           sizeof(Archive::MemberHeader);
+  uint64_t symtab_size = 0;
+  if (!parseSize(header->size, sizeof(header->size), symtab_size) ||
+      ar_file.memArea()->handler()->size() - symtab_offset < symtab_size) {
+    error(diag::err_malformed_archive) << ar_file.path();
+    ar_file.memArea()->release(header_region);
+    return false;
+  }
   pArchive.setSymTabSize(symtab_size);
 
-  if (!pArchive.getARFile().attribute()->isWholeArchive()) {
+  if (!ar_file.attribute()->isWholeArchive()) {
+    // the archives larger than 4GB have a /SYM64/ armap with 64-bit words
+    size_t word_size = sizeof(uint32_t);
+    if (0 == memcmp(header->name,
+                    Archive::SYM64_SYMTAB_NAME,
+                    sizeof(header->name)))
+      word_size = sizeof(uint64_t);
+    ar_file.memArea()->release(header_region);
+
+    if (symtab_size < word_size) {
+      error(diag::err_malformed_archive) << ar_file.path();
+      return false;
+    }
+
     MemoryRegion* symtab_region =
-      pArchive.getARFile().memArea()->request(
-                                            (pArchive.getARFile().fileOffset() +
-                                             Archive::MAGIC_LEN +
-                                             sizeof(Archive::MemberHeader)),
-                                            symtab_size);
-    const uint32_t* data =
-      reinterpret_cast<const uint32_t*>(symtab_region->getBuffer());
-
-    // read the number of symbols
-    uint32_t number = 0;
-    if (llvm::sys::isLittleEndianHost())
-      number = mcld::bswap32(*data);
-    else
-      number = *data;
+      ar_file.memArea()->request(symtab_offset, symtab_size);
+    const uint8_t* data = symtab_region->getBuffer();
+    const char* end = reinterpret_cast<const char*>(data + symtab_size);
+
+    // read the number of symbols, and check the offsets fit in the armap
+    uint64_t number = readWord(data, word_size);
+    if (number > (symtab_size - word_size) / word_size) {
+      error(diag::err_malformed_archive) << ar_file.path();
+      ar_file.memArea()->release(symtab_region);
+      return false;
+    }
 
     // set up the pointers for file offset and name offset
-    ++data;
-    const char* name = reinterpret_cast<const char*>(data + number);
-
-    // add the archive symbols
-    for (uint32_t i = 0; i < number; ++i) {
-      if (llvm::sys::isLittleEndianHost())
-        pArchive.addSymbol(name, mcld::bswap32(*data));
-      else
-        pArchive.addSymbol(name, *data);
-      name += strlen(name) + 1;
-      ++data;
+    data += word_size;
+    const char* name = reinterpret_cast<const char*>(data + number * word_size);
+
+    // add the archive symbols. The names are not copied; the archive keeps
+    // the symtab region instead.
+    for (uint64_t i = 0; i < number; ++i) {
+      const char* name_end = static_cast<const char*>(
+                                     memchr(name, '\0', end - name));
+      if (NULL == name_end) {
+        error(diag::err_malformed_archive) << ar_file.path();
+        ar_file.memArea()->release(symtab_region);
+        return false;
+      }
+      pArchive.addSymbol(llvm::StringRef(name, name_end - name),
+                         readWord(data, word_size));
+      name = name_end + 1;
+      data += word_size;
     }
-    pArchive.getARFile().memArea()->release(symtab_region);
+    pArchive.setSymTabRegion(symtab_region);
+    return true;
   }
-  pArchive.getARFile().memArea()->release(header_region);
+  ar_file.memArea()->release(header_region);
   return true;
 }
 
 /// readStringTable - read the strtab for long file name of the archive
 bool GNUArchiveReader::readStringTable(Archive& pArchive)
 {
-  size_t offset = Archive::MAGIC_LEN +
-                  sizeof(Archive::MemberHeader) +
-                  pArchive.getSymTabSize();
+  uint64_t offset = Archive::MAGIC_LEN +
+                    sizeof(Archive::MemberHeader) +
+                    pArchive.getSymTabSize();
 
   if (0x0 != (offset & 1))
     ++offset;
 
   assert(pArchive.getARFile().hasMemArea());
 
+  // the archive has no members
+  uint64_t begin = pArchive.getARFile().fileOffset() + offset;
+  uint64_t file_size = pArchive.getARFile().memArea()->handler()->size();
+  if (begin > file_size ||
+      file_size - begin < sizeof(Archive::MemberHeader))
+    return true;
+
   MemoryRegion* header_region =
-    pArchive.getARFile().memArea()->request((pArchive.getARFile().fileOffset() +
-                                             offset),
+    pArchive.getARFile().memArea()->request(begin,
                                             sizeof(Archive::MemberHeader));
   const Archive::MemberHeader* header =
     reinterpret_cast<const Archive::MemberHeader*>(header_region->getBuffer());
@@ -312,11 +551,16 @@ bool GNUArchiveReader::readStringTable(Archive& pArchive)
 
   if (0 == memcmp(header->name, Archive::STRTAB_NAME, sizeof(header->name))) {
     // read the extended name table
-    int strtab_size = atoi(header->size);
+    uint64_t strtab_size = 0;
+    if (!parseSize(header->size, sizeof(header->size), strtab_size) ||
+        file_size - begin - sizeof(Archive::MemberHeader) < strtab_size) {
+      error(diag::err_malformed_archive) << pArchive.getARFile().path();
+      pArchive.getARFile().memArea()->release(header_region);
+      return false;
+    }
     MemoryRegion* strtab_region =
       pArchive.getARFile().memArea()->request(
-                                   (pArchive.getARFile().fileOffset() +
-                                    offset + sizeof(Archive::MemberHeader)),
+                                   begin + sizeof(Archive::MemberHeader),
                                    strtab_size);
     const char* strtab =
       reinterpret_cast<const char*>(strtab_region->getBuffer());
@@ -345,25 +589,29 @@ GNUArchiveReader::shouldIncludeSymbol(const llvm::StringRef& pSymName) const
 }
 
 /// includeMember - include the object member in the given file offset, and
-/// return the size of the object
+/// get the size of the object
 /// @param pArchiveRoot - the archive root
 /// @param pFileOffset  - file offset of the member header in the archive
-size_t GNUArchiveReader::includeMember(Archive& pArchive, uint32_t pFileOffset)
+/// @param pSize        - the size of the object
+/// @return false if the member header is malformed
+bool GNUArchiveReader::includeMember(Archive& pArchive,
+                                     uint64_t pFileOffset,
+                                     uint64_t& pSize)
 {
   Input* cur_archive = &(pArchive.getARFile());
   Input* member = NULL;
-  uint32_t file_offset = pFileOffset;
-  size_t size = 0;
+  uint64_t file_offset = pFileOffset;
   do {
-    uint32_t nested_offset = 0;
+    uint64_t nested_offset = 0;
     // use the file offset in current archive to find out the member we
     // want to include
     member = readMemberHeader(pArchive,
                               *cur_archive,
                               file_offset,
                               nested_offset,
-                              size);
-    assert(member != NULL);
+                              pSize);
+    if (NULL == member)
+      return false;
     // bypass if we get an archive that is already in the map
     if (Input::Archive == member->type()) {
         cur_archive = member;
@@ -402,18 +650,16 @@ size_t GNUArchiveReader::includeMember(Archive& pArchive, uint32_t pFileOffset)
       file_offset = nested_offset;
     }
   } while (Input::Object != member->type());
-  return size;
+  return true;
 }
 
 /// includeAllMembers - include all object members. This is called if
 /// --whole-archive is the attribute for this archive file.
 bool GNUArchiveReader::includeAllMembers(Archive& pArchive)
 {
-  // read the symtab of the archive
-  readSymbolTable(pArchive);
-
-  // read the strtab of the archive
-  readStringTable(pArchive);
+  // read the symtab and the strtab of the archive
+  if (!readSymbolTable(pArchive) || !readStringTable(pArchive))
+    return false;
 
   // add root archive to ArchiveMemberMap
   pArchive.addArchiveMember(pArchive.getARFile().name(),
@@ -421,7 +667,7 @@ bool GNUArchiveReader::includeAllMembers(Archive& pArchive)
                             &InputTree::Downward);
 
   bool isThinAR = isThinArchive(pArchive.getARFile());
-  uint32_t begin_offset = pArchive.getARFile().fileOffset() +
+  uint64_t begin_offset = pArchive.getARFile().fileOffset() +
                           Archive::MAGIC_LEN +
                           sizeof(Archive::MemberHeader) +
                           pArchive.getSymTabSize();
@@ -431,12 +677,14 @@ bool GNUArchiveReader::includeAllMembers(Archive& pArchive)
     begin_offset += sizeof(Archive::MemberHeader) +
                     pArchive.getStrTable().size();
   }
-  uint32_t end_offset = pArchive.getARFile().memArea()->handler()->size();
-  for (uint32_t offset = begin_offset;
+  uint64_t end_offset = pArchive.getARFile().memArea()->handler()->size();
+  for (uint64_t offset = begin_offset;
        offset < end_offset;
        offset += sizeof(Archive::MemberHeader)) {
 
-    size_t size = includeMember(pArchive, offset);
+    uint64_t size = 0;
+    if (!includeMember(pArchive, offset, size))
+      return false;
 
     if (!isThinAR) {
       offset += size;
@@ -0,0 +1,329 @@
+//===- GarbageCollection.cpp ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/GarbageCollection.h>
+#include <mcld/Fragment/Fragment.h>
+#include <mcld/Fragment/FragmentRef.h>
+#include <mcld/Fragment/Relocation.h>
+#include <mcld/LD/LDContext.h>
+#include <mcld/LD/LDFileFormat.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/RelocData.h>
+#include <mcld/LD/ResolveInfo.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/LinkerConfig.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Module.h>
+#include <mcld/Support/MsgHandling.h>
+#include <mcld/Target/TargetLDBackend.h>
+
+#include <llvm/Support/Casting.h>
+#include <llvm/Support/ELF.h>
+
+#include <cctype>
+#include <cstring>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// non-member functions
+//===----------------------------------------------------------------------===//
+/// isCIdentifier - __start_SECNAME and __stop_SECNAME may refer to a section
+/// whose name is a C identifier, so such sections are always kept.
+static bool isCIdentifier(const std::string& pName)
+{
+  if (pName.empty() || (!isalpha(pName[0]) && '_' != pName[0]))
+    return false;
+  for (size_t i = 1; i < pName.size(); ++i) {
+    if (!isalnum(pName[i]) && '_' != pName[i])
+      return false;
+  }
+  return true;
+}
+
+static bool hasPrefix(const std::string& pName, const char* pPrefix)
+{
+  return (0 == pName.compare(0, strlen(pPrefix), pPrefix));
+}
+
+//===----------------------------------------------------------------------===//
+// GarbageCollection
+//===----------------------------------------------------------------------===//
+GarbageCollection::GarbageCollection(const LinkerConfig& pConfig,
+                                     const TargetLDBackend& pBackend,
+                                     Module& pModule)
+  : m_Config(pConfig), m_Backend(pBackend), m_Module(pModule),
+    m_SectionIndex(256),
+    m_NumOfStripped(0) {
+}
+
+GarbageCollection::~GarbageCollection()
+{
+}
+
+bool GarbageCollection::run()
+{
+  // the output of -r may be linked again, and nothing is a root there.
+  if (LinkerConfig::Object == m_Config.codeGenType())
+    return true;
+
+  setUpNodes();
+  setUpEdges();
+
+  IndexListType work_list;
+  setUpRoots(work_list);
+  findReachedSections(work_list);
+
+  stripSections();
+  return true;
+}
+
+/// mayProcess - only the allocatable regular and BSS sections are the nodes.
+/// The relocations in the other sections (.eh_frame, .gcc_except_table,
+/// debugging sections, target sections such as .ARM.exidx) are not followed,
+/// otherwise every function with an FDE would be kept.
+bool GarbageCollection::mayProcess(const LDSection& pSection)
+{
+  if (LDFileFormat::Regular != pSection.kind() &&
+      LDFileFormat::BSS != pSection.kind())
+    return false;
+
+  if (0x0 == (pSection.flag() & llvm::ELF::SHF_ALLOC))
+    return false;
+
+  return true;
+}
+
+/// shouldKeep - the sections which are listed with KEEP in the default GNU
+/// linker scripts, and the sections whose address is taken by the runtime
+/// rather than by relocations.
+bool GarbageCollection::shouldKeep(const LDSection& pSection)
+{
+  switch (pSection.type()) {
+    case llvm::ELF::SHT_INIT_ARRAY:
+    case llvm::ELF::SHT_FINI_ARRAY:
+    case llvm::ELF::SHT_PREINIT_ARRAY:
+    case llvm::ELF::SHT_NOTE:
+      return true;
+    default:
+      break;
+  }
+
+  const std::string& name = pSection.name();
+  if (name == ".init" || name == ".fini" || name == ".jcr" ||
+      name == ".interp")
+    return true;
+
+  if (hasPrefix(name, ".ctors") ||
+      hasPrefix(name, ".dtors") ||
+      hasPrefix(name, ".init_array") ||
+      hasPrefix(name, ".fini_array") ||
+      hasPrefix(name, ".preinit_array") ||
+      hasPrefix(name, ".note"))
+    return true;
+
+  return isCIdentifier(name);
+}
+
+void GarbageCollection::setUpNodes()
+{
+  Module::obj_iterator obj, objEnd = m_Module.obj_end();
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    LDContext::sect_iterator sect, sectEnd = (*obj)->context()->sectEnd();
+    for (sect = (*obj)->context()->sectBegin(); sect != sectEnd; ++sect) {
+      if (!mayProcess(**sect))
+        continue;
+
+      bool exist = false;
+      SectHashEntryType* entry = m_SectionIndex.insert(*sect, exist);
+      entry->setValue(m_Sections.size());
+      m_Sections.push_back(*sect);
+    }
+  }
+
+  m_Edges.resize(m_Sections.size());
+  m_Reached.assign(m_Sections.size(), false);
+}
+
+void GarbageCollection::setUpEdges()
+{
+  Module::obj_iterator obj, objEnd = m_Module.obj_end();
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    LDContext::sect_iterator rs, rsEnd = (*obj)->context()->relocSectEnd();
+    for (rs = (*obj)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      // bypass the discarded relocation sections
+      if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
+        continue;
+
+      size_t from = 0;
+      if (NULL == (*rs)->getLink() || !getIndex(*(*rs)->getLink(), from))
+        continue;
+
+      RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
+      for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
+        Relocation* relocation = llvm::cast<Relocation>(reloc);
+        size_t to = 0;
+        if (NULL == relocation->symInfo() ||
+            !getIndex(*relocation->symInfo(), to) ||
+            from == to)
+          continue;
+        m_Edges[from].push_back(to);
+      }
+    }
+  }
+}
+
+void GarbageCollection::setUpRoots(IndexListType& pWorkList)
+{
+  // 1. the sections kept by name or type
+  for (size_t i = 0; i < m_Sections.size(); ++i) {
+    if (shouldKeep(*m_Sections[i]))
+      markReached(i, pWorkList);
+  }
+
+  // 2. the entry symbol. The default entry is the one of GNUInfo.
+  std::string entry("_start");
+  if (m_Config.options().hasEntry())
+    entry = m_Config.options().entry();
+
+  const ResolveInfo* entry_info = m_Module.getNamePool().findInfo(entry);
+  size_t index = 0;
+  if (NULL != entry_info && getIndex(*entry_info, index))
+    markReached(index, pWorkList);
+
+  // 3. the exported symbols, which may be referred from the outside world.
+  // An executable linked against shared objects exports the symbols which
+  // the backend puts in .dynsym, since the shared objects may refer to them
+  // even without --export-dynamic.
+  bool export_all = (LinkerConfig::DynObj == m_Config.codeGenType() ||
+                     m_Config.options().exportDynamic());
+  Module::SymbolTable& sym_tab = m_Module.getSymbolTable();
+  Module::SymbolTable::iterator sym, symEnd = sym_tab.end();
+  for (sym = sym_tab.begin(); sym != symEnd; ++sym) {
+    const ResolveInfo* info = (*sym)->resolveInfo();
+    if (info->isLocal() ||
+        ResolveInfo::Hidden == info->visibility() ||
+        ResolveInfo::Internal == info->visibility())
+      continue;
+    if (!export_all && !m_Backend.isExported(*info))
+      continue;
+    if (getIndex(*info, index))
+      markReached(index, pWorkList);
+  }
+}
+
+void GarbageCollection::findReachedSections(IndexListType& pWorkList)
+{
+  while (!pWorkList.empty()) {
+    size_t from = pWorkList.back();
+    pWorkList.pop_back();
+
+    IndexListType::iterator to, toEnd = m_Edges[from].end();
+    for (to = m_Edges[from].begin(); to != toEnd; ++to)
+      markReached(*to, pWorkList);
+  }
+}
+
+void GarbageCollection::stripSections()
+{
+  bool print = m_Config.options().getPrintGCSections();
+
+  Module::obj_iterator obj, objEnd = m_Module.obj_end();
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    LDContext::sect_iterator sect, sectEnd = (*obj)->context()->sectEnd();
+    for (sect = (*obj)->context()->sectBegin(); sect != sectEnd; ++sect) {
+      size_t index = 0;
+      if (!getIndex(**sect, index) || m_Reached[index])
+        continue;
+
+      (*sect)->setKind(LDFileFormat::Ignore);
+      ++m_NumOfStripped;
+      if (print)
+        note(diag::note_removed_unused_section) << (*sect)->name()
+                                                << (*obj)->name();
+    }
+
+    // the relocations of the stripped sections are neither scanned nor
+    // applied.
+    LDContext::sect_iterator rs, rsEnd = (*obj)->context()->relocSectEnd();
+    for (rs = (*obj)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (NULL != (*rs)->getLink() &&
+          LDFileFormat::Ignore == (*rs)->getLink()->kind())
+        (*rs)->setKind(LDFileFormat::Ignore);
+    }
+  }
+
+  if (0 == m_NumOfStripped)
+    return;
+
+  // The symbols defined in the stripped sections become absolute zero, like
+  // the symbols in the discarded group sections. Only the sections which are
+  // not followed, such as .eh_frame and the debugging sections, can still
+  // refer to them. The local symbols, including the section symbols, are
+  // only in the symbol tables of the inputs.
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    LDContext* context = (*obj)->context();
+    for (size_t i = 0; i < context->numOfSymbols(); ++i) {
+      if (NULL != context->getSymbol(i))
+        clearIfStripped(*context->getSymbol(i));
+    }
+  }
+
+  Module::SymbolTable& sym_tab = m_Module.getSymbolTable();
+  Module::SymbolTable::iterator sym, symEnd = sym_tab.end();
+  for (sym = sym_tab.begin(); sym != symEnd; ++sym)
+    clearIfStripped(**sym);
+}
+
+void GarbageCollection::clearIfStripped(LDSymbol& pSymbol)
+{
+  if (!pSymbol.hasFragRef() || NULL == pSymbol.fragRef()->frag() ||
+      NULL == pSymbol.fragRef()->frag()->getParent())
+    return;
+
+  const LDSection& sect =
+                    pSymbol.fragRef()->frag()->getParent()->getSection();
+  if (LDFileFormat::Ignore == sect.kind()) {
+    pSymbol.setFragmentRef(FragmentRef::Null());
+    pSymbol.setValue(0x0);
+  }
+}
+
+bool GarbageCollection::getIndex(const ResolveInfo& pSymbol,
+                                 size_t& pIndex) const
+{
+  if (!pSymbol.isDefine() || NULL == pSymbol.outSymbol() ||
+      !pSymbol.outSymbol()->hasFragRef())
+    return false;
+
+  const FragmentRef* frag_ref = pSymbol.outSymbol()->fragRef();
+  if (NULL == frag_ref->frag() || NULL == frag_ref->frag()->getParent())
+    return false;
+
+  return getIndex(frag_ref->frag()->getParent()->getSection(), pIndex);
+}
+
+bool GarbageCollection::getIndex(const LDSection& pSection,
+                                 size_t& pIndex) const
+{
+  SectHashTableType::const_iterator entry = m_SectionIndex.find(&pSection);
+  if (entry == m_SectionIndex.end())
+    return false;
+  pIndex = entry.getEntry()->value();
+  return true;
+}
+
+void GarbageCollection::markReached(size_t pIndex, IndexListType& pWorkList)
+{
+  if (m_Reached[pIndex])
+    return;
+  m_Reached[pIndex] = true;
+  pWorkList.push_back(pIndex);
+}
+
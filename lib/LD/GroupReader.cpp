@@ -36,14 +36,10 @@ bool GroupReader::readGroup(Module::input_iterator pRoot,
                             InputBuilder& pBuilder,
                             const LinkerConfig& pConfig)
 {
-  // record the number of total objects included in this sub-tree
-  size_t cur_obj_cnt = 0;
-  size_t last_obj_cnt = 0;
-  size_t non_ar_obj_cnt = 0;
-
   // record the archive files in this sub-tree
   typedef std::vector<ArchiveListEntry*> ArchiveListType;
   ArchiveListType ar_list;
+  ArchiveReader::ArchiveListType archives;
 
   Module::input_iterator input = --pRoot;
 
@@ -71,9 +67,9 @@ bool GroupReader::readGroup(Module::input_iterator pRoot,
       Archive* ar = new Archive(**input, pBuilder);
       ArchiveListEntry* entry = new ArchiveListEntry(*ar, input);
       ar_list.push_back(entry);
+      archives.push_back(ar);
       // read archive
       m_ArchiveReader.readArchive(*ar);
-      cur_obj_cnt += ar->numOfObjectMember();
     }
     // is a relocatable object file
     else if (m_ObjectReader.isMyFormat(**input)) {
@@ -82,8 +78,6 @@ bool GroupReader::readGroup(Module::input_iterator pRoot,
       m_ObjectReader.readSections(**input);
       m_ObjectReader.readSymbols(**input);
       m_Module.getObjectList().push_back(*input);
-      ++cur_obj_cnt;
-      ++non_ar_obj_cnt;
     }
     // is a shared object file
     else if (m_DynObjReader.isMyFormat(**input)) {
@@ -99,25 +93,14 @@ bool GroupReader::readGroup(Module::input_iterator pRoot,
     ++input;
   }
 
-  // after read in all the archives, traverse the archive list in a loop until
-  // there is no unresolved symbols added
-  ArchiveListType::iterator it = ar_list.begin();
-  ArchiveListType::iterator end = ar_list.end();
-  while (cur_obj_cnt != last_obj_cnt) {
-    last_obj_cnt = cur_obj_cnt;
-    cur_obj_cnt = non_ar_obj_cnt;
-    for (it = ar_list.begin(); it != end; ++it) {
-      Archive& ar = (*it)->archive;
-      // if --whole-archive is given to this archive, no need to read it again
-      if ( ar.getARFile().attribute()->isWholeArchive())
-        continue;
-      m_ArchiveReader.readArchive(ar);
-      cur_obj_cnt += ar.numOfObjectMember();
-    }
-  }
+  // after read in all the archives, include the members needed by the
+  // symbols referred after each archive was read
+  m_ArchiveReader.readGroup(archives);
 
   // after all needed member included, merge the archive sub-tree to main
   // InputTree
+  ArchiveListType::iterator it = ar_list.begin();
+  ArchiveListType::iterator end = ar_list.end();
   for (it = ar_list.begin(); it != end; ++it) {
     Archive& ar = (*it)->archive;
     if (ar.numOfObjectMember() > 0) {
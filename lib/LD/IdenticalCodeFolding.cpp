@@ -0,0 +1,836 @@
+//===- IdenticalCodeFolding.cpp -------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/IdenticalCodeFolding.h>
+#include <mcld/ADT/StringHash.h>
+#include <mcld/Fragment/Fragment.h>
+#include <mcld/Fragment/FragmentRef.h>
+#include <mcld/Fragment/RegionFragment.h>
+#include <mcld/Fragment/Relocation.h>
+#include <mcld/LD/LDContext.h>
+#include <mcld/LD/LDFileFormat.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/RelocData.h>
+#include <mcld/LD/ResolveInfo.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/LinkerConfig.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Module.h>
+#include <mcld/Support/MemoryRegion.h>
+#include <mcld/Target/TargetLDBackend.h>
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Casting.h>
+#include <llvm/Support/ELF.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// non-member functions
+//===----------------------------------------------------------------------===//
+namespace {
+
+/** \class MangledName
+ *  \brief MangledName follows the Itanium C++ ABI mangling grammar far enough
+ *  to tell whether a name is a constructor or a destructor.
+ *
+ *  Whatever the parser does not understand is not a constructor or
+ *  destructor, which only makes --icf=safe fold less.
+ */
+class MangledName
+{
+public:
+  MangledName(const std::string& pName, size_t pPos)
+    : m_Name(pName), m_Pos(pPos) {
+  }
+
+  /// isCtorOrDtor - <mangled-name> ::= _Z N [<CV-qualifiers>]
+  ///   [<ref-qualifier>] <prefix> <ctor-dtor-name> [<abi-tags>]
+  ///   [<template-args>] E <bare-function-type>
+  bool isCtorOrDtor()
+  {
+    if (!eat('_') || !eat('Z') || !eat('N'))
+      return false;
+    eat('r');
+    eat('V');
+    eat('K');
+    if (!eat('R'))
+      eat('O');
+
+    bool has_prefix = false;
+    while (true) {
+      if (has_prefix && 'C' == peek() && '1' <= peek(1) && '5' >= peek(1)) {
+        m_Pos += 2;
+        return parseFunctionTail();
+      }
+      // inheriting constructor: CI1 <base class type>, CI2 <base class type>
+      if (has_prefix && 'C' == peek() && 'I' == peek(1) &&
+          ('1' == peek(2) || '2' == peek(2))) {
+        m_Pos += 3;
+        return parseType() && parseFunctionTail();
+      }
+      if (has_prefix && 'D' == peek() &&
+          NULL != strchr("01245", peek(1)) && '\0' != peek(1)) {
+        m_Pos += 2;
+        return parseFunctionTail();
+      }
+      if (!parsePrefixComponent())
+        return false;
+      has_prefix = true;
+    }
+  }
+
+private:
+  char peek(size_t pOffset = 0) const
+  {
+    if (m_Pos + pOffset >= m_Name.size())
+      return '\0';
+    return m_Name[m_Pos + pOffset];
+  }
+
+  bool eat(char pChar)
+  {
+    if ('\0' == pChar || pChar != peek())
+      return false;
+    ++m_Pos;
+    return true;
+  }
+
+  bool atEnd() const { return m_Pos >= m_Name.size(); }
+
+  /// parseFunctionTail - [<abi-tags>] [<template-args>] E
+  /// <bare-function-type>
+  bool parseFunctionTail()
+  {
+    while (eat('B')) {
+      if (!parseSourceName())
+        return false;
+    }
+    if ('I' == peek() && !parseTemplateArgs())
+      return false;
+    if (!eat('E'))
+      return false;
+
+    // the parameter types, at least one
+    do {
+      if (!parseType())
+        return false;
+    } while (!atEnd());
+    return true;
+  }
+
+  /// parseSourceName - <source-name> ::= <positive length number> <identifier>
+  bool parseSourceName()
+  {
+    if (!isdigit(peek()) || '0' == peek())
+      return false;
+    size_t length = 0;
+    while (isdigit(peek())) {
+      length = length * 10 + (peek() - '0');
+      if (length > m_Name.size())
+        return false;
+      ++m_Pos;
+    }
+    if (m_Pos + length > m_Name.size())
+      return false;
+    m_Pos += length;
+    return true;
+  }
+
+  /// parseSeqID - [<seq-id>] _
+  bool parseSeqID()
+  {
+    while (isdigit(peek()) || isupper(peek()))
+      ++m_Pos;
+    return eat('_');
+  }
+
+  /// parseSubstitution - S_, S <seq-id> _, St, Sa, Sb, Ss, Si, So, Sd
+  bool parseSubstitution()
+  {
+    if (!eat('S'))
+      return false;
+    if ('\0' != peek() && NULL != strchr("tabsiod", peek())) {
+      ++m_Pos;
+      return true;
+    }
+    return parseSeqID();
+  }
+
+  /// parseTemplateParam - T_, T <number> _
+  bool parseTemplateParam()
+  {
+    if (!eat('T'))
+      return false;
+    return parseSeqID();
+  }
+
+  /// parseTemplateArgs - I <template-arg>+ E
+  bool parseTemplateArgs()
+  {
+    if (!eat('I'))
+      return false;
+    while (!eat('E')) {
+      if (atEnd() || !parseTemplateArg())
+        return false;
+    }
+    return true;
+  }
+
+  /// parseTemplateArg - <type>, J <template-arg>* E, or a literal
+  /// L <type> <value> E. The other expressions are not followed.
+  bool parseTemplateArg()
+  {
+    if (eat('J')) {
+      while (!eat('E')) {
+        if (atEnd() || !parseTemplateArg())
+          return false;
+      }
+      return true;
+    }
+    if (eat('L')) {
+      if ('_' == peek() || !parseType())
+        return false;
+      eat('n');
+      while (isalnum(peek()))
+        ++m_Pos;
+      return eat('E');
+    }
+    return parseType();
+  }
+
+  /// parsePrefixComponent - one component of a nested name: a source name,
+  /// a substitution or a template parameter, each optionally followed by
+  /// template arguments, or an ABI tag.
+  bool parsePrefixComponent()
+  {
+    bool result = false;
+    if (isdigit(peek()))
+      result = parseSourceName();
+    else if ('S' == peek())
+      result = parseSubstitution();
+    else if ('T' == peek())
+      result = parseTemplateParam();
+    else if (eat('L'))
+      result = parseSourceName();
+    else if (eat('B'))
+      return parseSourceName();
+    if (!result)
+      return false;
+    if ('I' == peek())
+      return parseTemplateArgs();
+    return true;
+  }
+
+  /// parseNestedType - N [<CV-qualifiers>] <prefix> E as a type
+  bool parseNestedType()
+  {
+    if (!eat('N'))
+      return false;
+    eat('r');
+    eat('V');
+    eat('K');
+    while (!eat('E')) {
+      if (atEnd() || !parsePrefixComponent())
+        return false;
+    }
+    return true;
+  }
+
+  bool parseType()
+  {
+    char c = peek();
+    if ('\0' == c)
+      return false;
+
+    // <builtin-type>
+    if (NULL != strchr("vwbcahstijlmxynofdegz", c)) {
+      ++m_Pos;
+      return true;
+    }
+
+    switch (c) {
+      case 'u':
+        ++m_Pos;
+        return parseSourceName();
+      case 'D':
+        if ('\0' != peek(1) && NULL != strchr("defhisacnu", peek(1))) {
+          m_Pos += 2;
+          return true;
+        }
+        // pack expansion
+        if ('p' == peek(1)) {
+          m_Pos += 2;
+          return parseType();
+        }
+        return false;
+      case 'K':
+      case 'V':
+      case 'r':
+      case 'P':
+      case 'R':
+      case 'O':
+      case 'C':
+      case 'G':
+        ++m_Pos;
+        return parseType();
+      case 'A':
+        ++m_Pos;
+        while (isdigit(peek()))
+          ++m_Pos;
+        return eat('_') && parseType();
+      case 'M':
+        ++m_Pos;
+        return parseType() && parseType();
+      case 'F': {
+        ++m_Pos;
+        eat('Y');
+        if (!parseType())
+          return false;
+        while (!eat('E')) {
+          if (('R' == peek() || 'O' == peek()) && 'E' == peek(1)) {
+            ++m_Pos;
+            continue;
+          }
+          if (atEnd() || !parseType())
+            return false;
+        }
+        return true;
+      }
+      case 'N':
+        return parseNestedType();
+      case 'S':
+        // ::std::<name>
+        if ('t' == peek(1)) {
+          m_Pos += 2;
+          if (!parseSourceName())
+            return false;
+        }
+        else if (!parseSubstitution())
+          return false;
+        break;
+      case 'T':
+        if (!parseTemplateParam())
+          return false;
+        break;
+      default:
+        if (!parseSourceName())
+          return false;
+        break;
+    }
+
+    // <template-template-param> <template-args> or <class-enum-type>
+    // <template-args>
+    if ('I' == peek())
+      return parseTemplateArgs();
+    return true;
+  }
+
+private:
+  const std::string& m_Name;
+  size_t m_Pos;
+};
+
+uint32_t mix(uint32_t pHash, uint64_t pValue)
+{
+  uint32_t low = (uint32_t)pValue;
+  uint32_t high = (uint32_t)(pValue >> 32);
+  pHash ^= low + 0x9e3779b9U + (pHash << 6) + (pHash >> 2);
+  pHash ^= high + 0x9e3779b9U + (pHash << 6) + (pHash >> 2);
+  return pHash;
+}
+
+/// HashCompare - order candidates by their hash values
+struct HashCompare
+{
+  const std::vector<uint32_t>& hashes;
+
+  HashCompare(const std::vector<uint32_t>& pHashes) : hashes(pHashes) { }
+
+  bool operator()(size_t pX, size_t pY) const
+  {
+    if (hashes[pX] != hashes[pY])
+      return hashes[pX] < hashes[pY];
+    return pX < pY;
+  }
+};
+
+/// KeyCompare - order candidates by their class keys
+struct KeyCompare
+{
+  const std::vector<std::vector<size_t> >& keys;
+
+  KeyCompare(const std::vector<std::vector<size_t> >& pKeys) : keys(pKeys) { }
+
+  bool operator()(size_t pX, size_t pY) const
+  {
+    if (keys[pX] != keys[pY])
+      return keys[pX] < keys[pY];
+    return pX < pY;
+  }
+};
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// IdenticalCodeFolding
+//===----------------------------------------------------------------------===//
+const size_t IdenticalCodeFolding::npos;
+
+IdenticalCodeFolding::IdenticalCodeFolding(const LinkerConfig& pConfig,
+                                           const TargetLDBackend& pBackend,
+                                           Module& pModule)
+  : m_Config(pConfig), m_Backend(pBackend), m_Module(pModule),
+    m_SectionIndex(256), m_NumOfFolded(0) {
+}
+
+IdenticalCodeFolding::~IdenticalCodeFolding()
+{
+}
+
+bool IdenticalCodeFolding::foldIdenticalCode()
+{
+  if (GeneralOptions::ICFNone == m_Config.options().getICFMode())
+    return true;
+
+  findCandidates();
+  if (m_Sections.size() < 2)
+    return true;
+
+  collectRelocations();
+
+  // iterate until the number of classes does not grow. Classes are only
+  // split, so the number of classes can not stay the same while the classes
+  // change.
+  size_t num_of_classes = initClasses();
+  while (num_of_classes < m_Sections.size()) {
+    size_t refined = refineClasses();
+    if (refined == num_of_classes)
+      break;
+    num_of_classes = refined;
+  }
+
+  if (num_of_classes < m_Sections.size())
+    fold();
+  return true;
+}
+
+bool IdenticalCodeFolding::isCandidate(const LDSection& pSection) const
+{
+  if (LDFileFormat::Regular != pSection.kind() || 0x0 == pSection.size())
+    return false;
+
+  uint32_t flag = pSection.flag();
+  if (0x0 == (flag & llvm::ELF::SHF_ALLOC) ||
+      0x0 == (flag & llvm::ELF::SHF_EXECINSTR) ||
+      0x0 != (flag & llvm::ELF::SHF_WRITE))
+    return false;
+
+  // .init and .fini are concatenated pieces of one function
+  if (pSection.name() == ".init" || pSection.name() == ".fini")
+    return false;
+
+  // the section read from the file is one RegionFragment, surrounded by the
+  // AlignFragment and the NullFragment added by ObjectBuilder::AppendFragment
+  const SectionData* sd = pSection.getSectionData();
+  if (NULL == sd)
+    return false;
+  size_t num_of_regions = 0;
+  SectionData::const_iterator frag, fragEnd = sd->end();
+  for (frag = sd->begin(); frag != fragEnd; ++frag) {
+    switch (frag->getKind()) {
+      case Fragment::Region:
+        ++num_of_regions;
+        break;
+      case Fragment::Alignment:
+      case Fragment::Null:
+        break;
+      default:
+        return false;
+    }
+  }
+  return (1 == num_of_regions);
+}
+
+void IdenticalCodeFolding::findCandidates()
+{
+  Module::obj_iterator obj, objEnd = m_Module.obj_end();
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    LDContext::sect_iterator sect, sectEnd = (*obj)->context()->sectEnd();
+    for (sect = (*obj)->context()->sectBegin(); sect != sectEnd; ++sect) {
+      if (!isCandidate(**sect))
+        continue;
+
+      bool exist = false;
+      SectHashEntryType* entry = m_SectionIndex.insert(*sect, exist);
+      entry->setValue(m_Sections.size());
+      m_Sections.push_back(*sect);
+    }
+  }
+
+  if (GeneralOptions::ICFSafe == m_Config.options().getICFMode())
+    dropUnsafeCandidates();
+}
+
+/// dropUnsafeCandidates - the unwinding tables and the debugging information
+/// refer to every function without taking its address, so their relocations
+/// are not checked.
+void IdenticalCodeFolding::dropUnsafeCandidates()
+{
+  std::vector<bool> unsafe(m_Sections.size(), false);
+  size_t index = 0;
+
+  Module::obj_iterator obj, objEnd = m_Module.obj_end();
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    LDContext::sect_iterator rs, rsEnd = (*obj)->context()->relocSectEnd();
+    for (rs = (*obj)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
+        continue;
+
+      const LDSection* target = (*rs)->getLink();
+      if (NULL == target ||
+          LDFileFormat::Ignore == target->kind() ||
+          LDFileFormat::EhFrame == target->kind() ||
+          LDFileFormat::Debug == target->kind())
+        continue;
+
+      RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
+      for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
+        Relocation* relocation = llvm::cast<Relocation>(reloc);
+        if (NULL == relocation->symInfo() ||
+            !getIndex(*relocation->symInfo(), index) || unsafe[index])
+          continue;
+        if (m_Backend.mayTakeFunctionAddress(*relocation))
+          unsafe[index] = true;
+      }
+    }
+  }
+
+  // the outside world may take the address of an exported function
+  Module::SymbolTable& sym_tab = m_Module.getSymbolTable();
+  Module::SymbolTable::iterator sym, symEnd = sym_tab.end();
+  for (sym = sym_tab.begin(); sym != symEnd; ++sym) {
+    const ResolveInfo* info = (*sym)->resolveInfo();
+    if (m_Backend.isExported(*info) && getIndex(*info, index))
+      unsafe[index] = true;
+  }
+
+  SectionListType sections;
+  m_SectionIndex.clear();
+  for (size_t i = 0; i < m_Sections.size(); ++i) {
+    if (unsafe[i] && !isCtorOrDtor(m_Sections[i]->name()))
+      continue;
+
+    bool exist = false;
+    SectHashEntryType* entry = m_SectionIndex.insert(m_Sections[i], exist);
+    entry->setValue(sections.size());
+    sections.push_back(m_Sections[i]);
+  }
+  m_Sections.swap(sections);
+}
+
+void IdenticalCodeFolding::collectRelocations()
+{
+  m_Relocs.resize(m_Sections.size());
+
+  Module::obj_iterator obj, objEnd = m_Module.obj_end();
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    LDContext::sect_iterator rs, rsEnd = (*obj)->context()->relocSectEnd();
+    for (rs = (*obj)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
+        continue;
+
+      size_t from = 0;
+      if (NULL == (*rs)->getLink() || !getIndex(*(*rs)->getLink(), from))
+        continue;
+
+      RelocData::iterator reloc, rEnd = (*rs)->getRelocData()->end();
+      for (reloc = (*rs)->getRelocData()->begin(); reloc != rEnd; ++reloc) {
+        Relocation* relocation = llvm::cast<Relocation>(reloc);
+        RelocKey key;
+        key.offset = relocation->targetRef().getOutputOffset();
+        key.type = relocation->type();
+        key.addend = relocation->addend();
+        key.symbol = relocation->symInfo();
+        key.target = npos;
+        key.target_offset = 0;
+
+        // a symbol defined in a candidate is compared by the class of the
+        // candidate and the offset in it.
+        const ResolveInfo* sym = relocation->symInfo();
+        if (NULL != sym && sym->isDefine() && NULL != sym->outSymbol() &&
+            sym->outSymbol()->hasFragRef()) {
+          const FragmentRef* ref = sym->outSymbol()->fragRef();
+          size_t to = 0;
+          if (NULL != ref->frag() && NULL != ref->frag()->getParent() &&
+              getIndex(ref->frag()->getParent()->getSection(), to)) {
+            key.symbol = NULL;
+            key.target = to;
+            key.target_offset = ref->getOutputOffset();
+          }
+        }
+        m_Relocs[from].push_back(key);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < m_Relocs.size(); ++i)
+    std::stable_sort(m_Relocs[i].begin(), m_Relocs[i].end());
+}
+
+uint32_t IdenticalCodeFolding::hashOf(size_t pIndex) const
+{
+  const MemoryRegion& region = getRegion(pIndex).getRegion();
+  StringHash<XX> hash_func;
+  uint32_t result = hash_func(llvm::StringRef(
+                        reinterpret_cast<const char*>(region.start()),
+                        region.size()));
+  result = mix(result, m_Sections[pIndex]->size());
+
+  RelocKeyListType::const_iterator key, keyEnd = m_Relocs[pIndex].end();
+  for (key = m_Relocs[pIndex].begin(); key != keyEnd; ++key) {
+    result = mix(result, key->offset);
+    result = mix(result, key->type);
+    result = mix(result, key->addend);
+    result = mix(result, npos == key->target ? (uintptr_t)key->symbol
+                                             : key->target_offset);
+  }
+  return result;
+}
+
+bool IdenticalCodeFolding::isStaticallyEqual(size_t pX, size_t pY) const
+{
+  const LDSection& x = *m_Sections[pX];
+  const LDSection& y = *m_Sections[pY];
+  if (x.size() != y.size() || x.flag() != y.flag() ||
+      x.type() != y.type() || x.align() != y.align())
+    return false;
+
+  const MemoryRegion& x_region = getRegion(pX).getRegion();
+  const MemoryRegion& y_region = getRegion(pY).getRegion();
+  if (x_region.size() != y_region.size() ||
+      0 != std::memcmp(x_region.start(), y_region.start(), x_region.size()))
+    return false;
+
+  const RelocKeyListType& x_relocs = m_Relocs[pX];
+  const RelocKeyListType& y_relocs = m_Relocs[pY];
+  if (x_relocs.size() != y_relocs.size())
+    return false;
+  for (size_t i = 0; i < x_relocs.size(); ++i) {
+    const RelocKey& a = x_relocs[i];
+    const RelocKey& b = y_relocs[i];
+    if (a.offset != b.offset || a.type != b.type || a.addend != b.addend ||
+        a.symbol != b.symbol || (npos == a.target) != (npos == b.target) ||
+        a.target_offset != b.target_offset)
+      return false;
+  }
+  return true;
+}
+
+size_t IdenticalCodeFolding::initClasses()
+{
+  std::vector<uint32_t> hashes(m_Sections.size());
+  IndexListType order(m_Sections.size());
+  for (size_t i = 0; i < m_Sections.size(); ++i) {
+    hashes[i] = hashOf(i);
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), HashCompare(hashes));
+
+  // compare the candidates with the same hash value to the first member of
+  // each class made so far for this hash value.
+  m_Class.assign(m_Sections.size(), npos);
+  size_t num_of_classes = 0;
+  size_t begin = 0;
+  while (begin < order.size()) {
+    size_t end = begin + 1;
+    while (end < order.size() && hashes[order[end]] == hashes[order[begin]])
+      ++end;
+
+    IndexListType leaders;
+    for (size_t i = begin; i < end; ++i) {
+      size_t cur = order[i];
+      IndexListType::iterator leader, lEnd = leaders.end();
+      for (leader = leaders.begin(); leader != lEnd; ++leader) {
+        if (isStaticallyEqual(*leader, cur)) {
+          m_Class[cur] = m_Class[*leader];
+          break;
+        }
+      }
+      if (npos == m_Class[cur]) {
+        m_Class[cur] = num_of_classes++;
+        leaders.push_back(cur);
+      }
+    }
+    begin = end;
+  }
+  return num_of_classes;
+}
+
+size_t IdenticalCodeFolding::refineClasses()
+{
+  // key = the current class, followed by the classes of referred candidates
+  std::vector<IndexListType> keys(m_Sections.size());
+  IndexListType order(m_Sections.size());
+  for (size_t i = 0; i < m_Sections.size(); ++i) {
+    keys[i].push_back(m_Class[i]);
+    RelocKeyListType::const_iterator key, keyEnd = m_Relocs[i].end();
+    for (key = m_Relocs[i].begin(); key != keyEnd; ++key) {
+      if (npos != key->target)
+        keys[i].push_back(m_Class[key->target]);
+    }
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), KeyCompare(keys));
+
+  size_t num_of_classes = 0;
+  for (size_t i = 0; i < order.size(); ++i) {
+    if (0 != i && keys[order[i]] != keys[order[i - 1]])
+      ++num_of_classes;
+    m_Class[order[i]] = num_of_classes;
+  }
+  return num_of_classes + 1;
+}
+
+void IdenticalCodeFolding::fold()
+{
+  // kept[i] is the candidate which the candidate i is folded into
+  IndexListType first(m_Sections.size(), npos);
+  IndexListType kept(m_Sections.size());
+  for (size_t i = 0; i < m_Sections.size(); ++i) {
+    if (npos == first[m_Class[i]])
+      first[m_Class[i]] = i;
+    kept[i] = first[m_Class[i]];
+  }
+
+  // move the symbols, both the input symbols of every object and the output
+  // symbols.
+  Module::obj_iterator obj, objEnd = m_Module.obj_end();
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    LDContext* context = (*obj)->context();
+    for (size_t i = 0; i < context->numOfSymbols(); ++i) {
+      if (NULL != context->getSymbol(i))
+        redirect(*context->getSymbol(i), kept);
+    }
+  }
+
+  Module::SymbolTable& sym_tab = m_Module.getSymbolTable();
+  Module::SymbolTable::iterator sym, symEnd = sym_tab.end();
+  for (sym = sym_tab.begin(); sym != symEnd; ++sym)
+    redirect(**sym, kept);
+
+  // drop the folded sections and their relocations
+  for (size_t i = 0; i < m_Sections.size(); ++i) {
+    if (kept[i] != i) {
+      m_Sections[i]->setKind(LDFileFormat::Ignore);
+      ++m_NumOfFolded;
+    }
+  }
+
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    LDContext::sect_iterator rs, rsEnd = (*obj)->context()->relocSectEnd();
+    for (rs = (*obj)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (NULL != (*rs)->getLink() &&
+          LDFileFormat::Ignore == (*rs)->getLink()->kind())
+        (*rs)->setKind(LDFileFormat::Ignore);
+    }
+  }
+}
+
+void IdenticalCodeFolding::redirect(LDSymbol& pSymbol,
+                                    const IndexListType& pKept)
+{
+  if (!pSymbol.hasFragRef())
+    return;
+
+  const FragmentRef* ref = pSymbol.fragRef();
+  if (NULL == ref->frag() || NULL == ref->frag()->getParent())
+    return;
+
+  size_t index = 0;
+  if (!getIndex(ref->frag()->getParent()->getSection(), index) ||
+      pKept[index] == index)
+    return;
+
+  // identical sections have the same list of fragments, so the fragment at
+  // the same position in the kept section has the same offset.
+  const SectionData* from = ref->frag()->getParent();
+  SectionData* to = m_Sections[pKept[index]]->getSectionData();
+  SectionData::const_iterator frag = from->begin();
+  SectionData::iterator target = to->begin();
+  while (frag != from->end() && target != to->end()) {
+    if (&*frag == ref->frag()) {
+      pSymbol.setFragmentRef(FragmentRef::Create(*target, ref->offset()));
+      return;
+    }
+    ++frag;
+    ++target;
+  }
+}
+
+bool IdenticalCodeFolding::getIndex(const LDSection& pSection,
+                                    size_t& pIndex) const
+{
+  SectHashTableType::const_iterator entry = m_SectionIndex.find(&pSection);
+  if (entry == m_SectionIndex.end())
+    return false;
+  pIndex = entry.getEntry()->value();
+  return true;
+}
+
+bool IdenticalCodeFolding::getIndex(const ResolveInfo& pSymbol,
+                                    size_t& pIndex) const
+{
+  if (!pSymbol.isDefine() || NULL == pSymbol.outSymbol() ||
+      !pSymbol.outSymbol()->hasFragRef())
+    return false;
+
+  const FragmentRef* ref = pSymbol.outSymbol()->fragRef();
+  if (NULL == ref->frag() || NULL == ref->frag()->getParent())
+    return false;
+
+  return getIndex(ref->frag()->getParent()->getSection(), pIndex);
+}
+
+/// isCtorOrDtor - the address of a C++ constructor or destructor can not be
+/// taken, so --icf=safe can always fold it.
+bool IdenticalCodeFolding::isCtorOrDtor(const std::string& pSectionName)
+{
+  static const std::string prefix(".text.");
+  if (0 != pSectionName.compare(0, prefix.size(), prefix))
+    return false;
+
+  // -ffunction-sections puts the hot and cold functions in .text.hot.<name>
+  // and .text.unlikely.<name>
+  size_t pos = prefix.size();
+  if (0 != pSectionName.compare(pos, 2, "_Z")) {
+    pos = pSectionName.find('.', pos);
+    if (std::string::npos == pos)
+      return false;
+    ++pos;
+  }
+  return MangledName(pSectionName, pos).isCtorOrDtor();
+}
+
+const RegionFragment& IdenticalCodeFolding::getRegion(size_t pIndex) const
+{
+  const SectionData* sd = m_Sections[pIndex]->getSectionData();
+  SectionData::const_iterator frag, fragEnd = sd->end();
+  for (frag = sd->begin(); frag != fragEnd; ++frag) {
+    if (Fragment::Region == frag->getKind())
+      break;
+  }
+  assert(frag != fragEnd && "candidate has no RegionFragment");
+  return llvm::cast<RegionFragment>(*frag);
+}
+
@@ -0,0 +1,377 @@
+//===- InputPrefetcher.cpp ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/InputPrefetcher.h>
+#include <mcld/LD/ELFInputTables.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Support/FileHandle.h>
+#include <mcld/Support/MemoryArea.h>
+#include <mcld/Support/MemoryRegion.h>
+#include <mcld/Support/MsgHandling.h>
+#include <mcld/Support/Space.h>
+
+#include <llvm/Support/ELF.h>
+#include <llvm/Support/Host.h>
+
+#include <cstring>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// InputPrefetcher::Task
+//===----------------------------------------------------------------------===//
+/// Task - decode the tables of one input file. Task runs in a worker thread,
+/// so it only reads its own file and reports nothing. The ranges which can
+/// not be read are kept for InputPrefetcher::load to report in the main
+/// thread. Malformed files are left to the readers, which report the errors.
+class InputPrefetcher::Task : public ThreadPool::Task
+{
+public:
+  typedef std::vector<Input*> InputList;
+  typedef std::vector<Space*> SpaceList;
+  typedef std::vector<std::pair<uint64_t, uint64_t> > RangeList;
+
+public:
+  Task(MemoryArea& pArea, off_t pFileOffset)
+    : m_Area(pArea), m_FileOffset(pFileOffset), m_bDecoded(false) {
+  }
+
+  void run();
+
+  MemoryArea& area() { return m_Area; }
+
+  InputList& inputs() { return m_Inputs; }
+
+  SpaceList& spaces() { return m_Spaces; }
+
+  /// failures - the ranges [offset, offset+length) which can not be loaded
+  const RangeList& failures() const { return m_Failures; }
+
+  /// tables - the decoded tables. Valid only if isDecoded().
+  const ELFInputTables& tables() const { return m_Tables; }
+  ELFInputTables&       tables()       { return m_Tables; }
+
+  bool isDecoded() const { return m_bDecoded; }
+
+private:
+  /// load - get the bytes [pOffset, pOffset+pLength) relative to the input
+  /// @return NULL if the bytes are out of the file or can not be read
+  const uint8_t* load(uint64_t pOffset, uint64_t pLength);
+
+  template<typename EHDR, typename SHDR, typename SYM>
+  void decode(const EHDR& pHeader);
+
+  template<typename SHDR, typename SYM>
+  void decodeSymbols(const SHDR* pShdrTab, uint64_t pShnum, uint32_t pType);
+
+  /// willNeed - advise the system to read the sections in the whole file
+  /// mapping ahead
+  void willNeed();
+
+private:
+  MemoryArea& m_Area;
+  off_t m_FileOffset;
+  InputList m_Inputs;
+  SpaceList m_Spaces;
+  RangeList m_Failures;
+  ELFInputTables m_Tables;
+  bool m_bDecoded;
+};
+
+const uint8_t* InputPrefetcher::Task::load(uint64_t pOffset, uint64_t pLength)
+{
+  FileHandle& file = *m_Area.handler();
+  uint64_t start = m_FileOffset + pOffset;
+  if (0 == pLength || start + pLength > file.size() || start + pLength < start)
+    return NULL;
+
+  // the host can not address the bytes. The readers report it.
+  if (pLength != static_cast<size_t>(pLength))
+    return NULL;
+
+  // the whole file is mapped already. Read it in place.
+  const Space* whole = m_Area.wholeFile();
+  if (NULL != whole) {
+    if (start + pLength > whole->size())
+      return NULL;
+    return whole->memory() + start;
+  }
+
+  Space* space = Space::TryCreate(file, start, static_cast<size_t>(pLength));
+  if (NULL == space) {
+    m_Failures.push_back(std::make_pair(start, pLength));
+    return NULL;
+  }
+  m_Spaces.push_back(space);
+  return space->memory() + (start - space->start());
+}
+
+void InputPrefetcher::Task::run()
+{
+  FileHandle& file = *m_Area.handler();
+  if (!file.isOpened() || !file.isReadable() ||
+      (uint64_t)m_FileOffset > file.size())
+    return;
+
+  uint64_t hdr_size = file.size() - m_FileOffset;
+  if (hdr_size < llvm::ELF::EI_NIDENT)
+    return;
+  if (hdr_size > sizeof(llvm::ELF::Elf64_Ehdr))
+    hdr_size = sizeof(llvm::ELF::Elf64_Ehdr);
+
+  const uint8_t* ident = load(0, hdr_size);
+  if (NULL == ident ||
+      0 != memcmp(ident, llvm::ELF::ElfMagic, strlen(llvm::ELF::ElfMagic)))
+    return;
+
+  // the readers take care of the byte swapping. Here we only decode inputs
+  // in the host byte order.
+  bool is_little = (llvm::ELF::ELFDATA2LSB == ident[llvm::ELF::EI_DATA]);
+  if (is_little != llvm::sys::isLittleEndianHost())
+    return;
+
+  switch (ident[llvm::ELF::EI_CLASS]) {
+    case llvm::ELF::ELFCLASS32:
+      if (hdr_size >= sizeof(llvm::ELF::Elf32_Ehdr)) {
+        decode<llvm::ELF::Elf32_Ehdr,
+               llvm::ELF::Elf32_Shdr,
+               llvm::ELF::Elf32_Sym>(
+               *reinterpret_cast<const llvm::ELF::Elf32_Ehdr*>(ident));
+      }
+      break;
+    case llvm::ELF::ELFCLASS64:
+      if (hdr_size >= sizeof(llvm::ELF::Elf64_Ehdr)) {
+        decode<llvm::ELF::Elf64_Ehdr,
+               llvm::ELF::Elf64_Shdr,
+               llvm::ELF::Elf64_Sym>(
+               *reinterpret_cast<const llvm::ELF::Elf64_Ehdr*>(ident));
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+template<typename EHDR, typename SHDR, typename SYM>
+void InputPrefetcher::Task::decode(const EHDR& pHeader)
+{
+  uint32_t sym_type;
+  if (llvm::ELF::ET_REL == pHeader.e_type)
+    sym_type = llvm::ELF::SHT_SYMTAB;
+  else if (llvm::ELF::ET_DYN == pHeader.e_type)
+    sym_type = llvm::ELF::SHT_DYNSYM;
+  else
+    return;
+
+  if (0 == pHeader.e_shoff || sizeof(SHDR) != pHeader.e_shentsize)
+    return;
+
+  uint64_t shnum = pHeader.e_shnum;
+  uint32_t shstrndx = pHeader.e_shstrndx;
+
+  // if the number of sections or the index of the section name table do not
+  // fit in the ELF header, they are in the first section header.
+  if (0 == shnum || llvm::ELF::SHN_XINDEX == shstrndx) {
+    const SHDR* first =
+      reinterpret_cast<const SHDR*>(load(pHeader.e_shoff, sizeof(SHDR)));
+    if (NULL == first)
+      return;
+    if (0 == shnum)
+      shnum = first->sh_size;
+    if (llvm::ELF::SHN_XINDEX == shstrndx)
+      shstrndx = first->sh_link;
+  }
+
+  if (shstrndx >= shnum || shnum > m_Area.handler()->size() / sizeof(SHDR))
+    return;
+
+  const SHDR* shdr = reinterpret_cast<const SHDR*>(
+                       load(pHeader.e_shoff, shnum * sizeof(SHDR)));
+  if (NULL == shdr)
+    return;
+
+  uint64_t names_size = shdr[shstrndx].sh_size;
+  const char* names = reinterpret_cast<const char*>(
+                        load(shdr[shstrndx].sh_offset, names_size));
+  if (NULL == names)
+    return;
+
+  ELFInputTables::SectionList& sections = m_Tables.sections();
+  sections.resize(shnum);
+  for (uint64_t idx = 0; idx < shnum; ++idx) {
+    // the name must end in the section name table
+    const void* end = NULL;
+    if (shdr[idx].sh_name < names_size) {
+      end = memchr(names + shdr[idx].sh_name, '\0',
+                   names_size - shdr[idx].sh_name);
+    }
+    if (NULL == end) {
+      sections.clear();
+      return;
+    }
+
+    ELFInputTables::Section& section = sections[idx];
+    section.name.assign(names + shdr[idx].sh_name,
+                        static_cast<const char*>(end));
+    section.sh_type      = shdr[idx].sh_type;
+    section.sh_flags     = shdr[idx].sh_flags;
+    section.sh_offset    = shdr[idx].sh_offset;
+    section.sh_size      = shdr[idx].sh_size;
+    section.sh_link      = shdr[idx].sh_link;
+    section.sh_info      = shdr[idx].sh_info;
+    section.sh_addralign = shdr[idx].sh_addralign;
+    section.sh_entsize   = shdr[idx].sh_entsize;
+  }
+  m_bDecoded = true;
+
+  decodeSymbols<SHDR, SYM>(shdr, shnum, sym_type);
+
+  if (llvm::ELF::ET_REL == pHeader.e_type && NULL != m_Area.wholeFile())
+    willNeed();
+}
+
+template<typename SHDR, typename SYM>
+void InputPrefetcher::Task::decodeSymbols(const SHDR* pShdrTab,
+                                          uint64_t pShnum,
+                                          uint32_t pType)
+{
+  for (uint64_t idx = 1; idx < pShnum; ++idx) {
+    if (pType != pShdrTab[idx].sh_type)
+      continue;
+
+    const SHDR& symtab = pShdrTab[idx];
+    if (symtab.sh_link >= pShnum)
+      return;
+    const SYM* syms = reinterpret_cast<const SYM*>(
+                        load(symtab.sh_offset, symtab.sh_size));
+    if (NULL == syms)
+      return;
+
+    // load the string table for the readers, and check the names end in it
+    const SHDR& strtab = pShdrTab[symtab.sh_link];
+    const char* strs = reinterpret_cast<const char*>(
+                         load(strtab.sh_offset, strtab.sh_size));
+    if (NULL == strs || '\0' != strs[strtab.sh_size - 1])
+      return;
+
+    ELFInputTables::SymbolList& symbols = m_Tables.symbols();
+    symbols.resize(symtab.sh_size / sizeof(SYM));
+    for (size_t sym = 0; sym < symbols.size(); ++sym) {
+      if (syms[sym].st_name >= strtab.sh_size) {
+        symbols.clear();
+        return;
+      }
+      symbols[sym].st_name  = syms[sym].st_name;
+      symbols[sym].st_info  = syms[sym].st_info;
+      symbols[sym].st_other = syms[sym].st_other;
+      symbols[sym].st_shndx = syms[sym].st_shndx;
+      symbols[sym].st_value = syms[sym].st_value;
+      symbols[sym].st_size  = syms[sym].st_size;
+    }
+    m_Tables.setSymTab(idx);
+    return;
+  }
+}
+
+void InputPrefetcher::Task::willNeed()
+{
+  // the readers go through the contents of all sections next
+  uint64_t begin = (uint64_t)-1, end = 0;
+  const ELFInputTables::SectionList& sections = m_Tables.sections();
+  ELFInputTables::SectionList::const_iterator sect, sectEnd = sections.end();
+  for (sect = sections.begin(); sect != sectEnd; ++sect) {
+    if (llvm::ELF::SHT_NOBITS == sect->sh_type || 0 == sect->sh_size)
+      continue;
+    if (sect->sh_offset < begin)
+      begin = sect->sh_offset;
+    if (sect->sh_offset + sect->sh_size > end)
+      end = sect->sh_offset + sect->sh_size;
+  }
+
+  if (begin < end)
+    Space::WillNeed(*m_Area.wholeFile(), m_FileOffset + begin, end - begin);
+}
+
+//===----------------------------------------------------------------------===//
+// InputPrefetcher
+//===----------------------------------------------------------------------===//
+InputPrefetcher::InputPrefetcher(unsigned int pNumOfThreads)
+  : m_Pool(pNumOfThreads) {
+}
+
+InputPrefetcher::~InputPrefetcher()
+{
+  release();
+  TaskList::iterator task, tEnd = m_Tasks.end();
+  for (task = m_Tasks.begin(); task != tEnd; ++task)
+    delete *task;
+}
+
+void InputPrefetcher::add(Input& pInput)
+{
+  MemoryArea* area = pInput.memArea();
+  if (NULL == area || !area->hasHandler())
+    return;
+
+  // the same file may be given twice. Both inputs share one MemoryArea, and
+  // one task decodes the tables for both.
+  Task*& task = m_TaskMap[std::make_pair(area, pInput.fileOffset())];
+  if (NULL == task) {
+    task = new Task(*area, pInput.fileOffset());
+    m_Tasks.push_back(task);
+  }
+  task->inputs().push_back(&pInput);
+}
+
+void InputPrefetcher::load()
+{
+  TaskList::iterator task, tEnd = m_Tasks.end();
+  for (task = m_Tasks.begin(); task != tEnd; ++task)
+    m_Pool.enqueue(**task);
+  m_Pool.wait();
+
+  // Input, MemoryArea and the diagnostic engine are not thread-safe. Attach
+  // the tables, hand the spaces over and report the failures in this thread.
+  for (task = m_Tasks.begin(); task != tEnd; ++task) {
+    Task::RangeList::const_iterator range, rEnd = (*task)->failures().end();
+    for (range = (*task)->failures().begin(); range != rEnd; ++range) {
+      error(diag::err_cannot_read_file) << (*task)->area().handler()->path()
+                                        << range->first
+                                        << range->second;
+    }
+
+    Task::SpaceList::iterator space, sEnd = (*task)->spaces().end();
+    for (space = (*task)->spaces().begin(); space != sEnd; ++space) {
+      MemoryRegion* pin = (*task)->area().adopt(**space);
+      m_Pins.push_back(std::make_pair(&(*task)->area(), pin));
+    }
+    (*task)->spaces().clear();
+
+    if (!(*task)->isDecoded())
+      continue;
+    Task::InputList::iterator input, iEnd = (*task)->inputs().end();
+    for (input = (*task)->inputs().begin(); input != iEnd; ++input)
+      (*input)->setELFTables(&(*task)->tables());
+  }
+}
+
+void InputPrefetcher::release()
+{
+  TaskList::iterator task, tEnd = m_Tasks.end();
+  for (task = m_Tasks.begin(); task != tEnd; ++task) {
+    Task::InputList::iterator input, iEnd = (*task)->inputs().end();
+    for (input = (*task)->inputs().begin(); input != iEnd; ++input)
+      (*input)->setELFTables(NULL);
+  }
+
+  PinList::iterator pin, pEnd = m_Pins.end();
+  for (pin = m_Pins.begin(); pin != pEnd; ++pin)
+    pin->first->release(pin->second);
+  m_Pins.clear();
+}
+
@@ -8,16 +8,10 @@
 //===----------------------------------------------------------------------===//
 #include <mcld/LD/LDSection.h>
 
-#include <mcld/Support/GCFactory.h>
-
-#include <llvm/Support/ManagedStatic.h>
+#include <mcld/LinkContext.h>
 
 using namespace mcld;
 
-typedef GCFactory<LDSection, MCLD_SECTIONS_PER_INPUT> SectionFactory;
-
-static llvm::ManagedStatic<SectionFactory> g_SectFactory;
-
 //===----------------------------------------------------------------------===//
 // LDSection
 //===----------------------------------------------------------------------===//
@@ -32,6 +26,7 @@ LDSection::LDSection()
     m_Align(0),
     m_Info(0),
     m_pLink(NULL),
+    m_EntSize(0),
     m_Index(0) {
   m_Data.sect_data = NULL;
 }
@@ -52,6 +47,7 @@ LDSection::LDSection(const std::string& pName,
     m_Align(0),
     m_Info(0),
     m_pLink(NULL),
+    m_EntSize(0),
     m_Index(0) {
   m_Data.sect_data = NULL;
 }
@@ -72,21 +68,21 @@ LDSection* LDSection::Create(const std::string& pName,
                              uint64_t pSize,
                              uint64_t pAddr)
 {
-  LDSection* result = g_SectFactory->allocate();
+  LDSection* result = LinkContext::current().getSectionFactory().allocate();
   new (result) LDSection(pName, pKind, pType, pFlag, pSize, pAddr);
   return result;
 }
 
 void LDSection::Destroy(LDSection*& pSection)
 {
-  g_SectFactory->destroy(pSection);
-  g_SectFactory->deallocate(pSection);
+  LinkContext::current().getSectionFactory().destroy(pSection);
+  LinkContext::current().getSectionFactory().deallocate(pSection);
   pSection = NULL;
 }
 
 void LDSection::Clear()
 {
-  g_SectFactory->clear();
+  LinkContext::current().getSectionFactory().clear();
 }
 
 bool LDSection::hasSectionData() const
@@ -11,7 +11,7 @@
 #include <mcld/Config/Config.h>
 #include <mcld/Fragment/FragmentRef.h>
 #include <mcld/Fragment/NullFragment.h>
-#include <mcld/Support/GCFactory.h>
+#include <mcld/LinkContext.h>
 
 #include <cstring>
 
@@ -19,11 +19,8 @@
 
 using namespace mcld;
 
-typedef GCFactory<LDSymbol, MCLD_SYMBOLS_PER_INPUT> LDSymbolFactory;
-
 static llvm::ManagedStatic<LDSymbol> g_NullSymbol;
 static llvm::ManagedStatic<NullFragment> g_NullSymbolFragment;
-static llvm::ManagedStatic<LDSymbolFactory> g_LDSymbolFactory;
 
 //===----------------------------------------------------------------------===//
 // LDSymbol
@@ -52,7 +49,7 @@ LDSymbol& LDSymbol::operator=(const LDSymbol& pCopy)
 
 LDSymbol* LDSymbol::Create(ResolveInfo& pResolveInfo)
 {
-  LDSymbol* result = g_LDSymbolFactory->allocate();
+  LDSymbol* result = LinkContext::current().getLDSymbolFactory().allocate();
   new (result) LDSymbol();
   result->setResolveInfo(pResolveInfo);
   return result;
@@ -61,21 +58,23 @@ LDSymbol* LDSymbol::Create(ResolveInfo& pResolveInfo)
 void LDSymbol::Destroy(LDSymbol*& pSymbol)
 {
   pSymbol->~LDSymbol();
-  g_LDSymbolFactory->deallocate(pSymbol);
+  LinkContext::current().getLDSymbolFactory().deallocate(pSymbol);
   pSymbol = NULL;
 }
 
 void LDSymbol::Clear()
 {
-  g_LDSymbolFactory->clear();
+  LinkContext::current().getLDSymbolFactory().clear();
 }
 
 LDSymbol* LDSymbol::Null()
 {
-  // lazy initialization
+  // lazy initialization. The null symbol outlives every link, so its
+  // fragment reference is not allocated from a LinkContext.
+  static FragmentRef null_frag_ref(*g_NullSymbolFragment, 0);
   if (NULL == g_NullSymbol->resolveInfo()) {
     g_NullSymbol->setResolveInfo(*ResolveInfo::Null());
-    g_NullSymbol->setFragmentRef(FragmentRef::Create(*g_NullSymbolFragment, 0));
+    g_NullSymbol->setFragmentRef(&null_frag_ref);
     ResolveInfo::Null()->setSymPtr(&*g_NullSymbol);
   }
   return &*g_NullSymbol;
@@ -0,0 +1,639 @@
+//===- MergeableSectionOptimizer.cpp --------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LD/MergeableSectionOptimizer.h>
+#include <mcld/Fragment/Fragment.h>
+#include <mcld/Fragment/FragmentRef.h>
+#include <mcld/Fragment/NullFragment.h>
+#include <mcld/Fragment/RegionFragment.h>
+#include <mcld/Fragment/Relocation.h>
+#include <mcld/IRBuilder.h>
+#include <mcld/LD/LDContext.h>
+#include <mcld/LD/LDFileFormat.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/NamePool.h>
+#include <mcld/LD/RelocData.h>
+#include <mcld/LD/ResolveInfo.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/LinkerConfig.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Module.h>
+#include <mcld/Support/MemoryRegion.h>
+#include <mcld/Support/ThreadPool.h>
+
+#include <llvm/Support/Casting.h>
+#include <llvm/Support/ELF.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// non-member functions
+//===----------------------------------------------------------------------===//
+namespace {
+
+template<typename T>
+void append(std::string& pKey, T pValue)
+{
+  pKey.append(reinterpret_cast<const char*>(&pValue), sizeof(T));
+}
+
+bool IsZero(const char* pData, uint64_t pSize)
+{
+  for (uint64_t i = 0; i < pSize; ++i) {
+    if ('\0' != pData[i])
+      return false;
+  }
+  return true;
+}
+
+/// TailCompare - order the strings by their reversed contents, and put a
+/// string before its tails.
+class TailCompare
+{
+public:
+  TailCompare(const std::vector<llvm::StringRef>& pContents)
+    : m_Contents(pContents) {
+  }
+
+  bool operator()(size_t pX, size_t pY) const
+  {
+    const llvm::StringRef& x = m_Contents[pX];
+    const llvm::StringRef& y = m_Contents[pY];
+    size_t i = x.size(), j = y.size();
+    while (0 != i && 0 != j) {
+      --i;
+      --j;
+      if (x[i] != y[j])
+        return ((unsigned char)x[i] > (unsigned char)y[j]);
+    }
+    return (x.size() > y.size());
+  }
+
+private:
+  const std::vector<llvm::StringRef>& m_Contents;
+};
+
+} // anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// MergeableSectionOptimizer::PieceTask
+//===----------------------------------------------------------------------===//
+/// PieceTask - split a member into pieces, or merge the pieces of a group.
+/// The tasks only write their own members and groups.
+class MergeableSectionOptimizer::PieceTask : public ThreadPool::Task
+{
+public:
+  enum Kind {
+    Split,
+    Merge
+  };
+
+public:
+  PieceTask(MergeableSectionOptimizer& pOptimizer, Kind pKind, size_t pIdx)
+    : m_Optimizer(pOptimizer), m_Kind(pKind), m_Idx(pIdx) {
+  }
+
+  void run()
+  {
+    if (Split == m_Kind)
+      m_Optimizer.splitMember(m_Idx);
+    else
+      m_Optimizer.mergeGroup(m_Idx);
+  }
+
+private:
+  MergeableSectionOptimizer& m_Optimizer;
+  Kind m_Kind;
+  size_t m_Idx;
+};
+
+//===----------------------------------------------------------------------===//
+// MergeableSectionOptimizer
+//===----------------------------------------------------------------------===//
+MergeableSectionOptimizer::MergeableSectionOptimizer(
+                                                 const LinkerConfig& pConfig,
+                                                 Module& pModule)
+  : m_Config(pConfig), m_Module(pModule), m_MemberIndex(256),
+    m_NumOfRemovedPieces(0), m_NumOfRemovedBytes(0) {
+}
+
+MergeableSectionOptimizer::~MergeableSectionOptimizer()
+{
+}
+
+bool MergeableSectionOptimizer::run()
+{
+  // the output of -r keeps all pieces, since it may be linked again.
+  if (LinkerConfig::Object == m_Config.codeGenType())
+    return true;
+
+  collectSections();
+  if (m_Members.empty())
+    return true;
+  collectRelocations();
+
+  // 1. split the members, and 2. find the unique pieces of each group. Both
+  // only read the input regions, so they run in parallel.
+  ThreadPool pool(m_Config.options().numThreads());
+  std::vector<PieceTask*> tasks;
+  for (size_t i = 0; i < m_Members.size(); ++i) {
+    tasks.push_back(new PieceTask(*this, PieceTask::Split, i));
+    pool.enqueue(*tasks.back());
+  }
+  pool.wait();
+
+  for (size_t i = 0; i < m_Groups.size(); ++i) {
+    tasks.push_back(new PieceTask(*this, PieceTask::Merge, i));
+    pool.enqueue(*tasks.back());
+  }
+  pool.wait();
+
+  for (size_t i = 0; i < tasks.size(); ++i)
+    delete tasks[i];
+
+  // 3. rewrite the members, and then move the symbols and the relocations
+  for (size_t i = 0; i < m_Members.size(); ++i)
+    rewrite(i);
+
+  Module::obj_iterator obj, objEnd = m_Module.obj_end();
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    LDContext* context = (*obj)->context();
+    for (size_t i = 0; i < context->numOfSymbols(); ++i) {
+      if (NULL != context->getSymbol(i))
+        redirect(*context->getSymbol(i));
+    }
+  }
+
+  Module::SymbolTable& sym_tab = m_Module.getSymbolTable();
+  Module::SymbolTable::iterator sym, symEnd = sym_tab.end();
+  for (sym = sym_tab.begin(); sym != symEnd; ++sym)
+    redirect(**sym);
+
+  std::vector<SectionReloc>::const_iterator reloc, rEnd = m_Relocs.end();
+  for (reloc = m_Relocs.begin(); reloc != rEnd; ++reloc)
+    redirect(*reloc);
+
+  // 4. nothing refers to the replaced region fragments now
+  std::vector<Member>::iterator member, mEnd = m_Members.end();
+  for (member = m_Members.begin(); member != mEnd; ++member) {
+    if (member->merged && member->runs.front().frag != member->frag) {
+      delete member->frag;
+      member->frag = NULL;
+    }
+  }
+  return true;
+}
+
+/// collectSections - the mergeable sections are read as a region fragment
+/// followed by null fragments. The pieces are not aligned in the output, so
+/// the sections aligned more than their entries are left as they are.
+void MergeableSectionOptimizer::collectSections()
+{
+  GroupHashTableType group_index(16);
+  Module::obj_iterator obj, objEnd = m_Module.obj_end();
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    LDContext::sect_iterator sect, sectEnd = (*obj)->context()->sectEnd();
+    for (sect = (*obj)->context()->sectBegin(); sect != sectEnd; ++sect) {
+      LDSection* section = *sect;
+      if (LDFileFormat::Regular != section->kind() &&
+          LDFileFormat::Debug != section->kind())
+        continue;
+      if (0x0 == (section->flag() & llvm::ELF::SHF_MERGE) ||
+          0x0 == section->entSize() ||
+          section->align() > section->entSize() ||
+          0x0 != (section->size() % section->entSize()) ||
+          !section->hasSectionData() ||
+          section->getSectionData()->empty())
+        continue;
+
+      SectionData* data = section->getSectionData();
+      RegionFragment* frag = llvm::dyn_cast<RegionFragment>(&data->front());
+      if (NULL == frag || frag->size() != section->size())
+        continue;
+
+      bool regular = true;
+      SectionData::iterator tail, tailEnd = data->end();
+      for (tail = ++data->begin(); tail != tailEnd; ++tail) {
+        if (Fragment::Null != tail->getKind())
+          regular = false;
+      }
+      if (!regular)
+        continue;
+
+      std::string key(section->name());
+      key.push_back('\0');
+      append(key, section->flag());
+      append(key, section->entSize());
+      if (key.size() >= 0xFFFF)
+        continue;
+
+      bool exist = false;
+      GroupHashTableType::entry_type* entry = group_index.insert(key, exist);
+      if (!exist) {
+        entry->setValue(m_Groups.size());
+        m_Groups.push_back(Group());
+        m_Groups.back().entsize = section->entSize();
+        m_Groups.back().strings =
+                         (0x0 != (section->flag() & llvm::ELF::SHF_STRINGS));
+      }
+
+      Member member;
+      member.section = section;
+      member.frag = frag;
+      member.group = entry->value();
+      member.merged = true;
+      member.symbol = NULL;
+
+      FragHashEntryType* index = m_MemberIndex.insert(frag, exist);
+      index->setValue(m_Members.size());
+      m_Groups[member.group].members.push_back(m_Members.size());
+      m_Members.push_back(member);
+    }
+  }
+}
+
+/// collectRelocations - the addend of a RELA relocation with a section
+/// symbol selects the piece. The addend of a REL relocation is in the
+/// relocated place, which is not rewritten, so such a member is kept.
+void MergeableSectionOptimizer::collectRelocations()
+{
+  size_t idx = 0;
+  Module::obj_iterator obj, objEnd = m_Module.obj_end();
+  for (obj = m_Module.obj_begin(); obj != objEnd; ++obj) {
+    LDContext::sect_iterator rs, rsEnd = (*obj)->context()->relocSectEnd();
+    for (rs = (*obj)->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+      if (LDFileFormat::Ignore == (*rs)->kind() || !(*rs)->hasRelocData())
+        continue;
+
+      const LDSection* target = (*rs)->getLink();
+      if (NULL != target &&
+          (LDFileFormat::Regular == target->kind() ||
+           LDFileFormat::Debug == target->kind()) &&
+          target->hasSectionData() &&
+          !target->getSectionData()->empty() &&
+          getMember(&target->getSectionData()->front(), idx))
+        m_Members[idx].merged = false;
+
+      bool is_rel = (llvm::ELF::SHT_REL == (*rs)->type());
+      RelocData* data = (*rs)->getRelocData();
+      RelocData::iterator reloc, rEnd = data->end();
+      for (reloc = data->begin(); reloc != rEnd; ++reloc) {
+        Relocation* relocation = llvm::cast<Relocation>(reloc);
+        ResolveInfo* info = relocation->symInfo();
+        if (NULL == info || ResolveInfo::Section != info->type() ||
+            NULL == info->outSymbol() || !info->outSymbol()->hasFragRef())
+          continue;
+
+        const FragmentRef* ref = info->outSymbol()->fragRef();
+        if (!getMember(ref->frag(), idx))
+          continue;
+
+        uint64_t offset = ref->offset() + relocation->addend();
+        if (is_rel || offset >= m_Members[idx].section->size()) {
+          m_Members[idx].merged = false;
+          continue;
+        }
+
+        SectionReloc entry = { relocation, idx, offset };
+        m_Relocs.push_back(entry);
+      }
+    }
+  }
+}
+
+/// splitMember - a string ends with an entry of zeros. A string section
+/// which does not end with a whole string is left as is.
+void MergeableSectionOptimizer::splitMember(size_t pIdx)
+{
+  Member& member = m_Members[pIdx];
+  if (!member.merged)
+    return;
+
+  const Group& group = m_Groups[member.group];
+  const char* data =
+           reinterpret_cast<const char*>(member.frag->getRegion().start());
+  uint64_t size = member.section->size();
+
+  StringHash<XX> hash_func;
+  uint64_t offset = 0;
+  while (offset < size) {
+    uint64_t end = offset + group.entsize;
+    if (group.strings) {
+      if (1 == group.entsize) {
+        const void* nul = memchr(data + offset, '\0', size - offset);
+        end = (NULL == nul) ? size + 1 :
+              (reinterpret_cast<const char*>(nul) - data + 1);
+      }
+      else {
+        while (end <= size && !IsZero(data + end - group.entsize,
+                                      group.entsize))
+          end += group.entsize;
+      }
+
+      if (end > size) {
+        member.merged = false;
+        member.pieces.clear();
+        return;
+      }
+    }
+
+    Piece piece;
+    piece.offset = offset;
+    piece.size = end - offset;
+    piece.hash = hash_func(llvm::StringRef(data + offset, piece.size));
+    piece.unique = 0;
+    member.pieces.push_back(piece);
+    offset = end;
+  }
+}
+
+/// mergeGroup - the unique pieces are laid out in the order of the members,
+/// so the first one of the same contents is kept. The groups are merged in
+/// parallel, but the pieces of one group are not, so a dominant group such
+/// as .debug_str is merged by one thread.
+void MergeableSectionOptimizer::mergeGroup(size_t pIdx)
+{
+  Group& group = m_Groups[pIdx];
+  PieceHashTableType index(1024);
+  std::vector<size_t>::const_iterator m, mEnd = group.members.end();
+  for (m = group.members.begin(); m != mEnd; ++m) {
+    Member& member = m_Members[*m];
+    if (!member.merged)
+      continue;
+
+    for (size_t p = 0; p < member.pieces.size(); ++p) {
+      Piece& piece = member.pieces[p];
+      bool exist = false;
+      PieceHashEntryType* entry =
+               index.insert(getContents(member, piece), exist, piece.hash);
+      if (!exist) {
+        Unique unique = { *m, p, group.uniques.size(), 0, 0 };
+        entry->setValue(group.uniques.size());
+        group.uniques.push_back(unique);
+      }
+      piece.unique = entry->value();
+    }
+  }
+
+  if (group.strings && m_Config.options().tailMergeStrings())
+    tailMerge(group);
+
+  for (m = group.members.begin(); m != mEnd; ++m) {
+    Member& member = m_Members[*m];
+    if (!member.merged)
+      continue;
+
+    uint64_t offset = 0;
+    for (size_t p = 0; p < member.pieces.size(); ++p) {
+      Unique& unique = group.uniques[member.pieces[p].unique];
+      if (unique.member == *m && unique.piece == p &&
+          unique.root == member.pieces[p].unique) {
+        unique.offset = offset;
+        offset += member.pieces[p].size;
+      }
+    }
+  }
+}
+
+/// tailMerge - after sorting, the tails of a string follow it, so a string
+/// is compared with the last string which is not a tail.
+void MergeableSectionOptimizer::tailMerge(Group& pGroup)
+{
+  if (pGroup.uniques.empty())
+    return;
+
+  std::vector<llvm::StringRef> contents(pGroup.uniques.size());
+  std::vector<size_t> order(pGroup.uniques.size());
+  for (size_t i = 0; i < pGroup.uniques.size(); ++i) {
+    const Member& member = m_Members[pGroup.uniques[i].member];
+    contents[i] = getContents(member,
+                              member.pieces[pGroup.uniques[i].piece]);
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), TailCompare(contents));
+
+  size_t root = order[0];
+  for (size_t i = 1; i < order.size(); ++i) {
+    const llvm::StringRef& string = contents[order[i]];
+    uint64_t delta = contents[root].size() - string.size();
+    if (string.size() < contents[root].size() &&
+        0 == (delta % pGroup.entsize) &&
+        contents[root].endswith(string)) {
+      pGroup.uniques[order[i]].root = root;
+      pGroup.uniques[order[i]].delta = delta;
+      continue;
+    }
+    root = order[i];
+  }
+}
+
+/// rewrite - the kept pieces replace the region fragment, and the null
+/// fragments after it move to the new end of the section.
+void MergeableSectionOptimizer::rewrite(size_t pIdx)
+{
+  Member& member = m_Members[pIdx];
+  if (!member.merged)
+    return;
+
+  const Group& group = m_Groups[member.group];
+  std::vector<bool> kept(member.pieces.size(), false);
+  bool changed = false;
+  for (size_t p = 0; p < member.pieces.size(); ++p) {
+    const Unique& unique = group.uniques[member.pieces[p].unique];
+    kept[p] = (unique.member == pIdx && unique.piece == p &&
+               unique.root == member.pieces[p].unique);
+    if (!kept[p]) {
+      changed = true;
+      ++m_NumOfRemovedPieces;
+      m_NumOfRemovedBytes += member.pieces[p].size;
+    }
+  }
+
+  if (!changed) {
+    Run run = { 0, member.frag };
+    member.runs.push_back(run);
+    return;
+  }
+
+  SectionData* data = member.section->getSectionData();
+  SectionData::iterator tail(member.frag);
+  ++tail;
+  data->getFragmentList().remove(SectionData::iterator(member.frag));
+
+  uint8_t* start = member.frag->getRegion().start();
+  uint64_t offset = 0;
+  size_t p = 0;
+  while (p < member.pieces.size()) {
+    if (!kept[p]) {
+      ++p;
+      continue;
+    }
+
+    uint64_t begin = member.pieces[p].offset, size = 0;
+    while (p < member.pieces.size() && kept[p])
+      size += member.pieces[p++].size;
+
+    Run run = { offset, IRBuilder::CreateRegion(start + begin, size) };
+    run.frag->setParent(data);
+    run.frag->setOffset(offset);
+    data->getFragmentList().insert(tail, run.frag);
+    member.runs.push_back(run);
+    offset += size;
+  }
+
+  if (member.runs.empty()) {
+    Run run = { 0, new NullFragment() };
+    run.frag->setParent(data);
+    run.frag->setOffset(0);
+    data->getFragmentList().insert(tail, run.frag);
+    member.runs.push_back(run);
+  }
+
+  for (SectionData::iterator end = data->end(); tail != end; ++tail)
+    tail->setOffset(offset);
+  member.section->setSize(offset);
+}
+
+/// redirect - a section symbol refers to the start of its rewritten member.
+/// The other symbols refer to the kept pieces.
+void MergeableSectionOptimizer::redirect(LDSymbol& pSymbol)
+{
+  if (!pSymbol.hasFragRef())
+    return;
+
+  const FragmentRef* ref = pSymbol.fragRef();
+  size_t idx = 0;
+  if (!getMember(ref->frag(), idx) || !m_Members[idx].merged)
+    return;
+
+  Member& member = m_Members[idx];
+  if (ResolveInfo::Section == pSymbol.type()) {
+    if (NULL == member.symbol)
+      member.symbol = pSymbol.resolveInfo();
+    if (member.runs.front().frag != ref->frag())
+      pSymbol.setFragmentRef(FragmentRef::Create(*member.runs.front().frag,
+                                                 0));
+    return;
+  }
+
+  if (member.pieces.empty() || member.runs.front().frag == member.frag)
+    return;
+
+  size_t piece = getPiece(member, ref->offset());
+  size_t kept = 0;
+  uint64_t offset = 0;
+  getLocation(member, piece, kept, offset);
+  offset += ref->offset() - member.pieces[piece].offset;
+  pSymbol.setFragmentRef(getFragmentRef(m_Members[kept], offset));
+}
+
+/// redirect - the relocation refers to the section symbol of the member
+/// which keeps the piece.
+void MergeableSectionOptimizer::redirect(const SectionReloc& pReloc)
+{
+  const Member& member = m_Members[pReloc.member];
+  if (!member.merged)
+    return;
+
+  size_t piece = getPiece(member, pReloc.offset);
+  size_t kept = 0;
+  uint64_t offset = 0;
+  getLocation(member, piece, kept, offset);
+  offset += pReloc.offset - member.pieces[piece].offset;
+
+  pReloc.reloc->setSymInfo(getSectionSymbol(m_Members[kept]));
+  pReloc.reloc->setAddend(offset);
+}
+
+const llvm::StringRef
+MergeableSectionOptimizer::getContents(const Member& pMember,
+                                       const Piece& pPiece) const
+{
+  const char* data =
+          reinterpret_cast<const char*>(pMember.frag->getRegion().start());
+  return llvm::StringRef(data + pPiece.offset, pPiece.size);
+}
+
+size_t MergeableSectionOptimizer::getPiece(const Member& pMember,
+                                           uint64_t pOffset) const
+{
+  size_t low = 0, high = pMember.pieces.size();
+  while (high - low > 1) {
+    size_t mid = (low + high) / 2;
+    if (pMember.pieces[mid].offset <= pOffset)
+      low = mid;
+    else
+      high = mid;
+  }
+  return low;
+}
+
+void MergeableSectionOptimizer::getLocation(const Member& pMember,
+                                            size_t pPiece,
+                                            size_t& pKept,
+                                            uint64_t& pOffset) const
+{
+  const Group& group = m_Groups[pMember.group];
+  const Unique& unique = group.uniques[pMember.pieces[pPiece].unique];
+  const Unique& root = group.uniques[unique.root];
+  pKept = root.member;
+  pOffset = root.offset + unique.delta;
+}
+
+FragmentRef*
+MergeableSectionOptimizer::getFragmentRef(const Member& pMember,
+                                          uint64_t pOffset) const
+{
+  size_t low = 0, high = pMember.runs.size();
+  while (high - low > 1) {
+    size_t mid = (low + high) / 2;
+    if (pMember.runs[mid].offset <= pOffset)
+      low = mid;
+    else
+      high = mid;
+  }
+  const Run& run = pMember.runs[low];
+  return FragmentRef::Create(*run.frag, pOffset - run.offset);
+}
+
+/// getSectionSymbol - an assembler may omit the section symbol of a section
+/// which is only referred by the other symbols.
+ResolveInfo* MergeableSectionOptimizer::getSectionSymbol(Member& pMember)
+{
+  if (NULL != pMember.symbol)
+    return pMember.symbol;
+
+  ResolveInfo* info =
+    m_Module.getNamePool().createSymbol(pMember.section->name(),
+                                        false,
+                                        ResolveInfo::Section,
+                                        ResolveInfo::Define,
+                                        ResolveInfo::Local,
+                                        0x0);
+  LDSymbol* symbol = LDSymbol::Create(*info);
+  symbol->setFragmentRef(FragmentRef::Create(*pMember.runs.front().frag, 0));
+  info->setSymPtr(symbol);
+  pMember.symbol = info;
+  return info;
+}
+
+bool MergeableSectionOptimizer::getMember(const Fragment* pFrag,
+                                          size_t& pIdx) const
+{
+  FragHashTableType::const_iterator entry = m_MemberIndex.find(pFrag);
+  if (entry == m_MemberIndex.end())
+    return false;
+  pIdx = entry.getEntry()->value();
+  return true;
+}
+
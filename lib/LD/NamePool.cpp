@@ -12,11 +12,41 @@
 
 using namespace mcld;
 
+//===----------------------------------------------------------------------===//
+// Non-member functions
+//===----------------------------------------------------------------------===//
+/// hash_name - hash a name once. The value picks the shard and is handed to
+/// the table of the shard.
+static inline unsigned int hash_name(const llvm::StringRef& pName)
+{
+  return NamePool::Table::hasher()(pName);
+}
+
+//===----------------------------------------------------------------------===//
+// NamePool::InfoFactory
+//===----------------------------------------------------------------------===//
+ResolveInfo* NamePool::InfoFactory::produce(const key_type& pKey)
+{
+  if (m_bStableName)
+    return ResolveInfo::Create(m_Arena.allocate(), pKey);
+  return ResolveInfo::Create(pKey);
+}
+
+void NamePool::InfoFactory::destroy(entry_type*& pEntry)
+{
+  // the entries in the arena are released along with the arena
+  if (pEntry->isNameBorrowed())
+    pEntry = NULL;
+  else
+    ResolveInfo::Destroy(pEntry);
+}
+
 //===----------------------------------------------------------------------===//
 // NamePool
 //===----------------------------------------------------------------------===//
 NamePool::NamePool(NamePool::size_type pSize)
-  : m_pResolver(new StaticResolver()), m_Table(pSize) {
+  : m_pResolver(new StaticResolver()) {
+  reserve(pSize);
 }
 
 NamePool::~NamePool()
@@ -36,18 +66,31 @@ ResolveInfo* NamePool::createSymbol(const llvm::StringRef& pName,
                                     ResolveInfo::Desc pDesc,
                                     ResolveInfo::Binding pBinding,
                                     ResolveInfo::SizeType pSize,
-                                    ResolveInfo::Visibility pVisibility)
+                                    ResolveInfo::Visibility pVisibility,
+                                    bool pStableName)
 {
-  ResolveInfo** result = m_FreeInfoSet.allocate();
-  (*result) = ResolveInfo::Create(pName);
-  (*result)->setIsSymbol(true);
-  (*result)->setSource(pIsDyn);
-  (*result)->setType(pType);
-  (*result)->setDesc(pDesc);
-  (*result)->setBinding(pBinding);
-  (*result)->setVisibility(pVisibility);
-  (*result)->setSize(pSize);
-  return *result;
+  ResolveInfo* result = NULL;
+  if (pStableName) {
+    Mutex::Guard guard(m_FreeInfoLock);
+    result = ResolveInfo::Create(m_FreeInfoArena.allocate(), pName);
+  }
+  else {
+    ResolveInfo** slot = NULL;
+    {
+      Mutex::Guard guard(m_FreeInfoLock);
+      slot = m_FreeInfoSet.allocate();
+    }
+    (*slot) = ResolveInfo::Create(pName);
+    result = *slot;
+  }
+  result->setIsSymbol(true);
+  result->setSource(pIsDyn);
+  result->setType(pType);
+  result->setDesc(pDesc);
+  result->setBinding(pBinding);
+  result->setVisibility(pVisibility);
+  result->setSize(pSize);
+  return result;
 }
 
 /// insertSymbol - insert a symbol and resolve it immediately
@@ -61,17 +104,29 @@ void NamePool::insertSymbol(const llvm::StringRef& pName,
                               ResolveInfo::SizeType pSize,
                               ResolveInfo::Visibility pVisibility,
                               ResolveInfo* pOldInfo,
-                              Resolver::Result& pResult)
+                              Resolver::Result& pResult,
+                              bool pStableName)
 {
   // We should check if there is any symbol with the same name existed.
   // If it already exists, we should use resolver to decide which symbol
   // should be reserved. Otherwise, we insert the symbol and set up its
   // attributes.
+  unsigned int hash = hash_name(pName);
+  Shard& shard = getShard(hash);
+  Mutex::Guard guard(shard.lock);
+
   bool exist = false;
-  ResolveInfo* old_symbol = m_Table.insert(pName, exist);
+  shard.table.getEntryFactory().setStableName(pStableName);
+  ResolveInfo* old_symbol = shard.table.insert(pName, exist, hash);
+  shard.table.getEntryFactory().setStableName(false);
+
+  // the new symbol of an existent name lives only during the resolution. It
+  // is placed on the stack and borrows the name of the old symbol.
+  InfoSlot new_slot;
   ResolveInfo* new_symbol = NULL;
   if (exist && old_symbol->isSymbol()) {
-    new_symbol = m_Table.getEntryFactory().produce(pName);
+    new_symbol = ResolveInfo::Create(&new_slot,
+                   llvm::StringRef(old_symbol->name(), old_symbol->nameSize()));
   }
   else {
     exist = false;
@@ -108,44 +163,93 @@ void NamePool::insertSymbol(const llvm::StringRef& pName,
     pResult.overriden = override;
   }
   else {
+      // resolveAgain runs with the shard locked. It must not insert the
+      // same name again.
       m_pResolver->resolveAgain(*this, action, *old_symbol, *new_symbol, pResult);
   }
-
-  m_Table.getEntryFactory().destroy(new_symbol);
   return;
 }
 
 llvm::StringRef NamePool::insertString(const llvm::StringRef& pString)
 {
+  unsigned int hash = hash_name(pString);
+  Shard& shard = getShard(hash);
+  Mutex::Guard guard(shard.lock);
+
   bool exist = false;
-  ResolveInfo* resolve_info = m_Table.insert(pString, exist);
+  ResolveInfo* resolve_info = shard.table.insert(pString, exist, hash);
   return llvm::StringRef(resolve_info->name(), resolve_info->nameSize());
 }
 
 void NamePool::reserve(NamePool::size_type pSize)
 {
-  m_Table.rehash(pSize);
+  size_type shard_size = pSize / MCLD_NAMEPOOL_SHARDS + 1;
+  for (unsigned int i = 0; i < MCLD_NAMEPOOL_SHARDS; ++i) {
+    Mutex::Guard guard(m_Shards[i].lock);
+    if (m_Shards[i].table.numOfBuckets() < shard_size)
+      m_Shards[i].table.rehash(shard_size);
+  }
 }
 
 NamePool::size_type NamePool::capacity() const
 {
-  return (m_Table.numOfBuckets() - m_Table.numOfEntries());
+  size_type result = 0;
+  for (unsigned int i = 0; i < MCLD_NAMEPOOL_SHARDS; ++i) {
+    result += m_Shards[i].table.numOfBuckets() -
+              m_Shards[i].table.numOfEntries();
+  }
+  return result;
+}
+
+NamePool::size_type NamePool::size() const
+{
+  size_type result = 0;
+  for (unsigned int i = 0; i < MCLD_NAMEPOOL_SHARDS; ++i)
+    result += m_Shards[i].table.numOfEntries();
+  return result;
+}
+
+bool NamePool::empty() const
+{
+  for (unsigned int i = 0; i < MCLD_NAMEPOOL_SHARDS; ++i) {
+    if (!m_Shards[i].table.empty())
+      return false;
+  }
+  return true;
 }
 
 /// findInfo - find the resolved ResolveInfo
 ResolveInfo* NamePool::findInfo(const llvm::StringRef& pName)
 {
-  Table::iterator iter = m_Table.find(pName);
+  unsigned int hash = hash_name(pName);
+  Shard& shard = getShard(hash);
+  Mutex::Guard guard(shard.lock);
+  Table::iterator iter = shard.table.find(pName, hash);
   return iter.getEntry();
 }
 
 /// findInfo - find the resolved ResolveInfo
 const ResolveInfo* NamePool::findInfo(const llvm::StringRef& pName) const
 {
-  Table::const_iterator iter = m_Table.find(pName);
+  unsigned int hash = hash_name(pName);
+  const Shard& shard = getShard(hash);
+  Mutex::Guard guard(shard.lock);
+  Table::const_iterator iter = shard.table.find(pName, hash);
   return iter.getEntry();
 }
 
+/// getShard - the buckets take the hash value modulo a prime, so the shards
+/// take the high bits to stay independent of the buckets.
+NamePool::Shard& NamePool::getShard(unsigned int pHash)
+{
+  return m_Shards[(pHash >> 16) % MCLD_NAMEPOOL_SHARDS];
+}
+
+const NamePool::Shard& NamePool::getShard(unsigned int pHash) const
+{
+  return m_Shards[(pHash >> 16) % MCLD_NAMEPOOL_SHARDS];
+}
+
 /// findSymbol - find the resolved output LDSymbol
 LDSymbol* NamePool::findSymbol(const llvm::StringRef& pName)
 {
@@ -7,16 +7,10 @@
 //
 //===----------------------------------------------------------------------===//
 #include <mcld/LD/RelocData.h>
-#include <mcld/Support/GCFactory.h>
-
-#include <llvm/Support/ManagedStatic.h>
+#include <mcld/LinkContext.h>
 
 using namespace mcld;
 
-typedef GCFactory<RelocData, MCLD_SECTIONS_PER_INPUT> RelocDataFactory;
-
-static llvm::ManagedStatic<RelocDataFactory> g_RelocDataFactory;
-
 //===----------------------------------------------------------------------===//
 // RelocData
 //===----------------------------------------------------------------------===//
@@ -30,7 +24,7 @@ RelocData::RelocData(LDSection &pSection)
 
 RelocData* RelocData::Create(LDSection& pSection)
 {
-  RelocData* result = g_RelocDataFactory->allocate();
+  RelocData* result = LinkContext::current().getRelocDataFactory().allocate();
   new (result) RelocData(pSection);
   return result;
 }
@@ -38,13 +32,13 @@ RelocData* RelocData::Create(LDSection& pSection)
 void RelocData::Destroy(RelocData*& pSection)
 {
   pSection->~RelocData();
-  g_RelocDataFactory->deallocate(pSection);
+  LinkContext::current().getRelocDataFactory().deallocate(pSection);
   pSection = NULL;
 }
 
 void RelocData::Clear()
 {
-  g_RelocDataFactory->clear();
+  LinkContext::current().getRelocDataFactory().clear();
 }
 
 RelocData& RelocData::append(Relocation& pRelocation)
@@ -7,6 +7,8 @@
 //
 //===----------------------------------------------------------------------===//
 #include <mcld/LD/Relocator.h>
+#include <mcld/LD/ResolveInfo.h>
+#include <mcld/Support/MsgHandling.h>
 
 using namespace mcld;
 
@@ -17,3 +19,33 @@ Relocator::~Relocator()
 {
 }
 
+void Relocator::report(Result pResult, const Relocation& pRelocation) const
+{
+  switch (pResult) {
+    case OK: {
+      // do nothing
+      return;
+    }
+    case Overflow: {
+      error(diag::result_overflow) << getName(pRelocation.type())
+                                   << pRelocation.symInfo()->name();
+      return;
+    }
+    case BadReloc: {
+      error(diag::result_badreloc) << getName(pRelocation.type())
+                                   << pRelocation.symInfo()->name();
+      return;
+    }
+    case Unsupport: {
+      fatal(diag::unsupported_relocation) << pRelocation.type()
+                                          << "mclinker@googlegroups.com";
+      return;
+    }
+    case Unknown: {
+      fatal(diag::unknown_relocation) << pRelocation.type()
+                                      << pRelocation.symInfo()->name();
+      return;
+    }
+  } // end of switch
+}
+
@@ -7,6 +7,7 @@
 //
 //===----------------------------------------------------------------------===//
 #include <mcld/LD/ResolveInfo.h>
+#include <cassert>
 #include <cstdlib>
 #include <cstring>
 
@@ -19,7 +20,7 @@ static ResolveInfo* g_NullResolveInfo = NULL;
 // ResolveInfo
 //===----------------------------------------------------------------------===//
 ResolveInfo::ResolveInfo()
-  : m_Size(0), m_BitField(0) {
+  : m_Size(0), m_BitField(0), m_pName("") {
   m_Ptr.sym_ptr = 0;
 }
 
@@ -233,7 +234,7 @@ bool ResolveInfo::compare(const ResolveInfo::key_type& pKey)
   size_t length = nameSize();
   if (length != pKey.size())
     return false;
-  return (0 == std::memcmp(m_Name, pKey.data(), length));
+  return (0 == std::memcmp(m_pName, pKey.data(), length));
 }
 
 //===----------------------------------------------------------------------===//
@@ -249,6 +250,18 @@ ResolveInfo* ResolveInfo::Create(const ResolveInfo::key_type& pKey)
   new (result) ResolveInfo();
   std::memcpy(result->m_Name, pKey.data(), pKey.size());
   result->m_Name[pKey.size()] = '\0';
+  result->m_pName = result->m_Name;
+  result->m_BitField &= ~ResolveInfo::RESOLVE_MASK;
+  result->m_BitField |= (pKey.size() << ResolveInfo::NAME_LENGTH_OFFSET);
+  return result;
+}
+
+ResolveInfo* ResolveInfo::Create(void* pPlace,
+                                 const ResolveInfo::key_type& pKey)
+{
+  assert('\0' == pKey.data()[pKey.size()] && "name is not a C string");
+  ResolveInfo* result = new (pPlace) ResolveInfo();
+  result->m_pName = pKey.data();
   result->m_BitField &= ~ResolveInfo::RESOLVE_MASK;
   result->m_BitField |= (pKey.size() << ResolveInfo::NAME_LENGTH_OFFSET);
   return result;
@@ -274,6 +287,7 @@ ResolveInfo* ResolveInfo::Null()
                           malloc(sizeof(ResolveInfo) + 1));
     new (g_NullResolveInfo) ResolveInfo();
     g_NullResolveInfo->m_Name[0] = '\0';
+    g_NullResolveInfo->m_pName = g_NullResolveInfo->m_Name;
     g_NullResolveInfo->m_BitField = 0x0;
     g_NullResolveInfo->setBinding(Local);
   }
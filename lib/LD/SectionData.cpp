@@ -9,16 +9,10 @@
 #include <mcld/LD/SectionData.h>
 
 #include <mcld/LD/LDSection.h>
-#include <mcld/Support/GCFactory.h>
-
-#include <llvm/Support/ManagedStatic.h>
+#include <mcld/LinkContext.h>
 
 using namespace mcld;
 
-typedef GCFactory<SectionData, MCLD_SECTIONS_PER_INPUT> SectDataFactory;
-
-static llvm::ManagedStatic<SectDataFactory> g_SectDataFactory;
-
 //===----------------------------------------------------------------------===//
 // SectionData
 //===----------------------------------------------------------------------===//
@@ -32,7 +26,7 @@ SectionData::SectionData(LDSection &pSection)
 
 SectionData* SectionData::Create(LDSection& pSection)
 {
-  SectionData* result = g_SectDataFactory->allocate();
+  SectionData* result = LinkContext::current().getSectDataFactory().allocate();
   new (result) SectionData(pSection);
   return result;
 }
@@ -40,12 +34,12 @@ SectionData* SectionData::Create(LDSection& pSection)
 void SectionData::Destroy(SectionData*& pSection)
 {
   pSection->~SectionData();
-  g_SectDataFactory->deallocate(pSection);
+  LinkContext::current().getSectDataFactory().deallocate(pSection);
   pSection = NULL;
 }
 
 void SectionData::Clear()
 {
-  g_SectDataFactory->clear();
+  LinkContext::current().getSectDataFactory().clear();
 }
 
@@ -135,6 +135,10 @@ bool InputBuilder::setMemory(Input& pInput,
   if (!memory->handler()->isGood())
     return false;
 
+  // load a read-only input at once, so its regions share one space
+  if (m_Config.options().mapWholeFiles())
+    memory->mapWholeFile();
+
   pInput.setMemArea(memory);
   return true;
 }
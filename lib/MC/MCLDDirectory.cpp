@@ -15,11 +15,11 @@ using namespace mcld::sys::fs;
 //==========================
 // MCLDDirectory
 MCLDDirectory::MCLDDirectory()
-  : Directory(), m_Name(), m_bInSysroot(false) {
+  : Directory(), m_Name(), m_bInSysroot(false), m_bIndexed(false) {
 }
 
 MCLDDirectory::MCLDDirectory(const char* pName)
-  : Directory(), m_Name(pName) {
+  : Directory(), m_Name(pName), m_bIndexed(false) {
   Directory::m_Path.assign(pName);
 
   if (!Directory::m_Path.empty())
@@ -33,7 +33,7 @@ MCLDDirectory::MCLDDirectory(const char* pName)
 }
 
 MCLDDirectory::MCLDDirectory(const std::string &pName)
-  : Directory(), m_Name(pName) {
+  : Directory(), m_Name(pName), m_bIndexed(false) {
   Directory::m_Path.assign(pName);
 
   if (!Directory::m_Path.empty())
@@ -47,7 +47,7 @@ MCLDDirectory::MCLDDirectory(const std::string &pName)
 }
 
 MCLDDirectory::MCLDDirectory(llvm::StringRef pName)
-  : Directory(), m_Name(pName.data(), pName.size()) {
+  : Directory(), m_Name(pName.data(), pName.size()), m_bIndexed(false) {
   Directory::m_Path.assign(pName.str());
 
   if (!Directory::m_Path.empty())
@@ -77,6 +77,7 @@ MCLDDirectory &MCLDDirectory::assign(llvm::StringRef pName)
   Directory::m_SymLinkStatus = FileStatus();
   Directory::m_Cache.clear();
   Directory::m_Handler = 0;
+  resetIndex();
   return (*this);
 }
 
@@ -98,6 +99,43 @@ void MCLDDirectory::setSysroot(const sys::fs::Path& pSysroot)
     Directory::m_Path.native() += old_path;
     detail::canonicalize(Directory::m_Path.native());
     detail::open_dir(*this);
+    resetIndex();
   }
 }
 
+sys::fs::Path* MCLDDirectory::find(const llvm::StringRef& pFileName)
+{
+  if (!m_bIndexed)
+    buildIndex();
+
+  IndexType::iterator entry = m_Index.find(pFileName);
+  if (entry == m_Index.end())
+    return NULL;
+  return entry.getEntry()->value();
+}
+
+void MCLDDirectory::buildIndex()
+{
+  // iterating to the end brings all entries into the cache. The keys refer to
+  // the paths in the cache, which stay until the cache is cleared.
+  size_t dir_size = Directory::m_Path.native().size();
+  iterator entry = begin(), enEnd = end();
+  for (; entry != enEnd; ++entry) {
+    const std::string& path = entry.path()->native();
+    llvm::StringRef file_name(path.data() + dir_size, path.size() - dir_size);
+
+    // keep the first one, as the linear search did
+    bool exist = false;
+    IndexEntryType* index_entry = m_Index.insert(file_name, exist);
+    if (!exist)
+      index_entry->setValue(entry.path());
+  }
+  m_bIndexed = true;
+}
+
+void MCLDDirectory::resetIndex()
+{
+  m_Index.clear();
+  m_bIndexed = false;
+}
+
@@ -24,7 +24,8 @@ Input::Input(llvm::StringRef pName)
     m_bNeeded(false),
     m_fileOffset(0),
     m_pMemArea(NULL),
-    m_pContext(NULL) {
+    m_pContext(NULL),
+    m_pELFTables(NULL) {
 }
 
 Input::Input(llvm::StringRef pName, const AttributeProxy& pProxy)
@@ -35,7 +36,8 @@ Input::Input(llvm::StringRef pName, const AttributeProxy& pProxy)
     m_bNeeded(false),
     m_fileOffset(0),
     m_pMemArea(NULL),
-    m_pContext(NULL) {
+    m_pContext(NULL),
+    m_pELFTables(NULL) {
 }
 
 Input::Input(llvm::StringRef pName,
@@ -49,7 +51,8 @@ Input::Input(llvm::StringRef pName,
     m_bNeeded(false),
     m_fileOffset(pFileOffset),
     m_pMemArea(NULL),
-    m_pContext(NULL) {
+    m_pContext(NULL),
+    m_pELFTables(NULL) {
 }
 
 Input::Input(llvm::StringRef pName,
@@ -64,7 +67,8 @@ Input::Input(llvm::StringRef pName,
     m_bNeeded(false),
     m_fileOffset(pFileOffset),
     m_pMemArea(NULL),
-    m_pContext(NULL) {
+    m_pContext(NULL),
+    m_pELFTables(NULL) {
 }
 
 Input::~Input()
@@ -10,6 +10,8 @@
 #include <mcld/MC/MCLDDirectory.h>
 #include <mcld/Support/FileSystem.h>
 
+#include <cassert>
+
 using namespace mcld;
 
 //===----------------------------------------------------------------------===//
@@ -21,6 +23,36 @@ static inline void SpecToFilename(const std::string& pSpec, std::string& pFile)
   pFile += pSpec;
 }
 
+/// FindLibrary - find the shared object or the archive of a namespec. The
+/// file names are built once, and each directory costs one or two look-ups
+/// in its index.
+static mcld::sys::fs::Path* FindLibrary(const SearchDirs::DirList& pDirList,
+                                        const std::string& pNamespec,
+                                        mcld::Input::Type pType)
+{
+  assert(Input::DynObj == pType || Input::Archive == pType);
+
+  std::string stem;
+  SpecToFilename(pNamespec, stem);
+  std::string shared = stem + mcld::sys::fs::detail::shared_library_extension;
+  std::string archive = stem + mcld::sys::fs::detail::static_library_extension;
+
+  // for all MCLDDirectorys
+  SearchDirs::DirList::const_iterator dir, dirEnd = pDirList.end();
+  for (dir = pDirList.begin(); dir != dirEnd; ++dir) {
+    mcld::sys::fs::Path* path = NULL;
+    if (Input::DynObj == pType) {
+      path = (*dir)->find(shared);
+      if (NULL != path)
+        return path;
+    }
+    path = (*dir)->find(archive);
+    if (NULL != path)
+      return path;
+  }
+  return NULL;
+}
+
 //===----------------------------------------------------------------------===//
 // SearchDirs
 //===----------------------------------------------------------------------===//
@@ -73,89 +105,14 @@ bool SearchDirs::insert(const sys::fs::Path& pPath)
   return insert(pPath.native());
 }
 
-mcld::sys::fs::Path* SearchDirs::find(const std::string& pNamespec, mcld::Input::Type pType)
+mcld::sys::fs::Path*
+SearchDirs::find(const std::string& pNamespec, mcld::Input::Type pType)
 {
-  assert(Input::DynObj == pType || Input::Archive == pType);
-
-  std::string file;
-  SpecToFilename(pNamespec, file);
-  // for all MCLDDirectorys
-  DirList::iterator mcld_dir, mcld_dir_end = m_DirList.end();
-  for (mcld_dir=m_DirList.begin(); mcld_dir!=mcld_dir_end; ++mcld_dir) {
-    // for all entries in MCLDDirectory
-    MCLDDirectory::iterator entry = (*mcld_dir)->begin();
-    MCLDDirectory::iterator enEnd = (*mcld_dir)->end();
-
-    switch(pType) {
-      case Input::DynObj: {
-        while (entry!=enEnd) {
-          if (file == entry.path()->stem().native() ) {
-            if(mcld::sys::fs::detail::shared_library_extension == entry.path()->extension().native()) {
-              return entry.path();
-            }
-          }
-          ++entry;
-        }
-      }
-      /** Fall through **/
-      case Input::Archive : {
-        entry = (*mcld_dir)->begin();
-        enEnd = (*mcld_dir)->end();
-        while ( entry!=enEnd ) {
-          if (file == entry.path()->stem().native() &&
-            mcld::sys::fs::detail::static_library_extension == entry.path()->extension().native()) {
-            return entry.path();
-          }
-          ++entry;
-        }
-      }
-      default:
-        break;
-    } // end of switch
-  } // end of while
-  return NULL;
+  return FindLibrary(m_DirList, pNamespec, pType);
 }
 
 const mcld::sys::fs::Path*
 SearchDirs::find(const std::string& pNamespec, mcld::Input::Type pType) const
 {
-  assert(Input::DynObj == pType || Input::Archive == pType);
-
-  std::string file;
-  SpecToFilename(pNamespec, file);
-  // for all MCLDDirectorys
-  DirList::const_iterator mcld_dir, mcld_dir_end = m_DirList.end();
-  for (mcld_dir=m_DirList.begin(); mcld_dir!=mcld_dir_end; ++mcld_dir) {
-    // for all entries in MCLDDirectory
-    MCLDDirectory::iterator entry = (*mcld_dir)->begin();
-    MCLDDirectory::iterator enEnd = (*mcld_dir)->end();
-
-    switch(pType) {
-      case Input::DynObj: {
-        while (entry!=enEnd) {
-          if (file == entry.path()->stem().native() ) {
-            if(mcld::sys::fs::detail::shared_library_extension == entry.path()->extension().native()) {
-              return entry.path();
-            }
-          }
-          ++entry;
-        }
-      }
-      /** Fall through **/
-      case Input::Archive : {
-        entry = (*mcld_dir)->begin();
-        enEnd = (*mcld_dir)->end();
-        while ( entry!=enEnd ) {
-          if (file == entry.path()->stem().native() &&
-            mcld::sys::fs::detail::static_library_extension == entry.path()->extension().native()) {
-            return entry.path();
-          }
-          ++entry;
-        }
-      }
-      default:
-        break;
-    } // end of switch
-  } // end of while
-  return NULL;
+  return FindLibrary(m_DirList, pNamespec, pType);
 }
@@ -22,6 +22,7 @@
 #include <mcld/Fragment/FillFragment.h>
 
 #include <llvm/Support/Casting.h>
+#include <llvm/Support/ELF.h>
 
 using namespace mcld;
 
@@ -29,7 +30,8 @@ using namespace mcld;
 // ObjectBuilder
 //===----------------------------------------------------------------------===//
 ObjectBuilder::ObjectBuilder(const LinkerConfig& pConfig, Module& pTheModule)
-  : m_Config(pConfig), m_Module(pTheModule) {
+  : m_Config(pConfig), m_Module(pTheModule), m_InputIndex(64),
+    m_OutputIndex(64), m_NumOfIndexed(0) {
 }
 
 /// CreateSection - create an output section.
@@ -51,18 +53,35 @@ LDSection* ObjectBuilder::CreateSection(const std::string& pName,
 /// MergeSection - merge the pInput section to the pOutput section
 LDSection* ObjectBuilder::MergeSection(LDSection& pInputSection)
 {
-  const SectionMap::NamePair& pair =
-              m_Config.scripts().sectionMap().find(pInputSection.name());
-  std::string output_name = (pair.isNull())?pInputSection.name():pair.to;
-  LDSection* target = m_Module.getSection(output_name);
-
-  if (NULL == target) {
-    target = LDSection::Create(output_name,
-                               pInputSection.kind(),
-                               pInputSection.type(),
-                               pInputSection.flag());
-    target->setAlign(pInputSection.align());
-    m_Module.getSectionTable().push_back(target);
+  // the input sections of the same name go to the same output section, so
+  // the section map is only looked up once for a name.
+  bool exist = false;
+  const std::string& input_name = pInputSection.name();
+  SectionIndexType::entry_type* entry = NULL;
+  if (input_name.size() < 0xFFFF)
+    entry = m_InputIndex.insert(input_name, exist);
+
+  LDSection* target = NULL;
+  if (exist) {
+    target = entry->value();
+  }
+  else {
+    const SectionMap::NamePair& pair =
+                           m_Config.scripts().sectionMap().find(input_name);
+    const std::string& output_name = (pair.isNull())?input_name:pair.to;
+    target = getOutputSection(output_name);
+
+    if (NULL == target) {
+      target = LDSection::Create(output_name,
+                                 pInputSection.kind(),
+                                 pInputSection.type(),
+                                 pInputSection.flag());
+      target->setAlign(pInputSection.align());
+      m_Module.getSectionTable().push_back(target);
+    }
+
+    if (NULL != entry)
+      entry->setValue(target);
   }
 
   switch (target->kind()) {
@@ -99,6 +118,38 @@ LDSection* ObjectBuilder::MergeSection(LDSection& pInputSection)
   return target;
 }
 
+/// getOutputSection - the sections appended to mcld::Module since the last
+/// call are indexed first. A section of a name is found by the linear search
+/// of Module::getSection, so the first one of the name wins.
+LDSection* ObjectBuilder::getOutputSection(const std::string& pName)
+{
+  Module::SectionTable& table = m_Module.getSectionTable();
+  if (table.size() < m_NumOfIndexed) {
+    // the section table is rebuilt
+    m_OutputIndex.clear();
+    m_NumOfIndexed = 0;
+  }
+
+  for (; m_NumOfIndexed < table.size(); ++m_NumOfIndexed) {
+    LDSection* sect = table[m_NumOfIndexed];
+    if (sect->name().size() >= 0xFFFF)
+      continue;
+    bool exist = false;
+    SectionIndexType::entry_type* entry =
+                                    m_OutputIndex.insert(sect->name(), exist);
+    if (!exist)
+      entry->setValue(sect);
+  }
+
+  if (pName.size() >= 0xFFFF)
+    return m_Module.getSection(pName);
+
+  SectionIndexType::iterator entry = m_OutputIndex.find(pName);
+  if (entry == m_OutputIndex.end())
+    return NULL;
+  return entry.getEntry()->value();
+}
+
 /// MoveSectionData - move the fragments of pTO section data to pTo
 bool ObjectBuilder::MoveSectionData(SectionData& pFrom, SectionData& pTo)
 {
@@ -113,6 +164,9 @@ bool ObjectBuilder::MoveSectionData(SectionData& pFrom, SectionData& pTo)
                               1u,  // the size of filled value
                               pFrom.getSection().align() - 1 // max bytes to emit
                               );
+    // the padding between functions is filled with the target's NOPs
+    if (0x0 != (pFrom.getSection().flag() & llvm::ELF::SHF_EXECINSTR))
+      align->setEmitNops(true);
     align->setOffset(offset);
     align->setParent(&pTo);
     pTo.getFragmentList().push_back(align);
@@ -161,6 +215,8 @@ uint64_t ObjectBuilder::AppendFragment(Fragment& pFrag,
                               1u,  // the size of filled value
                               pAlignConstraint - 1 // max bytes to emit
                               );
+    if (0x0 != (pSD.getSection().flag() & llvm::ELF::SHF_EXECINSTR))
+      align->setEmitNops(true);
     align->setOffset(offset);
     align->setParent(&pSD);
     pSD.getFragmentList().push_back(align);
@@ -18,7 +18,12 @@
 #include <mcld/LD/ArchiveReader.h>
 #include <mcld/LD/ObjectReader.h>
 #include <mcld/LD/DynObjReader.h>
+#include <mcld/LD/EhFrameOptimizer.h>
+#include <mcld/LD/GarbageCollection.h>
 #include <mcld/LD/GroupReader.h>
+#include <mcld/LD/IdenticalCodeFolding.h>
+#include <mcld/LD/MergeableSectionOptimizer.h>
+#include <mcld/LD/InputPrefetcher.h>
 #include <mcld/LD/BinaryReader.h>
 #include <mcld/LD/ObjectWriter.h>
 #include <mcld/LD/ResolveInfo.h>
@@ -115,8 +120,27 @@ bool ObjectLinker::initStdSections()
 
 void ObjectLinker::normalize()
 {
-  // -----  set up inputs  ----- //
   Module::input_iterator input, inEnd = m_pModule->input_end();
+
+  // -----  prefetch inputs  ----- //
+  // Decode the section tables and symbol tables of the inputs in parallel.
+  // The readers below still create sections and symbols in the order of the
+  // command line, so symbols are inserted into the NamePool in the same order
+  // as a serial link.
+  unsigned int threads = m_Config.options().numThreads();
+  if (m_Config.options().isBinaryInput())
+    threads = 1;
+
+  InputPrefetcher prefetcher(threads);
+  if (threads > 1) {
+    for (input = m_pModule->input_begin(); input!=inEnd; ++input) {
+      if (!isGroup(input) && Input::Unknown == (*input)->type())
+        prefetcher.add(**input);
+    }
+    prefetcher.load();
+  }
+
+  // -----  set up inputs  ----- //
   for (input = m_pModule->input_begin(); input!=inEnd; ++input) {
     // is a group node
     if (isGroup(input)) {
@@ -177,6 +201,8 @@ void ObjectLinker::normalize()
                                           << m_Config.targets().triple().str();
     }
   } // end of for
+
+  prefetcher.release();
 }
 
 bool ObjectLinker::linkable() const
@@ -233,6 +259,45 @@ bool ObjectLinker::readRelocations()
   return true;
 }
 
+/// dataStrippingOpt - remove the unused input sections before they are merged
+///
+/// All relocations should be read before this function.
+bool ObjectLinker::dataStrippingOpt()
+{
+  if (LinkerConfig::Object == m_Config.codeGenType())
+    return true;
+
+  // garbage collection
+  if (m_Config.options().GCSections()) {
+    GarbageCollection gc(m_Config, m_LDBackend, *m_pModule);
+    if (!gc.run())
+      return false;
+  }
+
+  // identical code folding
+  if (GeneralOptions::ICFNone != m_Config.options().getICFMode()) {
+    IdenticalCodeFolding icf(m_Config, m_LDBackend, *m_pModule);
+    if (!icf.foldIdenticalCode())
+      return false;
+  }
+
+  // remove the FDEs of the removed code and the duplicate CIEs
+  EhFrameOptimizer eh_frame_opt(m_Config, *m_pModule);
+  if (!eh_frame_opt.run())
+    return false;
+
+  // remove the duplicate strings and constants of the mergeable sections
+  MergeableSectionOptimizer merge_opt(m_Config, *m_pModule);
+  if (!merge_opt.run())
+    return false;
+  if (0 != merge_opt.numOfRemovedPieces()) {
+    note(diag::note_removed_mergeable_pieces)
+      << static_cast<unsigned long>(merge_opt.numOfRemovedPieces())
+      << static_cast<unsigned long>(merge_opt.numOfRemovedBytes());
+  }
+  return true;
+}
+
 /// mergeSections - put allinput sections into output sections
 bool ObjectLinker::mergeSections()
 {
@@ -16,6 +16,8 @@ using namespace mcld;
 
 SectionMap::NamePair SectionMap::NullName;
 
+static const size_t NoPair = static_cast<size_t>(-1);
+
 //===----------------------------------------------------------------------===//
 // SectionMap::NamePair
 //===----------------------------------------------------------------------===//
@@ -36,16 +38,26 @@ bool SectionMap::NamePair::isNull() const
 //===----------------------------------------------------------------------===//
 // SectionMap
 //===----------------------------------------------------------------------===//
+SectionMap::SectionMap()
+  : m_Wildcard(NoPair) {
+  TrieNode root = { '\0', 0, 0, NoPair };
+  m_Trie.push_back(root);
+}
+
 const SectionMap::NamePair& SectionMap::find(const std::string& pFrom) const
 {
-  unsigned int hash = SectionMap::hash(pFrom);
-  return find(pFrom, hash);
+  size_t idx = lookup(pFrom);
+  if (NoPair == idx)
+    return NullName;
+  return m_NamePairList[idx];
 }
 
 SectionMap::NamePair& SectionMap::find(const std::string& pFrom)
 {
-  unsigned int hash = SectionMap::hash(pFrom);
-  return find(pFrom, hash);
+  size_t idx = lookup(pFrom);
+  if (NoPair == idx)
+    return NullName;
+  return m_NamePairList[idx];
 }
 
 const SectionMap::NamePair&
@@ -85,9 +97,61 @@ SectionMap::NamePair& SectionMap::append(const std::string &pFrom,
   pExist = false;
   NamePair entry(pFrom, pTo);
   m_NamePairList.push_back(entry);
+  addPrefix(pFrom, m_NamePairList.size() - 1);
   return m_NamePairList.back();
 }
 
+/// lookup - the mappings matching pFrom are the wildcards and the prefixes
+/// on the path of pFrom in the trie. The first of them wins.
+size_t SectionMap::lookup(const std::string& pFrom) const
+{
+  size_t result = m_Wildcard;
+  size_t node = 0;
+  std::string::const_iterator ch, chEnd = pFrom.end();
+  for (ch = pFrom.begin(); ; ++ch) {
+    if (m_Trie[node].pair < result)
+      result = m_Trie[node].pair;
+    if (ch == chEnd)
+      break;
+
+    size_t child = m_Trie[node].child;
+    while (0 != child && *ch != m_Trie[child].ch)
+      child = m_Trie[child].sibling;
+    if (0 == child)
+      break;
+    node = child;
+  }
+  return result;
+}
+
+void SectionMap::addPrefix(const std::string& pPrefix, size_t pIdx)
+{
+  if (!pPrefix.empty() && '*' == pPrefix[0]) {
+    if (NoPair == m_Wildcard)
+      m_Wildcard = pIdx;
+    return;
+  }
+
+  size_t node = 0;
+  std::string::const_iterator ch, chEnd = pPrefix.end();
+  for (ch = pPrefix.begin(); ch != chEnd; ++ch) {
+    size_t child = m_Trie[node].child;
+    while (0 != child && *ch != m_Trie[child].ch)
+      child = m_Trie[child].sibling;
+
+    if (0 == child) {
+      TrieNode entry = { *ch, 0, m_Trie[node].child, NoPair };
+      child = m_Trie.size();
+      m_Trie.push_back(entry);
+      m_Trie[node].child = child;
+    }
+    node = child;
+  }
+
+  if (NoPair == m_Trie[node].pair)
+    m_Trie[node].pair = pIdx;
+}
+
 bool SectionMap::matched(const NamePair& pNamePair,
                          const std::string& pInput,
                          unsigned int pHashValue) const
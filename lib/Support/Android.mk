@@ -11,12 +11,15 @@ mcld_support_SRC_FILES := \
   MemoryAreaFactory.cpp \
   MemoryRegion.cpp  \
   MsgHandling.cpp \
+  Mutex.cpp \
   Path.cpp  \
   RealPath.cpp  \
   RegionFactory.cpp \
   Space.cpp \
   SystemUtils.cpp \
   TargetRegistry.cpp  \
+  ThreadLocal.cpp \
+  ThreadPool.cpp \
   ToolOutputFile.cpp  \
   raw_mem_ostream.cpp \
   raw_ostream.cpp
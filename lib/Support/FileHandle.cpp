@@ -78,7 +78,7 @@ inline static int oflag(FileHandle::OpenMode pMode)
   return result;
 }
 
-inline static bool get_size(int pHandler, unsigned int &pSize)
+inline static bool get_size(int pHandler, uint64_t &pSize)
 {
   struct ::stat file_stat;
   if (-1 == ::fstat(pHandler, &file_stat)) {
@@ -89,6 +89,14 @@ inline static bool get_size(int pHandler, unsigned int &pSize)
   return true;
 }
 
+/// is_offset - whether the 64-bit offset can be passed to the system calls,
+/// which take off_t. off_t may be 32-bit in 32-bit hosts.
+inline static bool is_offset(uint64_t pOffset)
+{
+  off_t offset = static_cast<off_t>(pOffset);
+  return (0 <= offset && static_cast<uint64_t>(offset) == pOffset);
+}
+
 bool FileHandle::open(const sys::fs::Path& pPath,
                       FileHandle::OpenMode pMode,
                       FileHandle::Permission pPerm)
@@ -159,13 +167,18 @@ bool FileHandle::close()
   return true;
 }
 
-bool FileHandle::truncate(size_t pSize)
+bool FileHandle::truncate(uint64_t pSize)
 {
   if (!isOpened() || !isWritable()) {
     setState(BadBit);
     return false;
   }
 
+  if (!is_offset(pSize)) {
+    setState(FailBit);
+    return false;
+  }
+
   if (-1 == sys::fs::detail::ftruncate(m_Handler, pSize)) {
     setState(FailBit);
     return false;
@@ -175,7 +188,28 @@ bool FileHandle::truncate(size_t pSize)
   return true;
 }
 
-bool FileHandle::read(void* pMemBuffer, size_t pStartOffset, size_t pLength)
+bool FileHandle::allocate(uint64_t pSize)
+{
+  if (!isOpened() || !isWritable()) {
+    setState(BadBit);
+    return false;
+  }
+
+  if (!is_offset(pSize)) {
+    setState(FailBit);
+    return false;
+  }
+
+  if (-1 == sys::fs::detail::fallocate(m_Handler, pSize)) {
+    setState(FailBit);
+    return false;
+  }
+
+  m_Size = pSize;
+  return true;
+}
+
+bool FileHandle::read(void* pMemBuffer, uint64_t pStartOffset, size_t pLength)
 {
   if (!isOpened() || !isReadable()) {
     setState(BadBit);
@@ -185,10 +219,16 @@ bool FileHandle::read(void* pMemBuffer, size_t pStartOffset, size_t pLength)
   if (0 == pLength)
     return true;
 
+  if (!is_offset(pStartOffset)) {
+    setState(FailBit);
+    return false;
+  }
+
+  off_t offset = static_cast<off_t>(pStartOffset);
   ssize_t read_bytes = sys::fs::detail::pread(m_Handler,
                                               pMemBuffer,
                                               pLength,
-                                              pStartOffset);
+                                              offset);
 
   if (-1 == read_bytes) {
     setState(FailBit);
@@ -198,7 +238,9 @@ bool FileHandle::read(void* pMemBuffer, size_t pStartOffset, size_t pLength)
   return true;
 }
 
-bool FileHandle::write(const void* pMemBuffer, size_t pStartOffset, size_t pLength)
+bool FileHandle::write(const void* pMemBuffer,
+                       uint64_t pStartOffset,
+                       size_t pLength)
 {
   if (!isOpened() || !isWritable()) {
     setState(BadBit);
@@ -208,11 +250,17 @@ bool FileHandle::write(const void* pMemBuffer, size_t pStartOffset, size_t pLeng
   if (0 == pLength)
     return true;
 
+  if (!is_offset(pStartOffset)) {
+    setState(FailBit);
+    return false;
+  }
+
 
+  off_t offset = static_cast<off_t>(pStartOffset);
   ssize_t write_bytes = sys::fs::detail::pwrite(m_Handler,
                                                 pMemBuffer,
                                                 pLength,
-                                                pStartOffset);
+                                                offset);
 
   if (-1 == write_bytes) {
     setState(FailBit);
@@ -222,7 +270,7 @@ bool FileHandle::write(const void* pMemBuffer, size_t pStartOffset, size_t pLeng
   return true;
 }
 
-bool FileHandle::mmap(void*& pMemBuffer, size_t pStartOffset, size_t pLength)
+bool FileHandle::mmap(void*& pMemBuffer, uint64_t pStartOffset, size_t pLength)
 {
   if (!isOpened()) {
     setState(BadBit);
@@ -232,6 +280,11 @@ bool FileHandle::mmap(void*& pMemBuffer, size_t pStartOffset, size_t pLength)
   if (0 == pLength)
     return true;
 
+  if (!is_offset(pStartOffset)) {
+    setState(FailBit);
+    return false;
+  }
+
   int prot, flag;
   if (isReadable() && !isWritable()) {
     // read-only
@@ -254,7 +307,8 @@ bool FileHandle::mmap(void*& pMemBuffer, size_t pStartOffset, size_t pLength)
     return false;
   }
 
-  pMemBuffer = ::mmap(NULL, pLength, prot, flag, m_Handler, pStartOffset);
+  pMemBuffer = ::mmap(NULL, pLength, prot, flag, m_Handler,
+                      static_cast<off_t>(pStartOffset));
 
   if (MAP_FAILED == pMemBuffer) {
     setState(FailBit);
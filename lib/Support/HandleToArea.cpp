@@ -8,87 +8,177 @@
 //===----------------------------------------------------------------------===//
 #include <mcld/Support/HandleToArea.h>
 #include <mcld/Support/MemoryArea.h>
+#include <mcld/Support/FileSystem.h>
 #include <llvm/ADT/StringRef.h>
 
 using namespace mcld;
 
 //===----------------------------------------------------------------------===//
 // HandleToArea
+//===----------------------------------------------------------------------===//
+const size_t HandleToArea::npos;
+
+HandleToArea::HandleToArea()
+  : m_AreaMap(), m_PathIndex(64), m_AreaIndex(64) {
+  sys::fs::detail::get_pwd(m_PWD);
+}
+
+HandleToArea::~HandleToArea()
+{
+}
+
 bool HandleToArea::push_back(FileHandle* pHandle, MemoryArea* pArea)
 {
   if (NULL == pHandle || NULL == pArea)
     return false;
 
-  Bucket bucket;
-  bucket.hash_value = HashFunction()(
-                              llvm::StringRef(pHandle->path().native().c_str(),
-                                              pHandle->path().native().size()));
+  bool exist = false;
+  AreaIndex::entry_type* area = m_AreaIndex.insert(pArea, exist);
+  if (exist)
+    return false;
+
+  size_t pos = m_AreaMap.size();
+  area->setValue(pos);
 
+  Bucket bucket;
   bucket.handle = pHandle;
   bucket.area = pArea;
+  getKey(pHandle->path(), bucket.key);
+  bucket.prev = npos;
+  bucket.next = npos;
+
+  // append the pair to the pairs of the same file
+  PathIndex::entry_type* entry = m_PathIndex.insert(bucket.key, exist);
+  if (exist) {
+    Chain& chain = entry->value();
+    bucket.prev = chain.last;
+    m_AreaMap[chain.last].next = pos;
+    chain.last = pos;
+  }
+  else {
+    Chain chain;
+    chain.first = pos;
+    chain.last = pos;
+    entry->setValue(chain);
+  }
   m_AreaMap.push_back(bucket);
   return true;
 }
 
 bool HandleToArea::erase(MemoryArea* pArea)
 {
-  if (NULL == pArea || NULL == pArea->handler())
+  AreaIndex::iterator entry = m_AreaIndex.find(pArea);
+  if (entry == m_AreaIndex.end())
     return false;
 
-  return erase(pArea->handler()->path());
+  erase(entry.getEntry()->value());
+  return true;
 }
 
 bool HandleToArea::erase(const sys::fs::Path& pPath)
 {
-  unsigned int hash_value = HashFunction()(
-                                  llvm::StringRef(pPath.native().c_str(),
-                                                  pPath.native().size()));
-
-  HandleToAreaMap::iterator bucket, bEnd = m_AreaMap.end();
-  for (bucket = m_AreaMap.begin(); bucket != bEnd; ++bucket) {
-    if (bucket->hash_value == hash_value && bucket->handle->path() == pPath) {
-      // found
-      m_AreaMap.erase(bucket);
-      return true;
-    }
+  std::string key;
+  getKey(pPath, key);
+  PathIndex::iterator entry = m_PathIndex.find(key);
+  if (entry == m_PathIndex.end())
+    return false;
+
+  erase(entry.getEntry()->value().first);
+  return true;
+}
+
+/// erase - unlink the pair from the pairs of its file, and fill the hole with
+/// the last pair. The buckets keep their keys, so neither step resolves the
+/// paths again.
+void HandleToArea::erase(size_t pPos)
+{
+  Bucket& bucket = m_AreaMap[pPos];
+
+  // the next pair of the same file, if any, becomes the first one
+  PathIndex::iterator entry = m_PathIndex.find(bucket.key);
+  Chain& chain = entry.getEntry()->value();
+  if (npos == bucket.prev && npos == bucket.next)
+    m_PathIndex.erase(bucket.key);
+  else {
+    if (npos == bucket.prev)
+      chain.first = bucket.next;
+    else
+      m_AreaMap[bucket.prev].next = bucket.next;
+
+    if (npos == bucket.next)
+      chain.last = bucket.prev;
+    else
+      m_AreaMap[bucket.next].prev = bucket.prev;
   }
+  m_AreaIndex.erase(bucket.area);
 
-  return false;
+  size_t last = m_AreaMap.size() - 1;
+  if (pPos != last)
+    move(last, pPos);
+  m_AreaMap.pop_back();
 }
 
-HandleToArea::Result HandleToArea::findFirst(const sys::fs::Path& pPath)
+/// move - redirect the neighbours and the indices of the pair at pFrom
+void HandleToArea::move(size_t pFrom, size_t pTo)
 {
-  unsigned int hash_value = HashFunction()(llvm::StringRef(pPath.native().c_str(),
-                                                         pPath.native().size()));
+  Bucket& bucket = m_AreaMap[pFrom];
+  Chain& chain = m_PathIndex.find(bucket.key).getEntry()->value();
 
-  HandleToAreaMap::iterator bucket, bEnd = m_AreaMap.end();
+  if (npos == bucket.prev)
+    chain.first = pTo;
+  else
+    m_AreaMap[bucket.prev].next = pTo;
 
-  for (bucket = m_AreaMap.begin(); bucket != bEnd; ++bucket) {
-    if (bucket->hash_value == hash_value) {
-      if (bucket->handle->path() == pPath) {
-        return Result(bucket->handle, bucket->area);
-      }
-    }
-  }
+  if (npos == bucket.next)
+    chain.last = pTo;
+  else
+    m_AreaMap[bucket.next].prev = pTo;
 
-  return Result(NULL, NULL);
+  m_AreaIndex.find(bucket.area).getEntry()->setValue(pTo);
+  m_AreaMap[pTo] = bucket;
 }
 
-HandleToArea::ConstResult HandleToArea::findFirst(const sys::fs::Path& pPath) const
+HandleToArea::Result HandleToArea::findFirst(const sys::fs::Path& pPath)
 {
-  unsigned int hash_value = HashFunction()(llvm::StringRef(pPath.native().c_str(),
-                                                         pPath.native().size()));
+  std::string key;
+  getKey(pPath, key);
+  PathIndex::iterator entry = m_PathIndex.find(key);
+  if (entry == m_PathIndex.end())
+    return Result(NULL, NULL);
+  const Bucket& bucket = m_AreaMap[entry.getEntry()->value().first];
+  return Result(bucket.handle, bucket.area);
+}
 
-  HandleToAreaMap::const_iterator bucket, bEnd = m_AreaMap.end();
+HandleToArea::ConstResult
+HandleToArea::findFirst(const sys::fs::Path& pPath) const
+{
+  std::string key;
+  getKey(pPath, key);
+  PathIndex::const_iterator entry = m_PathIndex.find(key);
+  if (entry == m_PathIndex.end())
+    return ConstResult(NULL, NULL);
+  const Bucket& bucket = m_AreaMap[entry.getEntry()->value().first];
+  return ConstResult(bucket.handle, bucket.area);
+}
 
-  for (bucket = m_AreaMap.begin(); bucket != bEnd; ++bucket) {
-    if (bucket->hash_value == hash_value) {
-      if (bucket->handle->path() == pPath) {
-        return ConstResult(bucket->handle, bucket->area);
-      }
-    }
+/// getKey - the relative paths are based on the working directory at the
+/// construction, and the symbolic links, "." and ".." are resolved by the
+/// file system. If the file does not exist, "." and ".." are folded
+/// lexically instead.
+void HandleToArea::getKey(const sys::fs::Path& pPath, std::string& pKey) const
+{
+  std::string path;
+  if (pPath.isFromRoot() || m_PWD.empty())
+    path = pPath.native();
+  else {
+    path = m_PWD;
+    path += sys::fs::separator;
+    path += pPath.native();
   }
 
-  return ConstResult(NULL, NULL);
-}
+  if (sys::fs::detail::real_path(sys::fs::Path(path), pKey))
+    return;
 
+  sys::fs::detail::canonicalize(path);
+  pKey.swap(path);
+}
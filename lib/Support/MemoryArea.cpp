@@ -21,13 +21,13 @@ using namespace mcld;
 // This constructor is used for *SPECIAL* situation. I'm sorry I can not
 // reveal what is the special situation.
 MemoryArea::MemoryArea(Space& pUniverse)
-  : m_pFileHandle(NULL) {
+  : m_pFileHandle(NULL), m_pWholeFile(NULL) {
   m_SpaceMap.insert(std::make_pair(Key(pUniverse.start(), pUniverse.size()),
                                    &pUniverse));
 }
 
 MemoryArea::MemoryArea(FileHandle& pFileHandle)
-  : m_pFileHandle(&pFileHandle) {
+  : m_pFileHandle(&pFileHandle), m_pWholeFile(NULL) {
 }
 
 MemoryArea::~MemoryArea()
@@ -51,8 +51,28 @@ MemoryArea::~MemoryArea()
 // the file. if the MemorySpace's type is ALLOCATED_ARRAY, the distances of
 // (space.data, r_start) and (r_len, space.size) are zero.
 //
-MemoryRegion* MemoryArea::request(size_t pOffset, size_t pLength)
+MemoryRegion* MemoryArea::request(uint64_t pOffset, uint64_t pLength)
 {
+  // a length which does not fit in size_t wraps silently in 32-bit hosts
+  if (pLength != static_cast<size_t>(pLength) ||
+      pOffset + pLength < pOffset) {
+    if (NULL != m_pFileHandle) {
+      fatal(diag::fatal_cannot_address_region) << m_pFileHandle->path()
+                                               << pOffset
+                                               << pLength;
+    }
+    unreachable(diag::err_out_of_range_region) << pOffset << pLength;
+    return NULL;
+  }
+
+  // the whole file is loaded. The space starts at the beginning of the file.
+  if (NULL != m_pWholeFile && pOffset + pLength <= m_pWholeFile->size() &&
+      pOffset + pLength >= pOffset) {
+    return MemoryRegion::Create(m_pWholeFile->memory() + pOffset,
+                                pLength,
+                                *m_pWholeFile);
+  }
+
   Space* space = find(pOffset, pLength);
   if (NULL == space) {
     // not found
@@ -67,13 +87,22 @@ MemoryRegion* MemoryArea::request(size_t pOffset, size_t pLength)
   }
 
   // adjust r_start
-  off_t distance = pOffset - space->start();
+  size_t distance = static_cast<size_t>(pOffset - space->start());
   void* r_start = space->memory() + distance;
 
   // now, we have a legal space to hold the new MemoryRegion
   return MemoryRegion::Create(r_start, pLength, *space);
 }
 
+// adopt - take over a Space which was loaded out of this MemoryArea
+MemoryRegion* MemoryArea::adopt(Space& pSpace)
+{
+  assert(NULL != m_pFileHandle);
+  m_SpaceMap.insert(std::make_pair(Key(pSpace.start(), pSpace.size()),
+                                   &pSpace));
+  return MemoryRegion::Create(pSpace.memory(), pSpace.size(), pSpace);
+}
+
 // release - release a MemoryRegion
 void MemoryArea::release(MemoryRegion* pRegion)
 {
@@ -83,6 +112,10 @@ void MemoryArea::release(MemoryRegion* pRegion)
   Space *space = pRegion->parent();
   MemoryRegion::Destroy(pRegion);
 
+  // the whole file space is released by clear()
+  if (space == m_pWholeFile)
+    return;
+
   if (0 == space->numOfRegions()) {
 
     if (NULL != m_pFileHandle) {
@@ -134,12 +167,86 @@ void MemoryArea::clear()
   }
 
   m_SpaceMap.clear();
+
+  if (NULL != m_pWholeFile) {
+    if (m_pFileHandle->isWritable())
+      Space::Sync(m_pWholeFile, *m_pFileHandle);
+    Space::Release(m_pWholeFile, *m_pFileHandle);
+    Space::Destroy(m_pWholeFile);
+  }
+}
+
+// mapWholeFile - load the whole read-only file at once
+bool MemoryArea::mapWholeFile()
+{
+  if (NULL != m_pWholeFile)
+    return true;
+
+  if (NULL == m_pFileHandle || !m_pFileHandle->isOpened() ||
+      !m_pFileHandle->isReadable() || m_pFileHandle->isWritable())
+    return false;
+
+  uint64_t size = m_pFileHandle->size();
+  if (0 == size)
+    return false;
+
+  // the file does not fit in the address space of the host. The readers load
+  // it by parts.
+  if (size != static_cast<size_t>(size))
+    return false;
+
+  m_pWholeFile = Space::Create(*m_pFileHandle, 0, static_cast<size_t>(size));
+  return true;
+}
+
+// mapWholeOutput - preallocate and map the whole writable file at once
+bool MemoryArea::mapWholeOutput(uint64_t pSize)
+{
+  if (NULL != m_pWholeFile)
+    return (pSize <= m_pWholeFile->size());
+
+  if (NULL == m_pFileHandle || !m_pFileHandle->isOpened() ||
+      !m_pFileHandle->isWritable() || !m_SpaceMap.empty() || 0 == pSize ||
+      pSize != static_cast<size_t>(pSize))
+    return false;
+
+  // the writers skip the zeros, so the old contents must not show through
+  if (0 != m_pFileHandle->size())
+    return false;
+
+  if (!m_pFileHandle->allocate(pSize))
+    return false;
+
+  // the space ends at the end of the file, so the file is not extended to a
+  // page boundary. If the file can not be mapped, the caller writes it by
+  // regions, and the file is empty again.
+  m_pWholeFile = Space::TryCreate(*m_pFileHandle, 0,
+                                  static_cast<size_t>(pSize));
+  if (NULL == m_pWholeFile || NULL == m_pWholeFile->memory()) {
+    if (NULL != m_pWholeFile)
+      Space::Destroy(m_pWholeFile);
+    m_pWholeFile = NULL;
+    m_pFileHandle->truncate(0);
+    return false;
+  }
+  return true;
+}
+
+bool MemoryArea::isInWholeFile(const void* pData, size_t pSize) const
+{
+  if (NULL == m_pWholeFile)
+    return false;
+
+  const uint8_t* start = m_pWholeFile->memory();
+  const uint8_t* data = static_cast<const uint8_t*>(pData);
+  return (data >= start && pSize <= m_pWholeFile->size() &&
+          data <= start + (m_pWholeFile->size() - pSize));
 }
 
 //===--------------------------------------------------------------------===//
 // SpaceList methods
 //===--------------------------------------------------------------------===//
-Space* MemoryArea::find(size_t pOffset, size_t pLength)
+Space* MemoryArea::find(uint64_t pOffset, uint64_t pLength)
 {
   SpaceMapType::iterator it = m_SpaceMap.find(Key(pOffset, pLength));
   if (it != m_SpaceMap.end())
@@ -148,7 +255,7 @@ Space* MemoryArea::find(size_t pOffset, size_t pLength)
   return NULL;
 }
 
-const Space* MemoryArea::find(size_t pOffset, size_t pLength) const
+const Space* MemoryArea::find(uint64_t pOffset, uint64_t pLength) const
 {
   SpaceMapType::const_iterator it = m_SpaceMap.find(Key(pOffset, pLength));
   if (it != m_SpaceMap.end())
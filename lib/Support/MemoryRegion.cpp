@@ -7,13 +7,17 @@
 //
 //===----------------------------------------------------------------------===//
 #include <mcld/Support/MemoryRegion.h>
+#include <mcld/Support/Mutex.h>
 #include <mcld/Support/RegionFactory.h>
 
 #include <llvm/Support/ManagedStatic.h>
 
 using namespace mcld;
 
+// The regions belong to the MemoryAreas rather than to a link, and the
+// areas may be shared by the links running on different threads.
 static llvm::ManagedStatic<RegionFactory> g_RegionFactory;
+static llvm::ManagedStatic<Mutex> g_RegionFactoryLock;
 
 //===----------------------------------------------------------------------===//
 // MemoryRegion
@@ -30,15 +34,25 @@ MemoryRegion::~MemoryRegion()
 {
 }
 
+void MemoryRegion::SetUp()
+{
+  *g_RegionFactoryLock;
+  *g_RegionFactory;
+}
+
 MemoryRegion* MemoryRegion::Create(void* pStart, size_t pSize)
 {
+  Mutex::Guard guard(*g_RegionFactoryLock);
   return g_RegionFactory->produce(static_cast<Address>(pStart), pSize);
 }
 
 MemoryRegion* MemoryRegion::Create(void* pStart, size_t pSize, Space& pSpace)
 {
-  MemoryRegion* result = g_RegionFactory->produce(static_cast<Address>(pStart),
-                                                  pSize);
+  MemoryRegion* result = NULL;
+  {
+    Mutex::Guard guard(*g_RegionFactoryLock);
+    result = g_RegionFactory->produce(static_cast<Address>(pStart), pSize);
+  }
   result->setParent(pSpace);
   pSpace.addRegion(*result);
   return result;
@@ -51,6 +65,8 @@ void MemoryRegion::Destroy(MemoryRegion*& pRegion)
 
   if (pRegion->hasParent())
     pRegion->parent()->removeRegion(*pRegion);
+
+  Mutex::Guard guard(*g_RegionFactoryLock);
   g_RegionFactory->destruct(pRegion);
   pRegion = NULL;
 }
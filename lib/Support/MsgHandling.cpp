@@ -12,6 +12,8 @@
 #include <mcld/LD/TextDiagnosticPrinter.h>
 #include <mcld/LD/MsgHandler.h>
 #include <mcld/Support/MsgHandling.h>
+#include <mcld/Support/Mutex.h>
+#include <mcld/Support/ThreadLocal.h>
 #include <mcld/Support/raw_ostream.h>
 
 #include <llvm/Support/ManagedStatic.h>
@@ -19,40 +21,124 @@
 #include <llvm/Support/Signals.h>
 
 #include <cstdlib>
+#include <vector>
 
 using namespace mcld;
 
+//===----------------------------------------------------------------------===//
+// EngineRegistry
+//===----------------------------------------------------------------------===//
+namespace {
+
+/// EngineRegistry - own the diagnostic engines of all threads. A thread gets
+/// its engine when it first reports, and keeps it until the thread exits or
+/// llvm_shutdown.
+class EngineRegistry
+{
+public:
+  ~EngineRegistry() {
+    std::vector<DiagnosticEngine*>::iterator engine, eEnd = m_Engines.end();
+    for (engine = m_Engines.begin(); engine != eEnd; ++engine)
+      delete *engine;
+  }
+
+  DiagnosticEngine* create() {
+    Mutex::Guard guard(m_Lock);
+    m_Engines.push_back(new DiagnosticEngine());
+    return m_Engines.back();
+  }
+
+  void destroy(DiagnosticEngine* pEngine) {
+    {
+      Mutex::Guard guard(m_Lock);
+      std::vector<DiagnosticEngine*>::iterator engine, eEnd = m_Engines.end();
+      for (engine = m_Engines.begin(); engine != eEnd; ++engine) {
+        if (*engine == pEngine)
+          break;
+      }
+      if (engine == eEnd)
+        return;
+      *engine = m_Engines.back();
+      m_Engines.pop_back();
+    }
+    delete pEngine;
+  }
+
+private:
+  Mutex m_Lock;
+  std::vector<DiagnosticEngine*> m_Engines;
+};
+
+} // anonymous namespace
+
 //===----------------------------------------------------------------------===//
 // static variables
 //===----------------------------------------------------------------------===//
-static llvm::ManagedStatic<DiagnosticEngine> g_pEngine;
+static llvm::ManagedStatic<EngineRegistry> g_EngineRegistry;
+
+/// ReleaseEngine - destroy the engine of an exiting thread
+static void ReleaseEngine(void* pEngine)
+{
+  if (g_EngineRegistry.isConstructed())
+    g_EngineRegistry->destroy(static_cast<DiagnosticEngine*>(pEngine));
+}
+
+namespace {
+
+/// EngineSlot - the engine of each thread
+class EngineSlot : public ThreadLocal
+{
+public:
+  EngineSlot() : ThreadLocal(&ReleaseEngine) { }
+};
+
+} // anonymous namespace
+
+static llvm::ManagedStatic<EngineSlot> g_CurrentEngine;
+
+/// SetUpDiagnosticEngines - llvm_shutdown destroys the ManagedStatics in the
+/// reverse order of construction, so the slot goes first and no thread
+/// releases its engine into a destroyed registry.
+void mcld::SetUpDiagnosticEngines()
+{
+  *g_EngineRegistry;
+  *g_CurrentEngine;
+}
 
 void
 mcld::InitializeDiagnosticEngine(const mcld::LinkerConfig& pConfig,
                                  DiagnosticPrinter* pPrinter)
 {
-  g_pEngine->reset(pConfig);
+  DiagnosticEngine& engine = getDiagnosticEngine();
+  engine.reset(pConfig);
   if (NULL != pPrinter)
-    g_pEngine->setPrinter(*pPrinter, false);
+    engine.setPrinter(*pPrinter, false);
   else {
     DiagnosticPrinter* printer = new TextDiagnosticPrinter(mcld::errs(), pConfig);
-    g_pEngine->setPrinter(*printer, true);
+    engine.setPrinter(*printer, true);
   }
 }
 
 DiagnosticEngine& mcld::getDiagnosticEngine()
 {
-  return *g_pEngine;
+  DiagnosticEngine* engine =
+    static_cast<DiagnosticEngine*>(g_CurrentEngine->get());
+  if (NULL == engine) {
+    engine = g_EngineRegistry->create();
+    g_CurrentEngine->set(engine);
+  }
+  return *engine;
 }
 
 bool mcld::Diagnose()
 {
-  if (g_pEngine->getPrinter()->getNumErrors() > 0) {
+  DiagnosticEngine& engine = getDiagnosticEngine();
+  if (engine.getPrinter()->getNumErrors() > 0) {
     // If we reached here, we are failing ungracefully. Run the interrupt handlers
     // to make sure any special cleanups get done, in particular that we remove
     // files registered with RemoveFileOnSignal.
     llvm::sys::RunInterruptHandlers();
-    g_pEngine->getPrinter()->finish();
+    engine.getPrinter()->finish();
     return false;
   }
   return true;
@@ -60,6 +146,6 @@ bool mcld::Diagnose()
 
 void mcld::FinalizeDiagnosticEngine()
 {
-  g_pEngine->getPrinter()->finish();
+  getDiagnosticEngine().getPrinter()->finish();
 }
 
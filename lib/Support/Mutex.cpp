@@ -0,0 +1,21 @@
+//===- Mutex.cpp ----------------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/Config/Config.h"
+#include <mcld/Support/Mutex.h>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// Mutex
+#if defined(MCLD_ON_UNIX)
+#include "Unix/Mutex.inc"
+#endif
+#if defined(MCLD_ON_WIN32)
+#include "Windows/Mutex.inc"
+#endif
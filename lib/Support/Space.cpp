@@ -11,12 +11,13 @@
 #include <mcld/Support/MsgHandling.h>
 #include <cstdlib>
 #include <unistd.h>
+#include <sys/mman.h>
 
 using namespace mcld;
 
 //===----------------------------------------------------------------------===//
 // constant data
-static const off_t PageSize = getpagesize();
+static const uint64_t PageSize = getpagesize();
 
 //===----------------------------------------------------------------------===//
 // Non-member functions
@@ -28,15 +29,15 @@ static const off_t PageSize = getpagesize();
 //
 // Given a file offset, return the page offset.
 // return the first page boundary \b before pFileOffset
-inline static off_t page_offset(off_t pFileOffset)
+inline static uint64_t page_offset(uint64_t pFileOffset)
 { return pFileOffset & ~ (PageSize - 1); }
 
 // page_boundary - Given a file size, return the size to read integral pages.
 // return the first page boundary \b after pFileOffset
-inline static off_t page_boundary(off_t pFileOffset)
+inline static uint64_t page_boundary(uint64_t pFileOffset)
 { return (pFileOffset + (PageSize - 1)) & ~ (PageSize - 1); }
 
-inline static Space::Type policy(off_t pOffset, size_t pLength)
+inline static Space::Type policy(uint64_t pOffset, size_t pLength)
 {
   const size_t threshold = (PageSize*3)/4; // 3/4 page size in Linux
   if (pLength < threshold)
@@ -70,12 +71,13 @@ Space* Space::Create(void* pMemBuffer, size_t pSize)
   return result;
 }
 
-Space* Space::Create(FileHandle& pHandler, size_t pStart, size_t pSize)
+Space* Space::Create(FileHandle& pHandler, uint64_t pStart, size_t pSize)
 {
   Type type;
   void* memory = NULL;
   Space* result = NULL;
-  size_t start = 0, size = 0, total_offset;
+  uint64_t start = 0, total_offset;
+  size_t size = 0;
   switch(type = policy(pStart, pSize)) {
     case ALLOCATED_ARRAY: {
       // adjust total_offset, start and size
@@ -87,7 +89,7 @@ Space* Space::Create(FileHandle& pHandler, size_t pStart, size_t pSize)
           pHandler.truncate(total_offset);
         }
         else if (pHandler.size() > start)
-          size = pHandler.size() - start;
+          size = static_cast<size_t>(pHandler.size() - start);
         else {
           // create a space out of a read-only file.
           fatal(diag::err_cannot_read_small_file) << pHandler.path()
@@ -111,11 +113,11 @@ Space* Space::Create(FileHandle& pHandler, size_t pStart, size_t pSize)
       start = page_offset(pStart);
       if (total_offset > pHandler.size()) {
         if (pHandler.isWritable()) {
-          size = page_boundary((pStart - start) + pSize);
+          size = static_cast<size_t>(page_boundary((pStart - start) + pSize));
           pHandler.truncate(total_offset);
         }
         else if (pHandler.size() > start)
-          size = pHandler.size() - start;
+          size = static_cast<size_t>(pHandler.size() - start);
         else {
           // create a space out of a read-only file.
           fatal(diag::err_cannot_read_small_file) << pHandler.path()
@@ -124,7 +126,7 @@ Space* Space::Create(FileHandle& pHandler, size_t pStart, size_t pSize)
         }
       }
       else
-        size = page_boundary((pStart - start) + pSize);
+        size = static_cast<size_t>(page_boundary((pStart - start) + pSize));
 
       // mmap
       if (!pHandler.mmap(memory, start, size))
@@ -141,6 +143,39 @@ Space* Space::Create(FileHandle& pHandler, size_t pStart, size_t pSize)
   return result;
 }
 
+Space* Space::TryCreate(FileHandle& pHandler, uint64_t pStart, size_t pSize)
+{
+  if (pStart + pSize > pHandler.size() || pStart + pSize < pStart)
+    return NULL;
+
+  Type type = policy(pStart, pSize);
+  void* memory = NULL;
+  uint64_t start = pStart;
+  size_t size = pSize;
+  if (ALLOCATED_ARRAY == type) {
+    memory = (void*)malloc(size);
+    if (NULL == memory)
+      return NULL;
+    if (!pHandler.read(memory, start, size)) {
+      free(memory);
+      return NULL;
+    }
+  }
+  else {
+    start = page_offset(pStart);
+    if (page_boundary(pStart + pSize) > pHandler.size())
+      size = static_cast<size_t>(pHandler.size() - start);
+    else
+      size = static_cast<size_t>(page_boundary((pStart - start) + pSize));
+    if (!pHandler.mmap(memory, start, size))
+      return NULL;
+  }
+
+  Space* result = new Space(type, memory, size);
+  result->setStart(start);
+  return result;
+}
+
 void Space::Destroy(Space*& pSpace)
 {
   delete pSpace;
@@ -190,3 +225,20 @@ void Space::Sync(Space* pSpace, FileHandle& pHandler)
   } // end of switch
 }
 
+void Space::WillNeed(const Space& pSpace, uint64_t pOffset, size_t pSize)
+{
+  if (MMAPED != pSpace.type() || pOffset < pSpace.start() ||
+      pOffset - pSpace.start() >= pSpace.size())
+    return;
+
+  // madvise takes a page-aligned address. The mapped space starts at a page.
+  size_t distance = static_cast<size_t>(pOffset - pSpace.start());
+  size_t end = distance + pSize;
+  if (end > pSpace.size() || end < pSize)
+    end = pSpace.size();
+  size_t begin = static_cast<size_t>(page_offset(distance));
+#if defined(MADV_WILLNEED)
+  ::madvise(const_cast<Address>(pSpace.memory()) + begin, end - begin,
+            MADV_WILLNEED);
+#endif
+}
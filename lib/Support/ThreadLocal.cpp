@@ -0,0 +1,21 @@
+//===- ThreadLocal.cpp ----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/Config/Config.h"
+#include <mcld/Support/ThreadLocal.h>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// ThreadLocal
+#if defined(MCLD_ON_UNIX)
+#include "Unix/ThreadLocal.inc"
+#endif
+#if defined(MCLD_ON_WIN32)
+#include "Windows/ThreadLocal.inc"
+#endif
@@ -0,0 +1,21 @@
+//===- ThreadPool.cpp -----------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "mcld/Config/Config.h"
+#include <mcld/Support/ThreadPool.h>
+
+using namespace mcld;
+
+//===----------------------------------------------------------------------===//
+// ThreadPool
+#if defined(MCLD_ON_UNIX)
+#include "Unix/ThreadPool.inc"
+#endif
+#if defined(MCLD_ON_WIN32)
+#include "Windows/ThreadPool.inc"
+#endif
@@ -58,7 +58,9 @@ ARMGNULDBackend::ARMGNULDBackend(const LinkerConfig& pConfig, GNUInfo* pInfo)
     m_pEXIDXEnd(NULL),
     m_pEXIDX(NULL),
     m_pEXTAB(NULL),
-    m_pAttributes(NULL) {
+    m_pAttributes(NULL),
+    m_pBuilder(NULL),
+    m_pModule(NULL) {
 }
 
 ARMGNULDBackend::~ARMGNULDBackend()
@@ -69,6 +71,7 @@ ARMGNULDBackend::~ARMGNULDBackend()
   delete m_pRelDyn;
   delete m_pRelPLT;
   delete m_pDynamic;
+  delete m_pBuilder;
 }
 
 void ARMGNULDBackend::initTargetSections(Module& pModule, ObjectBuilder& pBuilder)
@@ -850,8 +853,12 @@ bool ARMGNULDBackend::mergeSection(Module& pModule, LDSection& pSection)
       return true;
     }
     default: {
-      ObjectBuilder builder(config(), pModule);
-      return builder.MergeSection(pSection);
+      if (NULL == m_pBuilder || &pModule != m_pModule) {
+        delete m_pBuilder;
+        m_pBuilder = new ObjectBuilder(config(), pModule);
+        m_pModule = &pModule;
+      }
+      return (NULL != m_pBuilder->MergeSection(pSection));
     }
   } // end of switch
   return true;
@@ -860,8 +867,8 @@ bool ARMGNULDBackend::mergeSection(Module& pModule, LDSection& pSection)
 bool ARMGNULDBackend::readSection(Input& pInput, SectionData& pSD)
 {
   Fragment* frag = NULL;
-  uint32_t offset = pInput.fileOffset() + pSD.getSection().offset();
-  uint32_t size = pSD.getSection().size();
+  uint64_t offset = pInput.fileOffset() + pSD.getSection().offset();
+  uint64_t size = pSD.getSection().size();
 
   MemoryRegion* region = pInput.memArea()->request(offset, size);
   if (NULL == region) {
@@ -877,6 +884,24 @@ bool ARMGNULDBackend::readSection(Input& pInput, SectionData& pSD)
   return true;
 }
 
+/// mayTakeFunctionAddress - the branch relocations only call or jump to the
+/// function. Every other relocation may compute its address.
+bool ARMGNULDBackend::mayTakeFunctionAddress(const Relocation& pReloc) const
+{
+  switch (pReloc.type()) {
+    case llvm::ELF::R_ARM_PC24:
+    case llvm::ELF::R_ARM_CALL:
+    case llvm::ELF::R_ARM_JUMP24:
+    case llvm::ELF::R_ARM_PLT32:
+    case llvm::ELF::R_ARM_THM_CALL:
+    case llvm::ELF::R_ARM_THM_JUMP24:
+    case llvm::ELF::R_ARM_THM_JUMP19:
+      return false;
+    default:
+      return true;
+  }
+}
+
 ARMGOT& ARMGNULDBackend::getGOT()
 {
   assert(NULL != m_pGOT && "GOT section not exist");
@@ -172,6 +172,9 @@ public:
   /// readSection - read target dependent sections
   bool readSection(Input& pInput, SectionData& pSD);
 
+  /// mayTakeFunctionAddress - for --icf=safe
+  bool mayTakeFunctionAddress(const Relocation& pReloc) const;
+
 private:
   void scanLocalReloc(Relocation& pReloc, const LDSection& pSection);
 
@@ -240,6 +243,11 @@ private:
   LDSection* m_pEXIDX;           // .ARM.exidx
   LDSection* m_pEXTAB;           // .ARM.extab
   LDSection* m_pAttributes;      // .ARM.attributes
+
+  /// m_pBuilder - merge the other target sections of m_pModule. One builder
+  /// is kept, so the output sections are indexed once.
+  ObjectBuilder* m_pBuilder;
+  Module* m_pModule;
 //  LDSection* m_pPreemptMap;      // .ARM.preemptmap
 //  LDSection* m_pDebugOverlay;    // .ARM.debug_overlay
 //  LDSection* m_pOverlayTable;    // .ARM.overlay_table
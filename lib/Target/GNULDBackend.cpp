@@ -21,6 +21,7 @@
 #include <mcld/InputTree.h>
 #include <mcld/Config/Config.h>
 #include <mcld/ADT/SizeTraits.h>
+#include <mcld/LD/ArchiveIndexCache.h>
 #include <mcld/LD/LDSymbol.h>
 #include <mcld/LD/LDContext.h>
 #include <mcld/Fragment/FillFragment.h>
@@ -138,7 +139,11 @@ GNUArchiveReader*
 GNULDBackend::createArchiveReader(Module& pModule)
 {
   assert(NULL != m_pObjectReader);
-  return new GNUArchiveReader(pModule, *m_pObjectReader);
+  GNUArchiveReader* reader = new GNUArchiveReader(pModule, *m_pObjectReader);
+  const GeneralOptions& options = config().options();
+  if (options.hasArchiveIndexCache())
+    reader->setIndexCache(new ArchiveIndexCache(options.archiveIndexCache()));
+  return reader;
 }
 
 ELFObjectReader* GNULDBackend::createObjectReader(IRBuilder& pBuilder)
@@ -2271,10 +2276,11 @@ void GNULDBackend::postProcessing(MemoryArea& pOutput)
   if (LinkerConfig::Object != config().codeGenType() &&
       config().options().hasEhFrameHdr() && getOutputFormat()->hasEhFrame()) {
     // emit eh_frame_hdr
+    unsigned int num_threads = config().options().numThreads();
     if (config().targets().is32Bits())
-      m_pEhFrameHdr->emitOutput<32>(pOutput);
+      m_pEhFrameHdr->emitOutput<32>(pOutput, num_threads);
     else
-      m_pEhFrameHdr->emitOutput<64>(pOutput);
+      m_pEhFrameHdr->emitOutput<64>(pOutput, num_threads);
   }
 }
 
@@ -2327,7 +2333,7 @@ unsigned GNULDBackend::getGNUHashMaskbitslog2(unsigned pNumOfSymbols) const
 
 /// isDynamicSymbol
 /// @ref Google gold linker: symtab.cc:311
-bool GNULDBackend::isDynamicSymbol(const LDSymbol& pSymbol)
+bool GNULDBackend::isDynamicSymbol(const LDSymbol& pSymbol) const
 {
   // If a local symbol is in the LDContext's symbol table, it's a real local
   // symbol. We should not add it
@@ -2348,7 +2354,7 @@ bool GNULDBackend::isDynamicSymbol(const LDSymbol& pSymbol)
 
 /// isDynamicSymbol
 /// @ref Google gold linker: symtab.cc:311
-bool GNULDBackend::isDynamicSymbol(const ResolveInfo& pResolveInfo)
+bool GNULDBackend::isDynamicSymbol(const ResolveInfo& pResolveInfo) const
 {
   // If a local symbol is in the LDContext's symbol table, it's a real local
   // symbol. We should not add it
@@ -2367,6 +2373,15 @@ bool GNULDBackend::isDynamicSymbol(const ResolveInfo& pResolveInfo)
   return false;
 }
 
+/// isExported - a static link has no .dynsym. Otherwise the symbols selected
+/// by isDynamicSymbol are emitted to .dynsym by sizeNamePools.
+bool GNULDBackend::isExported(const ResolveInfo& pSymbol) const
+{
+  if (config().isCodeStatic())
+    return false;
+  return isDynamicSymbol(pSymbol);
+}
+
 /// commonPageSize - the common page size of the target machine.
 /// @ref gold linker: target.h:135
 uint64_t GNULDBackend::commonPageSize() const
@@ -2387,6 +2402,12 @@ uint64_t GNULDBackend::abiPageSize() const
     return m_pInfo->abiPageSize();
 }
 
+/// emitNops - fill the padding with zeros
+void GNULDBackend::emitNops(uint8_t* pBuf, size_t pSize) const
+{
+  memset(pBuf, 0x0, pSize);
+}
+
 /// isSymbolPreemtible - whether the symbol can be preemted by other
 /// link unit
 /// @ref Google gold linker, symtab.h:551
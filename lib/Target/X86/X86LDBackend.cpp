@@ -29,6 +29,32 @@
 
 using namespace mcld;
 
+//===----------------------------------------------------------------------===//
+// non-member functions
+//===----------------------------------------------------------------------===//
+/// isBranchDisplacement - return true if the PC-relative displacement fixed
+/// up by pReloc belongs to a call, a jmp or a conditional jump.
+static bool isBranchDisplacement(const Relocation& pReloc)
+{
+  const FragmentRef& place = pReloc.targetRef();
+  if (NULL == place.frag() || Fragment::Region != place.frag()->getKind() ||
+      0 == place.offset())
+    return false;
+
+  const MemoryRegion& region =
+                 static_cast<const RegionFragment*>(place.frag())->getRegion();
+  if (place.offset() > region.size())
+    return false;
+
+  const uint8_t* opcode = region.start() + place.offset() - 1;
+  if (0xe8 == opcode[0] || 0xe9 == opcode[0])
+    return true;
+
+  // jcc rel32 is 0x0f 0x80-0x8f
+  return (place.offset() >= 2 && 0x0f == opcode[-1] &&
+          0x80 == (opcode[0] & 0xf0));
+}
+
 //===----------------------------------------------------------------------===//
 // X86GNULDBackend
 //===----------------------------------------------------------------------===//
@@ -302,6 +328,29 @@ uint64_t X86GNULDBackend::emitSectionData(const LDSection& pSection,
   return RegionSize;
 }
 
+/// emitNops
+/// @ref Intel 64 and IA-32 Architectures Software Developer's Manual, NOP
+void X86GNULDBackend::emitNops(uint8_t* pBuf, size_t pSize) const
+{
+  static const uint8_t nops[8][8] = {
+    { 0x90 },                                           // nop
+    { 0x66, 0x90 },                                     // xchg %ax,%ax
+    { 0x0f, 0x1f, 0x00 },                               // nopl (%eax)
+    { 0x0f, 0x1f, 0x40, 0x00 },                         // nopl 0(%eax)
+    { 0x0f, 0x1f, 0x44, 0x00, 0x00 },                   // nopl 0(%eax,%eax,1)
+    { 0x66, 0x0f, 0x1f, 0x44, 0x00, 0x00 },             // nopw 0(%eax,%eax,1)
+    { 0x0f, 0x1f, 0x80, 0x00, 0x00, 0x00, 0x00 },       // nopl 0L(%eax)
+    { 0x0f, 0x1f, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 }  // nopl 0L(%eax,%eax,1)
+  };
+
+  while (pSize > 0) {
+    size_t size = (pSize < 8) ? pSize : 8;
+    memcpy(pBuf, nops[size - 1], size);
+    pBuf += size;
+    pSize -= size;
+  }
+}
+
 X86PLT& X86GNULDBackend::getPLT()
 {
   assert(NULL != m_pPLT && "PLT section not exist");
@@ -405,6 +454,20 @@ X86_32GNULDBackend::~X86_32GNULDBackend()
   delete m_pGOTPLT;
 }
 
+/// mayTakeFunctionAddress - a PLT32 relocation or a PC32 relocation of a
+/// branch only calls or jumps to the function.
+bool X86_32GNULDBackend::mayTakeFunctionAddress(const Relocation& pReloc) const
+{
+  switch (pReloc.type()) {
+    case llvm::ELF::R_386_PLT32:
+      return false;
+    case llvm::ELF::R_386_PC32:
+      return !isBranchDisplacement(pReloc);
+    default:
+      return true;
+  }
+}
+
 bool X86_32GNULDBackend::initRelocator()
 {
   if (NULL == m_pRelocator) {
@@ -992,6 +1055,20 @@ X86_64GNULDBackend::~X86_64GNULDBackend()
   delete m_pGOTPLT;
 }
 
+/// mayTakeFunctionAddress - a PLT32 relocation or a PC32 relocation of a
+/// branch only calls or jumps to the function.
+bool X86_64GNULDBackend::mayTakeFunctionAddress(const Relocation& pReloc) const
+{
+  switch (pReloc.type()) {
+    case llvm::ELF::R_X86_64_PLT32:
+      return false;
+    case llvm::ELF::R_X86_64_PC32:
+      return !isBranchDisplacement(pReloc);
+    default:
+      return true;
+  }
+}
+
 bool X86_64GNULDBackend::initRelocator()
 {
   if (NULL == m_pRelocator) {
@@ -116,6 +116,10 @@ public:
   uint64_t emitSectionData(const LDSection& pSection,
                            MemoryRegion& pRegion) const;
 
+  /// emitNops - fill the padding with the multi-byte NOPs of the P6 family,
+  /// the longest one first, as GNU as does.
+  void emitNops(uint8_t* pBuf, size_t pSize) const;
+
   /// initRelocator - create and initialize Relocator.
   virtual bool initRelocator() = 0;
 
@@ -244,6 +248,9 @@ public:
 
   X86_32GOTEntry& getTLSModuleID();
 
+  /// mayTakeFunctionAddress - for --icf=safe
+  bool mayTakeFunctionAddress(const Relocation& pReloc) const;
+
 private:
   void scanLocalReloc(Relocation& pReloc,
                       IRBuilder& pBuilder,
@@ -298,6 +305,9 @@ public:
 
   const X86_64GOTPLT& getGOTPLT() const;
 
+  /// mayTakeFunctionAddress - for --icf=safe
+  bool mayTakeFunctionAddress(const Relocation& pReloc) const;
+
 private:
   void scanLocalReloc(Relocation& pReloc,
                       IRBuilder& pBuilder,
@@ -52,6 +52,22 @@ X86Relocator::~X86Relocator()
 {
 }
 
+/// helper_is_static - check if the absolute or PC-relative relocation only
+/// performs the static relocation. Otherwise, it may use the PLT entry or
+/// emit a dynamic relocation of the symbol.
+static bool helper_is_static(const Relocation& pReloc,
+                             const X86GNULDBackend& pBackend)
+{
+  const LDSection& target_sect =
+                     pReloc.targetRef().frag()->getParent()->getSection();
+  if (0x0 == (llvm::ELF::SHF_ALLOC & target_sect.flag()))
+    return true;
+
+  const ResolveInfo* rsym = pReloc.symInfo();
+  return (0x0 == rsym->reserved() &&
+          !pBackend.symbolNeedsDynRel(*rsym, false, true));
+}
+
 //===--------------------------------------------------------------------===//
 // X86_32Relocator
 //===--------------------------------------------------------------------===//
@@ -82,6 +98,28 @@ Relocator::Size X86_32Relocator::getSize(Relocation::Type pType) const
   return X86_32ApplyFunctions[pType].size;;
 }
 
+bool X86_32Relocator::mayApplyConcurrently(const Relocation& pRelocation) const
+{
+  Relocation::Type type = pRelocation.type();
+  if (type >= sizeof (X86_32ApplyFunctions) / sizeof (X86_32ApplyFunctions[0]))
+    return false;
+
+  X86_32ApplyFunctionType func = X86_32ApplyFunctions[type].func;
+  X86_32ApplyFunctionType none_func = &none, gotoff32_func = &gotoff32,
+                          gotpc32_func = &gotpc32, abs_func = &abs,
+                          rel_func = &rel;
+
+  // GOT_ORG is fixed after layout
+  if (none_func == func || gotoff32_func == func || gotpc32_func == func)
+    return true;
+
+  if (abs_func == func || rel_func == func)
+    return helper_is_static(pRelocation, m_Target);
+
+  // GOT, PLT and TLS relocations consume the entries
+  return false;
+}
+
 //===--------------------------------------------------------------------===//
 // Relocation helper function
 //===--------------------------------------------------------------------===//
@@ -638,6 +676,26 @@ Relocator::Size X86_64Relocator::getSize(Relocation::Type pType) const
   return X86_64ApplyFunctions[pType].size;
 }
 
+bool X86_64Relocator::mayApplyConcurrently(const Relocation& pRelocation) const
+{
+  Relocation::Type type = pRelocation.type();
+  if (type >= sizeof (X86_64ApplyFunctions) / sizeof (X86_64ApplyFunctions[0]))
+    return false;
+
+  X86_64ApplyFunctionType func = X86_64ApplyFunctions[type].func;
+  X86_64ApplyFunctionType none_func = &none, abs_func = &abs,
+                          signed32_func = &signed32, rel_func = &rel;
+
+  if (none_func == func)
+    return true;
+
+  if (abs_func == func || signed32_func == func || rel_func == func)
+    return helper_is_static(pRelocation, m_Target);
+
+  // GOT and PLT relocations consume the entries
+  return false;
+}
+
 /// helper_DynRel - Get an relocation entry in .rela.dyn
 static
 Relocation& helper_DynRel(ResolveInfo* pSym,
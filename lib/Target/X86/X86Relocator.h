@@ -65,6 +65,8 @@ public:
 
   Result applyRelocation(Relocation& pRelocation);
 
+  bool mayApplyConcurrently(const Relocation& pRelocation) const;
+
   X86_32GNULDBackend& getTarget()
   { return m_Target; }
 
@@ -102,6 +104,8 @@ public:
 
   Result applyRelocation(Relocation& pRelocation);
 
+  bool mayApplyConcurrently(const Relocation& pRelocation) const;
+
   X86_64GNULDBackend& getTarget()
   { return m_Target; }
 
@@ -521,9 +521,42 @@ ArgOMagicAlias("N",
                cl::desc("alias for --omagic"),
                cl::aliasopt(ArgOMagic));
 
-/// @{
-/// @name FIXME: begin of unsupported options
-/// @}
+static cl::opt<unsigned int>
+ArgThreads("threads",
+           cl::desc("Number of threads used to read the input files and to "
+                    "apply relocations"),
+           cl::value_desc("N"),
+           cl::init(1));
+
+static cl::opt<bool>
+ArgMapWholeFiles("map-whole-files",
+              cl::desc("Map each input file into memory at once."),
+              cl::init(false));
+
+static cl::opt<bool>
+ArgNoMapWholeFiles("no-map-whole-files",
+              cl::desc("Map only the requested parts of the input files."),
+              cl::init(false));
+
+static cl::opt<bool>
+ArgLazyDynSymbols("lazy-dynamic-symbols",
+              cl::desc("Read a symbol of the shared libraries only when it is "
+                       "referred."),
+              cl::init(false));
+
+static cl::opt<bool>
+ArgTailMergeStrings("tail-merge-strings",
+              cl::desc("Put a mergeable string which is the tail of another "
+                       "string into that string."),
+              cl::init(false));
+
+static cl::opt<std::string>
+ArgArchiveIndexCache("archive-index-cache",
+              cl::desc("Keep the symbol maps of the archives in the given "
+                       "directory, and reuse them in later links."),
+              cl::value_desc("dir"),
+              cl::init(""));
+
 static cl::opt<bool>
 ArgGCSections("gc-sections",
               cl::desc("Enable garbage collection of unused input sections."),
@@ -534,6 +567,17 @@ ArgNoGCSections("no-gc-sections",
               cl::desc("disable garbage collection of unused input sections."),
               cl::init(false));
 
+static cl::opt<bool>
+ArgPrintGCSections("print-gc-sections",
+              cl::desc("List all sections removed by garbage collection. "
+                       "The list is shown as notes, with --verbose=1."),
+              cl::init(false));
+
+static cl::opt<bool>
+ArgNoPrintGCSections("no-print-gc-sections",
+              cl::desc("disable --print-gc-sections"),
+              cl::init(false));
+
 namespace icf {
 enum Mode {
   None,
@@ -556,6 +600,10 @@ ArgICF("icf",
            "Folds ctors, dtors and functions whose pointers are definitely not taken."),
          clEnumValEnd));
 
+/// @{
+/// @name FIXME: begin of unsupported options
+/// @}
+
 // FIXME: add this to target options?
 static cl::opt<bool>
 ArgFIXCA8("fix-cortex-a8",
@@ -1056,6 +1104,16 @@ static bool ProcessLinkerOptionsFromCommand(mcld::LinkerConfig& pConfig) {
   pConfig.options().setNewDTags(ArgEnableNewDTags);
   pConfig.options().setHashStyle(ArgHashStyle);
   pConfig.options().setNoStdlib(ArgNoStdlib);
+  pConfig.options().setNumThreads(ArgThreads);
+
+  // --map-whole-files is the default, the last one on the command line wins
+  if (ArgNoMapWholeFiles &&
+      ArgNoMapWholeFiles.getPosition() > ArgMapWholeFiles.getPosition())
+    pConfig.options().setMapWholeFiles(false);
+
+  pConfig.options().setLazyDynSymbols(ArgLazyDynSymbols);
+  pConfig.options().setTailMergeStrings(ArgTailMergeStrings);
+  pConfig.options().setArchiveIndexCache(ArgArchiveIndexCache);
 
   if (ArgStripAll)
     pConfig.options().setStripSymbols(mcld::GeneralOptions::StripAllSymbols);
@@ -1124,16 +1182,26 @@ static bool ProcessLinkerOptionsFromCommand(mcld::LinkerConfig& pConfig) {
     pConfig.options().addZOption(*zOpt);
   }
 
-  if (ArgGCSections) {
-    mcld::warning(mcld::diag::warn_unsupported_option) << ArgGCSections.ArgStr;
-  }
+  // --gc-sections and --print-gc-sections, the last one on the command line
+  // wins
+  if (ArgGCSections &&
+      ArgGCSections.getPosition() > ArgNoGCSections.getPosition())
+    pConfig.options().setGCSections(true);
+  if (ArgPrintGCSections &&
+      ArgPrintGCSections.getPosition() > ArgNoPrintGCSections.getPosition())
+    pConfig.options().setPrintGCSections(true);
 
   // set up icf mode
   switch (ArgICF) {
     case icf::None:
+      pConfig.options().setICFMode(mcld::GeneralOptions::ICFNone);
       break;
     case icf::All:
+      pConfig.options().setICFMode(mcld::GeneralOptions::ICFAll);
+      break;
     case icf::Safe:
+      pConfig.options().setICFMode(mcld::GeneralOptions::ICFSafe);
+      break;
     default:
       mcld::warning(mcld::diag::warn_unsupported_option) << ArgICF.ArgStr;
       break;
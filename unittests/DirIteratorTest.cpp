@@ -7,6 +7,7 @@
 //
 //===----------------------------------------------------------------------===//
 #include "mcld/Support/Directory.h"
+#include "mcld/MC/MCLDDirectory.h"
 #include "DirIteratorTest.h"
 #include "errno.h"
 
@@ -61,4 +62,19 @@ TEST_F( DirIteratorTest, open_dir ) {
   }
 }
 
+TEST_F( DirIteratorTest, find_by_file_name ) {
+  MCLDDirectory dir(".");
+  ASSERT_TRUE( dir.isGood() );
 
+  // every entry can be found by its file name after the index is built
+  size_t dir_size = dir.path().native().size();
+  EXPECT_TRUE(NULL == dir.find("no-such-file.so"));
+
+  Directory::iterator entry = dir.begin();
+  Directory::iterator enEnd = dir.end();
+  while( entry!=enEnd ) {
+    std::string file_name = entry.path()->native().substr(dir_size);
+    EXPECT_EQ(entry.path(), dir.find(file_name));
+    ++entry;
+  }
+}
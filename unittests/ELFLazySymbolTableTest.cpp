@@ -0,0 +1,499 @@
+//===- ELFLazySymbolTableTest.cpp -----------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/IRBuilder.h>
+#include <mcld/LinkerConfig.h>
+#include <mcld/Module.h>
+#include <mcld/Fragment/Relocation.h>
+#include <mcld/LD/ELFLazySymbolTable.h>
+#include <mcld/LD/ELFReader.h>
+#include <mcld/LD/LDContext.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/NamePool.h>
+#include <mcld/LD/ResolveInfo.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Support/MemoryArea.h>
+#include <mcld/Support/Path.h>
+#include <../lib/Target/X86/X86LDBackend.h>
+#include <../lib/Target/X86/X86GNUInfo.h>
+
+#include <llvm/Support/ELF.h>
+
+#include "ELFLazySymbolTableTest.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <unistd.h>
+
+using namespace mcld;
+using namespace mcldtest;
+
+namespace {
+
+void putLE(std::string& pData, size_t pOffset, uint64_t pValue, size_t pSize)
+{
+  for (size_t i = 0; i < pSize; ++i)
+    pData[pOffset + i] = static_cast<char>((pValue >> (8 * i)) & 0xff);
+}
+
+uint64_t getLE(const std::string& pData, size_t pOffset, size_t pSize)
+{
+  uint64_t result = 0;
+  for (size_t i = 0; i < pSize; ++i)
+    result |= uint64_t(static_cast<unsigned char>(pData[pOffset + i]))
+                << (8 * i);
+  return result;
+}
+
+/// GNUHash - the hash function of .gnu.hash
+uint32_t GNUHash(const std::string& pName)
+{
+  uint32_t hash = 5381;
+  for (size_t i = 0; i < pName.size(); ++i)
+    hash = (hash << 5) + hash + static_cast<unsigned char>(pName[i]);
+  return hash;
+}
+
+/// SysVHash - the hash function of .hash
+uint32_t SysVHash(const std::string& pName)
+{
+  uint32_t hash = 0;
+  for (size_t i = 0; i < pName.size(); ++i) {
+    hash = (hash << 4) + static_cast<unsigned char>(pName[i]);
+    uint32_t high = hash & 0xF0000000;
+    if (0 != high)
+      hash ^= high >> 24;
+    hash &= ~high;
+  }
+  return hash;
+}
+
+struct BucketCompare
+{
+  BucketCompare(uint32_t pNumOfBuckets) : buckets(pNumOfBuckets) { }
+
+  bool operator()(const std::pair<std::string, bool>& pX,
+                  const std::pair<std::string, bool>& pY) const
+  { return (GNUHash(pX.first) % buckets < GNUHash(pY.first) % buckets); }
+
+  uint32_t buckets;
+};
+
+/// BloomOffset - the offset of the bloom filter in .gnu.hash
+const size_t BloomOffset = 16;
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+ELFLazySymbolTableTest::ELFLazySymbolTableTest()
+{
+  m_pConfig = new LinkerConfig("x86_64-linux-gnu");
+  m_pConfig->targets().setEndian(TargetOptions::Little);
+  m_pConfig->targets().setBitClass(64);
+  m_pConfig->setCodeGenType(LinkerConfig::Exec);
+  Relocation::SetUp(*m_pConfig);
+
+  m_pInfo = new X86_64GNUInfo(m_pConfig->targets().triple());
+  m_pLDBackend = new X86_64GNULDBackend(*m_pConfig, m_pInfo);
+  m_pModule = new Module("lazy");
+  m_pIRBuilder = new IRBuilder(*m_pModule, *m_pConfig);
+  m_pELFReader = new ELFReader<64, true>(*m_pLDBackend);
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+ELFLazySymbolTableTest::~ELFLazySymbolTableTest()
+{
+  delete m_pELFReader;
+  delete m_pIRBuilder;
+  delete m_pModule;
+  delete m_pLDBackend;
+  delete m_pConfig;
+}
+
+// SetUp() will be called immediately before each test.
+void ELFLazySymbolTableTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void ELFLazySymbolTableTest::TearDown()
+{
+  for (size_t i = 0; i < m_Tables.size(); ++i)
+    delete m_Tables[i];
+  m_Tables.clear();
+
+  for (size_t i = 0; i < m_Files.size(); ++i)
+    ::unlink(m_Files[i].c_str());
+  m_Files.clear();
+}
+
+void ELFLazySymbolTableTest::addSymbol(const std::string& pName,
+                                       bool pDefined)
+{
+  m_Symbols.push_back(std::make_pair(pName, pDefined));
+}
+
+std::string ELFLazySymbolTableTest::gnuHash(uint32_t pNumOfBuckets,
+                                            uint32_t pSymOffset,
+                                            uint32_t pBloomSize,
+                                            uint32_t pBloomShift)
+{
+  // m_Symbols[i] is the symbol i + 1
+  std::stable_sort(m_Symbols.begin() + (pSymOffset - 1), m_Symbols.end(),
+                   BucketCompare(pNumOfBuckets));
+
+  size_t num_of_symbols = m_Symbols.size() + 1;
+  size_t buckets = BloomOffset + pBloomSize * 8;
+  size_t chains = buckets + pNumOfBuckets * 4;
+  std::string result(chains + (num_of_symbols - pSymOffset) * 4, '\0');
+  putLE(result, 0, pNumOfBuckets, 4);
+  putLE(result, 4, pSymOffset, 4);
+  putLE(result, 8, pBloomSize, 4);
+  putLE(result, 12, pBloomShift, 4);
+
+  for (uint32_t idx = pSymOffset; idx < num_of_symbols; ++idx) {
+    uint32_t hash = GNUHash(m_Symbols[idx - 1].first);
+    size_t word = BloomOffset + ((hash / 64) % pBloomSize) * 8;
+    putLE(result, word, getLE(result, word, 8) |
+                        (1ULL << (hash % 64)) |
+                        (1ULL << ((hash >> pBloomShift) % 64)), 8);
+
+    uint32_t bucket = hash % pNumOfBuckets;
+    if (0 == getLE(result, buckets + bucket * 4, 4))
+      putLE(result, buckets + bucket * 4, idx, 4);
+
+    // the lowest bit marks the end of the chain of a bucket
+    bool last = (idx + 1 == num_of_symbols ||
+                 bucket != GNUHash(m_Symbols[idx].first) % pNumOfBuckets);
+    putLE(result, chains + (idx - pSymOffset) * 4,
+          (hash & ~1U) | (last ? 1 : 0), 4);
+  }
+  return result;
+}
+
+std::string ELFLazySymbolTableTest::sysvHash(uint32_t pNumOfBuckets)
+{
+  size_t num_of_symbols = m_Symbols.size() + 1;
+  size_t chains = 8 + pNumOfBuckets * 4;
+  std::string result(chains + num_of_symbols * 4, '\0');
+  putLE(result, 0, pNumOfBuckets, 4);
+  putLE(result, 4, num_of_symbols, 4);
+
+  for (uint32_t idx = 1; idx < num_of_symbols; ++idx) {
+    uint32_t hash = SysVHash(m_Symbols[idx - 1].first);
+    size_t bucket = 8 + (hash % pNumOfBuckets) * 4;
+    putLE(result, chains + idx * 4, getLE(result, bucket, 4), 4);
+    putLE(result, bucket, idx, 4);
+  }
+  return result;
+}
+
+ELFLazySymbolTable* ELFLazySymbolTableTest::create(const std::string& pHashName,
+                                                   const std::string& pHash,
+                                                   bool pMapWholeFile)
+{
+  // .dynsym, .dynstr and the hash section, aligned to 8 bytes
+  std::string dynstr(1, '\0');
+  std::string dynsym(sizeof(llvm::ELF::Elf64_Sym), '\0');
+  for (size_t i = 0; i < m_Symbols.size(); ++i) {
+    std::string sym(sizeof(llvm::ELF::Elf64_Sym), '\0');
+    putLE(sym, 0, dynstr.size(), 4);
+    if (m_Symbols[i].second) {
+      sym[4] = (llvm::ELF::STB_GLOBAL << 4) | llvm::ELF::STT_FUNC;
+      putLE(sym, 6, llvm::ELF::SHN_ABS, 2);
+      putLE(sym, 8, 0x1000 + i * 16, 8);
+      putLE(sym, 16, 16, 8);
+    }
+    else
+      sym[4] = (llvm::ELF::STB_GLOBAL << 4) | llvm::ELF::STT_NOTYPE;
+    dynsym += sym;
+    dynstr += m_Symbols[i].first;
+    dynstr.push_back('\0');
+  }
+
+  std::string contents = dynsym + dynstr;
+  contents.resize((contents.size() + 7) & ~7U, '\0');
+  size_t hash_offset = contents.size();
+  contents += pHash;
+
+  char path[] = "/tmp/mcld-dynobj-XXXXXX";
+  int fd = ::mkstemp(path);
+  if (-1 == fd)
+    return NULL;
+  m_Files.push_back(path);
+  ssize_t size = ::write(fd, contents.data(), contents.size());
+  ::close(fd);
+  if (size != static_cast<ssize_t>(contents.size()))
+    return NULL;
+
+  Input* input = m_pIRBuilder->ReadInput("libfoo.so", sys::fs::Path(path));
+  if (NULL == input)
+    return NULL;
+  input->setType(Input::DynObj);
+  if (pMapWholeFile && !input->memArea()->mapWholeFile())
+    return NULL;
+
+  LDSection* symtab = IRBuilder::CreateELFHeader(*input,
+                                                 ".dynsym",
+                                                 llvm::ELF::SHT_DYNSYM,
+                                                 llvm::ELF::SHF_ALLOC,
+                                                 8);
+  symtab->setOffset(0);
+  symtab->setSize(dynsym.size());
+
+  LDSection* strtab = IRBuilder::CreateELFHeader(*input,
+                                                 ".dynstr",
+                                                 llvm::ELF::SHT_STRTAB,
+                                                 llvm::ELF::SHF_ALLOC,
+                                                 1);
+  strtab->setOffset(dynsym.size());
+  strtab->setSize(dynstr.size());
+  symtab->setLink(strtab);
+
+  uint32_t type = llvm::ELF::SHT_HASH;
+  if (".gnu.hash" == pHashName)
+    type = llvm::ELF::SHT_GNU_HASH;
+  LDSection* hash = IRBuilder::CreateELFHeader(*input,
+                                               pHashName,
+                                               type,
+                                               llvm::ELF::SHF_ALLOC,
+                                               8);
+  hash->setOffset(hash_offset);
+  hash->setSize(pHash.size());
+
+  ELFLazySymbolTable* result =
+    ELFLazySymbolTable::Create(*input, *m_pELFReader, 64);
+  if (NULL != result)
+    m_Tables.push_back(result);
+  return result;
+}
+
+bool ELFLazySymbolTableTest::isDefined(const std::string& pName) const
+{
+  const ResolveInfo* info = m_pModule->getNamePool().findInfo(pName);
+  return (NULL != info && info->isDefine());
+}
+
+bool ELFLazySymbolTableTest::isAdded(const std::string& pName) const
+{
+  return (NULL != m_pModule->getNamePool().findInfo(pName));
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( ELFLazySymbolTableTest, materialize_by_gnu_hash) {
+  addSymbol("puts", false);
+  addSymbol("foo");
+  addSymbol("bar");
+  addSymbol("baz");
+  addSymbol("qux");
+  ELFLazySymbolTable* table = create(".gnu.hash", gnuHash(3, 2, 1, 6));
+  ASSERT_TRUE(NULL != table);
+  ASSERT_EQ(6U, table->numOfSymbols());
+
+  // the undefined symbols are added at once, and the others on demand
+  table->readUnhashed(*m_pIRBuilder);
+  ASSERT_TRUE(isAdded("puts"));
+  ASSERT_FALSE(isDefined("puts"));
+  ASSERT_FALSE(isAdded("foo"));
+
+  ASSERT_TRUE(table->materialize("foo", *m_pIRBuilder));
+  ASSERT_TRUE(isDefined("foo"));
+  ASSERT_FALSE(isAdded("bar"));
+  ASSERT_TRUE(table->materialize("qux", *m_pIRBuilder));
+  ASSERT_TRUE(table->materialize("baz", *m_pIRBuilder));
+  ASSERT_TRUE(table->materialize("bar", *m_pIRBuilder));
+  ASSERT_EQ(4U, table->numOfMaterialized());
+
+  // not in the dynamic object, or not defined
+  ASSERT_FALSE(table->materialize("quux", *m_pIRBuilder));
+  ASSERT_FALSE(table->materialize("fo", *m_pIRBuilder));
+  ASSERT_FALSE(table->materialize("puts", *m_pIRBuilder));
+  ASSERT_EQ(4U, table->numOfMaterialized());
+}
+
+TEST_F( ELFLazySymbolTableTest, materialize_gnu_hash_chain) {
+  // all symbols are in the chain of the only bucket
+  addSymbol("foo");
+  addSymbol("bar");
+  addSymbol("baz");
+  ELFLazySymbolTable* table = create(".gnu.hash", gnuHash(1, 1, 2, 5));
+  ASSERT_TRUE(NULL != table);
+
+  table->readUnhashed(*m_pIRBuilder);
+  ASSERT_FALSE(isAdded("foo"));
+  ASSERT_TRUE(table->materialize("baz", *m_pIRBuilder));
+  ASSERT_TRUE(table->materialize("foo", *m_pIRBuilder));
+  ASSERT_TRUE(table->materialize("bar", *m_pIRBuilder));
+  ASSERT_FALSE(table->materialize("qux", *m_pIRBuilder));
+  ASSERT_EQ(3U, table->numOfMaterialized());
+}
+
+TEST_F( ELFLazySymbolTableTest, read_unhashed_symbols) {
+  // the symbols before symoffset are not in .gnu.hash
+  addSymbol("local_foo");
+  addSymbol("puts", false);
+  addSymbol("foo");
+  ELFLazySymbolTable* table = create(".gnu.hash", gnuHash(1, 3, 1, 6));
+  ASSERT_TRUE(NULL != table);
+
+  table->readUnhashed(*m_pIRBuilder);
+  ASSERT_TRUE(isDefined("local_foo"));
+  ASSERT_TRUE(isAdded("puts"));
+  ASSERT_FALSE(isAdded("foo"));
+  ASSERT_FALSE(table->materialize("local_foo", *m_pIRBuilder));
+  ASSERT_TRUE(table->materialize("foo", *m_pIRBuilder));
+}
+
+TEST_F( ELFLazySymbolTableTest, reject_by_bloom_filter) {
+  addSymbol("foo");
+  addSymbol("bar");
+  std::string hash = gnuHash(1, 1, 1, 6);
+
+  // without the bits of the bloom filter, the symbols in the chain are not
+  // looked at
+  putLE(hash, BloomOffset, 0x0, 8);
+  ELFLazySymbolTable* table = create(".gnu.hash", hash);
+  ASSERT_TRUE(NULL != table);
+  ASSERT_FALSE(table->materialize("foo", *m_pIRBuilder));
+  ASSERT_FALSE(table->materialize("bar", *m_pIRBuilder));
+  ASSERT_FALSE(isAdded("foo"));
+
+  // a bloom filter of all bits lets the chain reject the names
+  putLE(hash, BloomOffset, ~0x0ULL, 8);
+  table = create(".gnu.hash", hash);
+  ASSERT_TRUE(NULL != table);
+  ASSERT_FALSE(table->materialize("qux", *m_pIRBuilder));
+  ASSERT_TRUE(table->materialize("bar", *m_pIRBuilder));
+}
+
+TEST_F( ELFLazySymbolTableTest, materialize_by_sysv_hash) {
+  addSymbol("puts", false);
+  addSymbol("foo");
+  addSymbol("bar");
+  addSymbol("baz");
+  ELFLazySymbolTable* table = create(".hash", sysvHash(2));
+  ASSERT_TRUE(NULL != table);
+
+  table->readUnhashed(*m_pIRBuilder);
+  ASSERT_TRUE(isAdded("puts"));
+  ASSERT_FALSE(isAdded("bar"));
+
+  ASSERT_TRUE(table->materialize("bar", *m_pIRBuilder));
+  ASSERT_TRUE(isDefined("bar"));
+  ASSERT_TRUE(table->materialize("foo", *m_pIRBuilder));
+  ASSERT_TRUE(table->materialize("baz", *m_pIRBuilder));
+  ASSERT_FALSE(table->materialize("puts", *m_pIRBuilder));
+  ASSERT_FALSE(table->materialize("qux", *m_pIRBuilder));
+  ASSERT_EQ(3U, table->numOfMaterialized());
+}
+
+TEST_F( ELFLazySymbolTableTest, reject_malformed_gnu_hash) {
+  addSymbol("foo");
+  addSymbol("bar");
+  const std::string hash = gnuHash(2, 1, 1, 6);
+
+  // a header cut by the end of the section
+  ASSERT_TRUE(NULL == create(".gnu.hash", hash.substr(0, 12)));
+
+  // no bucket, no bloom filter, or a shift as wide as a word
+  std::string bad(hash);
+  putLE(bad, 0, 0, 4);
+  ASSERT_TRUE(NULL == create(".gnu.hash", bad));
+  bad = hash;
+  putLE(bad, 8, 0, 4);
+  ASSERT_TRUE(NULL == create(".gnu.hash", bad));
+  bad = hash;
+  putLE(bad, 12, 32, 4);
+  ASSERT_TRUE(NULL == create(".gnu.hash", bad));
+
+  // symoffset is beyond .dynsym
+  bad = hash;
+  putLE(bad, 4, 4, 4);
+  ASSERT_TRUE(NULL == create(".gnu.hash", bad));
+
+  // the bloom filter or the buckets run off the section
+  bad = hash;
+  putLE(bad, 8, 0x20000000, 4);
+  ASSERT_TRUE(NULL == create(".gnu.hash", bad));
+  bad = hash;
+  putLE(bad, 0, 0x40000000, 4);
+  ASSERT_TRUE(NULL == create(".gnu.hash", bad));
+
+  // not mapped as a whole
+  ASSERT_TRUE(NULL == create(".gnu.hash", hash, false));
+  ASSERT_TRUE(NULL != create(".gnu.hash", hash));
+}
+
+TEST_F( ELFLazySymbolTableTest, bound_gnu_hash_chains) {
+  addSymbol("foo");
+  addSymbol("bar");
+  addSymbol("baz");
+  std::string hash = gnuHash(1, 1, 1, 6);
+
+  // the chains are cut short, and the end of the chain is never marked
+  hash.resize(hash.size() - 4);
+  putLE(hash, hash.size() - 4, getLE(hash, hash.size() - 4, 4) & ~1U, 4);
+  ELFLazySymbolTable* table = create(".gnu.hash", hash);
+  ASSERT_TRUE(NULL != table);
+  ASSERT_FALSE(table->materialize("baz", *m_pIRBuilder));
+  ASSERT_FALSE(table->materialize("qux", *m_pIRBuilder));
+  ASSERT_TRUE(table->materialize("foo", *m_pIRBuilder));
+
+  // a bucket before symoffset
+  hash = gnuHash(1, 2, 1, 6);
+  putLE(hash, BloomOffset + 8, 1, 4);
+  table = create(".gnu.hash", hash);
+  ASSERT_TRUE(NULL != table);
+  ASSERT_FALSE(table->materialize("bar", *m_pIRBuilder));
+}
+
+TEST_F( ELFLazySymbolTableTest, reject_malformed_sysv_hash) {
+  addSymbol("foo");
+  addSymbol("bar");
+  const std::string hash = sysvHash(2);
+
+  // a header cut by the end of the section
+  ASSERT_TRUE(NULL == create(".hash", hash.substr(0, 4)));
+
+  // no bucket, or fewer chains than the symbols
+  std::string bad(hash);
+  putLE(bad, 0, 0, 4);
+  ASSERT_TRUE(NULL == create(".hash", bad));
+  bad = hash;
+  putLE(bad, 4, 2, 4);
+  ASSERT_TRUE(NULL == create(".hash", bad));
+
+  // the buckets or the chains run off the section
+  bad = hash;
+  putLE(bad, 0, 0x40000000, 4);
+  ASSERT_TRUE(NULL == create(".hash", bad));
+  ASSERT_TRUE(NULL == create(".hash", hash.substr(0, hash.size() - 4)));
+}
+
+TEST_F( ELFLazySymbolTableTest, bound_sysv_hash_chains) {
+  addSymbol("foo");
+  addSymbol("bar");
+  std::string hash = sysvHash(1);
+
+  // the chains are a loop
+  size_t chains = 8 + 4;
+  putLE(hash, chains + 1 * 4, 2, 4);
+  putLE(hash, chains + 2 * 4, 1, 4);
+  ELFLazySymbolTable* table = create(".hash", hash);
+  ASSERT_TRUE(NULL != table);
+  ASSERT_FALSE(table->materialize("qux", *m_pIRBuilder));
+  ASSERT_TRUE(table->materialize("foo", *m_pIRBuilder));
+
+  // a chain to a symbol beyond .dynsym
+  putLE(hash, chains + 2 * 4, 7, 4);
+  table = create(".hash", hash);
+  ASSERT_TRUE(NULL != table);
+  ASSERT_FALSE(table->materialize("qux", *m_pIRBuilder));
+}
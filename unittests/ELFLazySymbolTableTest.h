@@ -0,0 +1,98 @@
+//===- ELFLazySymbolTableTest.h -------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_ELF_LAZY_SYMBOL_TABLE_TEST_H
+#define MCLD_ELF_LAZY_SYMBOL_TABLE_TEST_H
+
+#include <gtest.h>
+#include <llvm/Support/DataTypes.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mcld {
+class ELFLazySymbolTable;
+class ELFReaderIF;
+class GNUInfo;
+class GNULDBackend;
+class IRBuilder;
+class LinkerConfig;
+class Module;
+} // namespace for mcld
+
+namespace mcldtest
+{
+
+/** \class ELFLazySymbolTableTest
+ *  \brief The testcases of looking up the .dynsym of a dynamic object by its
+ *  .gnu.hash or .hash section.
+ *
+ *  The .dynsym, .dynstr and the hash section are written to a temporary
+ *  file, which is mapped as a whole.
+ *
+ *  \see ELFLazySymbolTable
+ */
+class ELFLazySymbolTableTest : public ::testing::Test
+{
+public:
+  // Constructor can do set-up work for all test here.
+  ELFLazySymbolTableTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~ELFLazySymbolTableTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+
+protected:
+  /// addSymbol - add a global function to .dynsym, or an undefined symbol
+  void addSymbol(const std::string& pName, bool pDefined = true);
+
+  /// gnuHash - lay out the symbols from pSymOffset by their buckets, and
+  /// build the .gnu.hash of them
+  std::string gnuHash(uint32_t pNumOfBuckets,
+                      uint32_t pSymOffset,
+                      uint32_t pBloomSize,
+                      uint32_t pBloomShift);
+
+  /// sysvHash - build the .hash of the symbols
+  std::string sysvHash(uint32_t pNumOfBuckets);
+
+  /// create - write .dynsym, .dynstr and the hash section pHashName to a
+  /// file, and create the lazy symbol table of it
+  mcld::ELFLazySymbolTable* create(const std::string& pHashName,
+                                   const std::string& pHash,
+                                   bool pMapWholeFile = true);
+
+  /// isDefined - whether pName is defined in NamePool
+  bool isDefined(const std::string& pName) const;
+
+  /// isAdded - whether pName is in NamePool
+  bool isAdded(const std::string& pName) const;
+
+protected:
+  mcld::LinkerConfig* m_pConfig;
+  mcld::GNUInfo* m_pInfo;
+  mcld::GNULDBackend* m_pLDBackend;
+  mcld::Module* m_pModule;
+  mcld::IRBuilder* m_pIRBuilder;
+  mcld::ELFReaderIF* m_pELFReader;
+
+  /// the names of the symbols from index 1, and whether they are defined
+  std::vector<std::pair<std::string, bool> > m_Symbols;
+  std::vector<mcld::ELFLazySymbolTable*> m_Tables;
+  std::vector<std::string> m_Files;
+};
+
+} // namespace of mcldtest
+
+#endif
+
@@ -0,0 +1,162 @@
+//===- ELFObjectWriterTest.cpp --------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/LinkerConfig.h>
+#include <mcld/LD/ELFObjectWriter.h>
+#include <mcld/Target/GNULDBackend.h>
+#include <../lib/Target/X86/X86LDBackend.h>
+#include <../lib/Target/X86/X86GNUInfo.h>
+
+#include "ELFObjectWriterTest.h"
+
+#include <cstring>
+
+using namespace mcld;
+using namespace mcldtest;
+
+// Constructor can do set-up work for all test here.
+ELFObjectWriterTest::ELFObjectWriterTest()
+{
+  m_pConfig = new LinkerConfig("x86_64-linux-gnu");
+  m_pConfig->targets().setEndian(TargetOptions::Little);
+  m_pConfig->targets().setBitClass(64);
+
+  m_pInfo = new X86_64GNUInfo(m_pConfig->targets().triple());
+  m_pLDBackend = new X86_64GNULDBackend(*m_pConfig, m_pInfo);
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+ELFObjectWriterTest::~ELFObjectWriterTest()
+{
+  delete m_pLDBackend;
+  delete m_pConfig;
+}
+
+// SetUp() will be called immediately before each test.
+void ELFObjectWriterTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void ELFObjectWriterTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( ELFObjectWriterTest, fill_one_byte) {
+  uint8_t buf[9];
+  std::memset(buf, 0xee, sizeof(buf));
+  ELFObjectWriter::FillPattern(buf, 8, 0x1234ab, 1, true);
+  for (size_t i = 0; i < 8; ++i)
+    ASSERT_EQ(0xab, buf[i]);
+  ASSERT_EQ(0xee, buf[8]);
+}
+
+TEST_F( ELFObjectWriterTest, fill_in_target_byte_order) {
+  uint8_t buf[11];
+
+  std::memset(buf, 0xee, sizeof(buf));
+  ELFObjectWriter::FillPattern(buf, 10, 0x11223344, 4, true);
+  const uint8_t little[] = { 0x44, 0x33, 0x22, 0x11, 0x44,
+                             0x33, 0x22, 0x11, 0x44, 0x33, 0xee };
+  ASSERT_EQ(0, std::memcmp(little, buf, sizeof(buf)));
+
+  std::memset(buf, 0xee, sizeof(buf));
+  ELFObjectWriter::FillPattern(buf, 10, 0x11223344, 4, false);
+  const uint8_t big[] = { 0x11, 0x22, 0x33, 0x44, 0x11,
+                          0x22, 0x33, 0x44, 0x11, 0x22, 0xee };
+  ASSERT_EQ(0, std::memcmp(big, buf, sizeof(buf)));
+
+  std::memset(buf, 0xee, sizeof(buf));
+  ELFObjectWriter::FillPattern(buf, 5, 0xa1b2, 2, false);
+  const uint8_t half[] = { 0xa1, 0xb2, 0xa1, 0xb2, 0xa1, 0xee };
+  ASSERT_EQ(0, std::memcmp(half, buf, sizeof(half)));
+}
+
+TEST_F( ELFObjectWriterTest, fill_eight_bytes) {
+  uint8_t buf[40];
+  std::memset(buf, 0xee, sizeof(buf));
+  ELFObjectWriter::FillPattern(buf, 35, 0x0102030405060708ULL, 8, true);
+  for (size_t i = 0; i < 35; ++i)
+    ASSERT_EQ(8 - (i % 8), buf[i]);
+  for (size_t i = 35; i < sizeof(buf); ++i)
+    ASSERT_EQ(0xee, buf[i]);
+}
+
+TEST_F( ELFObjectWriterTest, fill_shorter_than_value) {
+  uint8_t buf[4];
+  std::memset(buf, 0xee, sizeof(buf));
+  ELFObjectWriter::FillPattern(buf, 3, 0x0102030405060708ULL, 8, false);
+  ASSERT_EQ(0x01, buf[0]);
+  ASSERT_EQ(0x02, buf[1]);
+  ASSERT_EQ(0x03, buf[2]);
+  ASSERT_EQ(0xee, buf[3]);
+
+  ELFObjectWriter::FillPattern(buf, 0, 0x01, 1, true);
+  ASSERT_EQ(0x01, buf[0]);
+}
+
+TEST_F( ELFObjectWriterTest, fill_repeated_byte_value) {
+  uint8_t buf[17];
+  std::memset(buf, 0xee, sizeof(buf));
+  ELFObjectWriter::FillPattern(buf, 16, 0x9090909090909090ULL, 8, false);
+  for (size_t i = 0; i < 16; ++i)
+    ASSERT_EQ(0x90, buf[i]);
+  ASSERT_EQ(0xee, buf[16]);
+}
+
+TEST_F( ELFObjectWriterTest, x86_nops) {
+  const uint8_t nops[] = {
+    0x90,
+    0x66, 0x90,
+    0x0f, 0x1f, 0x00,
+    0x0f, 0x1f, 0x40, 0x00,
+    0x0f, 0x1f, 0x44, 0x00, 0x00,
+    0x66, 0x0f, 0x1f, 0x44, 0x00, 0x00,
+    0x0f, 0x1f, 0x80, 0x00, 0x00, 0x00, 0x00,
+    0x0f, 0x1f, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00
+  };
+  const size_t start[] = { 0, 1, 3, 6, 10, 15, 21, 28, 36 };
+
+  // each padding of one to eight bytes is a single NOP
+  uint8_t buf[9];
+  for (size_t size = 1; size <= 8; ++size) {
+    std::memset(buf, 0xee, sizeof(buf));
+    m_pLDBackend->emitNops(buf, size);
+    ASSERT_EQ(0, std::memcmp(nops + start[size - 1], buf, size));
+    ASSERT_EQ(0xee, buf[size]);
+  }
+}
+
+TEST_F( ELFObjectWriterTest, x86_long_nops) {
+  // the longest NOP first, and the rest in one
+  uint8_t buf[20];
+  std::memset(buf, 0xee, sizeof(buf));
+  m_pLDBackend->emitNops(buf, 19);
+
+  const uint8_t nop8[] = { 0x0f, 0x1f, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 };
+  const uint8_t nop3[] = { 0x0f, 0x1f, 0x00 };
+  ASSERT_EQ(0, std::memcmp(nop8, buf, 8));
+  ASSERT_EQ(0, std::memcmp(nop8, buf + 8, 8));
+  ASSERT_EQ(0, std::memcmp(nop3, buf + 16, 3));
+  ASSERT_EQ(0xee, buf[19]);
+
+  m_pLDBackend->emitNops(buf, 0);
+  ASSERT_EQ(0x0f, buf[0]);
+}
+
+TEST_F( ELFObjectWriterTest, default_nops_are_zeros) {
+  uint8_t buf[6];
+  std::memset(buf, 0xee, sizeof(buf));
+  m_pLDBackend->GNULDBackend::emitNops(buf, 5);
+  for (size_t i = 0; i < 5; ++i)
+    ASSERT_EQ(0x0, buf[i]);
+  ASSERT_EQ(0xee, buf[5]);
+}
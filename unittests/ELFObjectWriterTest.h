@@ -0,0 +1,52 @@
+//===- ELFObjectWriterTest.h ----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_ELF_OBJECT_WRITER_TEST_H
+#define MCLD_ELF_OBJECT_WRITER_TEST_H
+
+#include <gtest.h>
+
+namespace mcld {
+class GNUInfo;
+class GNULDBackend;
+class LinkerConfig;
+} // namespace for mcld
+
+namespace mcldtest
+{
+
+/** \class ELFObjectWriterTest
+ *  \brief The testcases of filling the padding of the output.
+ *
+ *  \see ELFObjectWriter
+ */
+class ELFObjectWriterTest : public ::testing::Test
+{
+public:
+  // Constructor can do set-up work for all test here.
+  ELFObjectWriterTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~ELFObjectWriterTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+
+protected:
+  mcld::LinkerConfig* m_pConfig;
+  mcld::GNUInfo* m_pInfo;
+  mcld::GNULDBackend* m_pLDBackend;
+};
+
+} // namespace of mcldtest
+
+#endif
+
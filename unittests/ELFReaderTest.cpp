@@ -7,13 +7,24 @@
 //
 //===----------------------------------------------------------------------===//
 #include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <unistd.h>
 
 #include <llvm/Support/ELF.h>
 #include <mcld/IRBuilder.h>
 #include <mcld/TargetOptions.h>
+#include <mcld/Fragment/FragmentRef.h>
+#include <mcld/LD/ELFInputTables.h>
 #include <mcld/LD/ELFReader.h>
+#include <mcld/LD/InputPrefetcher.h>
+#include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/SectionData.h>
 #include <mcld/MC/MCLDInput.h>
+#include <mcld/Support/MemoryArea.h>
 #include <mcld/Support/Path.h>
+#include <mcld/Support/Space.h>
 #include <../lib/Target/X86/X86LDBackend.h>
 #include <../lib/Target/X86/X86GNUInfo.h>
 
@@ -23,6 +34,136 @@ using namespace mcld;
 using namespace mcld::sys::fs;
 using namespace mcldtest;
 
+namespace {
+
+void putLE(std::string& pData, size_t pOffset, uint64_t pValue, size_t pSize)
+{
+  for (size_t i = 0; i < pSize; ++i)
+    pData[pOffset + i] = static_cast<char>((pValue >> (8 * i)) & 0xff);
+}
+
+/// append - append pData aligned to pAlign, and return its offset
+size_t append(std::string& pFile, const std::string& pData, size_t pAlign)
+{
+  pFile.resize((pFile.size() + pAlign - 1) / pAlign * pAlign, '\0');
+  size_t result = pFile.size();
+  pFile += pData;
+  return result;
+}
+
+std::string symbol(uint32_t pName, uint8_t pInfo, uint16_t pShndx,
+                   uint64_t pValue)
+{
+  std::string result(sizeof(llvm::ELF::Elf64_Sym), '\0');
+  putLE(result, 0, pName, 4);
+  result[4] = pInfo;
+  putLE(result, 6, pShndx, 2);
+  putLE(result, 8, pValue, 8);
+  putLE(result, 16, 8, 8);
+  return result;
+}
+
+/// ExtendedObject - an x86_64 object whose e_shnum and e_shstrndx are in
+/// the first section header. The section index of foo is in .symtab_shndx.
+///   [0] NULL, [1] .text, [2] .symtab, [3] .strtab, [4] .symtab_shndx,
+///   [5] .shstrtab
+std::string ExtendedObject()
+{
+  std::string file(sizeof(llvm::ELF::Elf64_Ehdr), '\0');
+  file[0] = 0x7f; file[1] = 'E'; file[2] = 'L'; file[3] = 'F';
+  file[4] = llvm::ELF::ELFCLASS64;
+  file[5] = llvm::ELF::ELFDATA2LSB;
+  file[6] = llvm::ELF::EV_CURRENT;
+  putLE(file, 16, llvm::ELF::ET_REL, 2);
+  putLE(file, 18, llvm::ELF::EM_X86_64, 2);
+  putLE(file, 20, llvm::ELF::EV_CURRENT, 4);
+  putLE(file, 52, sizeof(llvm::ELF::Elf64_Ehdr), 2);
+  putLE(file, 58, sizeof(llvm::ELF::Elf64_Shdr), 2);
+  putLE(file, 60, 0, 2);
+  putLE(file, 62, llvm::ELF::SHN_XINDEX, 2);
+
+  std::string symtab = symbol(0, 0, 0, 0);
+  symtab += symbol(1, (llvm::ELF::STB_GLOBAL << 4) | llvm::ELF::STT_FUNC,
+                   llvm::ELF::SHN_XINDEX, 0);
+  symtab += symbol(5, (llvm::ELF::STB_GLOBAL << 4) | llvm::ELF::STT_FUNC,
+                   1, 8);
+  std::string strtab("\0foo\0bar\0", 9);
+  std::string shndx(3 * 4, '\0');
+  putLE(shndx, 4, 1, 4);
+  std::string shstrtab("\0.text\0.symtab\0.strtab\0.symtab_shndx\0.shstrtab\0",
+                       47);
+
+  size_t text_off = append(file, std::string(16, '\xc3'), 16);
+  size_t symtab_off = append(file, symtab, 8);
+  size_t strtab_off = append(file, strtab, 1);
+  size_t shndx_off = append(file, shndx, 4);
+  size_t shstrtab_off = append(file, shstrtab, 1);
+
+  std::string shdrs(6 * sizeof(llvm::ELF::Elf64_Shdr), '\0');
+  struct {
+    uint32_t name, type;
+    uint64_t flags, offset, size;
+    uint32_t link, info;
+    uint64_t align, entsize;
+  } headers[6] = {
+    { 0, 0, 0, 0, 6, 5, 0, 0, 0 },
+    { 1, llvm::ELF::SHT_PROGBITS,
+      llvm::ELF::SHF_ALLOC | llvm::ELF::SHF_EXECINSTR,
+      text_off, 16, 0, 0, 16, 0 },
+    { 7, llvm::ELF::SHT_SYMTAB, 0, symtab_off, symtab.size(), 3, 1, 8, 24 },
+    { 15, llvm::ELF::SHT_STRTAB, 0, strtab_off, strtab.size(), 0, 0, 1, 0 },
+    { 23, llvm::ELF::SHT_SYMTAB_SHNDX, 0, shndx_off, shndx.size(), 2, 0, 4,
+      4 },
+    { 37, llvm::ELF::SHT_STRTAB, 0, shstrtab_off, shstrtab.size(), 0, 0, 1,
+      0 }
+  };
+  for (size_t i = 0; i < 6; ++i) {
+    size_t offset = i * sizeof(llvm::ELF::Elf64_Shdr);
+    putLE(shdrs, offset + 0x0,  headers[i].name,    4);
+    putLE(shdrs, offset + 0x4,  headers[i].type,    4);
+    putLE(shdrs, offset + 0x8,  headers[i].flags,   8);
+    putLE(shdrs, offset + 0x18, headers[i].offset,  8);
+    putLE(shdrs, offset + 0x20, headers[i].size,    8);
+    putLE(shdrs, offset + 0x28, headers[i].link,    4);
+    putLE(shdrs, offset + 0x2c, headers[i].info,    4);
+    putLE(shdrs, offset + 0x30, headers[i].align,   8);
+    putLE(shdrs, offset + 0x38, headers[i].entsize, 8);
+  }
+  putLE(file, 40, append(file, shdrs, 8), 8);
+  return file;
+}
+
+/// TempFile - a temporary file which is removed at the end of the scope
+class TempFile
+{
+public:
+  TempFile(const std::string& pContents) {
+    char path[] = "/tmp/mcld-elf-XXXXXX";
+    int fd = ::mkstemp(path);
+    if (-1 == fd)
+      return;
+    m_Path = path;
+    ssize_t size = ::write(fd, pContents.data(), pContents.size());
+    ::close(fd);
+    if (size != static_cast<ssize_t>(pContents.size())) {
+      ::unlink(path);
+      m_Path.clear();
+    }
+  }
+
+  ~TempFile() {
+    if (!m_Path.empty())
+      ::unlink(m_Path.c_str());
+  }
+
+  const std::string& path() const { return m_Path; }
+
+private:
+  std::string m_Path;
+};
+
+} // anonymous namespace
+
 // Constructor can do set-up work for all test here.
 ELFReaderTest::ELFReaderTest()
  : m_pInput(NULL)
@@ -116,7 +257,7 @@ TEST_F( ELFReaderTest, read_symbol_and_rela )
                          strtab_shdr->size());
   char* strtab = reinterpret_cast<char*>(strtab_region->start());
   bool result = m_pELFReader->readSymbols(*m_pInput, *m_pIRBuilder,
-                                          *symtab_region, strtab);
+                                          *symtab_region, strtab, NULL);
   ASSERT_TRUE(result);
   ASSERT_EQ("hello.c", std::string(m_pInput->context()->getSymbol(1)->name()));
   ASSERT_EQ("puts", std::string(m_pInput->context()->getSymbol(10)->name()));
@@ -159,4 +300,151 @@ TEST_F( ELFReaderTest, is_my_format ) {
   ASSERT_TRUE( m_pELFObjReader->isMyFormat(*m_pInput) );
 }
 
+TEST_F( ELFReaderTest, read_extended_section_headers ) {
+  TempFile file(ExtendedObject());
+  ASSERT_FALSE(file.path().empty());
+  Input* input = m_pIRBuilder->ReadInput("extended", Path(file.path()));
+  ASSERT_TRUE(NULL != input);
+  input->setType(Input::Object);
 
+  // e_shnum and e_shstrndx are in the first section header, which is a
+  // section of the object, too
+  ASSERT_TRUE(m_pELFObjReader->readHeader(*input));
+  ASSERT_EQ(6U, input->context()->numOfSections());
+  ASSERT_EQ("", input->context()->getSection(0)->name());
+  ASSERT_EQ(".text", input->context()->getSection(1)->name());
+  ASSERT_EQ(0x40U, input->context()->getSection(1)->offset());
+  ASSERT_EQ(".symtab_shndx", input->context()->getSection(4)->name());
+  ASSERT_EQ(".shstrtab", input->context()->getSection(5)->name());
+  ASSERT_TRUE(input->context()->getSection(2) ==
+              input->context()->getSection(4)->getLink());
+}
+
+TEST_F( ELFReaderTest, read_extended_section_index ) {
+  TempFile file(ExtendedObject());
+  ASSERT_FALSE(file.path().empty());
+  Input* input = m_pIRBuilder->ReadInput("extended", Path(file.path()));
+  ASSERT_TRUE(NULL != input);
+  input->setType(Input::Object);
+
+  ASSERT_TRUE(m_pELFObjReader->readHeader(*input));
+  ASSERT_TRUE(m_pELFObjReader->readSections(*input));
+  ASSERT_TRUE(m_pELFObjReader->readSymbols(*input));
+  ASSERT_EQ(3U, input->context()->numOfSymbols());
+
+  // foo is SHN_XINDEX, and .symtab_shndx puts it in .text
+  LDSymbol* foo = input->context()->getSymbol(1);
+  ASSERT_EQ("foo", std::string(foo->name()));
+  ASSERT_TRUE(foo->resolveInfo()->isDefine());
+  ASSERT_TRUE(foo->hasFragRef());
+  ASSERT_EQ(".text",
+            foo->fragRef()->frag()->getParent()->getSection().name());
+
+  LDSymbol* bar = input->context()->getSymbol(2);
+  ASSERT_EQ("bar", std::string(bar->name()));
+  ASSERT_TRUE(bar->resolveInfo()->isDefine());
+}
+
+TEST_F( ELFReaderTest, read_prefetched_tables ) {
+  // the workers read the tables in the whole file mapping as well as in the
+  // spaces they load by themselves
+  for (int whole = 0; whole < 2; ++whole) {
+    m_pConfig->options().setMapWholeFiles(1 == whole);
+    TempFile file(ExtendedObject());
+    ASSERT_FALSE(file.path().empty());
+    Input* input = m_pIRBuilder->ReadInput("extended", Path(file.path()));
+    ASSERT_TRUE(NULL != input);
+    ASSERT_EQ(1 == whole, input->memArea()->isWholeFileMapped());
+
+    InputPrefetcher prefetcher(2);
+    prefetcher.add(*input);
+    prefetcher.load();
+    ASSERT_TRUE(input->hasELFTables());
+
+    const ELFInputTables* tables = input->elfTables();
+    ASSERT_EQ(6U, tables->sections().size());
+    ASSERT_EQ(".text", tables->sections()[1].name);
+    ASSERT_EQ(".symtab_shndx", tables->sections()[4].name);
+    ASSERT_EQ(2U, tables->symTab());
+    ASSERT_EQ(3U, tables->symbols().size());
+    ASSERT_TRUE(llvm::ELF::SHN_XINDEX == tables->symbols()[1].st_shndx);
+    ASSERT_EQ(8U, tables->symbols()[2].st_size);
+
+    // change the decoded size of bar. The readers take the symbols from the
+    // tables, not from the file.
+    const_cast<ELFInputTables*>(tables)->symbols()[2].st_size = 4;
+
+    input->setType(Input::Object);
+    ASSERT_TRUE(m_pELFObjReader->readHeader(*input));
+    ASSERT_TRUE(m_pELFObjReader->readSections(*input));
+    ASSERT_TRUE(m_pELFObjReader->readSymbols(*input));
+    ASSERT_EQ(6U, input->context()->numOfSections());
+    ASSERT_TRUE(input->context()->getSection(2) ==
+                input->context()->getSection(4)->getLink());
+    ASSERT_EQ(3U, input->context()->numOfSymbols());
+
+    LDSymbol* foo = input->context()->getSymbol(1);
+    ASSERT_EQ("foo", std::string(foo->name()));
+    ASSERT_TRUE(foo->hasFragRef());
+    ASSERT_EQ(".text",
+              foo->fragRef()->frag()->getParent()->getSection().name());
+
+    LDSymbol* bar = input->context()->getSymbol(2);
+    ASSERT_EQ("bar", std::string(bar->name()));
+    ASSERT_EQ(4U, bar->resolveInfo()->size());
+
+    prefetcher.release();
+    ASSERT_FALSE(input->hasELFTables());
+  }
+}
+
+TEST_F( ELFReaderTest, read_symbols_throughput ) {
+  // about the number of symbols of a large object; a quarter of them are
+  // undefined, and a quarter are local
+  const unsigned int num_of_symbols = 60000;
+  std::string strtab(1, '\0');
+  std::string symtab = symbol(0, 0, 0, 0);
+  char name[64];
+  for (unsigned int i = 0; i < num_of_symbols; ++i) {
+    snprintf(name, sizeof(name), "_ZN4mcld8LDSymbol%u6bench%uEv", i % 97, i);
+    uint8_t info = (llvm::ELF::STB_GLOBAL << 4) | llvm::ELF::STT_FUNC;
+    uint16_t shndx = llvm::ELF::SHN_ABS;
+    if (0 == i % 4) {
+      info = (llvm::ELF::STB_GLOBAL << 4) | llvm::ELF::STT_NOTYPE;
+      shndx = llvm::ELF::SHN_UNDEF;
+    }
+    else if (1 == i % 4)
+      info = (llvm::ELF::STB_LOCAL << 4) | llvm::ELF::STT_OBJECT;
+    symtab += symbol(strtab.size(), info, shndx, i);
+    strtab += name;
+    strtab.push_back('\0');
+  }
+
+  Space* space = Space::Create(const_cast<char*>(symtab.data()),
+                               symtab.size());
+  MemoryArea* area = new MemoryArea(*space);
+  MemoryRegion* region = area->request(0, symtab.size());
+
+  const unsigned int rounds = 5;
+  clock_t start = clock();
+  for (unsigned int round = 0; round < rounds; ++round) {
+    Module module("bench");
+    IRBuilder builder(module, *m_pConfig);
+    Input* input = builder.CreateInput("bench.o", Path("bench.o"),
+                                       Input::Object);
+    ASSERT_TRUE(m_pELFReader->readSymbols(*input, builder, *region,
+                                          strtab.data(), NULL));
+    ASSERT_EQ(num_of_symbols + 1, input->context()->numOfSymbols());
+  }
+  double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  area->release(region);
+  delete area;
+  Space::Destroy(space);
+
+  if (seconds <= 0.0)
+    seconds = 1.0 / CLOCKS_PER_SEC;
+  printf("[ BENCH    ] %u symbols\n", num_of_symbols);
+  printf("[ BENCH    ] readSymbols: %.0f symbols/s\n",
+         rounds * num_of_symbols / seconds);
+}
@@ -0,0 +1,320 @@
+//===- EhFrameHdrTest.cpp -------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/IRBuilder.h>
+#include <mcld/LinkerConfig.h>
+#include <mcld/Module.h>
+#include <mcld/Fragment/Relocation.h>
+#include <mcld/LD/EhFrame.h>
+#include <mcld/LD/EhFrameHdr.h>
+#include <mcld/LD/EhFrameReader.h>
+#include <mcld/LD/LDContext.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Support/MemoryArea.h>
+#include <mcld/Support/Path.h>
+#include <mcld/Support/Space.h>
+
+#include <llvm/Support/Dwarf.h>
+#include <llvm/Support/ELF.h>
+
+#include <cstring>
+
+#include "EhFrameHdrTest.h"
+
+using namespace mcld;
+using namespace mcldtest;
+using namespace llvm::dwarf;
+
+namespace {
+
+void append32(std::string& pData, uint32_t pValue)
+{
+  for (size_t i = 0; i < 4; ++i)
+    pData.push_back(char((pValue >> (8 * i)) & 0xff));
+}
+
+/// CIE - a CIE with the "zR" augmentation, 24 bytes. The FDEs of it encode
+/// PC Begin by pEncoding.
+std::string CIE(uint8_t pEncoding = DW_EH_PE_pcrel | DW_EH_PE_sdata4)
+{
+  std::string result;
+  append32(result, 20);                    // length
+  append32(result, 0);                     // CIE ID
+  const uint8_t body[] = {
+    0x1, 'z', 'R', 0x0,                    // version, augmentation
+    0x1, 0x78, 0x10,                       // alignment factors, RA register
+    0x1, pEncoding,                        // augmentation data
+    0x0c, 0x07, 0x08, 0x90, 0x01,          // def_cfa, offset
+    0x0, 0x0                               // nop
+  };
+  result.append(reinterpret_cast<const char*>(body), sizeof(body));
+  return result;
+}
+
+/// FDE - an FDE of 24 bytes whose CIE Pointer field is pCIEPointer bytes
+/// after its CIE. PC Begin is at the offset 8.
+std::string FDE(uint32_t pCIEPointer, uint32_t pPCBegin)
+{
+  std::string result;
+  append32(result, 20);                    // length
+  append32(result, pCIEPointer);           // CIE pointer
+  append32(result, pPCBegin);              // PC begin
+  append32(result, 16);                    // PC range
+  result.append(8, '\0');                  // augmentation data, nop
+  return result;
+}
+
+/// PCRelFDE - an FDE at pOffset of the section at pAddr, whose function is
+/// at pFunc. Its CIE is at the offset 0.
+std::string PCRelFDE(uint64_t pAddr, uint32_t pOffset, uint64_t pFunc)
+{
+  return FDE(pOffset + 4, pFunc - (pAddr + pOffset + 8));
+}
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+EhFrameHdrTest::EhFrameHdrTest()
+  : m_pInputSpace(NULL), m_pInputArea(NULL), m_pEhFrameHdr(NULL) {
+  m_pConfig = new LinkerConfig("x86_64-linux-gnu");
+  m_pConfig->targets().setEndian(TargetOptions::Little);
+  m_pConfig->targets().setBitClass(64);
+  m_pConfig->setCodeGenType(LinkerConfig::Exec);
+  Relocation::SetUp(*m_pConfig);
+
+  m_pModule = new Module("eh_frame_hdr");
+  m_pIRBuilder = new IRBuilder(*m_pModule, *m_pConfig);
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+EhFrameHdrTest::~EhFrameHdrTest()
+{
+  delete m_pIRBuilder;
+  delete m_pModule;
+  delete m_pConfig;
+
+  delete m_pInputArea;
+  if (NULL != m_pInputSpace)
+    Space::Destroy(m_pInputSpace);
+  if (NULL != m_pEhFrameHdr)
+    LDSection::Destroy(m_pEhFrameHdr);
+}
+
+// SetUp() will be called immediately before each test.
+void EhFrameHdrTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void EhFrameHdrTest::TearDown()
+{
+}
+
+bool EhFrameHdrTest::read(const std::string& pContents, uint64_t pAddr)
+{
+  Input* input = m_pIRBuilder->CreateInput("a.o",
+                                           sys::fs::Path("a.o"),
+                                           Input::Object);
+  m_pModule->getObjectList().push_back(input);
+
+  // the .eh_frame is at the offset 0 of both the input and the output
+  m_Input = pContents;
+  m_pInputSpace = Space::Create(const_cast<char*>(m_Input.data()),
+                                m_Input.size());
+  m_pInputArea = new MemoryArea(*m_pInputSpace);
+  input->setMemArea(m_pInputArea);
+
+  LDSection* section = IRBuilder::CreateELFHeader(*input,
+                                                  ".eh_frame",
+                                                  llvm::ELF::SHT_PROGBITS,
+                                                  llvm::ELF::SHF_ALLOC,
+                                                  8);
+  section->setSize(m_Input.size());
+  section->setAddr(pAddr);
+  section->setOffset(0x0);
+  EhFrame* eh_frame = IRBuilder::CreateEhFrame(*section);
+
+  EhFrameReader reader;
+  return reader.read<64, true>(*input, *eh_frame);
+}
+
+void EhFrameHdrTest::emit(uint64_t pAddr, unsigned int pNumOfThreads)
+{
+  m_pEhFrameHdr = LDSection::Create(".eh_frame_hdr",
+                                    LDFileFormat::EhFrameHdr,
+                                    llvm::ELF::SHT_PROGBITS,
+                                    llvm::ELF::SHF_ALLOC);
+  m_pEhFrameHdr->setAddr(pAddr);
+  m_pEhFrameHdr->setOffset(m_Input.size());
+
+  EhFrameHdr eh_frame_hdr(*m_pEhFrameHdr, ehFrame());
+  eh_frame_hdr.sizeOutput();
+
+  // the header is filled with garbage to see what is written
+  m_Output = m_Input + std::string(m_pEhFrameHdr->size(), '\xcc');
+  Space* space = Space::Create(const_cast<char*>(m_Output.data()),
+                               m_Output.size());
+  MemoryArea* area = new MemoryArea(*space);
+  eh_frame_hdr.emitOutput<64>(*area, pNumOfThreads);
+  delete area;
+  Space::Destroy(space);
+}
+
+LDSection& EhFrameHdrTest::ehFrame()
+{
+  return *m_pModule->getObjectList().front()->context()->getSection(
+                                                                ".eh_frame");
+}
+
+const uint8_t* EhFrameHdrTest::header() const
+{
+  return reinterpret_cast<const uint8_t*>(m_Output.data()) + m_Input.size();
+}
+
+uint32_t EhFrameHdrTest::word(size_t pOffset) const
+{
+  uint32_t result;
+  std::memcpy(&result, header() + pOffset, 4);
+  return result;
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( EhFrameHdrTest, emit_header_and_sorted_table) {
+  const uint64_t eh_frame = 0x400, hdr = 0x500;
+  ASSERT_TRUE(read(CIE() +
+                   PCRelFDE(eh_frame, 24, 0x3000) +
+                   PCRelFDE(eh_frame, 48, 0x1000) +
+                   PCRelFDE(eh_frame, 72, 0x2000), eh_frame));
+  emit(hdr);
+  ASSERT_EQ(12U + 3 * 8, m_pEhFrameHdr->size());
+
+  ASSERT_EQ(1, header()[0]);
+  ASSERT_EQ(DW_EH_PE_pcrel | DW_EH_PE_sdata4, header()[1]);
+  ASSERT_EQ(DW_EH_PE_udata4, header()[2]);
+  ASSERT_EQ(DW_EH_PE_datarel | DW_EH_PE_sdata4, header()[3]);
+  ASSERT_EQ(uint32_t(eh_frame - (hdr + 4)), word(4));
+  ASSERT_EQ(3U, word(8));
+
+  // the rows are sorted by the initial location, and are relative to the
+  // .eh_frame_hdr
+  ASSERT_EQ(uint32_t(0x1000 - hdr), word(12));
+  ASSERT_EQ(uint32_t(eh_frame + 48 - hdr), word(16));
+  ASSERT_EQ(uint32_t(0x2000 - hdr), word(20));
+  ASSERT_EQ(uint32_t(eh_frame + 72 - hdr), word(24));
+  ASSERT_EQ(uint32_t(0x3000 - hdr), word(28));
+  ASSERT_EQ(uint32_t(eh_frame + 24 - hdr), word(32));
+}
+
+TEST_F( EhFrameHdrTest, sort_table_on_threads) {
+  // more than one task of rows on each of the threads
+  const uint64_t eh_frame = 0x1000, hdr = 0x400;
+  const uint32_t num_of_fdes = 20000;
+  std::string contents = CIE();
+  for (uint32_t i = 0; i < num_of_fdes; ++i) {
+    uint64_t func = 0x800000 + ((i * 7919) % num_of_fdes) * 16;
+    contents += PCRelFDE(eh_frame, contents.size(), func);
+  }
+  ASSERT_TRUE(read(contents, eh_frame));
+  emit(hdr, 4);
+
+  ASSERT_EQ(num_of_fdes, word(8));
+  for (uint32_t i = 0; i < num_of_fdes; ++i) {
+    uint32_t func = word(12 + 8 * i) + hdr;
+    ASSERT_EQ(0x800000 + i * 16, func);
+
+    // the FDE of the row covers the function
+    uint32_t fde = word(16 + 8 * i) + hdr - eh_frame;
+    ASSERT_EQ(0U, (fde - 24) % 24);
+    uint32_t j = (fde - 24) / 24;
+    ASSERT_EQ(i, (j * 7919) % num_of_fdes);
+  }
+}
+
+TEST_F( EhFrameHdrTest, read_udata2_initial_location) {
+  // PC Begin is an absolute 2-byte value, followed by the other bytes of the
+  // field
+  ASSERT_TRUE(read(CIE(DW_EH_PE_udata2) +
+                   FDE(28, 0xffff2345) +
+                   FDE(52, 0xffff1234), 0x400));
+  emit(0x500);
+
+  ASSERT_EQ(2U, word(8));
+  ASSERT_EQ(uint32_t(0x1234 - 0x500), word(12));
+  ASSERT_EQ(uint32_t(0x2345 - 0x500), word(20));
+}
+
+TEST_F( EhFrameHdrTest, omit_table_of_unparsed_eh_frame) {
+  ASSERT_TRUE(read(CIE() + PCRelFDE(0x400, 24, 0x1000), 0x400));
+  ehFrame().getEhFrame()->setUnparsed();
+  emit(0x500);
+
+  ASSERT_EQ(12U, m_pEhFrameHdr->size());
+  ASSERT_EQ(1, header()[0]);
+  ASSERT_EQ(DW_EH_PE_omit, header()[2]);
+  ASSERT_EQ(DW_EH_PE_omit, header()[3]);
+  ASSERT_EQ(uint32_t(0x400 - (0x500 + 4)), word(4));
+  ASSERT_EQ(0U, word(8));
+}
+
+TEST_F( EhFrameHdrTest, unparsed_eh_frame_is_merged) {
+  LDSection* input = LDSection::Create(".eh_frame",
+                                       LDFileFormat::EhFrame,
+                                       llvm::ELF::SHT_PROGBITS,
+                                       llvm::ELF::SHF_ALLOC);
+  LDSection* output = LDSection::Create(".eh_frame",
+                                        LDFileFormat::EhFrame,
+                                        llvm::ELF::SHT_PROGBITS,
+                                        llvm::ELF::SHF_ALLOC);
+  EhFrame* input_eh_frame = IRBuilder::CreateEhFrame(*input);
+  EhFrame* output_eh_frame = IRBuilder::CreateEhFrame(*output);
+  input_eh_frame->setUnparsed();
+  ASSERT_FALSE(output_eh_frame->isUnparsed());
+
+  output_eh_frame->merge(*input_eh_frame);
+  ASSERT_TRUE(output_eh_frame->isUnparsed());
+
+  LDSection::Destroy(input);
+  LDSection::Destroy(output);
+}
+
+TEST_F( EhFrameHdrTest, omit_table_of_unsupported_encodings) {
+  // the start of the data segment is unknown
+  ASSERT_TRUE(read(CIE() +
+                   PCRelFDE(0x400, 24, 0x1000) +
+                   CIE(DW_EH_PE_datarel | DW_EH_PE_sdata4) +
+                   FDE(28, 0x10), 0x400));
+  emit(0x500);
+
+  ASSERT_EQ(12U + 2 * 8, m_pEhFrameHdr->size());
+  ASSERT_EQ(DW_EH_PE_omit, header()[2]);
+  ASSERT_EQ(DW_EH_PE_omit, header()[3]);
+  ASSERT_EQ(0U, word(8));
+}
+
+TEST_F( EhFrameHdrTest, omit_table_of_indirect_encoding) {
+  ASSERT_TRUE(read(CIE(DW_EH_PE_indirect | DW_EH_PE_pcrel | DW_EH_PE_sdata4) +
+                   PCRelFDE(0x400, 24, 0x1000), 0x400));
+  emit(0x500);
+
+  ASSERT_EQ(DW_EH_PE_omit, header()[2]);
+  ASSERT_EQ(0U, word(8));
+}
+
+TEST_F( EhFrameHdrTest, omit_table_of_far_rows) {
+  // the function is more than 2GB below the .eh_frame_hdr
+  ASSERT_TRUE(read(CIE(DW_EH_PE_udata4) + FDE(28, 0x10), 0x100000000ULL));
+  emit(0x100000400ULL);
+
+  ASSERT_EQ(DW_EH_PE_omit, header()[2]);
+  ASSERT_EQ(DW_EH_PE_omit, header()[3]);
+  ASSERT_EQ(0U, word(8));
+}
+
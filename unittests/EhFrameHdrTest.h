@@ -0,0 +1,81 @@
+//===- EhFrameHdrTest.h ---------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_EH_FRAME_HDR_TEST_H
+#define MCLD_EH_FRAME_HDR_TEST_H
+
+#include <gtest.h>
+#include <llvm/Support/DataTypes.h>
+#include <string>
+#include <vector>
+
+namespace mcld {
+class IRBuilder;
+class LDSection;
+class LinkerConfig;
+class MemoryArea;
+class Module;
+class Space;
+} // namespace for mcld
+
+namespace mcldtest
+{
+
+/** \class EhFrameHdrTest
+ *  \brief The testcases of the .eh_frame_hdr header and its binary search
+ *  table.
+ *
+ *  \see EhFrameHdr
+ */
+class EhFrameHdrTest : public ::testing::Test
+{
+public:
+  // Constructor can do set-up work for all test here.
+  EhFrameHdrTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~EhFrameHdrTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+
+protected:
+  /// read - read pContents as the .eh_frame of an input at pAddr
+  /// @return false if the .eh_frame can not be parsed
+  bool read(const std::string& pContents, uint64_t pAddr);
+
+  /// emit - emit the .eh_frame and then the .eh_frame_hdr at pAddr
+  void emit(uint64_t pAddr, unsigned int pNumOfThreads = 1);
+
+  mcld::LDSection& ehFrame();
+
+  /// header - the emitted .eh_frame_hdr
+  const uint8_t* header() const;
+
+  uint32_t word(size_t pOffset) const;
+
+protected:
+  mcld::LinkerConfig* m_pConfig;
+  mcld::Module* m_pModule;
+  mcld::IRBuilder* m_pIRBuilder;
+
+  std::string m_Input;
+  mcld::Space* m_pInputSpace;
+  mcld::MemoryArea* m_pInputArea;
+
+  std::string m_Output;
+  mcld::LDSection* m_pEhFrameHdr;
+};
+
+} // namespace of mcldtest
+
+#endif
+
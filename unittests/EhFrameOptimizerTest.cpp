@@ -0,0 +1,393 @@
+//===- EhFrameOptimizerTest.cpp -------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/IRBuilder.h>
+#include <mcld/LinkerConfig.h>
+#include <mcld/Module.h>
+#include <mcld/Fragment/Relocation.h>
+#include <mcld/LD/EhFrame.h>
+#include <mcld/LD/EhFrameOptimizer.h>
+#include <mcld/LD/EhFrameReader.h>
+#include <mcld/LD/LDContext.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/RelocData.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Support/MemoryArea.h>
+#include <mcld/Support/Path.h>
+#include <mcld/Support/Space.h>
+
+#include <llvm/Support/ELF.h>
+
+#include "EhFrameOptimizerTest.h"
+
+using namespace mcld;
+using namespace mcldtest;
+
+namespace {
+
+uint8_t Code[16] = { 0xc3 };
+
+void append32(std::string& pData, uint32_t pValue)
+{
+  for (size_t i = 0; i < 4; ++i)
+    pData.push_back(char((pValue >> (8 * i)) & 0xff));
+}
+
+/// CIE - a CIE with the "zR" augmentation, 24 bytes. The CIEs with different
+/// data alignment factors are different.
+std::string CIE(uint8_t pDataAlign = 0x78)
+{
+  std::string result;
+  append32(result, 20);                    // length
+  append32(result, 0);                     // CIE ID
+  const uint8_t body[] = {
+    0x1, 'z', 'R', 0x0,                    // version, augmentation
+    0x1, pDataAlign, 0x10,                 // alignment factors, RA register
+    0x1, 0x1b,                             // augmentation data
+    0x0c, 0x07, 0x08, 0x90, 0x01,          // def_cfa, offset
+    0x0, 0x0                               // nop
+  };
+  result.append(reinterpret_cast<const char*>(body), sizeof(body));
+  return result;
+}
+
+/// PersonalityCIE - a CIE with the "zPR" augmentation, 32 bytes. The
+/// personality routine is at PersonalityOffset.
+const uint32_t PersonalityOffset = 18;
+
+std::string PersonalityCIE()
+{
+  std::string result;
+  append32(result, 28);                    // length
+  append32(result, 0);                     // CIE ID
+  const uint8_t body[] = {
+    0x1, 'z', 'P', 'R', 0x0,               // version, augmentation
+    0x1, 0x78, 0x10,                       // alignment factors, RA register
+    0x6, 0x9b, 0x0, 0x0, 0x0, 0x0, 0x1b,   // augmentation data
+    0x0c, 0x07, 0x08, 0x90, 0x01,          // def_cfa, offset
+    0x0, 0x0, 0x0, 0x0                     // nop
+  };
+  result.append(reinterpret_cast<const char*>(body), sizeof(body));
+  return result;
+}
+
+/// FDE - an FDE of 24 bytes whose CIE Pointer field is pCIEPointer bytes
+/// after its CIE. PC Begin is at the offset 8.
+std::string FDE(uint32_t pCIEPointer)
+{
+  std::string result;
+  append32(result, 20);                    // length
+  append32(result, pCIEPointer);           // CIE pointer
+  append32(result, 0);                     // PC begin
+  append32(result, 16);                    // PC range
+  result.append(8, '\0');                  // augmentation data, nop
+  return result;
+}
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+EhFrameOptimizerTest::EhFrameOptimizerTest()
+{
+  m_pConfig = new LinkerConfig("x86_64-linux-gnu");
+  m_pConfig->targets().setEndian(TargetOptions::Little);
+  m_pConfig->targets().setBitClass(64);
+  m_pConfig->setCodeGenType(LinkerConfig::Exec);
+  Relocation::SetUp(*m_pConfig);
+
+  m_pModule = new Module("eh_frame");
+  m_pIRBuilder = new IRBuilder(*m_pModule, *m_pConfig);
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+EhFrameOptimizerTest::~EhFrameOptimizerTest()
+{
+  delete m_pIRBuilder;
+  delete m_pModule;
+  delete m_pConfig;
+
+  for (size_t i = 0; i < m_Areas.size(); ++i) {
+    delete m_Areas[i];
+    Space::Destroy(m_Spaces[i]);
+    delete m_Contents[i];
+  }
+}
+
+// SetUp() will be called immediately before each test.
+void EhFrameOptimizerTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void EhFrameOptimizerTest::TearDown()
+{
+}
+
+bool EhFrameOptimizerTest::addInput(const std::string& pName,
+                                    const std::string& pContents)
+{
+  Input* input = m_pIRBuilder->CreateInput(pName,
+                                           sys::fs::Path(pName),
+                                           Input::Object);
+  m_pModule->getObjectList().push_back(input);
+  m_Inputs.push_back(input);
+
+  // the .eh_frame is at the offset 0 of the input
+  m_Contents.push_back(new std::string(pContents));
+  std::string& contents = *m_Contents.back();
+  m_Spaces.push_back(Space::Create(const_cast<char*>(contents.data()),
+                                   contents.size()));
+  m_Areas.push_back(new MemoryArea(*m_Spaces.back()));
+  input->setMemArea(m_Areas.back());
+
+  LDSection* text = IRBuilder::CreateELFHeader(*input,
+                                               ".text",
+                                               llvm::ELF::SHT_PROGBITS,
+                                               llvm::ELF::SHF_ALLOC |
+                                               llvm::ELF::SHF_EXECINSTR,
+                                               16);
+  IRBuilder::AppendFragment(*IRBuilder::CreateRegion(Code, sizeof(Code)),
+                            *IRBuilder::CreateSectionData(*text));
+
+  LDSection* section = IRBuilder::CreateELFHeader(*input,
+                                                  ".eh_frame",
+                                                  llvm::ELF::SHT_PROGBITS,
+                                                  llvm::ELF::SHF_ALLOC,
+                                                  8);
+  section->setSize(contents.size());
+  EhFrame* eh_frame = IRBuilder::CreateEhFrame(*section);
+
+  EhFrameReader reader;
+  return reader.read<64, true>(*input, *eh_frame);
+}
+
+LDSymbol* EhFrameOptimizerTest::define(Input& pInput, const std::string& pName)
+{
+  return m_pIRBuilder->AddSymbol(pInput,
+                                 pName,
+                                 ResolveInfo::Function,
+                                 ResolveInfo::Define,
+                                 ResolveInfo::Global,
+                                 sizeof(Code),
+                                 0x0,
+                                 pInput.context()->getSection(".text"));
+}
+
+LDSymbol* EhFrameOptimizerTest::refer(Input& pInput, const std::string& pName)
+{
+  return m_pIRBuilder->AddSymbol(pInput,
+                                 pName,
+                                 ResolveInfo::NoType,
+                                 ResolveInfo::Undefined,
+                                 ResolveInfo::Global,
+                                 0x0);
+}
+
+void EhFrameOptimizerTest::relocate(Input& pInput,
+                                    LDSymbol& pSymbol,
+                                    uint32_t pOffset)
+{
+  LDSection* rela = pInput.context()->getSection(".rela.eh_frame");
+  if (NULL == rela) {
+    rela = IRBuilder::CreateELFHeader(pInput,
+                                      ".rela.eh_frame",
+                                      llvm::ELF::SHT_RELA,
+                                      0x0,
+                                      8);
+    rela->setLink(pInput.context()->getSection(".eh_frame"));
+    IRBuilder::CreateRelocData(*rela);
+  }
+  m_pIRBuilder->AddRelocation(*rela,
+                              llvm::ELF::R_X86_64_PC32,
+                              pSymbol,
+                              pOffset,
+                              0x0);
+}
+
+Input& EhFrameOptimizerTest::input(size_t pIdx)
+{
+  return *m_Inputs[pIdx];
+}
+
+EhFrame& EhFrameOptimizerTest::ehFrame(size_t pIdx)
+{
+  return *m_Inputs[pIdx]->context()->getSection(".eh_frame")->getEhFrame();
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( EhFrameOptimizerTest, read_entries) {
+  ASSERT_TRUE(addInput("a.o", CIE() + FDE(28) + FDE(52) + CIE() + FDE(28)));
+
+  EhFrame& eh_frame = ehFrame(0);
+  ASSERT_EQ(2U, eh_frame.numOfCIEs());
+  ASSERT_EQ(3U, eh_frame.numOfFDEs());
+  ASSERT_TRUE(&eh_frame.getFDEList()[1]->getCIE() ==
+              eh_frame.getCIEList()[0]);
+  ASSERT_TRUE(&eh_frame.getFDEList()[2]->getCIE() ==
+              eh_frame.getCIEList()[1]);
+  ASSERT_EQ(8U, eh_frame.fde_front().getDataStart());
+  ASSERT_EQ(0x1b, eh_frame.cie_front().getFDEEncode());
+  ASSERT_EQ(72U, eh_frame.getCIEList()[1]->getOffset());
+}
+
+TEST_F( EhFrameOptimizerTest, read_terminated_entries) {
+  std::string terminator(4, '\0');
+  ASSERT_TRUE(addInput("a.o", PersonalityCIE() + FDE(36) + terminator));
+  ASSERT_EQ(1U, ehFrame(0).numOfCIEs());
+  ASSERT_EQ(1U, ehFrame(0).numOfFDEs());
+  ASSERT_EQ(3U, ehFrame(0).getSectionData().size());
+}
+
+TEST_F( EhFrameOptimizerTest, reject_malformed_eh_frame) {
+  // an entry longer than the section
+  std::string long_cie = CIE();
+  long_cie[0] = 0x40;
+  ASSERT_FALSE(addInput("long.o", long_cie + FDE(28)));
+  ASSERT_EQ(0U, ehFrame(0).numOfCIEs());
+
+  // a length field cut by the end of the section
+  ASSERT_FALSE(addInput("cut.o", CIE() + FDE(28) + std::string(2, '\0')));
+
+  // an extended length field cut by the end of the section
+  std::string extended;
+  append32(extended, 0xFFFFFFFF);
+  append32(extended, 24);
+  ASSERT_FALSE(addInput("extended.o", extended));
+
+  // a CIE without the version
+  std::string empty_cie;
+  append32(empty_cie, 4);
+  append32(empty_cie, 0);
+  ASSERT_FALSE(addInput("empty_cie.o", empty_cie));
+
+  // an FDE without PC Begin
+  std::string empty_fde;
+  append32(empty_fde, 4);
+  append32(empty_fde, 28);
+  ASSERT_FALSE(addInput("empty_fde.o", CIE() + empty_fde));
+
+  // an FDE before any CIE
+  ASSERT_FALSE(addInput("orphan.o", FDE(4)));
+  ASSERT_EQ(0U, ehFrame(5).numOfFDEs());
+
+  // an augmentation string running off the CIE
+  std::string cie = CIE();
+  cie.replace(9, 15, std::string(15, 'z'));
+  ASSERT_FALSE(addInput("augmentation.o", cie));
+
+  ASSERT_TRUE(addInput("empty.o", std::string()));
+  ASSERT_EQ(0U, ehFrame(7).numOfCIEs());
+}
+
+TEST_F( EhFrameOptimizerTest, merge_identical_cies) {
+  ASSERT_TRUE(addInput("a.o", CIE() + FDE(28)));
+  ASSERT_TRUE(addInput("b.o", CIE() + FDE(28)));
+  relocate(input(0), *define(input(0), "f"), 32);
+  relocate(input(1), *define(input(1), "g"), 32);
+
+  EhFrameOptimizer optimizer(*m_pConfig, *m_pModule);
+  ASSERT_TRUE(optimizer.run());
+  ASSERT_EQ(1U, optimizer.numOfRemovedCIEs());
+  ASSERT_EQ(0U, optimizer.numOfRemovedFDEs());
+
+  ASSERT_EQ(1U, ehFrame(0).numOfCIEs());
+  ASSERT_EQ(0U, ehFrame(1).numOfCIEs());
+  ASSERT_EQ(1U, ehFrame(1).numOfFDEs());
+  ASSERT_TRUE(&ehFrame(1).fde_front().getCIE() == &ehFrame(0).cie_front());
+
+  // the FDE is laid out again at the start of the section
+  ASSERT_EQ(1U, ehFrame(1).getSectionData().size());
+  ASSERT_EQ(0U, ehFrame(1).fde_front().getOffset());
+  ASSERT_EQ(24U, ehFrame(1).getSection().size());
+  ASSERT_EQ(48U, ehFrame(0).getSection().size());
+}
+
+TEST_F( EhFrameOptimizerTest, keep_different_cies) {
+  ASSERT_TRUE(addInput("a.o", CIE() + FDE(28)));
+  ASSERT_TRUE(addInput("b.o", CIE(0x7c) + FDE(28)));
+  relocate(input(0), *define(input(0), "f"), 32);
+  relocate(input(1), *define(input(1), "g"), 32);
+
+  EhFrameOptimizer optimizer(*m_pConfig, *m_pModule);
+  ASSERT_TRUE(optimizer.run());
+  ASSERT_EQ(0U, optimizer.numOfRemovedCIEs());
+  ASSERT_EQ(1U, ehFrame(1).numOfCIEs());
+  ASSERT_TRUE(&ehFrame(1).fde_front().getCIE() == &ehFrame(1).cie_front());
+}
+
+TEST_F( EhFrameOptimizerTest, compare_personality_routines) {
+  for (size_t i = 0; i < 3; ++i) {
+    std::string name(1, char('a' + i));
+    ASSERT_TRUE(addInput(name + ".o", PersonalityCIE() + FDE(36)));
+    relocate(input(i), *define(input(i), name), 40);
+  }
+  relocate(input(0), *refer(input(0), "__gxx_personality_v0"),
+           PersonalityOffset);
+  relocate(input(1), *refer(input(1), "__gxx_personality_v0"),
+           PersonalityOffset);
+  relocate(input(2), *refer(input(2), "__other_personality"),
+           PersonalityOffset);
+
+  EhFrameOptimizer optimizer(*m_pConfig, *m_pModule);
+  ASSERT_TRUE(optimizer.run());
+  ASSERT_EQ(1U, optimizer.numOfRemovedCIEs());
+  ASSERT_EQ(0U, ehFrame(1).numOfCIEs());
+  ASSERT_EQ(1U, ehFrame(2).numOfCIEs());
+
+  // the personality relocation of the removed CIE is removed, too
+  RelocData* relocs =
+    input(1).context()->getSection(".rela.eh_frame")->getRelocData();
+  ASSERT_EQ(1U, relocs->size());
+}
+
+TEST_F( EhFrameOptimizerTest, remove_dead_entries) {
+  ASSERT_TRUE(addInput("a.o", CIE() + FDE(28) + FDE(52)));
+  ASSERT_TRUE(addInput("b.o", CIE() + FDE(28)));
+  ASSERT_TRUE(addInput("c.o", CIE(0x7c) + FDE(28)));
+
+  // the second FDE of a.o has no PC Begin relocation, since its group is
+  // discarded. The .text of b.o and c.o are removed.
+  relocate(input(0), *define(input(0), "f"), 32);
+  relocate(input(1), *define(input(1), "g"), 32);
+  relocate(input(2), *define(input(2), "h"), 32);
+  input(1).context()->getSection(".text")->setKind(LDFileFormat::Ignore);
+  input(2).context()->getSection(".text")->setKind(LDFileFormat::Ignore);
+
+  EhFrameOptimizer optimizer(*m_pConfig, *m_pModule);
+  ASSERT_TRUE(optimizer.run());
+  ASSERT_EQ(3U, optimizer.numOfRemovedFDEs());
+  ASSERT_EQ(2U, optimizer.numOfRemovedCIEs());
+
+  ASSERT_EQ(1U, ehFrame(0).numOfCIEs());
+  ASSERT_EQ(1U, ehFrame(0).numOfFDEs());
+  ASSERT_EQ(48U, ehFrame(0).getSection().size());
+  ASSERT_TRUE(ehFrame(1).getSectionData().empty());
+  ASSERT_EQ(0U, ehFrame(2).getSection().size());
+
+  RelocData* relocs =
+    input(1).context()->getSection(".rela.eh_frame")->getRelocData();
+  ASSERT_TRUE(relocs->empty());
+}
+
+TEST_F( EhFrameOptimizerTest, keep_entries_of_relocatable) {
+  m_pConfig->setCodeGenType(LinkerConfig::Object);
+  ASSERT_TRUE(addInput("a.o", CIE() + FDE(28) + FDE(52)));
+  ASSERT_TRUE(addInput("b.o", CIE() + FDE(28)));
+  relocate(input(1), *define(input(1), "g"), 32);
+
+  EhFrameOptimizer optimizer(*m_pConfig, *m_pModule);
+  ASSERT_TRUE(optimizer.run());
+  ASSERT_EQ(0U, optimizer.numOfRemovedCIEs());
+  ASSERT_EQ(0U, optimizer.numOfRemovedFDEs());
+  ASSERT_EQ(2U, ehFrame(0).numOfFDEs());
+  ASSERT_EQ(1U, ehFrame(1).numOfCIEs());
+}
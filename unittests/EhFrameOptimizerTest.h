@@ -0,0 +1,87 @@
+//===- EhFrameOptimizerTest.h ---------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_EH_FRAME_OPTIMIZER_TEST_H
+#define MCLD_EH_FRAME_OPTIMIZER_TEST_H
+
+#include <gtest.h>
+#include <llvm/Support/DataTypes.h>
+#include <string>
+#include <vector>
+
+namespace mcld {
+class EhFrame;
+class Input;
+class IRBuilder;
+class LDSymbol;
+class LinkerConfig;
+class MemoryArea;
+class Module;
+class Space;
+} // namespace for mcld
+
+namespace mcldtest
+{
+
+/** \class EhFrameOptimizerTest
+ *  \brief The testcases of reading the input .eh_frame sections and removing
+ *  their redundant entries.
+ *
+ *  \see EhFrameReader
+ *  \see EhFrameOptimizer
+ */
+class EhFrameOptimizerTest : public ::testing::Test
+{
+public:
+  // Constructor can do set-up work for all test here.
+  EhFrameOptimizerTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~EhFrameOptimizerTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+
+protected:
+  /// addInput - add an object with a .text section and the .eh_frame
+  /// section pContents, and read the .eh_frame
+  /// @return false if the .eh_frame can not be parsed
+  bool addInput(const std::string& pName, const std::string& pContents);
+
+  /// define - define a global function in the .text of pInput
+  mcld::LDSymbol* define(mcld::Input& pInput, const std::string& pName);
+
+  /// refer - refer to a global symbol in pInput
+  mcld::LDSymbol* refer(mcld::Input& pInput, const std::string& pName);
+
+  /// relocate - add an R_X86_64_PC32 against pSymbol at pOffset of the
+  /// .eh_frame of pInput
+  void relocate(mcld::Input& pInput, mcld::LDSymbol& pSymbol, uint32_t pOffset);
+
+  mcld::Input& input(size_t pIdx);
+
+  mcld::EhFrame& ehFrame(size_t pIdx);
+
+protected:
+  mcld::LinkerConfig* m_pConfig;
+  mcld::Module* m_pModule;
+  mcld::IRBuilder* m_pIRBuilder;
+
+  std::vector<mcld::Input*> m_Inputs;
+  std::vector<std::string*> m_Contents;
+  std::vector<mcld::Space*> m_Spaces;
+  std::vector<mcld::MemoryArea*> m_Areas;
+};
+
+} // namespace of mcldtest
+
+#endif
+
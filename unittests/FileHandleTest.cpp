@@ -10,6 +10,9 @@
 #include <mcld/Support/Path.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cstdlib>
 #include "FileHandleTest.h"
 
 using namespace mcld;
@@ -99,3 +102,41 @@ TEST_F(FileHandleTest, fail_close) {
   ASSERT_FALSE(m_pTestee->isOpened());
   ASSERT_FALSE(m_pTestee->isGood());
 }
+
+TEST_F(FileHandleTest, allocate) {
+  char name[] = "/tmp/mcld_allocate_XXXXXX";
+  int fd = ::mkstemp(name);
+  ASSERT_TRUE(-1 != fd);
+  ::close(fd);
+
+  mcld::sys::fs::Path path(name);
+  ASSERT_TRUE(m_pTestee->open(path, FileHandle::ReadWrite |
+                                    FileHandle::Truncate));
+  ASSERT_TRUE(0 == m_pTestee->size());
+  ASSERT_TRUE(m_pTestee->allocate(0x12345));
+  ASSERT_TRUE(m_pTestee->isGood());
+  ASSERT_TRUE(0x12345 == m_pTestee->size());
+
+  struct stat file_stat;
+  ASSERT_EQ(0, ::stat(name, &file_stat));
+  ASSERT_TRUE(0x12345 == file_stat.st_size);
+
+  // the allocated range reads as zeros
+  char buffer[16];
+  ASSERT_TRUE(m_pTestee->read(buffer, 0x12335, sizeof(buffer)));
+  for (size_t i = 0; i < sizeof(buffer); ++i)
+    ASSERT_EQ(0, buffer[i]);
+
+  ASSERT_TRUE(m_pTestee->close());
+  ::unlink(name);
+}
+
+TEST_F(FileHandleTest, allocate_read_only_file) {
+  mcld::sys::fs::Path path(TOPDIR);
+  path.append("unittests/test.txt");
+  ASSERT_TRUE(m_pTestee->open(path, FileHandle::ReadOnly));
+  ASSERT_FALSE(m_pTestee->allocate(4096));
+  ASSERT_FALSE(m_pTestee->isGood());
+  ASSERT_TRUE(27 == m_pTestee->size());
+  ASSERT_TRUE(m_pTestee->close());
+}
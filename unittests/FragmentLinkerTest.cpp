@@ -0,0 +1,335 @@
+//===- FragmentLinkerTest.cpp ---------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/IRBuilder.h>
+#include <mcld/LinkerConfig.h>
+#include <mcld/Module.h>
+#include <mcld/Fragment/FragmentLinker.h>
+#include <mcld/Fragment/Relocation.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/Relocator.h>
+#include <mcld/LD/ResolveInfo.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Support/FileHandle.h>
+#include <mcld/Support/MemoryArea.h>
+#include <mcld/Support/MemoryRegion.h>
+#include <mcld/Support/Path.h>
+#include <../lib/Target/X86/X86LDBackend.h>
+#include <../lib/Target/X86/X86GNUInfo.h>
+
+#include <llvm/Support/ELF.h>
+
+#include "FragmentLinkerTest.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+using namespace mcld;
+using namespace mcldtest;
+
+namespace {
+
+const uint64_t TextOffset = 0x10;
+const uint64_t TextAddr = 0x1000;
+const size_t OutputSize = 0x30;
+
+uint8_t Text[] = {
+  0xe8, 0x0, 0x0, 0x0, 0x0,                // call f
+  0xc3,                                    // ret
+  0x90, 0x90,
+  0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,  // .quad f + 16
+  0xe8, 0x0, 0x0, 0x0, 0x0,                // call g
+  0xc3,                                    // ret
+  0x90, 0x90
+};
+
+uint64_t readLE(const std::string& pData, size_t pOffset, size_t pSize)
+{
+  uint64_t result = 0;
+  for (size_t i = 0; i < pSize; ++i)
+    result |= uint64_t(uint8_t(pData[pOffset + i])) << (8 * i);
+  return result;
+}
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+FragmentLinkerTest::FragmentLinkerTest()
+  : m_pText(NULL)
+{
+  m_pConfig = new LinkerConfig("x86_64-linux-gnu");
+  m_pConfig->targets().setEndian(TargetOptions::Little);
+  m_pConfig->targets().setBitClass(64);
+  m_pConfig->setCodeGenType(LinkerConfig::Exec);
+  m_pConfig->setCodePosition(LinkerConfig::StaticDependent);
+  Relocation::SetUp(*m_pConfig);
+
+  m_pInfo = new X86_64GNUInfo(m_pConfig->targets().triple());
+  m_pLDBackend = new X86_64GNULDBackend(*m_pConfig, m_pInfo);
+  m_pLDBackend->initRelocator();
+  m_pLDBackend->initBRIslandFactory();
+  m_pModule = new Module("relocation");
+  m_pIRBuilder = new IRBuilder(*m_pModule, *m_pConfig);
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+FragmentLinkerTest::~FragmentLinkerTest()
+{
+  delete m_pIRBuilder;
+  delete m_pModule;
+  delete m_pLDBackend;
+  delete m_pConfig;
+}
+
+// SetUp() will be called immediately before each test.
+void FragmentLinkerTest::SetUp()
+{
+  // the output .text after layout
+  m_pText = LDSection::Create(".text",
+                              LDFileFormat::Regular,
+                              llvm::ELF::SHT_PROGBITS,
+                              llvm::ELF::SHF_ALLOC | llvm::ELF::SHF_EXECINSTR);
+  m_pModule->getSectionTable().push_back(m_pText);
+  SectionData* data = IRBuilder::CreateSectionData(*m_pText);
+  IRBuilder::AppendFragment(*IRBuilder::CreateRegion(Text, sizeof(Text)),
+                            *data);
+  m_pText->setOffset(TextOffset);
+  m_pText->setAddr(TextAddr);
+}
+
+// TearDown() will be called immediately after each test.
+void FragmentLinkerTest::TearDown()
+{
+}
+
+Relocation* FragmentLinkerTest::addReloc(uint32_t pType,
+                                         LDSymbol& pSymbol,
+                                         uint32_t pOffset,
+                                         int64_t pAddend)
+{
+  // one input and relocation section for each relocation
+  Input* input = m_pIRBuilder->CreateInput("reloc.o",
+                                           sys::fs::Path("reloc.o"),
+                                           Input::Object);
+  m_pModule->getObjectList().push_back(input);
+
+  LDSection* rela = IRBuilder::CreateELFHeader(*input,
+                                               ".rela.text",
+                                               llvm::ELF::SHT_RELA,
+                                               0x0,
+                                               8);
+  rela->setLink(m_pText);
+  IRBuilder::CreateRelocData(*rela);
+  return IRBuilder::AddRelocation(*rela, pType, pSymbol, pOffset, pAddend);
+}
+
+LDSymbol* FragmentLinkerTest::addSymbol(const std::string& pName,
+                                        uint64_t pValue)
+{
+  Input* input = m_pIRBuilder->CreateInput(pName + ".o",
+                                           sys::fs::Path(pName + ".o"),
+                                           Input::Object);
+  LDSymbol* symbol = m_pIRBuilder->AddSymbol(*input, pName,
+                                             ResolveInfo::Function,
+                                             ResolveInfo::Define,
+                                             ResolveInfo::Local,
+                                             1, 0x0, m_pText);
+  symbol->resolveInfo()->outSymbol()->setValue(pValue);
+  return symbol;
+}
+
+void FragmentLinkerTest::emit(FragmentLinker& pLinker)
+{
+  char path[] = "/tmp/mcld-output-XXXXXX";
+  int fd = ::mkstemp(path);
+  ASSERT_NE(-1, fd);
+  ::close(fd);
+
+  FileHandle handle;
+  ASSERT_TRUE(handle.open(sys::fs::Path(path),
+                          FileHandle::ReadWrite | FileHandle::Truncate,
+                          FileHandle::System));
+  MemoryArea output(handle);
+  ASSERT_TRUE(output.mapWholeOutput(OutputSize));
+
+  // emit the section contents, and then the relocation results
+  MemoryRegion* region = output.request(TextOffset, sizeof(Text));
+  std::memcpy(region->getBuffer(), Text, sizeof(Text));
+  pLinker.syncRelocationResult(output);
+  handle.close();
+
+  m_Output.assign(OutputSize, '\0');
+  std::FILE* file = std::fopen(path, "rb");
+  ASSERT_TRUE(NULL != file);
+  size_t size = std::fread(&m_Output[0], 1, OutputSize, file);
+  std::fclose(file);
+  ::unlink(path);
+  ASSERT_EQ(OutputSize, size);
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( FragmentLinkerTest, apply_layout_relocations_into_output) {
+  LDSymbol* f = addSymbol("f", 0x1100);
+  LDSymbol* g = addSymbol("g", 0x800);
+  Relocation* call_f = addReloc(llvm::ELF::R_X86_64_PC32, *f, 1, -4);
+  Relocation* quad = addReloc(llvm::ELF::R_X86_64_64, *f, 8, 16);
+  Relocation* call_g = addReloc(llvm::ELF::R_X86_64_PC32, *g, 17, -4);
+
+  // the static relocations only depend on the layout, so they are left
+  // for the output
+  Relocator& relocator = *m_pLDBackend->getRelocator();
+  ASSERT_TRUE(relocator.mayApplyConcurrently(*call_f));
+  ASSERT_TRUE(relocator.mayApplyConcurrently(*quad));
+  ASSERT_TRUE(relocator.mayApplyConcurrently(*call_g));
+
+  FragmentLinker linker(*m_pConfig, *m_pModule, *m_pLDBackend);
+  ASSERT_TRUE(linker.applyRelocations());
+  ASSERT_EQ(0x0U, call_f->target());
+  ASSERT_EQ(0x0U, quad->target());
+  ASSERT_EQ(0x0U, call_g->target());
+
+  emit(linker);
+  ASSERT_EQ(0xfbU, call_f->target());
+
+  // S + A - P
+  ASSERT_EQ(0xe8U, readLE(m_Output, TextOffset, 1));
+  ASSERT_EQ(0x1100U - 4 - (TextAddr + 1),
+            readLE(m_Output, TextOffset + 1, 4));
+  ASSERT_EQ(0xc3U, readLE(m_Output, TextOffset + 5, 1));
+
+  // S + A
+  ASSERT_EQ(0x1110U, readLE(m_Output, TextOffset + 8, 8));
+
+  // a negative result is narrowed to 32 bits, and the next byte is kept
+  ASSERT_EQ(0xfffff7ebU, readLE(m_Output, TextOffset + 17, 4));
+  ASSERT_EQ(0xc3U, readLE(m_Output, TextOffset + 21, 1));
+
+  // nothing is written out of .text
+  ASSERT_EQ(0x0U, readLE(m_Output, 0x0, 8));
+  ASSERT_EQ(0x0U, readLE(m_Output, TextOffset + sizeof(Text), 8));
+}
+
+TEST_F( FragmentLinkerTest, apply_relocations_on_threads) {
+  m_pConfig->options().setNumThreads(4);
+  LDSymbol* f = addSymbol("f", 0x1100);
+  LDSymbol* g = addSymbol("g", 0x800);
+  addReloc(llvm::ELF::R_X86_64_PC32, *f, 1, -4);
+  addReloc(llvm::ELF::R_X86_64_64, *f, 8, 16);
+  addReloc(llvm::ELF::R_X86_64_PC32, *g, 17, -4);
+
+  FragmentLinker linker(*m_pConfig, *m_pModule, *m_pLDBackend);
+  ASSERT_TRUE(linker.applyRelocations());
+  emit(linker);
+  ASSERT_EQ(0xfbU, readLE(m_Output, TextOffset + 1, 4));
+  ASSERT_EQ(0x1110U, readLE(m_Output, TextOffset + 8, 8));
+  ASSERT_EQ(0xfffff7ebU, readLE(m_Output, TextOffset + 17, 4));
+}
+
+TEST_F( FragmentLinkerTest, keep_result_under_none_relocation) {
+  LDSymbol* f = addSymbol("f", 0x1100);
+  addReloc(llvm::ELF::R_X86_64_PC32, *f, 1, -4);
+  addReloc(llvm::ELF::R_X86_64_NONE, *f, 1, 0);
+
+  FragmentLinker linker(*m_pConfig, *m_pModule, *m_pLDBackend);
+  ASSERT_TRUE(linker.applyRelocations());
+  emit(linker);
+  ASSERT_EQ(0xfbU, readLE(m_Output, TextOffset + 1, 4));
+}
+
+TEST_F( FragmentLinkerTest, classify_x86_64_relocations) {
+  LDSymbol* f = addSymbol("f", 0x1100);
+  LDSymbol* p = addSymbol("p", 0x1200);
+  p->resolveInfo()->setReserved(X86GNULDBackend::ReservePLT);
+  Relocator& relocator = *m_pLDBackend->getRelocator();
+
+  // static relocations only depend on the layout
+  ASSERT_TRUE(relocator.mayApplyConcurrently(
+                *addReloc(llvm::ELF::R_X86_64_NONE, *f, 0, 0)));
+  ASSERT_TRUE(relocator.mayApplyConcurrently(
+                *addReloc(llvm::ELF::R_X86_64_64, *f, 8, 0)));
+  ASSERT_TRUE(relocator.mayApplyConcurrently(
+                *addReloc(llvm::ELF::R_X86_64_32S, *f, 8, 0)));
+  ASSERT_TRUE(relocator.mayApplyConcurrently(
+                *addReloc(llvm::ELF::R_X86_64_PC32, *f, 1, -4)));
+
+  // a symbol with reserved entries goes through the PLT
+  ASSERT_FALSE(relocator.mayApplyConcurrently(
+                 *addReloc(llvm::ELF::R_X86_64_PC32, *p, 1, -4)));
+  ASSERT_FALSE(relocator.mayApplyConcurrently(
+                 *addReloc(llvm::ELF::R_X86_64_64, *p, 8, 0)));
+
+  // GOT, PLT and TLS relocations consume the entries
+  ASSERT_FALSE(relocator.mayApplyConcurrently(
+                 *addReloc(llvm::ELF::R_X86_64_GOTPCREL, *f, 1, -4)));
+  ASSERT_FALSE(relocator.mayApplyConcurrently(
+                 *addReloc(llvm::ELF::R_X86_64_PLT32, *f, 1, -4)));
+  ASSERT_FALSE(relocator.mayApplyConcurrently(
+                 *addReloc(llvm::ELF::R_X86_64_TLSGD, *f, 1, -4)));
+  ASSERT_FALSE(relocator.mayApplyConcurrently(
+                 *addReloc(llvm::ELF::R_X86_64_GOTTPOFF, *f, 1, -4)));
+  ASSERT_FALSE(relocator.mayApplyConcurrently(
+                 *addReloc(llvm::ELF::R_X86_64_TPOFF32, *f, 1, 0)));
+
+  // unknown types are reported in order by applyRelocations
+  ASSERT_FALSE(relocator.mayApplyConcurrently(*addReloc(0xff, *f, 1, 0)));
+}
+
+TEST_F( FragmentLinkerTest, classify_i386_relocations) {
+  LinkerConfig config("i386-linux-gnu");
+  config.targets().setEndian(TargetOptions::Little);
+  config.targets().setBitClass(32);
+  config.setCodeGenType(LinkerConfig::Exec);
+  config.setCodePosition(LinkerConfig::StaticDependent);
+  X86_32GNULDBackend x86_32(config,
+                            new X86_32GNUInfo(config.targets().triple()));
+  GNULDBackend& backend = x86_32;
+  ASSERT_TRUE(backend.initRelocator());
+  Relocator& relocator = *backend.getRelocator();
+
+  LDSymbol* f = addSymbol("f", 0x1100);
+  LDSymbol* p = addSymbol("p", 0x1200);
+  p->resolveInfo()->setReserved(X86GNULDBackend::ReservePLT);
+
+  // static relocations, and the ones against GOT_ORG fixed after layout
+  ASSERT_TRUE(relocator.mayApplyConcurrently(
+                *addReloc(llvm::ELF::R_386_NONE, *f, 0, 0)));
+  ASSERT_TRUE(relocator.mayApplyConcurrently(
+                *addReloc(llvm::ELF::R_386_32, *f, 8, 0)));
+  ASSERT_TRUE(relocator.mayApplyConcurrently(
+                *addReloc(llvm::ELF::R_386_PC32, *f, 1, -4)));
+  ASSERT_TRUE(relocator.mayApplyConcurrently(
+                *addReloc(llvm::ELF::R_386_GOTOFF, *f, 8, 0)));
+  ASSERT_TRUE(relocator.mayApplyConcurrently(
+                *addReloc(llvm::ELF::R_386_GOTPC, *f, 8, 0)));
+
+  // a symbol with reserved entries goes through the PLT
+  ASSERT_FALSE(relocator.mayApplyConcurrently(
+                 *addReloc(llvm::ELF::R_386_PC32, *p, 1, -4)));
+
+  // GOT, PLT and TLS relocations consume the entries
+  ASSERT_FALSE(relocator.mayApplyConcurrently(
+                 *addReloc(llvm::ELF::R_386_GOT32, *f, 8, 0)));
+  ASSERT_FALSE(relocator.mayApplyConcurrently(
+                 *addReloc(llvm::ELF::R_386_PLT32, *f, 1, -4)));
+  ASSERT_FALSE(relocator.mayApplyConcurrently(
+                 *addReloc(llvm::ELF::R_386_TLS_GD, *f, 8, 0)));
+  ASSERT_FALSE(relocator.mayApplyConcurrently(
+                 *addReloc(llvm::ELF::R_386_TLS_IE, *f, 8, 0)));
+  ASSERT_FALSE(relocator.mayApplyConcurrently(
+                 *addReloc(llvm::ELF::R_386_TLS_LE, *f, 8, 0)));
+  ASSERT_FALSE(relocator.mayApplyConcurrently(
+                 *addReloc(llvm::ELF::R_386_TLS_LDM, *f, 8, 0)));
+
+  ASSERT_FALSE(relocator.mayApplyConcurrently(*addReloc(0xff, *f, 1, 0)));
+}
@@ -0,0 +1,78 @@
+//===- FragmentLinkerTest.h -----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_FRAGMENT_LINKER_TEST_H
+#define MCLD_FRAGMENT_LINKER_TEST_H
+
+#include <gtest.h>
+#include <llvm/Support/DataTypes.h>
+#include <string>
+
+namespace mcld {
+class FragmentLinker;
+class GNUInfo;
+class GNULDBackend;
+class IRBuilder;
+class LDSection;
+class LDSymbol;
+class LinkerConfig;
+class Module;
+class Relocation;
+} // namespace for mcld
+
+namespace mcldtest
+{
+
+/** \class FragmentLinkerTest
+ *  \brief The testcases of applying the relocations into the output.
+ *
+ *  \see FragmentLinker
+ */
+class FragmentLinkerTest : public ::testing::Test
+{
+public:
+  // Constructor can do set-up work for all test here.
+  FragmentLinkerTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~FragmentLinkerTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+
+protected:
+  /// addReloc - add a relocation of a new input against pSymbol to the
+  /// output .text
+  mcld::Relocation* addReloc(uint32_t pType,
+                             mcld::LDSymbol& pSymbol,
+                             uint32_t pOffset,
+                             int64_t pAddend);
+
+  /// addSymbol - define a local function at pValue
+  mcld::LDSymbol* addSymbol(const std::string& pName, uint64_t pValue);
+
+  /// emit - emit the output .text and write the relocation results into it.
+  /// m_Output gets the contents of the output file.
+  void emit(mcld::FragmentLinker& pLinker);
+
+protected:
+  mcld::LinkerConfig* m_pConfig;
+  mcld::GNUInfo* m_pInfo;
+  mcld::GNULDBackend* m_pLDBackend;
+  mcld::Module* m_pModule;
+  mcld::IRBuilder* m_pIRBuilder;
+  mcld::LDSection* m_pText;
+  std::string m_Output;
+};
+
+} // namespace of mcldtest
+
+#endif
@@ -0,0 +1,783 @@
+//===- GNUArchiveReaderTest.cpp -------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/IRBuilder.h>
+#include <mcld/LinkerConfig.h>
+#include <mcld/Module.h>
+#include <mcld/Fragment/Relocation.h>
+#include <mcld/LD/Archive.h>
+#include <mcld/LD/ArchiveIndexCache.h>
+#include <mcld/LD/ELFObjectReader.h>
+#include <mcld/LD/GNUArchiveReader.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Support/Path.h>
+#include <../lib/Target/X86/X86LDBackend.h>
+#include <../lib/Target/X86/X86GNUInfo.h>
+
+#include <llvm/Support/ELF.h>
+
+#include "GNUArchiveReaderTest.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace mcld;
+using namespace mcldtest;
+
+namespace {
+
+/// putLE - write a little-endian field of an ELF file
+void putLE(std::string& pData, size_t pOffset, uint64_t pValue, size_t pSize)
+{
+  for (size_t i = 0; i < pSize; ++i)
+    pData[pOffset + i] = static_cast<char>((pValue >> (8 * i)) & 0xff);
+}
+
+/// putBE - write a big-endian word of an armap
+void putBE(std::string& pData, size_t pOffset, uint64_t pValue, size_t pSize)
+{
+  for (size_t i = 0; i < pSize; ++i)
+    pData[pOffset + pSize - 1 - i] =
+                          static_cast<char>((pValue >> (8 * i)) & 0xff);
+}
+
+void putSection(std::string& pData,
+                uint64_t pOffset,
+                uint32_t pName,
+                uint32_t pType,
+                uint64_t pFlag,
+                uint64_t pSectOffset,
+                uint64_t pSize,
+                uint32_t pLink,
+                uint32_t pInfo,
+                uint64_t pAlign,
+                uint64_t pEntSize)
+{
+  putLE(pData, pOffset + 0x0,  pName,       4);
+  putLE(pData, pOffset + 0x4,  pType,       4);
+  putLE(pData, pOffset + 0x8,  pFlag,       8);
+  putLE(pData, pOffset + 0x18, pSectOffset, 8);
+  putLE(pData, pOffset + 0x20, pSize,       8);
+  putLE(pData, pOffset + 0x28, pLink,       4);
+  putLE(pData, pOffset + 0x2c, pInfo,       4);
+  putLE(pData, pOffset + 0x30, pAlign,      8);
+  putLE(pData, pOffset + 0x38, pEntSize,    8);
+}
+
+/// field - a field of a member header padded with spaces
+std::string field(const std::string& pValue, size_t pWidth)
+{
+  std::string result(pValue);
+  result.resize(pWidth, ' ');
+  return result;
+}
+
+std::string field(uint64_t pValue, size_t pWidth)
+{
+  std::ostringstream os;
+  os << pValue;
+  return field(os.str(), pWidth);
+}
+
+std::string memberHeader(const std::string& pName, uint64_t pSize)
+{
+  return field(pName, 16) + field(0, 12) + field(0, 6) + field(0, 6) +
+         field("644", 8) + field(pSize, 10) + "`\n";
+}
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+GNUArchiveReaderTest::GNUArchiveReaderTest()
+  : m_pMain(NULL)
+{
+  m_pConfig = new LinkerConfig("x86_64-linux-gnu");
+  m_pConfig->targets().setEndian(TargetOptions::Little);
+  m_pConfig->targets().setBitClass(64);
+  Relocation::SetUp(*m_pConfig);
+
+  m_pInfo = new X86_64GNUInfo(m_pConfig->targets().triple());
+  m_pLDBackend = new X86_64GNULDBackend(*m_pConfig, m_pInfo);
+  m_pModule = new Module("archive");
+  m_pIRBuilder = new IRBuilder(*m_pModule, *m_pConfig);
+  m_pObjectReader = new ELFObjectReader(*m_pLDBackend,
+                                        *m_pIRBuilder,
+                                        *m_pConfig);
+  m_pReader = new GNUArchiveReader(*m_pModule, *m_pObjectReader);
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+GNUArchiveReaderTest::~GNUArchiveReaderTest()
+{
+  delete m_pReader;
+  delete m_pObjectReader;
+  delete m_pIRBuilder;
+  delete m_pModule;
+  delete m_pLDBackend;
+  delete m_pConfig;
+}
+
+// SetUp() will be called immediately before each test.
+void GNUArchiveReaderTest::SetUp()
+{
+  m_pMain = m_pIRBuilder->CreateInput("main.o", sys::fs::Path("main.o"),
+                                      Input::Object);
+  ASSERT_TRUE(NULL != m_pMain);
+  m_pModule->getObjectList().push_back(m_pMain);
+}
+
+// TearDown() will be called immediately after each test.
+void GNUArchiveReaderTest::TearDown()
+{
+  for (size_t i = 0; i < m_Archives.size(); ++i)
+    delete m_Archives[i];
+  m_Archives.clear();
+
+  for (size_t i = 0; i < m_Files.size(); ++i)
+    ::unlink(m_Files[i].c_str());
+  m_Files.clear();
+
+  for (size_t i = 0; i < m_Directories.size(); ++i) {
+    DIR* dir = ::opendir(m_Directories[i].c_str());
+    if (NULL != dir) {
+      struct dirent* entry = NULL;
+      while (NULL != (entry = ::readdir(dir))) {
+        std::string name(entry->d_name);
+        if ("." != name && ".." != name)
+          ::unlink((m_Directories[i] + "/" + name).c_str());
+      }
+      ::closedir(dir);
+    }
+    ::rmdir(m_Directories[i].c_str());
+  }
+  m_Directories.clear();
+}
+
+std::string GNUArchiveReaderTest::object(const std::string& pDefined,
+                                         const std::string& pUndefined)
+{
+  std::string strtab(1, '\0');
+  std::vector<uint32_t> names;
+  if (!pDefined.empty()) {
+    names.push_back(strtab.size());
+    strtab += pDefined + '\0';
+  }
+  if (!pUndefined.empty()) {
+    names.push_back(strtab.size());
+    strtab += pUndefined + '\0';
+  }
+  const std::string shstrtab(".text\0.symtab\0.strtab\0.shstrtab\0", 32);
+
+  // ELF header, .text, .symtab, .strtab, .shstrtab and section headers
+  const uint64_t text_off = sizeof(llvm::ELF::Elf64_Ehdr);
+  const uint64_t symtab_off = text_off + 8;
+  const uint64_t symtab_size = (names.size() + 1) *
+                               sizeof(llvm::ELF::Elf64_Sym);
+  const uint64_t strtab_off = symtab_off + symtab_size;
+  const uint64_t shstrtab_off = strtab_off + strtab.size();
+  const uint64_t shoff = (shstrtab_off + 1 + shstrtab.size() + 7) & ~0x7ULL;
+  std::string data(shoff + 5 * sizeof(llvm::ELF::Elf64_Shdr), '\0');
+
+  data.replace(0, 4, "\x7f" "ELF");
+  data[llvm::ELF::EI_CLASS] = llvm::ELF::ELFCLASS64;
+  data[llvm::ELF::EI_DATA] = llvm::ELF::ELFDATA2LSB;
+  data[llvm::ELF::EI_VERSION] = llvm::ELF::EV_CURRENT;
+  putLE(data, 0x10, llvm::ELF::ET_REL, 2);
+  putLE(data, 0x12, llvm::ELF::EM_X86_64, 2);
+  putLE(data, 0x14, llvm::ELF::EV_CURRENT, 4);
+  putLE(data, 0x28, shoff, 8);
+  putLE(data, 0x34, sizeof(llvm::ELF::Elf64_Ehdr), 2);
+  putLE(data, 0x3a, sizeof(llvm::ELF::Elf64_Shdr), 2);
+  putLE(data, 0x3c, 5, 2);
+  putLE(data, 0x3e, 4, 2);
+
+  // ret
+  data[text_off] = '\xc3';
+
+  // the defined function is in .text, and the other is undefined
+  uint64_t sym = symtab_off + sizeof(llvm::ELF::Elf64_Sym);
+  for (size_t i = 0; i < names.size(); ++i) {
+    bool defined = (0 == i && !pDefined.empty());
+    putLE(data, sym, names[i], 4);
+    data[sym + 4] = (llvm::ELF::STB_GLOBAL << 4) |
+                    (defined ? llvm::ELF::STT_FUNC : llvm::ELF::STT_NOTYPE);
+    putLE(data, sym + 6, defined ? 1 : 0, 2);
+    putLE(data, sym + 16, defined ? 1 : 0, 8);
+    sym += sizeof(llvm::ELF::Elf64_Sym);
+  }
+  data.replace(strtab_off, strtab.size(), strtab);
+  data.replace(shstrtab_off + 1, shstrtab.size(), shstrtab);
+
+  uint64_t shdr = shoff + sizeof(llvm::ELF::Elf64_Shdr);
+  putSection(data, shdr, 1, llvm::ELF::SHT_PROGBITS,
+             llvm::ELF::SHF_ALLOC | llvm::ELF::SHF_EXECINSTR,
+             text_off, 1, 0, 0, 4, 0);
+  shdr += sizeof(llvm::ELF::Elf64_Shdr);
+  putSection(data, shdr, 7, llvm::ELF::SHT_SYMTAB, 0,
+             symtab_off, symtab_size, 3, 1, 8, sizeof(llvm::ELF::Elf64_Sym));
+  shdr += sizeof(llvm::ELF::Elf64_Shdr);
+  putSection(data, shdr, 15, llvm::ELF::SHT_STRTAB, 0,
+             strtab_off, strtab.size(), 0, 0, 1, 0);
+  shdr += sizeof(llvm::ELF::Elf64_Shdr);
+  putSection(data, shdr, 23, llvm::ELF::SHT_STRTAB, 0,
+             shstrtab_off, shstrtab.size() + 1, 0, 0, 1, 0);
+  return data;
+}
+
+GNUArchiveReaderTest::Member
+GNUArchiveReaderTest::member(const std::string& pName,
+                             const std::string& pDefined,
+                             const std::string& pUndefined)
+{
+  Member result;
+  result.name = pName;
+  result.contents = object(pDefined, pUndefined);
+  if (!pDefined.empty())
+    result.symbols.push_back(pDefined);
+  return result;
+}
+
+std::string GNUArchiveReaderTest::archive(const MemberList& pMembers,
+                                          bool pSym64,
+                                          std::vector<uint64_t>* pOffsets)
+{
+  const size_t word_size = pSym64 ? sizeof(uint64_t) : sizeof(uint32_t);
+  size_t number = 0;
+  std::string names;
+  for (size_t i = 0; i < pMembers.size(); ++i) {
+    for (size_t j = 0; j < pMembers[i].symbols.size(); ++j) {
+      names += pMembers[i].symbols[j] + '\0';
+      ++number;
+    }
+  }
+
+  // the members follow the armap at even offsets
+  std::vector<uint64_t> offsets;
+  uint64_t offset = Archive::MAGIC_LEN + sizeof(Archive::MemberHeader) +
+                    (number + 1) * word_size + names.size();
+  for (size_t i = 0; i < pMembers.size(); ++i) {
+    offset += (offset & 1);
+    offsets.push_back(offset);
+    offset += sizeof(Archive::MemberHeader) + pMembers[i].contents.size();
+  }
+
+  std::string armap((number + 1) * word_size, '\0');
+  putBE(armap, 0, number, word_size);
+  size_t idx = 1;
+  for (size_t i = 0; i < pMembers.size(); ++i) {
+    for (size_t j = 0; j < pMembers[i].symbols.size(); ++j, ++idx)
+      putBE(armap, idx * word_size, offsets[i], word_size);
+  }
+  armap += names;
+
+  std::string result(Archive::MAGIC, Archive::MAGIC_LEN);
+  result += memberHeader(pSym64 ? "/SYM64/" : "/", armap.size()) + armap;
+  for (size_t i = 0; i < pMembers.size(); ++i) {
+    if (0x0 != (result.size() & 1))
+      result += '\n';
+    result += memberHeader(pMembers[i].name + "/",
+                           pMembers[i].contents.size());
+    result += pMembers[i].contents;
+  }
+
+  if (NULL != pOffsets)
+    *pOffsets = offsets;
+  return result;
+}
+
+std::string GNUArchiveReaderTest::createDirectory()
+{
+  char path[] = "/tmp/mcld-cache-XXXXXX";
+  if (NULL == ::mkdtemp(path))
+    return std::string();
+  m_Directories.push_back(path);
+  return path;
+}
+
+Input* GNUArchiveReaderTest::readInput(const std::string& pName,
+                                       const std::string& pContents)
+{
+  char path[] = "/tmp/mcld-archive-XXXXXX";
+  int fd = ::mkstemp(path);
+  if (-1 == fd)
+    return NULL;
+  m_Files.push_back(path);
+
+  ssize_t size = ::write(fd, pContents.data(), pContents.size());
+  ::close(fd);
+  if (size != static_cast<ssize_t>(pContents.size()))
+    return NULL;
+  return m_pIRBuilder->ReadInput(pName, sys::fs::Path(path));
+}
+
+Archive* GNUArchiveReaderTest::createArchive(const std::string& pName,
+                                             const std::string& pContents)
+{
+  Input* input = readInput(pName, pContents);
+  if (NULL == input)
+    return NULL;
+  input->setType(Input::Archive);
+  Archive* result = new Archive(*input, m_pIRBuilder->getInputBuilder());
+  m_Archives.push_back(result);
+  return result;
+}
+
+void GNUArchiveReaderTest::refer(const std::string& pName, bool pWeak)
+{
+  m_pIRBuilder->AddSymbol(*m_pMain, pName, ResolveInfo::NoType,
+                          ResolveInfo::Undefined,
+                          pWeak ? ResolveInfo::Weak : ResolveInfo::Global,
+                          0x0);
+}
+
+bool GNUArchiveReaderTest::isIncluded(const std::string& pName) const
+{
+  return (0 != numOfIncluded(pName));
+}
+
+size_t GNUArchiveReaderTest::numOfIncluded(const std::string& pName) const
+{
+  size_t result = 0;
+  Module::const_obj_iterator obj, objEnd = m_pModule->obj_end();
+  for (obj = m_pModule->obj_begin(); obj != objEnd; ++obj) {
+    if (pName == (*obj)->name())
+      ++result;
+  }
+  return result;
+}
+
+/// cacheFile - the only cache file in pDirectory
+static std::string cacheFile(const std::string& pDirectory)
+{
+  std::string result;
+  DIR* dir = ::opendir(pDirectory.c_str());
+  if (NULL == dir)
+    return result;
+  struct dirent* entry = NULL;
+  while (NULL != (entry = ::readdir(dir))) {
+    std::string name(entry->d_name);
+    if (name.size() > 5 && 0 == name.compare(name.size() - 5, 5, ".aidx"))
+      result = pDirectory + "/" + name;
+  }
+  ::closedir(dir);
+  return result;
+}
+
+/// setTime - set the modification time of a file
+static bool setTime(const std::string& pPath, long pSec, long pNSec)
+{
+  struct timespec times[2];
+  times[0].tv_sec = times[1].tv_sec = pSec;
+  times[0].tv_nsec = times[1].tv_nsec = pNSec;
+  return (0 == ::utimensat(AT_FDCWD, pPath.c_str(), times, 0));
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( GNUArchiveReaderTest, parse_size) {
+  uint64_t size = 0;
+  ASSERT_TRUE(GNUArchiveReader::parseSize("1234      ", 10, size));
+  ASSERT_EQ(1234U, size);
+  ASSERT_TRUE(GNUArchiveReader::parseSize("9999999999", 10, size));
+  ASSERT_EQ(9999999999ULL, size);
+  ASSERT_TRUE(GNUArchiveReader::parseSize("0         ", 10, size));
+  ASSERT_EQ(0U, size);
+
+  // the largest file offset
+  ASSERT_TRUE(GNUArchiveReader::parseSize("9223372036854775807", 19, size));
+  ASSERT_EQ(0x7fffffffffffffffULL, size);
+
+  // not a number padded with spaces, or too large for a file offset
+  size = 42;
+  ASSERT_FALSE(GNUArchiveReader::parseSize("          ", 10, size));
+  ASSERT_FALSE(GNUArchiveReader::parseSize(" 1234     ", 10, size));
+  ASSERT_FALSE(GNUArchiveReader::parseSize("12a4      ", 10, size));
+  ASSERT_FALSE(GNUArchiveReader::parseSize("-1        ", 10, size));
+  ASSERT_FALSE(GNUArchiveReader::parseSize("9223372036854775808", 19, size));
+  ASSERT_FALSE(GNUArchiveReader::parseSize("99999999999999999999", 20, size));
+  ASSERT_EQ(42U, size);
+}
+
+TEST_F( GNUArchiveReaderTest, read_armap) {
+  MemberList members;
+  members.push_back(member("a.o", "a", ""));
+  members.push_back(member("b.o", "b", ""));
+  std::vector<uint64_t> offsets;
+  Archive* ar = createArchive("libab.a", archive(members, false, &offsets));
+  ASSERT_TRUE(NULL != ar);
+
+  refer("a");
+  ASSERT_TRUE(m_pReader->readArchive(*ar));
+  ASSERT_EQ(2U, ar->numOfSymbols());
+  ASSERT_TRUE("a" == ar->getSymbolName(0));
+  ASSERT_TRUE("b" == ar->getSymbolName(1));
+  ASSERT_EQ(offsets[0], ar->getObjFileOffset(0));
+  ASSERT_EQ(offsets[1], ar->getObjFileOffset(1));
+  ASSERT_TRUE(isIncluded("a.o"));
+  ASSERT_FALSE(isIncluded("b.o"));
+}
+
+TEST_F( GNUArchiveReaderTest, read_sym64_armap) {
+  MemberList members;
+  members.push_back(member("a.o", "a", ""));
+  members.push_back(member("b.o", "b", ""));
+  std::vector<uint64_t> offsets;
+  std::string contents = archive(members, true, &offsets);
+  ASSERT_EQ(0, contents.compare(Archive::MAGIC_LEN, 7, "/SYM64/"));
+  Archive* ar = createArchive("libab.a", contents);
+  ASSERT_TRUE(NULL != ar);
+
+  refer("b");
+  ASSERT_TRUE(m_pReader->readArchive(*ar));
+  ASSERT_EQ(2U, ar->numOfSymbols());
+  ASSERT_TRUE("a" == ar->getSymbolName(0));
+  ASSERT_TRUE("b" == ar->getSymbolName(1));
+  ASSERT_EQ(offsets[0], ar->getObjFileOffset(0));
+  ASSERT_EQ(offsets[1], ar->getObjFileOffset(1));
+  ASSERT_FALSE(isIncluded("a.o"));
+  ASSERT_TRUE(isIncluded("b.o"));
+}
+
+TEST_F( GNUArchiveReaderTest, reject_malformed_armap) {
+  MemberList members;
+  members.push_back(member("a.o", "a", ""));
+  const std::string contents = archive(members, true);
+  const size_t armap = Archive::MAGIC_LEN + sizeof(Archive::MemberHeader);
+  refer("a");
+
+  // the armap is larger than the file
+  std::string large_armap(contents);
+  large_armap.replace(Archive::MAGIC_LEN + 48, 10, field(9999999999ULL, 10));
+  Archive* ar = createArchive("large.a", large_armap);
+  ASSERT_TRUE(NULL != ar);
+  ASSERT_FALSE(m_pReader->readArchive(*ar));
+
+  // the offsets of the symbols are out of the armap
+  std::string many_symbols(contents);
+  putBE(many_symbols, armap, 0x2000000000000000ULL, sizeof(uint64_t));
+  ar = createArchive("many.a", many_symbols);
+  ASSERT_TRUE(NULL != ar);
+  ASSERT_FALSE(m_pReader->readArchive(*ar));
+
+  // the last name is not null-terminated
+  std::string no_null(contents);
+  no_null[armap + 2 * sizeof(uint64_t) + 1] = 'x';
+  ar = createArchive("no_null.a", no_null);
+  ASSERT_TRUE(NULL != ar);
+  ASSERT_FALSE(m_pReader->readArchive(*ar));
+
+  ASSERT_FALSE(isIncluded("a.o"));
+}
+
+TEST_F( GNUArchiveReaderTest, reject_member_out_of_archive) {
+  MemberList members;
+  members.push_back(member("a.o", "a", ""));
+  std::vector<uint64_t> offsets;
+  std::string contents = archive(members, false, &offsets);
+  contents.replace(offsets[0] + 48, 10, field(9999999999ULL, 10));
+  Archive* ar = createArchive("liba.a", contents);
+  ASSERT_TRUE(NULL != ar);
+
+  refer("a");
+  m_pReader->readArchive(*ar);
+  ASSERT_FALSE(isIncluded("a.o"));
+}
+
+TEST_F( GNUArchiveReaderTest, include_members_by_worklist) {
+  // a.o needs b.o and b.o needs c.o, but they come first in the armap, so
+  // only the undefined symbols of the included members can pull them in
+  MemberList members;
+  members.push_back(member("c.o", "c", ""));
+  members.push_back(member("b.o", "b", "c"));
+  members.push_back(member("a.o", "a", "b"));
+  members.push_back(member("d.o", "d", ""));
+  Archive* ar = createArchive("libabcd.a", archive(members, false));
+  ASSERT_TRUE(NULL != ar);
+
+  refer("a");
+  ASSERT_TRUE(m_pReader->readArchive(*ar));
+  ASSERT_EQ(4U, m_pModule->getObjectList().size());
+  ASSERT_TRUE("a.o" == m_pModule->getObjectList()[1]->name());
+  ASSERT_TRUE("b.o" == m_pModule->getObjectList()[2]->name());
+  ASSERT_TRUE("c.o" == m_pModule->getObjectList()[3]->name());
+  ASSERT_FALSE(isIncluded("d.o"));
+
+  // the armap symbols are decided
+  ASSERT_TRUE(Archive::Symbol::Include == ar->getSymbolStatus(0));
+  ASSERT_TRUE(Archive::Symbol::Include == ar->getSymbolStatus(1));
+  ASSERT_TRUE(Archive::Symbol::Include == ar->getSymbolStatus(2));
+  ASSERT_TRUE(Archive::Symbol::Unknown == ar->getSymbolStatus(3));
+}
+
+TEST_F( GNUArchiveReaderTest, include_member_once) {
+  // a.o has two symbols in the armap
+  MemberList members;
+  members.push_back(member("a.o", "a", ""));
+  members[0].symbols.push_back("a2");
+  Archive* ar = createArchive("liba.a", archive(members, false));
+  ASSERT_TRUE(NULL != ar);
+
+  refer("a");
+  refer("a2");
+  ASSERT_TRUE(m_pReader->readArchive(*ar));
+  ASSERT_EQ(1U, numOfIncluded("a.o"));
+  ASSERT_TRUE(Archive::Symbol::Include == ar->getSymbolStatus(1));
+
+  // reading the archive again includes nothing more
+  ASSERT_TRUE(m_pReader->readArchive(*ar));
+  ASSERT_EQ(1U, numOfIncluded("a.o"));
+}
+
+TEST_F( GNUArchiveReaderTest, skip_weak_and_defined_symbols) {
+  MemberList members;
+  members.push_back(member("a.o", "a", ""));
+  members.push_back(member("b.o", "b", ""));
+  Archive* ar = createArchive("libab.a", archive(members, false));
+  ASSERT_TRUE(NULL != ar);
+
+  // a weak reference does not include a member, and a defined symbol
+  // excludes it
+  refer("a", true);
+  m_pIRBuilder->AddSymbol(*m_pMain, "b", ResolveInfo::NoType,
+                          ResolveInfo::Define, ResolveInfo::Global, 0x0);
+  ASSERT_TRUE(m_pReader->readArchive(*ar));
+  ASSERT_FALSE(isIncluded("a.o"));
+  ASSERT_FALSE(isIncluded("b.o"));
+  ASSERT_TRUE(Archive::Symbol::Unknown == ar->getSymbolStatus(0));
+  ASSERT_TRUE(Archive::Symbol::Exclude == ar->getSymbolStatus(1));
+}
+
+TEST_F( GNUArchiveReaderTest, archive_index_cache) {
+  std::string dir = createDirectory();
+  ASSERT_FALSE(dir.empty());
+
+  MemberList members;
+  members.push_back(member("a.o", "a", ""));
+  members.push_back(member("b.o", "b", ""));
+  std::vector<uint64_t> offsets;
+  Archive* ar = createArchive("libab.a", archive(members, false, &offsets));
+  ASSERT_TRUE(NULL != ar);
+  const std::string ar_path = ar->getARFile().path().native();
+  ASSERT_TRUE(setTime(ar_path, 1000000000, 100));
+
+  // the first read stores the armap
+  m_pReader->setIndexCache(new ArchiveIndexCache(dir));
+  ASSERT_TRUE(m_pReader->readArchive(*ar));
+  std::string cache_path = cacheFile(dir);
+  ASSERT_FALSE(cache_path.empty());
+
+  // the cache file is little-endian with a version
+  std::FILE* file = std::fopen(cache_path.c_str(), "rb");
+  ASSERT_TRUE(NULL != file);
+  unsigned char header[16];
+  ASSERT_EQ(sizeof(header), std::fread(header, 1, sizeof(header), file));
+  std::fclose(file);
+  ASSERT_EQ(0, memcmp(header, "MCLDAIX\n", 8));
+  ASSERT_EQ(2, header[8]);
+  ASSERT_EQ(0, header[9] | header[10] | header[11]);
+  ASSERT_EQ(2, header[12]);
+  ASSERT_EQ(0, header[13] | header[14] | header[15]);
+
+  // a symbolic link to the archive shares the cache file
+  std::string link = ar_path + ".link";
+  ASSERT_EQ(0, ::symlink(ar_path.c_str(), link.c_str()));
+  m_Files.push_back(link);
+  Input* input = m_pIRBuilder->ReadInput("libab.a", sys::fs::Path(link));
+  ASSERT_TRUE(NULL != input);
+  ArchiveIndexCache cache(dir);
+  Archive linked(*input, m_pIRBuilder->getInputBuilder());
+  ASSERT_TRUE(cache.load(linked));
+  ASSERT_EQ(2U, linked.numOfSymbols());
+  ASSERT_TRUE("a" == linked.getSymbolName(0));
+  ASSERT_TRUE("b" == linked.getSymbolName(1));
+  ASSERT_EQ(offsets[0], linked.getObjFileOffset(0));
+  ASSERT_EQ(offsets[1], linked.getObjFileOffset(1));
+  ASSERT_EQ(ar->getSymTabSize(), linked.getSymTabSize());
+}
+
+TEST_F( GNUArchiveReaderTest, reject_stale_archive_index_cache) {
+  std::string dir = createDirectory();
+  ASSERT_FALSE(dir.empty());
+
+  MemberList members;
+  members.push_back(member("a.o", "a", ""));
+  Archive* ar = createArchive("liba.a", archive(members, false));
+  ASSERT_TRUE(NULL != ar);
+  const std::string ar_path = ar->getARFile().path().native();
+  ASSERT_TRUE(setTime(ar_path, 1000000000, 100));
+
+  ArchiveIndexCache cache(dir);
+  ASSERT_TRUE(m_pReader->readArchive(*ar));
+  ASSERT_TRUE(cache.store(*ar));
+  std::string cache_path = cacheFile(dir);
+  ASSERT_FALSE(cache_path.empty());
+
+  Archive same(ar->getARFile(), m_pIRBuilder->getInputBuilder());
+  ASSERT_TRUE(cache.load(same));
+
+  // the archive is rewritten within the same second
+  ASSERT_TRUE(setTime(ar_path, 1000000000, 200));
+  Archive rewritten(ar->getARFile(), m_pIRBuilder->getInputBuilder());
+  ASSERT_FALSE(cache.load(rewritten));
+  ASSERT_TRUE(setTime(ar_path, 1000000000, 100));
+
+  // an unknown version
+  std::string contents;
+  std::FILE* file = std::fopen(cache_path.c_str(), "rb");
+  ASSERT_TRUE(NULL != file);
+  char buffer[256];
+  size_t size = 0;
+  while (0 != (size = std::fread(buffer, 1, sizeof(buffer), file)))
+    contents.append(buffer, size);
+  std::fclose(file);
+
+  std::string version(contents);
+  version[8] = 1;
+  file = std::fopen(cache_path.c_str(), "wb");
+  ASSERT_TRUE(NULL != file);
+  std::fwrite(version.data(), 1, version.size(), file);
+  std::fclose(file);
+  Archive old(ar->getARFile(), m_pIRBuilder->getInputBuilder());
+  ASSERT_FALSE(cache.load(old));
+
+  // a truncated cache file
+  file = std::fopen(cache_path.c_str(), "wb");
+  ASSERT_TRUE(NULL != file);
+  std::fwrite(contents.data(), 1, contents.size() - 1, file);
+  std::fclose(file);
+  Archive truncated(ar->getARFile(), m_pIRBuilder->getInputBuilder());
+  ASSERT_FALSE(cache.load(truncated));
+}
+
+TEST_F( GNUArchiveReaderTest, resolve_group_from_next_archive) {
+  // s.o of libs.a refers to q in the first round of the group, after libq.a
+  // is scanned. In the second round, q.o of libq.a refers to x. Like GNU ld,
+  // the scan goes on from libq.a, so x is resolved by libs.a rather than the
+  // first archive of the group.
+  MemberList members;
+  members.push_back(member("x1.o", "x", ""));
+  Archive* libx = createArchive("libx.a", archive(members, false));
+  members.clear();
+  members.push_back(member("q.o", "q", "x"));
+  Archive* libq = createArchive("libq.a", archive(members, false));
+  members.clear();
+  members.push_back(member("x3.o", "x", ""));
+  members.push_back(member("s.o", "s", "q"));
+  Archive* libs = createArchive("libs.a", archive(members, false));
+  members.clear();
+  members.push_back(member("t.o", "t", "s"));
+  Archive* libt = createArchive("libt.a", archive(members, false));
+  ASSERT_TRUE(NULL != libx && NULL != libq && NULL != libs && NULL != libt);
+
+  refer("t");
+  ArchiveReader::ArchiveListType group;
+  group.push_back(libx);
+  group.push_back(libq);
+  group.push_back(libs);
+  group.push_back(libt);
+  for (size_t i = 0; i < group.size(); ++i)
+    ASSERT_TRUE(m_pReader->readArchive(*group[i]));
+  ASSERT_TRUE(isIncluded("t.o"));
+  ASSERT_FALSE(isIncluded("s.o"));
+
+  ASSERT_TRUE(m_pReader->readGroup(group));
+  ASSERT_TRUE(isIncluded("s.o"));
+  ASSERT_TRUE(isIncluded("q.o"));
+  ASSERT_TRUE(isIncluded("x3.o"));
+  ASSERT_FALSE(isIncluded("x1.o"));
+}
+
+TEST_F( GNUArchiveReaderTest, resolve_group_from_same_archive) {
+  // q.o and x2.o are in the same archive, which is scanned again before the
+  // scan goes on
+  MemberList members;
+  members.push_back(member("x1.o", "x", ""));
+  Archive* libx = createArchive("libx.a", archive(members, false));
+  members.clear();
+  members.push_back(member("x2.o", "x", ""));
+  members.push_back(member("q.o", "q", "x"));
+  Archive* libq = createArchive("libq.a", archive(members, false));
+  members.clear();
+  members.push_back(member("r.o", "r", "q"));
+  Archive* libr = createArchive("libr.a", archive(members, false));
+  ASSERT_TRUE(NULL != libx && NULL != libq && NULL != libr);
+
+  refer("r");
+  ArchiveReader::ArchiveListType group;
+  group.push_back(libx);
+  group.push_back(libq);
+  group.push_back(libr);
+  for (size_t i = 0; i < group.size(); ++i)
+    ASSERT_TRUE(m_pReader->readArchive(*group[i]));
+
+  ASSERT_TRUE(m_pReader->readGroup(group));
+  ASSERT_TRUE(isIncluded("q.o"));
+  ASSERT_TRUE(isIncluded("x2.o"));
+  ASSERT_FALSE(isIncluded("x1.o"));
+}
+
+TEST_F( GNUArchiveReaderTest, resolve_group_around) {
+  // q.o of the last archive refers to x in the second round, and the scan
+  // wraps around to the first archive before the second one
+  MemberList members;
+  members.push_back(member("x1.o", "x", ""));
+  Archive* libx = createArchive("libx.a", archive(members, false));
+  members.clear();
+  members.push_back(member("x2.o", "x", ""));
+  members.push_back(member("t.o", "t", "q"));
+  Archive* libt = createArchive("libt.a", archive(members, false));
+  members.clear();
+  members.push_back(member("q.o", "q", "x"));
+  members.push_back(member("r.o", "r", "t"));
+  Archive* libr = createArchive("libr.a", archive(members, false));
+  ASSERT_TRUE(NULL != libx && NULL != libt && NULL != libr);
+
+  refer("r");
+  ArchiveReader::ArchiveListType group;
+  group.push_back(libx);
+  group.push_back(libt);
+  group.push_back(libr);
+  for (size_t i = 0; i < group.size(); ++i)
+    ASSERT_TRUE(m_pReader->readArchive(*group[i]));
+  ASSERT_FALSE(isIncluded("t.o"));
+
+  ASSERT_TRUE(m_pReader->readGroup(group));
+  ASSERT_TRUE(isIncluded("t.o"));
+  ASSERT_TRUE(isIncluded("q.o"));
+  ASSERT_TRUE(isIncluded("x1.o"));
+  ASSERT_FALSE(isIncluded("x2.o"));
+  ASSERT_EQ(1U, numOfIncluded("q.o"));
+}
+
+TEST_F( GNUArchiveReaderTest, skip_weak_references_in_group) {
+  MemberList members;
+  members.push_back(member("x1.o", "x", ""));
+  Archive* libx = createArchive("libx.a", archive(members, false));
+  members.clear();
+  members.push_back(member("r.o", "r", ""));
+  Archive* libr = createArchive("libr.a", archive(members, false));
+  ASSERT_TRUE(NULL != libx && NULL != libr);
+
+  refer("x", true);
+  refer("r");
+  ArchiveReader::ArchiveListType group;
+  group.push_back(libx);
+  group.push_back(libr);
+  for (size_t i = 0; i < group.size(); ++i)
+    ASSERT_TRUE(m_pReader->readArchive(*group[i]));
+
+  ASSERT_TRUE(m_pReader->readGroup(group));
+  ASSERT_TRUE(isIncluded("r.o"));
+  ASSERT_FALSE(isIncluded("x1.o"));
+}
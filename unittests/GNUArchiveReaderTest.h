@@ -0,0 +1,119 @@
+//===- GNUArchiveReaderTest.h ---------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_GNU_ARCHIVE_READER_TEST_H
+#define MCLD_GNU_ARCHIVE_READER_TEST_H
+
+#include <gtest.h>
+#include <llvm/Support/DataTypes.h>
+#include <string>
+#include <vector>
+
+namespace mcld {
+class Archive;
+class ELFObjectReader;
+class GNUArchiveReader;
+class GNUInfo;
+class GNULDBackend;
+class Input;
+class IRBuilder;
+class LinkerConfig;
+class Module;
+} // namespace for mcld
+
+namespace mcldtest
+{
+
+/** \class GNUArchiveReaderTest
+ *  \brief The testcases of reading the GNU archives.
+ *
+ *  The archives and their ELF members are written to temporary files.
+ *
+ *  \see GNUArchiveReader
+ */
+class GNUArchiveReaderTest : public ::testing::Test
+{
+public:
+  /// Member - an object member and the symbols of it in the armap
+  struct Member
+  {
+    std::string name;
+    std::string contents;
+    std::vector<std::string> symbols;
+  };
+
+  typedef std::vector<Member> MemberList;
+
+public:
+  // Constructor can do set-up work for all test here.
+  GNUArchiveReaderTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~GNUArchiveReaderTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+
+protected:
+  /// object - an x86_64 relocatable object which defines the function
+  /// pDefined and refers to pUndefined. An empty name is left out.
+  static std::string object(const std::string& pDefined,
+                            const std::string& pUndefined);
+
+  /// member - an object member which defines pDefined in the armap
+  static Member member(const std::string& pName,
+                       const std::string& pDefined,
+                       const std::string& pUndefined);
+
+  /// archive - an archive of pMembers. If pOffsets is given, it gets the
+  /// file offsets of the member headers.
+  static std::string archive(const MemberList& pMembers,
+                             bool pSym64,
+                             std::vector<uint64_t>* pOffsets = NULL);
+
+  /// createDirectory - create a temporary directory, which is removed with
+  /// the files in it after the test
+  std::string createDirectory();
+
+  /// readInput - write pContents to a temporary file and read it as an input
+  mcld::Input* readInput(const std::string& pName,
+                         const std::string& pContents);
+
+  /// createArchive - read pContents as an archive
+  mcld::Archive* createArchive(const std::string& pName,
+                               const std::string& pContents);
+
+  /// refer - let the inputs before the archives refer to pName
+  void refer(const std::string& pName, bool pWeak = false);
+
+  /// isIncluded - whether a member named pName is read as an object
+  bool isIncluded(const std::string& pName) const;
+
+  /// numOfIncluded - the number of the members named pName read as objects
+  size_t numOfIncluded(const std::string& pName) const;
+
+protected:
+  mcld::LinkerConfig* m_pConfig;
+  mcld::GNUInfo* m_pInfo;
+  mcld::GNULDBackend* m_pLDBackend;
+  mcld::Module* m_pModule;
+  mcld::IRBuilder* m_pIRBuilder;
+  mcld::ELFObjectReader* m_pObjectReader;
+  mcld::GNUArchiveReader* m_pReader;
+  mcld::Input* m_pMain;
+  std::vector<mcld::Archive*> m_Archives;
+  std::vector<std::string> m_Files;
+  std::vector<std::string> m_Directories;
+};
+
+} // namespace of mcldtest
+
+#endif
@@ -0,0 +1,177 @@
+//===- GarbageCollectionTest.cpp ------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/IRBuilder.h>
+#include <mcld/LinkerConfig.h>
+#include <mcld/Module.h>
+#include <mcld/Fragment/FragmentRef.h>
+#include <mcld/Fragment/Relocation.h>
+#include <mcld/LD/GarbageCollection.h>
+#include <mcld/LD/LDContext.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Support/Path.h>
+#include <../lib/Target/X86/X86LDBackend.h>
+#include <../lib/Target/X86/X86GNUInfo.h>
+
+#include <llvm/Support/ELF.h>
+
+#include <cstring>
+
+#include "GarbageCollectionTest.h"
+
+using namespace mcld;
+using namespace mcldtest;
+
+// Constructor can do set-up work for all test here.
+GarbageCollectionTest::GarbageCollectionTest()
+  : m_pInput(NULL)
+{
+  m_pConfig = new LinkerConfig("x86_64-linux-gnu");
+  m_pConfig->targets().setEndian(TargetOptions::Little);
+  m_pConfig->targets().setBitClass(64);
+  m_pConfig->setCodeGenType(LinkerConfig::Exec);
+  Relocation::SetUp(*m_pConfig);
+
+  m_pInfo = new X86_64GNUInfo(m_pConfig->targets().triple());
+  m_pLDBackend = new X86_64GNULDBackend(*m_pConfig, m_pInfo);
+  m_pModule = new Module("gc");
+  m_pIRBuilder = new IRBuilder(*m_pModule, *m_pConfig);
+  memset(m_Contents, 0x90, sizeof(m_Contents));
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+GarbageCollectionTest::~GarbageCollectionTest()
+{
+  delete m_pIRBuilder;
+  delete m_pModule;
+  delete m_pLDBackend;
+  delete m_pConfig;
+}
+
+// SetUp() will be called immediately before each test.
+void GarbageCollectionTest::SetUp()
+{
+  m_pInput = m_pIRBuilder->CreateInput("gc.o", sys::fs::Path("gc.o"),
+                                       Input::Object);
+  ASSERT_TRUE(NULL != m_pInput);
+  m_pModule->getObjectList().push_back(m_pInput);
+}
+
+// TearDown() will be called immediately after each test.
+void GarbageCollectionTest::TearDown()
+{
+}
+
+LDSection* GarbageCollectionTest::addSection(const std::string& pName,
+                                             uint32_t pFlag)
+{
+  LDSection* sect = IRBuilder::CreateELFHeader(*m_pInput,
+                                               pName,
+                                               llvm::ELF::SHT_PROGBITS,
+                                               pFlag,
+                                               1);
+  SectionData* data = IRBuilder::CreateSectionData(*sect);
+  IRBuilder::AppendFragment(*IRBuilder::CreateRegion(m_Contents,
+                                                     sizeof(m_Contents)),
+                            *data);
+  return sect;
+}
+
+void GarbageCollectionTest::run()
+{
+  GarbageCollection gc(*m_pConfig, *m_pLDBackend, *m_pModule);
+  ASSERT_TRUE(gc.run());
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( GarbageCollectionTest, follow_relocations_from_entry) {
+  uint32_t text = llvm::ELF::SHF_ALLOC | llvm::ELF::SHF_EXECINSTR;
+  LDSection* start = addSection(".text._start", text);
+  LDSection* used = addSection(".text.used", text);
+  LDSection* unused = addSection(".text.unused", text);
+
+  m_pIRBuilder->AddSymbol(*m_pInput, "_start", ResolveInfo::Function,
+                          ResolveInfo::Define, ResolveInfo::Global,
+                          4, 0x0, start, ResolveInfo::Hidden);
+  LDSymbol* callee = m_pIRBuilder->AddSymbol(*m_pInput, "used",
+                          ResolveInfo::Function, ResolveInfo::Define,
+                          ResolveInfo::Global, 4, 0x0, used,
+                          ResolveInfo::Hidden);
+
+  LDSection* rela = IRBuilder::CreateELFHeader(*m_pInput,
+                                               ".rela.text._start",
+                                               llvm::ELF::SHT_RELA,
+                                               0x0,
+                                               8);
+  rela->setLink(start);
+  IRBuilder::CreateRelocData(*rela);
+  IRBuilder::AddRelocation(*rela, llvm::ELF::R_X86_64_PC32, *callee, 0x1);
+
+  run();
+  ASSERT_TRUE(LDFileFormat::Regular == start->kind());
+  ASSERT_TRUE(LDFileFormat::Regular == used->kind());
+  ASSERT_TRUE(LDFileFormat::Ignore == unused->kind());
+  ASSERT_TRUE(LDFileFormat::Regular == rela->kind());
+}
+
+TEST_F( GarbageCollectionTest, keep_dynamic_symbols_of_executable) {
+  // an executable linked against shared objects exports its default
+  // visibility symbols to .dynsym without --export-dynamic
+  uint32_t text = llvm::ELF::SHF_ALLOC | llvm::ELF::SHF_EXECINSTR;
+  LDSection* exported = addSection(".text.exported", text);
+  LDSection* hidden = addSection(".text.hidden", text);
+  m_pIRBuilder->AddSymbol(*m_pInput, "exported", ResolveInfo::Function,
+                          ResolveInfo::Define, ResolveInfo::Global,
+                          4, 0x0, exported);
+  m_pIRBuilder->AddSymbol(*m_pInput, "hidden", ResolveInfo::Function,
+                          ResolveInfo::Define, ResolveInfo::Global,
+                          4, 0x0, hidden, ResolveInfo::Hidden);
+
+  ASSERT_FALSE(m_pConfig->options().exportDynamic());
+  m_pConfig->setCodePosition(LinkerConfig::DynamicDependent);
+  run();
+  ASSERT_TRUE(LDFileFormat::Regular == exported->kind());
+  ASSERT_TRUE(LDFileFormat::Ignore == hidden->kind());
+}
+
+TEST_F( GarbageCollectionTest, strip_exported_symbols_of_static_link) {
+  uint32_t text = llvm::ELF::SHF_ALLOC | llvm::ELF::SHF_EXECINSTR;
+  LDSection* exported = addSection(".text.exported", text);
+  LDSymbol* symbol = m_pIRBuilder->AddSymbol(*m_pInput, "exported",
+                          ResolveInfo::Function, ResolveInfo::Define,
+                          ResolveInfo::Global, 4, 0x8, exported);
+
+  m_pConfig->setCodePosition(LinkerConfig::StaticDependent);
+  run();
+  ASSERT_TRUE(LDFileFormat::Ignore == exported->kind());
+
+  // the output symbol becomes absolute zero
+  LDSymbol* output = symbol->resolveInfo()->outSymbol();
+  ASSERT_FALSE(output->hasFragRef());
+  ASSERT_TRUE(0x0 == output->value());
+}
+
+TEST_F( GarbageCollectionTest, clear_section_symbols_of_stripped_sections) {
+  uint32_t data = llvm::ELF::SHF_ALLOC | llvm::ELF::SHF_WRITE;
+  LDSection* unused = addSection(".data.unused", data);
+  LDSymbol* section_sym = m_pIRBuilder->AddSymbol(*m_pInput, ".data.unused",
+                          ResolveInfo::Section, ResolveInfo::Define,
+                          ResolveInfo::Local, 0, 0x0, unused);
+  ASSERT_TRUE(section_sym->hasFragRef());
+
+  m_pConfig->setCodePosition(LinkerConfig::StaticDependent);
+  run();
+  ASSERT_TRUE(LDFileFormat::Ignore == unused->kind());
+  ASSERT_FALSE(section_sym->hasFragRef());
+  ASSERT_TRUE(0x0 == section_sym->value());
+}
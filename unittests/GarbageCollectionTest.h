@@ -0,0 +1,68 @@
+//===- GarbageCollectionTest.h --------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_GARBAGE_COLLECTION_TEST_H
+#define MCLD_GARBAGE_COLLECTION_TEST_H
+
+#include <gtest.h>
+#include <string>
+
+namespace mcld {
+class GNUInfo;
+class GNULDBackend;
+class Input;
+class IRBuilder;
+class LDSection;
+class LinkerConfig;
+class Module;
+} // namespace for mcld
+
+namespace mcldtest
+{
+
+/** \class GarbageCollectionTest
+ *  \brief The testcases of --gc-sections.
+ *
+ *  \see GarbageCollection
+ */
+class GarbageCollectionTest : public ::testing::Test
+{
+public:
+  // Constructor can do set-up work for all test here.
+  GarbageCollectionTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~GarbageCollectionTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+
+protected:
+  /// addSection - add an allocatable section of 16 bytes to m_pInput
+  mcld::LDSection* addSection(const std::string& pName, uint32_t pFlag);
+
+  /// run - run the garbage collection over m_pInput
+  void run();
+
+protected:
+  mcld::LinkerConfig* m_pConfig;
+  mcld::GNUInfo* m_pInfo;
+  mcld::GNULDBackend* m_pLDBackend;
+  mcld::Module* m_pModule;
+  mcld::IRBuilder* m_pIRBuilder;
+  mcld::Input* m_pInput;
+  uint8_t m_Contents[16];
+};
+
+} // namespace of mcldtest
+
+#endif
+
@@ -0,0 +1,257 @@
+//===- IdenticalCodeFoldingTest.cpp ---------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/IRBuilder.h>
+#include <mcld/LinkerConfig.h>
+#include <mcld/Module.h>
+#include <mcld/Fragment/FragmentRef.h>
+#include <mcld/Fragment/Relocation.h>
+#include <mcld/LD/IdenticalCodeFolding.h>
+#include <mcld/LD/LDContext.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Support/Path.h>
+#include <../lib/Target/X86/X86LDBackend.h>
+#include <../lib/Target/X86/X86GNUInfo.h>
+
+#include <llvm/Support/ELF.h>
+
+#include "IdenticalCodeFoldingTest.h"
+
+using namespace mcld;
+using namespace mcldtest;
+
+namespace {
+
+const uint32_t TextFlag = llvm::ELF::SHF_ALLOC | llvm::ELF::SHF_EXECINSTR;
+const uint32_t DataFlag = llvm::ELF::SHF_ALLOC | llvm::ELF::SHF_WRITE;
+
+// ret
+uint8_t Ret[] = { 0xc3 };
+
+// call f; jmp g
+uint8_t CallAndJump[] = { 0xe8, 0x0, 0x0, 0x0, 0x0, 0xe9, 0x0, 0x0, 0x0, 0x0 };
+
+// lea f(%rip), %rax
+uint8_t Lea[] = { 0x48, 0x8d, 0x05, 0x0, 0x0, 0x0, 0x0, 0xc3 };
+
+// a function pointer
+uint8_t Pointer[] = { 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0 };
+
+const LDSection& sectionOf(const LDSymbol& pSymbol)
+{
+  const LDSymbol* output = pSymbol.resolveInfo()->outSymbol();
+  return output->fragRef()->frag()->getParent()->getSection();
+}
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+IdenticalCodeFoldingTest::IdenticalCodeFoldingTest()
+  : m_pInput(NULL)
+{
+  m_pConfig = new LinkerConfig("x86_64-linux-gnu");
+  m_pConfig->targets().setEndian(TargetOptions::Little);
+  m_pConfig->targets().setBitClass(64);
+  m_pConfig->setCodeGenType(LinkerConfig::Exec);
+  m_pConfig->setCodePosition(LinkerConfig::StaticDependent);
+  Relocation::SetUp(*m_pConfig);
+
+  m_pInfo = new X86_64GNUInfo(m_pConfig->targets().triple());
+  m_pLDBackend = new X86_64GNULDBackend(*m_pConfig, m_pInfo);
+  m_pModule = new Module("icf");
+  m_pIRBuilder = new IRBuilder(*m_pModule, *m_pConfig);
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+IdenticalCodeFoldingTest::~IdenticalCodeFoldingTest()
+{
+  delete m_pIRBuilder;
+  delete m_pModule;
+  delete m_pLDBackend;
+  delete m_pConfig;
+}
+
+// SetUp() will be called immediately before each test.
+void IdenticalCodeFoldingTest::SetUp()
+{
+  m_pInput = m_pIRBuilder->CreateInput("icf.o", sys::fs::Path("icf.o"),
+                                       Input::Object);
+  ASSERT_TRUE(NULL != m_pInput);
+  m_pModule->getObjectList().push_back(m_pInput);
+}
+
+// TearDown() will be called immediately after each test.
+void IdenticalCodeFoldingTest::TearDown()
+{
+}
+
+LDSection* IdenticalCodeFoldingTest::addSection(const std::string& pName,
+                                                uint32_t pFlag,
+                                                const uint8_t* pData,
+                                                size_t pSize)
+{
+  LDSection* sect = IRBuilder::CreateELFHeader(*m_pInput,
+                                               pName,
+                                               llvm::ELF::SHT_PROGBITS,
+                                               pFlag,
+                                               1);
+  SectionData* data = IRBuilder::CreateSectionData(*sect);
+  IRBuilder::AppendFragment(
+           *IRBuilder::CreateRegion(const_cast<uint8_t*>(pData), pSize),
+           *data);
+  return sect;
+}
+
+LDSymbol* IdenticalCodeFoldingTest::addFunction(const std::string& pSectionName,
+                                                const std::string& pName)
+{
+  LDSection* sect = addSection(pSectionName, TextFlag, Ret, sizeof(Ret));
+  return m_pIRBuilder->AddSymbol(*m_pInput, pName, ResolveInfo::Function,
+                                 ResolveInfo::Define, ResolveInfo::Global,
+                                 sizeof(Ret), 0x0, sect, ResolveInfo::Hidden);
+}
+
+Relocation* IdenticalCodeFoldingTest::addReloc(LDSection& pTarget,
+                                               uint32_t pType,
+                                               LDSymbol& pSymbol,
+                                               uint32_t pOffset)
+{
+  LDSection* rela = NULL;
+  LDContext::sect_iterator rs, rsEnd = m_pInput->context()->relocSectEnd();
+  for (rs = m_pInput->context()->relocSectBegin(); rs != rsEnd; ++rs) {
+    if (&pTarget == (*rs)->getLink())
+      rela = *rs;
+  }
+
+  if (NULL == rela) {
+    rela = IRBuilder::CreateELFHeader(*m_pInput,
+                                      ".rela" + pTarget.name(),
+                                      llvm::ELF::SHT_RELA,
+                                      0x0,
+                                      8);
+    rela->setLink(&pTarget);
+    IRBuilder::CreateRelocData(*rela);
+  }
+  return IRBuilder::AddRelocation(*rela, pType, pSymbol, pOffset, -4);
+}
+
+void IdenticalCodeFoldingTest::fold(GeneralOptions::ICFMode pMode)
+{
+  m_pConfig->options().setICFMode(pMode);
+  IdenticalCodeFolding icf(*m_pConfig, *m_pLDBackend, *m_pModule);
+  ASSERT_TRUE(icf.foldIdenticalCode());
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( IdenticalCodeFoldingTest, ctor_and_dtor_names) {
+  ASSERT_TRUE(IdenticalCodeFolding::isCtorOrDtor(".text._ZN3FooC2Ev"));
+  ASSERT_TRUE(IdenticalCodeFolding::isCtorOrDtor(".text._ZN3FooD0Ev"));
+  ASSERT_TRUE(IdenticalCodeFolding::isCtorOrDtor(".text._ZN3FooC1ERKS_"));
+  ASSERT_TRUE(IdenticalCodeFolding::isCtorOrDtor(
+                                        ".text._ZNSt6vectorIiSaIiEEC2Ev"));
+  ASSERT_TRUE(IdenticalCodeFolding::isCtorOrDtor(".text._ZN3FooC2IiEET_"));
+  ASSERT_TRUE(IdenticalCodeFolding::isCtorOrDtor(
+                                        ".text.unlikely._ZN3FooD1Ev"));
+  ASSERT_TRUE(IdenticalCodeFolding::isCtorOrDtor(".text._ZN3BarCI13FooEi"));
+  ASSERT_TRUE(IdenticalCodeFolding::isCtorOrDtor(
+                                        ".text._ZN3FooC2B5cxx11Ev"));
+
+  // the substrings C1E, C2E or D0E do not make a constructor or destructor
+  ASSERT_FALSE(IdenticalCodeFolding::isCtorOrDtor(".text._ZN3Foo3barEv"));
+  ASSERT_FALSE(IdenticalCodeFolding::isCtorOrDtor(
+                                        ".text._ZN3Foo8C1EngineEv"));
+  ASSERT_FALSE(IdenticalCodeFolding::isCtorOrDtor(".text.C1E_ZN"));
+  ASSERT_FALSE(IdenticalCodeFolding::isCtorOrDtor(".text._Z3fooC1Ev"));
+  ASSERT_FALSE(IdenticalCodeFolding::isCtorOrDtor(".text._ZN3FooC2E"));
+  ASSERT_FALSE(IdenticalCodeFolding::isCtorOrDtor(".text._ZN3FooC2Ev.cold"));
+  ASSERT_FALSE(IdenticalCodeFolding::isCtorOrDtor(".rodata._ZN3FooC2Ev"));
+}
+
+TEST_F( IdenticalCodeFoldingTest, x86_64_function_address) {
+  LDSymbol* f = addFunction(".text.f", "f");
+  LDSection* caller = addSection(".text.caller", TextFlag,
+                                 CallAndJump, sizeof(CallAndJump));
+  LDSection* lea = addSection(".text.lea", TextFlag, Lea, sizeof(Lea));
+
+  Relocation* call = addReloc(*caller, llvm::ELF::R_X86_64_PC32, *f, 1);
+  Relocation* jump = addReloc(*caller, llvm::ELF::R_X86_64_PC32, *f, 6);
+  Relocation* plt = addReloc(*caller, llvm::ELF::R_X86_64_PLT32, *f, 6);
+  Relocation* addr = addReloc(*lea, llvm::ELF::R_X86_64_PC32, *f, 3);
+  Relocation* abs = addReloc(*lea, llvm::ELF::R_X86_64_64, *f, 0);
+
+  ASSERT_FALSE(m_pLDBackend->mayTakeFunctionAddress(*call));
+  ASSERT_FALSE(m_pLDBackend->mayTakeFunctionAddress(*jump));
+  ASSERT_FALSE(m_pLDBackend->mayTakeFunctionAddress(*plt));
+  ASSERT_TRUE(m_pLDBackend->mayTakeFunctionAddress(*addr));
+  ASSERT_TRUE(m_pLDBackend->mayTakeFunctionAddress(*abs));
+}
+
+TEST_F( IdenticalCodeFoldingTest, fold_all) {
+  LDSymbol* f = addFunction(".text.f", "f");
+  LDSymbol* g = addFunction(".text.g", "g");
+  LDSection* data = addSection(".data", DataFlag, Pointer, sizeof(Pointer));
+  addReloc(*data, llvm::ELF::R_X86_64_64, *g, 0);
+
+  fold(GeneralOptions::ICFAll);
+  ASSERT_TRUE(&sectionOf(*f) == &sectionOf(*g));
+  ASSERT_TRUE(LDFileFormat::Regular == sectionOf(*f).kind());
+}
+
+TEST_F( IdenticalCodeFoldingTest, safe_keeps_address_taken_functions) {
+  LDSymbol* f = addFunction(".text.f", "f");
+  LDSymbol* g = addFunction(".text.g", "g");
+  LDSymbol* h = addFunction(".text.h", "h");
+  LDSection* caller = addSection(".text.caller", TextFlag,
+                                 CallAndJump, sizeof(CallAndJump));
+  LDSection* data = addSection(".data", DataFlag, Pointer, sizeof(Pointer));
+
+  // f and g are only called, and the address of h is taken
+  addReloc(*caller, llvm::ELF::R_X86_64_PC32, *f, 1);
+  addReloc(*caller, llvm::ELF::R_X86_64_PC32, *g, 6);
+  addReloc(*data, llvm::ELF::R_X86_64_64, *h, 0);
+
+  fold(GeneralOptions::ICFSafe);
+  ASSERT_TRUE(&sectionOf(*f) == &sectionOf(*g));
+  ASSERT_TRUE(&sectionOf(*f) != &sectionOf(*h));
+  ASSERT_TRUE(LDFileFormat::Regular == sectionOf(*h).kind());
+}
+
+TEST_F( IdenticalCodeFoldingTest, safe_folds_ctors) {
+  LDSymbol* foo = addFunction(".text._ZN3FooC2Ev", "_ZN3FooC2Ev");
+  LDSymbol* bar = addFunction(".text._ZN3BarC2Ev", "_ZN3BarC2Ev");
+  LDSection* data = addSection(".data", DataFlag, Pointer, sizeof(Pointer));
+  addReloc(*data, llvm::ELF::R_X86_64_64, *bar, 0);
+
+  fold(GeneralOptions::ICFSafe);
+  ASSERT_TRUE(&sectionOf(*foo) == &sectionOf(*bar));
+}
+
+TEST_F( IdenticalCodeFoldingTest, safe_keeps_exported_functions) {
+  // a dynamically linked executable exports f and g to .dynsym
+  m_pConfig->setCodePosition(LinkerConfig::DynamicDependent);
+  LDSection* f_sect = addSection(".text.f", TextFlag, Ret, sizeof(Ret));
+  LDSection* g_sect = addSection(".text.g", TextFlag, Ret, sizeof(Ret));
+  LDSymbol* f = m_pIRBuilder->AddSymbol(*m_pInput, "f",
+                                        ResolveInfo::Function,
+                                        ResolveInfo::Define,
+                                        ResolveInfo::Global,
+                                        sizeof(Ret), 0x0, f_sect);
+  LDSymbol* g = m_pIRBuilder->AddSymbol(*m_pInput, "g",
+                                        ResolveInfo::Function,
+                                        ResolveInfo::Define,
+                                        ResolveInfo::Global,
+                                        sizeof(Ret), 0x0, g_sect);
+
+  fold(GeneralOptions::ICFSafe);
+  ASSERT_TRUE(&sectionOf(*f) != &sectionOf(*g));
+}
@@ -0,0 +1,84 @@
+//===- IdenticalCodeFoldingTest.h -----------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_IDENTICAL_CODE_FOLDING_TEST_H
+#define MCLD_IDENTICAL_CODE_FOLDING_TEST_H
+
+#include <gtest.h>
+#include <mcld/GeneralOptions.h>
+#include <string>
+
+namespace mcld {
+class GNUInfo;
+class GNULDBackend;
+class Input;
+class IRBuilder;
+class LDSection;
+class LDSymbol;
+class LinkerConfig;
+class Module;
+class Relocation;
+} // namespace for mcld
+
+namespace mcldtest
+{
+
+/** \class IdenticalCodeFoldingTest
+ *  \brief The testcases of --icf.
+ *
+ *  \see IdenticalCodeFolding
+ */
+class IdenticalCodeFoldingTest : public ::testing::Test
+{
+public:
+  // Constructor can do set-up work for all test here.
+  IdenticalCodeFoldingTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~IdenticalCodeFoldingTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+
+protected:
+  /// addSection - add a section with the contents pData to m_pInput
+  mcld::LDSection* addSection(const std::string& pName,
+                              uint32_t pFlag,
+                              const uint8_t* pData,
+                              size_t pSize);
+
+  /// addFunction - add a function section which only returns, and define
+  /// the global symbol pName in it
+  mcld::LDSymbol* addFunction(const std::string& pSectionName,
+                              const std::string& pName);
+
+  /// addReloc - add a relocation at pOffset of pTarget which refers pSymbol
+  mcld::Relocation* addReloc(mcld::LDSection& pTarget,
+                             uint32_t pType,
+                             mcld::LDSymbol& pSymbol,
+                             uint32_t pOffset);
+
+  /// fold - run the identical code folding over m_pInput
+  void fold(mcld::GeneralOptions::ICFMode pMode);
+
+protected:
+  mcld::LinkerConfig* m_pConfig;
+  mcld::GNUInfo* m_pInfo;
+  mcld::GNULDBackend* m_pLDBackend;
+  mcld::Module* m_pModule;
+  mcld::IRBuilder* m_pIRBuilder;
+  mcld::Input* m_pInput;
+};
+
+} // namespace of mcldtest
+
+#endif
+
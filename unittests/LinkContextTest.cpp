@@ -0,0 +1,206 @@
+//===- LinkContextTest.cpp ------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Environment.h>
+#include <mcld/LinkContext.h>
+#include <mcld/LinkerConfig.h>
+#include <mcld/LD/DiagnosticPrinter.h>
+#include <mcld/Support/MsgHandling.h>
+#include <mcld/Support/ThreadPool.h>
+#include "LinkContextTest.h"
+
+using namespace mcld;
+using namespace mcld::test;
+
+namespace {
+
+class CurrentTask : public ThreadPool::Task
+{
+public:
+  CurrentTask() : m_pContext(NULL) { }
+
+  void run() { m_pContext = &LinkContext::current(); }
+
+  const LinkContext* context() const { return m_pContext; }
+
+private:
+  const LinkContext* m_pContext;
+};
+
+/// ReportTask - set up the diagnostic engine of a worker thread and report
+/// an error to it
+class ReportTask : public ThreadPool::Task
+{
+public:
+  ReportTask() : m_pEngine(NULL), m_NumErrors(0) { }
+
+  void run() {
+    DiagnosticPrinter printer;
+    LinkerConfig config("x86_64-linux-gnu");
+    InitializeDiagnosticEngine(config, &printer);
+    error(diag::err_no_inputs);
+    m_pEngine = &getDiagnosticEngine();
+    m_NumErrors = printer.getNumErrors();
+  }
+
+  const DiagnosticEngine* engine() const { return m_pEngine; }
+
+  unsigned int numOfErrors() const { return m_NumErrors; }
+
+private:
+  const DiagnosticEngine* m_pEngine;
+  unsigned int m_NumErrors;
+};
+
+/// LinkTask - run a link in its own context on a worker thread and report
+/// pNumOfErrors errors to its own printer
+class LinkTask : public ThreadPool::Task
+{
+public:
+  explicit LinkTask(unsigned int pNumOfErrors)
+    : m_NumOfReports(pNumOfErrors), m_NumErrors(0), m_bOwnContext(false) { }
+
+  void run() {
+    LinkContext context;
+    context.activate();
+
+    DiagnosticPrinter printer;
+    LinkerConfig config("x86_64-linux-gnu");
+    InitializeDiagnosticEngine(config, &printer);
+    for (unsigned int i = 0; i < m_NumOfReports; ++i) {
+      error(diag::err_no_inputs);
+      m_bOwnContext = (&context == &LinkContext::current());
+    }
+    m_NumErrors = printer.getNumErrors();
+    context.deactivate();
+  }
+
+  unsigned int numOfErrors() const { return m_NumErrors; }
+
+  bool ownContext() const { return m_bOwnContext; }
+
+private:
+  unsigned int m_NumOfReports;
+  unsigned int m_NumErrors;
+  bool m_bOwnContext;
+};
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+LinkContextTest::LinkContextTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+LinkContextTest::~LinkContextTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void LinkContextTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void LinkContextTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( LinkContextTest, activate_and_deactivate) {
+  LinkContext* default_context = &LinkContext::current();
+
+  LinkContext context;
+  ASSERT_TRUE(default_context == &LinkContext::current());
+
+  context.activate();
+  ASSERT_TRUE(&context == &LinkContext::current());
+
+  context.deactivate();
+  ASSERT_TRUE(default_context == &LinkContext::current());
+}
+
+TEST_F( LinkContextTest, destroy_active_context) {
+  LinkContext* default_context = &LinkContext::current();
+  {
+    LinkContext context;
+    context.activate();
+    ASSERT_TRUE(&context == &LinkContext::current());
+  }
+  ASSERT_TRUE(default_context == &LinkContext::current());
+}
+
+TEST_F( LinkContextTest, context_per_thread) {
+  LinkContext* default_context = &LinkContext::current();
+  LinkContext context;
+  context.activate();
+
+  ThreadPool pool(2);
+  CurrentTask task;
+  pool.enqueue(task);
+  pool.wait();
+
+  // a worker thread does not see the context of this thread
+  if (pool.numOfThreads() > 1)
+    ASSERT_TRUE(default_context == task.context());
+  else
+    ASSERT_TRUE(&context == task.context());
+
+  context.deactivate();
+}
+
+TEST_F( LinkContextTest, diagnostic_engine_per_thread) {
+  DiagnosticPrinter printer;
+  LinkerConfig config("x86_64-linux-gnu");
+  InitializeDiagnosticEngine(config, &printer);
+
+  ThreadPool pool(2);
+  if (pool.numOfThreads() <= 1)
+    return;
+
+  ReportTask task;
+  pool.enqueue(task);
+  pool.wait();
+
+  // the error of the worker thread goes to its own engine
+  ASSERT_TRUE(&getDiagnosticEngine() != task.engine());
+  ASSERT_EQ(1U, task.numOfErrors());
+  ASSERT_EQ(0U, printer.getNumErrors());
+
+  error(diag::err_no_inputs);
+  ASSERT_EQ(1U, printer.getNumErrors());
+}
+
+TEST_F( LinkContextTest, concurrent_links) {
+  // construct the shared statics before the links run
+  Initialize();
+
+  DiagnosticPrinter printer;
+  LinkerConfig config("x86_64-linux-gnu");
+  InitializeDiagnosticEngine(config, &printer);
+
+  LinkTask link1(1000), link2(2000);
+  {
+    ThreadPool pool(2);
+    if (pool.numOfThreads() <= 1)
+      return;
+    pool.enqueue(link1);
+    pool.enqueue(link2);
+    pool.wait();
+  }
+
+  // each link reports to its own engine, even if they run at once
+  ASSERT_TRUE(link1.ownContext());
+  ASSERT_TRUE(link2.ownContext());
+  ASSERT_EQ(1000U, link1.numOfErrors());
+  ASSERT_EQ(2000U, link2.numOfErrors());
+  ASSERT_EQ(0U, printer.getNumErrors());
+}
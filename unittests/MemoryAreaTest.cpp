@@ -8,19 +8,47 @@
 //===----------------------------------------------------------------------===//
 #include <mcld/Support/FileHandle.h>
 #include <mcld/Support/FileSystem.h>
+#include <mcld/Support/HandleToArea.h>
 #include <mcld/Support/MemoryArea.h>
 #include <mcld/Support/MemoryRegion.h>
 #include <mcld/Support/MemoryAreaFactory.h>
 #include <mcld/Support/Path.h>
+#include <mcld/Support/ThreadPool.h>
 
 #include "MemoryAreaTest.h"
 #include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
 
 using namespace mcld;
 using namespace mcld::sys::fs;
 using namespace mcldtest;
 
+namespace {
+
+/// FillTask - write a range of the whole output on a worker thread
+class FillTask : public ThreadPool::Task
+{
+public:
+  FillTask(MemoryRegion& pRegion, char pValue)
+    : m_Region(pRegion), m_Value(pValue) { }
+
+  void run() {
+    for (size_t i = 0; i < m_Region.size(); ++i)
+      m_Region.getBuffer()[i] = m_Value;
+  }
+
+private:
+  MemoryRegion& m_Region;
+  char m_Value;
+};
+
+} // anonymous namespace
+
 
 // Constructor can do set-up work for all test here.
 MemoryAreaTest::MemoryAreaTest()
@@ -163,3 +191,233 @@ TEST_F( MemoryAreaTest, write_sync )
 }
 
 
+
+TEST_F( MemoryAreaTest, map_whole_file )
+{
+	Path path(TOPDIR);
+	path.append("unittests/test3.txt");
+
+	MemoryAreaFactory *AreaFactory = new MemoryAreaFactory(1);
+	MemoryArea* area = AreaFactory->produce(path, FileHandle::ReadOnly);
+	ASSERT_TRUE(area->mapWholeFile());
+	ASSERT_TRUE(area->isWholeFileMapped());
+	ASSERT_TRUE(area->mapWholeFile());
+
+	MemoryRegion* region1 = area->request(0, 2);
+	MemoryRegion* region2 = area->request(3, 2);
+	ASSERT_EQ('H', region1->getBuffer()[0]);
+	ASSERT_EQ('L', region2->getBuffer()[0]);
+	ASSERT_EQ('O', region2->getBuffer()[1]);
+	ASSERT_TRUE(region1->parent() == region2->parent());
+	ASSERT_EQ(region1->getBuffer() + 3, region2->getBuffer());
+
+	// the whole file space outlives its regions
+	area->release(region1);
+	area->release(region2);
+	ASSERT_TRUE(area->isWholeFileMapped());
+	region1 = area->request(4, 1);
+	ASSERT_EQ('O', region1->getBuffer()[0]);
+	area->release(region1);
+
+	area->clear();
+	ASSERT_FALSE(area->isWholeFileMapped());
+	AreaFactory->destruct(area);
+}
+
+TEST_F( MemoryAreaTest, no_map_writable_file )
+{
+	Path path(TOPDIR);
+	path.append("unittests/test2.txt");
+
+	MemoryAreaFactory *AreaFactory = new MemoryAreaFactory(1);
+	MemoryArea* area = AreaFactory->produce(path, FileHandle::ReadWrite);
+	ASSERT_FALSE(area->mapWholeFile());
+	ASSERT_FALSE(area->isWholeFileMapped());
+	AreaFactory->destruct(area);
+}
+
+TEST_F( MemoryAreaTest, share_area_of_same_file )
+{
+	Path path(TOPDIR);
+	path.append("unittests/test3.txt");
+	Path other(TOPDIR);
+	other.append("unittests/../unittests/./test3.txt");
+
+	MemoryAreaFactory *AreaFactory = new MemoryAreaFactory(1);
+	MemoryArea* area = AreaFactory->produce(path, FileHandle::ReadOnly);
+	ASSERT_TRUE(area == AreaFactory->produce(other, FileHandle::ReadOnly));
+	AreaFactory->destruct(area);
+}
+
+TEST_F( MemoryAreaTest, share_area_through_symbolic_links )
+{
+	char temp[] = "/tmp/mcld_area_XXXXXX";
+	ASSERT_TRUE(NULL != ::mkdtemp(temp));
+	std::string base(temp);
+	ASSERT_EQ(0, ::mkdir((base + "/d").c_str(), 0755));
+	ASSERT_EQ(0, ::mkdir((base + "/d/sub").c_str(), 0755));
+	FILE* file = ::fopen((base + "/d/f").c_str(), "w");
+	ASSERT_TRUE(NULL != file);
+	::fputs("HELLO", file);
+	::fclose(file);
+	ASSERT_EQ(0, ::symlink("d/sub", (base + "/l").c_str()));
+	ASSERT_EQ(0, ::symlink("d/f", (base + "/g").c_str()));
+
+	MemoryAreaFactory *AreaFactory = new MemoryAreaFactory(1);
+	MemoryArea* area = AreaFactory->produce(Path(base + "/d/f"),
+	                                        FileHandle::ReadOnly);
+	ASSERT_TRUE(NULL != area);
+	// "l/.." is "d", not the base directory
+	ASSERT_TRUE(area == AreaFactory->produce(Path(base + "/l/../f"),
+	                                         FileHandle::ReadOnly));
+	ASSERT_TRUE(area == AreaFactory->produce(Path(base + "/g"),
+	                                         FileHandle::ReadOnly));
+	AreaFactory->destruct(area);
+	delete AreaFactory;
+
+	::unlink((base + "/g").c_str());
+	::unlink((base + "/l").c_str());
+	::unlink((base + "/d/f").c_str());
+	::rmdir((base + "/d/sub").c_str());
+	::rmdir((base + "/d").c_str());
+	::rmdir(base.c_str());
+}
+
+TEST_F( MemoryAreaTest, erase_promotes_next_pair )
+{
+	Path path(TOPDIR);
+	path.append("unittests/test3.txt");
+	Path other(TOPDIR);
+	other.append("unittests/../unittests/test3.txt");
+
+	FileHandle handle1, handle2;
+	ASSERT_TRUE(handle1.open(path, FileHandle::ReadOnly));
+	ASSERT_TRUE(handle2.open(other, FileHandle::ReadOnly));
+	MemoryArea area1(handle1);
+	MemoryArea area2(handle2);
+
+	HandleToArea map;
+	ASSERT_TRUE(map.push_back(&handle1, &area1));
+	ASSERT_TRUE(map.push_back(&handle2, &area2));
+	ASSERT_TRUE(&area1 == map.findFirst(other).area);
+
+	ASSERT_TRUE(map.erase(path));
+	ASSERT_EQ(1U, map.size());
+	ASSERT_TRUE(&area2 == map.findFirst(path).area);
+	ASSERT_TRUE(&handle2 == map.findFirst(path).handle);
+
+	ASSERT_TRUE(map.erase(&area2));
+	ASSERT_TRUE(map.empty());
+	ASSERT_TRUE(NULL == map.findFirst(path).area);
+	ASSERT_FALSE(map.erase(&area2));
+}
+
+TEST_F( MemoryAreaTest, erase_moves_last_pair )
+{
+	Path path(TOPDIR);
+	path.append("unittests/test3.txt");
+	Path other(TOPDIR);
+	other.append("unittests/test2.txt");
+
+	FileHandle handle1, handle2, handle3;
+	ASSERT_TRUE(handle1.open(path, FileHandle::ReadOnly));
+	ASSERT_TRUE(handle2.open(other, FileHandle::ReadOnly));
+	ASSERT_TRUE(handle3.open(path, FileHandle::ReadOnly));
+	MemoryArea area1(handle1);
+	MemoryArea area2(handle2);
+	MemoryArea area3(handle3);
+
+	HandleToArea map;
+	ASSERT_TRUE(map.push_back(&handle1, &area1));
+	ASSERT_TRUE(map.push_back(&handle2, &area2));
+	ASSERT_TRUE(map.push_back(&handle3, &area3));
+	ASSERT_FALSE(map.push_back(&handle3, &area3));
+	ASSERT_EQ(3U, map.size());
+
+	// the last pair fills the hole, and stays the second pair of its file
+	ASSERT_TRUE(map.erase(&area2));
+	ASSERT_EQ(2U, map.size());
+	ASSERT_TRUE(NULL == map.findFirst(other).area);
+	ASSERT_TRUE(&area1 == map.findFirst(path).area);
+
+	ASSERT_TRUE(map.erase(path));
+	ASSERT_TRUE(&area3 == map.findFirst(path).area);
+	ASSERT_TRUE(&handle3 == map.findFirst(path).handle);
+	ASSERT_FALSE(map.erase(&area1));
+
+	ASSERT_TRUE(map.erase(&area3));
+	ASSERT_TRUE(map.empty());
+	ASSERT_FALSE(map.erase(path));
+}
+
+TEST_F( MemoryAreaTest, map_whole_output_on_threads )
+{
+	char name[] = "/tmp/mcld_output_XXXXXX";
+	int fd = ::mkstemp(name);
+	ASSERT_TRUE(-1 != fd);
+	::close(fd);
+
+	const size_t chunk = 0x3001;
+	const size_t num_of_chunks = 8;
+	FileHandle handle;
+	ASSERT_TRUE(handle.open(Path(name), FileHandle::ReadWrite |
+	                                    FileHandle::Truncate));
+	MemoryArea* area = new MemoryArea(handle);
+	ASSERT_FALSE(area->mapWholeOutput(0));
+	ASSERT_TRUE(area->mapWholeOutput(chunk * num_of_chunks));
+	ASSERT_TRUE(area->isWholeFileMapped());
+	ASSERT_TRUE(area->mapWholeOutput(chunk));
+	ASSERT_FALSE(area->mapWholeOutput(chunk * num_of_chunks + 1));
+
+	// every other chunk is written, the others stay zeros
+	ThreadPool pool(4);
+	std::vector<MemoryRegion*> regions;
+	std::vector<FillTask*> tasks;
+	for (size_t i = 0; i < num_of_chunks; i += 2) {
+		regions.push_back(area->request(i * chunk, chunk));
+		ASSERT_TRUE(NULL != regions.back());
+		tasks.push_back(new FillTask(*regions.back(), 'a' + i));
+		pool.enqueue(*tasks.back());
+	}
+	pool.wait();
+	for (size_t i = 0; i < tasks.size(); ++i) {
+		delete tasks[i];
+		area->release(regions[i]);
+	}
+
+	area->clear();
+	delete area;
+	ASSERT_TRUE(handle.close());
+
+	FILE* file = ::fopen(name, "rb");
+	ASSERT_TRUE(NULL != file);
+	std::string contents;
+	int c;
+	while (EOF != (c = ::fgetc(file)))
+		contents += char(c);
+	::fclose(file);
+	::unlink(name);
+
+	ASSERT_EQ(chunk * num_of_chunks, contents.size());
+	for (size_t i = 0; i < num_of_chunks; ++i) {
+		char value = (0 == i % 2) ? char('a' + i) : '\0';
+		ASSERT_EQ(value, contents[i * chunk]);
+		ASSERT_EQ(value, contents[(i + 1) * chunk - 1]);
+	}
+}
+
+TEST_F( MemoryAreaTest, no_map_whole_output_of_nonempty_file )
+{
+	Path path(TOPDIR);
+	path.append("unittests/test2.txt");
+
+	FileHandle handle;
+	ASSERT_TRUE(handle.open(path, FileHandle::ReadWrite));
+	size_t size = handle.size();
+	MemoryArea* area = new MemoryArea(handle);
+	ASSERT_FALSE(area->mapWholeOutput(0x1000));
+	ASSERT_FALSE(area->isWholeFileMapped());
+	ASSERT_EQ(size, handle.size());
+	delete area;
+	ASSERT_TRUE(handle.close());
+}
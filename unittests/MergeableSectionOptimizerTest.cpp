@@ -0,0 +1,366 @@
+//===- MergeableSectionOptimizerTest.cpp ----------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/IRBuilder.h>
+#include <mcld/LinkerConfig.h>
+#include <mcld/Module.h>
+#include <mcld/Fragment/FragmentRef.h>
+#include <mcld/Fragment/RegionFragment.h>
+#include <mcld/Fragment/Relocation.h>
+#include <mcld/LD/LDContext.h>
+#include <mcld/LD/LDSection.h>
+#include <mcld/LD/LDSymbol.h>
+#include <mcld/LD/MergeableSectionOptimizer.h>
+#include <mcld/LD/RelocData.h>
+#include <mcld/LD/ResolveInfo.h>
+#include <mcld/LD/SectionData.h>
+#include <mcld/MC/MCLDInput.h>
+#include <mcld/Object/ObjectBuilder.h>
+#include <mcld/Support/MemoryRegion.h>
+#include <mcld/Support/Path.h>
+
+#include <llvm/Support/Casting.h>
+#include <llvm/Support/ELF.h>
+
+#include "MergeableSectionOptimizerTest.h"
+
+using namespace mcld;
+using namespace mcldtest;
+
+namespace {
+
+uint8_t Code[16] = { 0xc3 };
+
+/// Contents - the contents of the region fragments of pSection
+std::string Contents(const LDSection& pSection)
+{
+  std::string result;
+  SectionData::const_iterator frag, fragEnd = pSection.getSectionData()->end();
+  for (frag = pSection.getSectionData()->begin(); frag != fragEnd; ++frag) {
+    const RegionFragment* region = llvm::dyn_cast<RegionFragment>(&*frag);
+    if (NULL != region)
+      result.append(reinterpret_cast<const char*>(region->getRegion().start()),
+                    region->getRegion().size());
+  }
+  return result;
+}
+
+/// SectionOf - the input section which pSymbol refers to
+const LDSection& SectionOf(const LDSymbol& pSymbol)
+{
+  return pSymbol.fragRef()->frag()->getParent()->getSection();
+}
+
+/// OffsetOf - the offset of pSymbol in its input section
+uint64_t OffsetOf(const LDSymbol& pSymbol)
+{
+  return pSymbol.fragRef()->frag()->getOffset() + pSymbol.fragRef()->offset();
+}
+
+/// Wide - a string of 16-bit characters with the terminator
+std::string Wide(const std::string& pString)
+{
+  std::string result;
+  for (size_t i = 0; i < pString.size(); ++i) {
+    result.push_back(pString[i]);
+    result.push_back('\0');
+  }
+  result.append(2, '\0');
+  return result;
+}
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+MergeableSectionOptimizerTest::MergeableSectionOptimizerTest()
+{
+  m_pConfig = new LinkerConfig("x86_64-linux-gnu");
+  m_pConfig->targets().setEndian(TargetOptions::Little);
+  m_pConfig->targets().setBitClass(64);
+  m_pConfig->setCodeGenType(LinkerConfig::Exec);
+  Relocation::SetUp(*m_pConfig);
+
+  m_pModule = new Module("merge");
+  m_pIRBuilder = new IRBuilder(*m_pModule, *m_pConfig);
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+MergeableSectionOptimizerTest::~MergeableSectionOptimizerTest()
+{
+  delete m_pIRBuilder;
+  delete m_pModule;
+  delete m_pConfig;
+
+  for (size_t i = 0; i < m_Contents.size(); ++i)
+    delete m_Contents[i];
+}
+
+// SetUp() will be called immediately before each test.
+void MergeableSectionOptimizerTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void MergeableSectionOptimizerTest::TearDown()
+{
+}
+
+Input& MergeableSectionOptimizerTest::addInput(const std::string& pName)
+{
+  Input* input = m_pIRBuilder->CreateInput(pName,
+                                           sys::fs::Path(pName),
+                                           Input::Object);
+  m_pModule->getObjectList().push_back(input);
+
+  LDSection* text = IRBuilder::CreateELFHeader(*input,
+                                               ".text",
+                                               llvm::ELF::SHT_PROGBITS,
+                                               llvm::ELF::SHF_ALLOC |
+                                               llvm::ELF::SHF_EXECINSTR,
+                                               16);
+  IRBuilder::AppendFragment(*IRBuilder::CreateRegion(Code, sizeof(Code)),
+                            *IRBuilder::CreateSectionData(*text));
+  return *input;
+}
+
+LDSection&
+MergeableSectionOptimizerTest::addSection(Input& pInput,
+                                          const std::string& pName,
+                                          uint32_t pFlag,
+                                          uint64_t pEntSize,
+                                          const std::string& pContents)
+{
+  m_Contents.push_back(new std::string(pContents));
+  std::string& contents = *m_Contents.back();
+
+  LDSection* section = IRBuilder::CreateELFHeader(pInput,
+                                                  pName,
+                                                  llvm::ELF::SHT_PROGBITS,
+                                                  llvm::ELF::SHF_ALLOC |
+                                                  llvm::ELF::SHF_MERGE |
+                                                  pFlag,
+                                                  pEntSize);
+  section->setEntSize(pEntSize);
+  section->setSize(contents.size());
+
+  // the region fragment is appended as ELFReader::readRegularSection does
+  ObjectBuilder::AppendFragment(
+                   *IRBuilder::CreateRegion(const_cast<char*>(contents.data()),
+                                            contents.size()),
+                   *IRBuilder::CreateSectionData(*section));
+  return *section;
+}
+
+LDSymbol* MergeableSectionOptimizerTest::define(Input& pInput,
+                                                const std::string& pName,
+                                                LDSection& pSection,
+                                                uint64_t pValue)
+{
+  return m_pIRBuilder->AddSymbol(pInput,
+                                 pName,
+                                 ResolveInfo::Object,
+                                 ResolveInfo::Define,
+                                 ResolveInfo::Global,
+                                 0x0,
+                                 pValue,
+                                 &pSection);
+}
+
+LDSymbol* MergeableSectionOptimizerTest::sectionSymbol(Input& pInput,
+                                                       LDSection& pSection)
+{
+  return m_pIRBuilder->AddSymbol(pInput,
+                                 pSection.name(),
+                                 ResolveInfo::Section,
+                                 ResolveInfo::Define,
+                                 ResolveInfo::Local,
+                                 0x0,
+                                 0x0,
+                                 &pSection);
+}
+
+Relocation* MergeableSectionOptimizerTest::relocate(Input& pInput,
+                                                    LDSymbol& pSymbol,
+                                                    uint32_t pOffset,
+                                                    int64_t pAddend)
+{
+  LDSection* rela = pInput.context()->getSection(".rela.text");
+  if (NULL == rela) {
+    rela = IRBuilder::CreateELFHeader(pInput,
+                                      ".rela.text",
+                                      llvm::ELF::SHT_RELA,
+                                      0x0,
+                                      8);
+    rela->setLink(pInput.context()->getSection(".text"));
+    IRBuilder::CreateRelocData(*rela);
+  }
+  return m_pIRBuilder->AddRelocation(*rela,
+                                     llvm::ELF::R_X86_64_64,
+                                     pSymbol,
+                                     pOffset,
+                                     pAddend);
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( MergeableSectionOptimizerTest, merge_strings) {
+  Input& a = addInput("a.o");
+  Input& b = addInput("b.o");
+  LDSection& a_str = addSection(a, ".rodata.str1.1", llvm::ELF::SHF_STRINGS, 1,
+                                std::string("foo\0bar\0", 8));
+  LDSection& b_str = addSection(b, ".rodata.str1.1", llvm::ELF::SHF_STRINGS, 1,
+                                std::string("bar\0baz\0foo\0", 12));
+  LDSymbol* foo = define(b, "foo", b_str, 9);
+  LDSymbol* baz = define(b, "baz", b_str, 4);
+
+  MergeableSectionOptimizer optimizer(*m_pConfig, *m_pModule);
+  ASSERT_TRUE(optimizer.run());
+  ASSERT_EQ(2U, optimizer.numOfRemovedPieces());
+  ASSERT_EQ(8U, optimizer.numOfRemovedBytes());
+
+  ASSERT_EQ(8U, a_str.size());
+  ASSERT_EQ(std::string("foo\0bar\0", 8), Contents(a_str));
+  ASSERT_EQ(4U, b_str.size());
+  ASSERT_EQ(std::string("baz\0", 4), Contents(b_str));
+
+  // foo+1 is moved to the kept foo of a.o, and baz to the new offset
+  ASSERT_TRUE(&a_str == &SectionOf(*foo));
+  ASSERT_EQ(1U, OffsetOf(*foo));
+  ASSERT_TRUE(&a_str == &SectionOf(*foo->resolveInfo()->outSymbol()));
+  ASSERT_TRUE(&b_str == &SectionOf(*baz));
+  ASSERT_EQ(0U, OffsetOf(*baz));
+}
+
+TEST_F( MergeableSectionOptimizerTest, merge_entries) {
+  m_pConfig->options().setNumThreads(4);
+  Input& a = addInput("a.o");
+  Input& b = addInput("b.o");
+  LDSection& a_cst = addSection(a, ".rodata.cst4", 0x0, 4,
+                                std::string("\1\0\0\0\2\0\0\0", 8));
+  LDSection& b_cst = addSection(b, ".rodata.cst4", 0x0, 4,
+                                std::string("\2\0\0\0\3\0\0\0\2\0\0\0", 12));
+  // the entries are not strings, so zeros do not split them
+  LDSection& c_cst = addSection(b, ".rodata.cst8", 0x0, 8,
+                                std::string("\0\0\0\0\1\0\0\0"
+                                            "\0\0\0\0\1\0\0\0", 16));
+  LDSymbol* two = define(b, "two", b_cst, 8);
+  LDSymbol* three = define(b, "three", b_cst, 4);
+
+  MergeableSectionOptimizer optimizer(*m_pConfig, *m_pModule);
+  ASSERT_TRUE(optimizer.run());
+  ASSERT_EQ(3U, optimizer.numOfRemovedPieces());
+  ASSERT_EQ(16U, optimizer.numOfRemovedBytes());
+
+  ASSERT_EQ(8U, a_cst.size());
+  ASSERT_EQ(4U, b_cst.size());
+  ASSERT_EQ(std::string("\3\0\0\0", 4), Contents(b_cst));
+  ASSERT_EQ(8U, c_cst.size());
+  ASSERT_EQ(std::string("\0\0\0\0\1\0\0\0", 8), Contents(c_cst));
+
+  ASSERT_TRUE(&a_cst == &SectionOf(*two));
+  ASSERT_EQ(4U, OffsetOf(*two));
+  ASSERT_TRUE(&b_cst == &SectionOf(*three));
+  ASSERT_EQ(0U, OffsetOf(*three));
+}
+
+TEST_F( MergeableSectionOptimizerTest, keep_unterminated_strings) {
+  Input& a = addInput("a.o");
+  Input& b = addInput("b.o");
+  LDSection& a_str = addSection(a, ".rodata.str1.1", llvm::ELF::SHF_STRINGS, 1,
+                                std::string("foo\0", 4));
+  LDSection& b_str = addSection(b, ".rodata.str1.1", llvm::ELF::SHF_STRINGS, 1,
+                                std::string("foo\0bar", 7));
+
+  MergeableSectionOptimizer optimizer(*m_pConfig, *m_pModule);
+  ASSERT_TRUE(optimizer.run());
+  ASSERT_EQ(0U, optimizer.numOfRemovedPieces());
+  ASSERT_EQ(4U, a_str.size());
+  ASSERT_EQ(7U, b_str.size());
+}
+
+TEST_F( MergeableSectionOptimizerTest, tail_merge_wide_strings) {
+  m_pConfig->options().setTailMergeStrings();
+  Input& a = addInput("a.o");
+  Input& b = addInput("b.o");
+  LDSection& a_str = addSection(a, ".rodata.str2.2", llvm::ELF::SHF_STRINGS, 2,
+                                Wide("xyz") + Wide("ab"));
+  LDSection& b_str = addSection(b, ".rodata.str2.2", llvm::ELF::SHF_STRINGS, 2,
+                                Wide("b") + Wide("yz") + Wide("c"));
+  LDSymbol* b_sym = define(b, "b", b_str, 0);
+  LDSymbol* yz = define(b, "yz", b_str, 6);
+  LDSymbol* c = define(b, "c", b_str, 12);
+
+  MergeableSectionOptimizer optimizer(*m_pConfig, *m_pModule);
+  ASSERT_TRUE(optimizer.run());
+  ASSERT_EQ(2U, optimizer.numOfRemovedPieces());
+  ASSERT_EQ(10U, optimizer.numOfRemovedBytes());
+
+  ASSERT_EQ(14U, a_str.size());
+  ASSERT_EQ(4U, b_str.size());
+  ASSERT_EQ(Wide("c"), Contents(b_str));
+
+  // a tail is at the offset of its root plus a multiple of the entry size
+  ASSERT_TRUE(&a_str == &SectionOf(*b_sym));
+  ASSERT_EQ(10U, OffsetOf(*b_sym));
+  ASSERT_TRUE(&a_str == &SectionOf(*yz));
+  ASSERT_EQ(2U, OffsetOf(*yz));
+  ASSERT_TRUE(&b_str == &SectionOf(*c));
+  ASSERT_EQ(0U, OffsetOf(*c));
+}
+
+TEST_F( MergeableSectionOptimizerTest, redirect_rela_section_symbols) {
+  Input& a = addInput("a.o");
+  Input& b = addInput("b.o");
+  LDSection& a_str = addSection(a, ".rodata.str1.1", llvm::ELF::SHF_STRINGS, 1,
+                                std::string("foo\0", 4));
+  LDSection& b_str = addSection(b, ".rodata.str1.1", llvm::ELF::SHF_STRINGS, 1,
+                                std::string("bar\0foo\0", 8));
+  LDSymbol* section = sectionSymbol(b, b_str);
+  Relocation* bar = relocate(b, *section, 0, 0);
+  Relocation* foo = relocate(b, *section, 8, 4);
+  Relocation* oo = relocate(b, *section, 8, 5);
+
+  MergeableSectionOptimizer optimizer(*m_pConfig, *m_pModule);
+  ASSERT_TRUE(optimizer.run());
+  ASSERT_EQ(1U, optimizer.numOfRemovedPieces());
+  ASSERT_EQ(4U, b_str.size());
+
+  // a.o has no section symbol, so one is created
+  ASSERT_TRUE(bar->symInfo() == section->resolveInfo());
+  ASSERT_EQ(0U, bar->addend());
+  ASSERT_TRUE(ResolveInfo::Section == foo->symInfo()->type());
+  ASSERT_TRUE(&a_str == &SectionOf(*foo->symInfo()->outSymbol()));
+  ASSERT_EQ(0U, foo->addend());
+  ASSERT_TRUE(foo->symInfo() == oo->symInfo());
+  ASSERT_EQ(1U, oo->addend());
+}
+
+TEST_F( MergeableSectionOptimizerTest, keep_relocated_sections) {
+  Input& a = addInput("a.o");
+  Input& b = addInput("b.o");
+  addSection(a, ".rodata.str1.1", llvm::ELF::SHF_STRINGS, 1,
+             std::string("foo\0", 4));
+  LDSection& b_str = addSection(b, ".rodata.str1.1", llvm::ELF::SHF_STRINGS, 1,
+                                std::string("foo\0", 4));
+  LDSection* rel = IRBuilder::CreateELFHeader(b,
+                                              ".rel.text",
+                                              llvm::ELF::SHT_REL,
+                                              0x0,
+                                              8);
+  rel->setLink(b.context()->getSection(".text"));
+  IRBuilder::CreateRelocData(*rel);
+  m_pIRBuilder->AddRelocation(*rel, llvm::ELF::R_X86_64_64,
+                              *sectionSymbol(b, b_str), 0, 0);
+
+  // the addend of a REL relocation is in the relocated place
+  MergeableSectionOptimizer optimizer(*m_pConfig, *m_pModule);
+  ASSERT_TRUE(optimizer.run());
+  ASSERT_EQ(0U, optimizer.numOfRemovedPieces());
+  ASSERT_EQ(4U, b_str.size());
+}
@@ -0,0 +1,90 @@
+//===- MergeableSectionOptimizerTest.h ------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#ifndef MCLD_MERGEABLE_SECTION_OPTIMIZER_TEST_H
+#define MCLD_MERGEABLE_SECTION_OPTIMIZER_TEST_H
+
+#include <gtest.h>
+#include <llvm/Support/DataTypes.h>
+#include <string>
+#include <vector>
+
+namespace mcld {
+class Input;
+class IRBuilder;
+class LDSection;
+class LDSymbol;
+class LinkerConfig;
+class Module;
+class Relocation;
+} // namespace for mcld
+
+namespace mcldtest
+{
+
+/** \class MergeableSectionOptimizerTest
+ *  \brief The testcases of removing the duplicate pieces of the mergeable
+ *  sections.
+ *
+ *  \see MergeableSectionOptimizer
+ */
+class MergeableSectionOptimizerTest : public ::testing::Test
+{
+public:
+  // Constructor can do set-up work for all test here.
+  MergeableSectionOptimizerTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~MergeableSectionOptimizerTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+
+protected:
+  /// addInput - add an object with a .text section
+  mcld::Input& addInput(const std::string& pName);
+
+  /// addSection - add a SHF_MERGE section whose contents are pContents
+  mcld::LDSection& addSection(mcld::Input& pInput,
+                              const std::string& pName,
+                              uint32_t pFlag,
+                              uint64_t pEntSize,
+                              const std::string& pContents);
+
+  /// define - define a symbol at pValue of pSection
+  mcld::LDSymbol* define(mcld::Input& pInput,
+                         const std::string& pName,
+                         mcld::LDSection& pSection,
+                         uint64_t pValue);
+
+  /// sectionSymbol - define the section symbol of pSection
+  mcld::LDSymbol* sectionSymbol(mcld::Input& pInput,
+                                mcld::LDSection& pSection);
+
+  /// relocate - add an R_X86_64_64 against pSymbol at pOffset of the .text
+  /// of pInput
+  mcld::Relocation* relocate(mcld::Input& pInput,
+                             mcld::LDSymbol& pSymbol,
+                             uint32_t pOffset,
+                             int64_t pAddend);
+
+protected:
+  mcld::LinkerConfig* m_pConfig;
+  mcld::Module* m_pModule;
+  mcld::IRBuilder* m_pIRBuilder;
+
+  std::vector<std::string*> m_Contents;
+};
+
+} // namespace of mcldtest
+
+#endif
+
@@ -12,13 +12,41 @@
 #include <mcld/LD/StaticResolver.h>
 #include <mcld/LD/ResolveInfo.h>
 #include <mcld/LD/LDSymbol.h>
+#include <mcld/Support/ThreadPool.h>
 #include <llvm/ADT/StringRef.h>
 #include <string>
+#include <vector>
 #include <cstdio>
 
 using namespace mcld;
 using namespace mcldtest;
 
+namespace {
+
+class InsertStringTask : public ThreadPool::Task
+{
+public:
+  InsertStringTask(NamePool& pPool, unsigned int pNum)
+    : m_Pool(pPool), m_Num(pNum), m_Results(pNum) { }
+
+  void run() {
+    char name[16];
+    for (unsigned int i = 0; i < m_Num; ++i) {
+      snprintf(name, sizeof(name), "sym_%u", i);
+      m_Results[i] = m_Pool.insertString(name).data();
+    }
+  }
+
+  const char* result(unsigned int pIdx) const { return m_Results[pIdx]; }
+
+private:
+  NamePool& m_Pool;
+  unsigned int m_Num;
+  std::vector<const char*> m_Results;
+};
+
+} // anonymous namespace
+
 
 // Constructor can do set-up work for all test here.
 NamePoolTest::NamePoolTest()
@@ -266,3 +294,75 @@ TEST_F( NamePoolTest, insert_16384_weak_reference_symbols ) {
     }
   }
 }
+
+TEST_F( NamePoolTest, concurrent_insertString ) {
+  NamePool pool;
+  ThreadPool threads(4);
+  InsertStringTask t1(pool, 4096), t2(pool, 4096), t3(pool, 4096);
+  threads.enqueue(t1);
+  threads.enqueue(t2);
+  threads.enqueue(t3);
+  threads.wait();
+
+  ASSERT_EQ(4096U, pool.size());
+  for (unsigned int i = 0; i < 4096; ++i) {
+    ASSERT_EQ(t1.result(i), t2.result(i));
+    ASSERT_EQ(t1.result(i), t3.result(i));
+    ASSERT_EQ(t1.result(i), pool.findInfo(t1.result(i))->name());
+  }
+}
+
+TEST_F( NamePoolTest, insertSymbol_after_concurrent_insertString ) {
+  NamePool pool;
+  ThreadPool threads(2);
+  InsertStringTask task(pool, 16);
+  threads.enqueue(task);
+  threads.wait();
+
+  // a name inserted by insertString is not a symbol yet. The first
+  // insertSymbol of that name must be the same as in an empty pool.
+  Resolver::Result result;
+  pool.insertSymbol("sym_3", false, ResolveInfo::Function, ResolveInfo::Define,
+                    ResolveInfo::Global, 0, ResolveInfo::Default, NULL, result);
+  EXPECT_FALSE(result.existent);
+  EXPECT_TRUE(result.overriden);
+  EXPECT_EQ(task.result(3), result.info->name());
+  EXPECT_EQ(16U, pool.size());
+}
+
+TEST_F( NamePoolTest, insertSymbol_stable_name ) {
+  NamePool pool;
+  const char* strtab = "\0foo\0bar";
+  llvm::StringRef foo(strtab + 1), bar(strtab + 5);
+
+  // a stable name is borrowed, not copied
+  Resolver::Result result;
+  pool.insertSymbol(foo, false, ResolveInfo::Function, ResolveInfo::Define,
+                    ResolveInfo::Global, 0, ResolveInfo::Default, NULL, result,
+                    true);
+  ASSERT_FALSE(result.existent);
+  EXPECT_EQ(foo.data(), result.info->name());
+  EXPECT_TRUE(result.info->isNameBorrowed());
+
+  // a duplicate resolves against the existent symbol
+  Resolver::Result dup;
+  pool.insertSymbol("foo", false, ResolveInfo::Function, ResolveInfo::Undefined,
+                    ResolveInfo::Global, 0, ResolveInfo::Default, NULL, dup);
+  EXPECT_TRUE(dup.existent);
+  EXPECT_EQ(result.info, dup.info);
+  EXPECT_TRUE(dup.info->isDefine());
+
+  ResolveInfo* local = pool.createSymbol(bar, false, ResolveInfo::Object,
+                                         ResolveInfo::Define,
+                                         ResolveInfo::Local, 4,
+                                         ResolveInfo::Default, true);
+  EXPECT_EQ(bar.data(), local->name());
+  EXPECT_EQ(3U, local->nameSize());
+
+  // the other names are copied
+  pool.insertSymbol(llvm::StringRef(strtab + 5, 2), false,
+                    ResolveInfo::Object, ResolveInfo::Define,
+                    ResolveInfo::Global, 0, ResolveInfo::Default, NULL, result);
+  EXPECT_FALSE(result.info->isNameBorrowed());
+  EXPECT_STREQ("ba", result.info->name());
+}
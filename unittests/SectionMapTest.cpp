@@ -0,0 +1,118 @@
+//===- SectionMapTest.cpp -------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include "SectionMapTest.h"
+
+#include <mcld/Object/SectionMap.h>
+
+using namespace mcld;
+using namespace mcldtest;
+
+
+// Constructor can do set-up work for all test here.
+SectionMapTest::SectionMapTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+SectionMapTest::~SectionMapTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void SectionMapTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void SectionMapTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( SectionMapTest, find_by_prefix ) {
+  SectionMap map;
+  bool exist = true;
+  map.append(".text.", ".text", exist);
+  ASSERT_FALSE(exist);
+  map.append(".data.rel.ro", ".data.rel.ro", exist);
+  ASSERT_FALSE(exist);
+  map.append(".data.", ".data", exist);
+  ASSERT_FALSE(exist);
+
+  ASSERT_EQ(".text", map.find(".text.foo").to);
+  ASSERT_EQ(".text", map.find(".text.").to);
+  ASSERT_EQ(".data", map.find(".data.foo").to);
+  ASSERT_EQ(".data.rel.ro", map.find(".data.rel.ro.local").to);
+  ASSERT_TRUE(map.find(".text").isNull());
+  ASSERT_TRUE(map.find(".tex").isNull());
+  ASSERT_TRUE(map.find(".bss").isNull());
+  ASSERT_TRUE(map.find("").isNull());
+}
+
+TEST_F( SectionMapTest, first_appended_wins ) {
+  SectionMap map;
+  bool exist = true;
+  map.append(".data.", ".data", exist);
+  map.append(".data.rel.ro", ".data.rel.ro", exist);
+  map.append(".text", ".text", exist);
+  map.append(".text.hot", ".text.hot", exist);
+
+  // a shorter prefix appended first hides a longer one
+  ASSERT_EQ(".data", map.find(".data.rel.ro.local").to);
+  ASSERT_EQ(".text", map.find(".text.hot.foo").to);
+
+  // the same prefix is appended once, and the first output is kept
+  SectionMap::NamePair& pair = map.append(".text", ".code", exist);
+  ASSERT_TRUE(exist);
+  ASSERT_EQ(".text", pair.to);
+  ASSERT_EQ(4U, map.size());
+
+  // a longer prefix appended first is found before a shorter one
+  SectionMap other;
+  other.append(".data.rel.ro", ".data.rel.ro", exist);
+  other.append(".data.", ".data", exist);
+  ASSERT_EQ(".data.rel.ro", other.find(".data.rel.ro.local").to);
+  ASSERT_EQ(".data", other.find(".data.rel.local").to);
+}
+
+TEST_F( SectionMapTest, find_wildcard ) {
+  SectionMap map;
+  bool exist = true;
+  map.append(".text.", ".text", exist);
+  map.append("*", ".other", exist);
+  map.append(".data.", ".data", exist);
+  map.append("*.foo", ".foo", exist);
+
+  // the wildcard matches every name, and it is after .text. only
+  ASSERT_EQ(".text", map.find(".text.foo").to);
+  ASSERT_EQ(".other", map.find(".data.foo").to);
+  ASSERT_EQ(".other", map.find(".bss").to);
+  ASSERT_EQ(".other", map.find("").to);
+}
+
+TEST_F( SectionMapTest, find_empty_prefix ) {
+  SectionMap map;
+  bool exist = true;
+  map.append(".text.", ".text", exist);
+  map.append("", ".all", exist);
+  ASSERT_FALSE(exist);
+  map.append(".data.", ".data", exist);
+
+  // the empty prefix is at the root of the trie, and it matches every name
+  ASSERT_EQ(".text", map.find(".text.foo").to);
+  ASSERT_EQ(".all", map.find(".data.foo").to);
+  ASSERT_EQ(".all", map.find(".bss").to);
+  ASSERT_EQ(".all", map.find("").to);
+
+  map.append("", ".none", exist);
+  ASSERT_TRUE(exist);
+  ASSERT_EQ(3U, map.size());
+}
@@ -0,0 +1,183 @@
+//===- StringHashTest.cpp -------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "StringHashTest.h"
+#include <mcld/ADT/StringHash.h>
+#include <mcld/ADT/HashTable.h>
+#include <mcld/LD/ResolveInfo.h>
+#include <llvm/Support/Host.h>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+
+using namespace std;
+using namespace mcld;
+using namespace mcldtest;
+
+namespace {
+
+// about the number of dynamic symbols of libLLVM.so
+const unsigned int NumOfGeneratedNames = 60000;
+
+const char* Namespaces[] = {
+  "4llvm", "4mcld", "3sys", "2fs", "6detail", "3cl", "6object", "3ELF"
+};
+
+const char* Classes[] = {
+  "5Value", "11Instruction", "8Function", "6Module", "10BasicBlock",
+  "8ResolveInfo", "9IRBuilder", "12SelectionDAG", "11MachineInstr",
+  "8LDSymbol", "9StringRef", "11raw_ostream"
+};
+
+const char* Methods[] = {
+  "3get", "4dump", "5print", "7getName", "8getValue", "9setParent",
+  "10eraseValue", "12getOperandNo", "15replaceAllUsesW", "6insert"
+};
+
+const char* Suffixes[] = {
+  "Ev", "EPKc", "ERKNS_9StringRefE", "EjRKS1_b", "ERNS_11raw_ostreamEb",
+  "EPNS_5ValueES2_", "Ej", "Ev.cold"
+};
+
+template<typename ARRAY, size_t N>
+size_t size_of(ARRAY (&)[N]) { return N; }
+
+/// generate - C++ mangled names with long common prefixes and suffixes.
+void generate(std::vector<std::string>& pNames)
+{
+  char idx[16];
+  for (unsigned int i = 0; i < NumOfGeneratedNames; ++i) {
+    std::string name("_ZN");
+    name += Namespaces[i % size_of(Namespaces)];
+    name += Classes[(i / 7) % size_of(Classes)];
+    snprintf(idx, sizeof(idx), "%u", i);
+    std::string method(Methods[(i / 3) % size_of(Methods)]);
+    method += idx;
+    snprintf(idx, sizeof(idx), "%u", (unsigned int)method.size() - 1);
+    name += idx;
+    name += method.substr(1);
+    name += Suffixes[(i / 11) % size_of(Suffixes)];
+    pNames.push_back(name);
+  }
+}
+
+/// probeLength - average number of buckets visited to find a name in a
+/// linear probing table at the load factor where HashTable grows.
+template<typename HASH>
+double probeLength(const std::vector<std::string>& pNames)
+{
+  HASH hash_func;
+  size_t size = pNames.size() * 4 / 3 + 1;
+  std::vector<bool> used(size, false);
+  unsigned long long total = 0;
+  for (size_t i = 0; i < pNames.size(); ++i) {
+    size_t index = hash_func(pNames[i]) % size;
+    ++total;
+    while (used[index]) {
+      index = (index + 1) % size;
+      ++total;
+    }
+    used[index] = true;
+  }
+  return (double)total / pNames.size();
+}
+
+/// insertTime - seconds to insert all names into a symbol table.
+template<typename HASH>
+double insertTime(const std::vector<std::string>& pNames, size_t& pEntries)
+{
+  typedef HashTable<ResolveInfo, HASH> TableType;
+  clock_t start = clock();
+  for (unsigned int round = 0; round < 5; ++round) {
+    TableType table;
+    bool exist;
+    for (size_t i = 0; i < pNames.size(); ++i)
+      table.insert(pNames[i], exist);
+    for (size_t i = 0; i < pNames.size(); ++i)
+      table.insert(pNames[i], exist);
+    pEntries = table.numOfEntries();
+  }
+  return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+StringHashTest::StringHashTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+StringHashTest::~StringHashTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void StringHashTest::SetUp()
+{
+  const char* path = getenv("MCLD_HASH_BENCH_SYMBOLS");
+  if (NULL != path) {
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+      if (!line.empty())
+        m_Names.push_back(line);
+    }
+  }
+  if (m_Names.empty())
+    generate(m_Names);
+}
+
+// TearDown() will be called immediately after each test.
+void StringHashTest::TearDown()
+{
+}
+
+//==========================================================================//
+// Testcases
+//
+TEST_F( StringHashTest, xxhash_reference_values ) {
+  StringHash<XX> hash_func;
+  if (!llvm::sys::isLittleEndianHost())
+    return;
+  // values of the reference implementation of XXH32 with seed 0
+  EXPECT_EQ(0x02CC5D05U, hash_func(""));
+  EXPECT_EQ(0x32D153FFU, hash_func("abc"));
+  EXPECT_EQ(0xE2293B2FU,
+            hash_func("Nobody inspects the spammish repetition"));
+}
+
+TEST_F( StringHashTest, xxhash_uses_every_byte ) {
+  StringHash<XX> hash_func;
+  std::string name("_ZN4llvm11Instruction12getOperandNoEv");
+  uint32_t value = hash_func(name);
+  for (size_t i = 0; i < name.size(); ++i) {
+    std::string other(name);
+    other[i] ^= 0x1;
+    EXPECT_NE(value, hash_func(other));
+  }
+}
+
+TEST_F( StringHashTest, benchmark_probe_length_and_insertion ) {
+  double elf_probe = probeLength<StringHash<ELF> >(m_Names);
+  double xx_probe = probeLength<StringHash<XX> >(m_Names);
+
+  size_t elf_entries = 0, xx_entries = 0;
+  double elf_time = insertTime<StringHash<ELF> >(m_Names, elf_entries);
+  double xx_time = insertTime<StringHash<XX> >(m_Names, xx_entries);
+
+  printf("[ BENCH    ] %u names\n", (unsigned int)m_Names.size());
+  printf("[ BENCH    ] ELF: %.3f probes/name, %.3fs\n", elf_probe, elf_time);
+  printf("[ BENCH    ] XX : %.3f probes/name, %.3fs\n", xx_probe, xx_time);
+
+  EXPECT_EQ(elf_entries, xx_entries);
+  // a well-distributed hash needs about 2.5 probes at 3/4 load factor.
+  EXPECT_TRUE(xx_probe < 4.0);
+}
@@ -0,0 +1,52 @@
+//===- StringHashTest.h ---------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef MCLD_STRING_HASH_TEST_H
+#define MCLD_STRING_HASH_TEST_H
+
+#include <gtest.h>
+#include <string>
+#include <vector>
+
+namespace mcldtest
+{
+
+/** \class StringHashTest
+ *  \brief Testcase and micro-benchmark for StringHash
+ *
+ *  The benchmark uses the symbol names listed in the file given by the
+ *  environment variable MCLD_HASH_BENCH_SYMBOLS, one name per line (for
+ *  example, the output of `nm -j libLLVM.so`). Without the file, it uses a
+ *  generated set of mangled names of the same size as libLLVM.
+ *
+ *  \see StringHash
+ */
+class StringHashTest : public ::testing::Test
+{
+public:
+  // Constructor can do set-up work for all test here.
+  StringHashTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~StringHashTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+
+protected:
+  std::vector<std::string> m_Names;
+};
+
+} // namespace of mcldtest
+
+#endif
+
@@ -0,0 +1,120 @@
+//===- SymbolEntryMapTest.cpp ---------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "SymbolEntryMapTest.h"
+#include <mcld/Target/SymbolEntryMap.h>
+#include <mcld/LD/ResolveInfo.h>
+#include <cstdio>
+#include <ctime>
+
+using namespace mcld;
+using namespace mcldtest;
+
+namespace {
+
+// about the number of PLT entries of a large shared object
+const unsigned int NumOfSymbols = 100000;
+
+struct Entry
+{
+  unsigned int id;
+};
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+SymbolEntryMapTest::SymbolEntryMapTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+SymbolEntryMapTest::~SymbolEntryMapTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void SymbolEntryMapTest::SetUp()
+{
+  char name[32];
+  for (unsigned int i = 0; i < NumOfSymbols; ++i) {
+    snprintf(name, sizeof(name), "sym%u", i);
+    m_Symbols.push_back(ResolveInfo::Create(name));
+  }
+}
+
+// TearDown() will be called immediately after each test.
+void SymbolEntryMapTest::TearDown()
+{
+  for (size_t i = 0; i < m_Symbols.size(); ++i)
+    ResolveInfo::Destroy(m_Symbols[i]);
+  m_Symbols.clear();
+}
+
+//==========================================================================//
+// Testcases
+//
+TEST_F( SymbolEntryMapTest, record_and_lookup ) {
+  SymbolEntryMap<Entry> map;
+  Entry entries[3];
+  ASSERT_TRUE(map.empty());
+  ASSERT_TRUE(NULL == map.lookUp(*m_Symbols[0]));
+
+  map.record(*m_Symbols[0], entries[0]);
+  map.record(*m_Symbols[1], entries[1]);
+  // the first recorded entry of a symbol wins
+  map.record(*m_Symbols[0], entries[2]);
+
+  const SymbolEntryMap<Entry>& const_map = map;
+  EXPECT_EQ(&entries[0], map.lookUp(*m_Symbols[0]));
+  EXPECT_EQ(&entries[0], const_map.lookUp(*m_Symbols[0]));
+  EXPECT_EQ(&entries[1], map.lookUp(*m_Symbols[1]));
+  EXPECT_TRUE(NULL == map.lookUp(*m_Symbols[2]));
+
+  // iteration keeps the order of record()
+  ASSERT_EQ(3U, map.size());
+  SymbolEntryMap<Entry>::iterator it = map.begin();
+  EXPECT_EQ(&entries[0], it->entry);
+  ++it;
+  EXPECT_EQ(&entries[1], it->entry);
+  ++it;
+  EXPECT_EQ(&entries[2], it->entry);
+}
+
+TEST_F( SymbolEntryMapTest, benchmark_record_and_lookup ) {
+  std::vector<Entry> entries(m_Symbols.size());
+  SymbolEntryMap<Entry> map;
+
+  clock_t start = clock();
+  for (size_t i = 0; i < m_Symbols.size(); ++i) {
+    // relocators look up a symbol before recording its new entry
+    if (NULL == map.lookUp(*m_Symbols[i])) {
+      entries[i].id = i;
+      map.record(*m_Symbols[i], entries[i]);
+    }
+  }
+  double record_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  start = clock();
+  unsigned int mismatch = 0;
+  for (unsigned int round = 0; round < 10; ++round) {
+    for (size_t i = 0; i < m_Symbols.size(); ++i) {
+      if (map.lookUp(*m_Symbols[i]) != &entries[i])
+        ++mismatch;
+    }
+  }
+  double lookup_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  printf("[ BENCH    ] %u symbols\n", (unsigned int)m_Symbols.size());
+  printf("[ BENCH    ] record: %.3fs, 10x lookUp: %.3fs\n",
+         record_time, lookup_time);
+
+  EXPECT_EQ(m_Symbols.size(), map.size());
+  EXPECT_EQ(0U, mismatch);
+}
+
@@ -0,0 +1,52 @@
+//===- SymbolEntryMapTest.h -----------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef MCLD_SYMBOL_ENTRY_MAP_TEST_H
+#define MCLD_SYMBOL_ENTRY_MAP_TEST_H
+
+#include <gtest.h>
+#include <vector>
+
+namespace mcld
+{
+class ResolveInfo;
+
+} // namespace for mcld
+
+namespace mcldtest
+{
+
+/** \class SymbolEntryMapTest
+ *  \brief Testcase and micro-benchmark for SymbolEntryMap
+ *
+ *  \see SymbolEntryMap
+ */
+class SymbolEntryMapTest : public ::testing::Test
+{
+public:
+  // Constructor can do set-up work for all test here.
+  SymbolEntryMapTest();
+
+  // Destructor can do clean-up work that doesn't throw exceptions here.
+  virtual ~SymbolEntryMapTest();
+
+  // SetUp() will be called immediately before each test.
+  virtual void SetUp();
+
+  // TearDown() will be called immediately after each test.
+  virtual void TearDown();
+
+protected:
+  std::vector<mcld::ResolveInfo*> m_Symbols;
+};
+
+} // namespace of mcldtest
+
+#endif
+
@@ -0,0 +1,102 @@
+//===- ThreadPoolTest.cpp -------------------------------------------------===//
+//
+//                     The MCLinker Project
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+#include <mcld/Support/ThreadPool.h>
+#include "ThreadPoolTest.h"
+
+#include <vector>
+
+using namespace mcld;
+using namespace mcld::test;
+
+namespace {
+
+class SumTask : public ThreadPool::Task
+{
+public:
+  SumTask() : m_Limit(0), m_Sum(0) { }
+
+  void set(unsigned int pLimit) { m_Limit = pLimit; }
+
+  void run() {
+    for (unsigned int i = 1; i <= m_Limit; ++i)
+      m_Sum += i;
+  }
+
+  unsigned int sum() const { return m_Sum; }
+
+private:
+  unsigned int m_Limit;
+  unsigned int m_Sum;
+};
+
+} // anonymous namespace
+
+// Constructor can do set-up work for all test here.
+ThreadPoolTest::ThreadPoolTest()
+{
+}
+
+// Destructor can do clean-up work that doesn't throw exceptions here.
+ThreadPoolTest::~ThreadPoolTest()
+{
+}
+
+// SetUp() will be called immediately before each test.
+void ThreadPoolTest::SetUp()
+{
+}
+
+// TearDown() will be called immediately after each test.
+void ThreadPoolTest::TearDown()
+{
+}
+
+//===----------------------------------------------------------------------===//
+// Testcases
+//===----------------------------------------------------------------------===//
+TEST_F( ThreadPoolTest, serial_pool) {
+  ThreadPool pool(1);
+  ASSERT_EQ(1U, pool.numOfThreads());
+
+  SumTask task;
+  task.set(10);
+  pool.enqueue(task);
+  // a serial pool runs the task in enqueue()
+  ASSERT_EQ(55U, task.sum());
+  pool.wait();
+}
+
+TEST_F( ThreadPoolTest, parallel_pool) {
+  ThreadPool pool(4);
+  ASSERT_TRUE(pool.numOfThreads() >= 1U);
+
+  std::vector<SumTask> tasks(100);
+  for (unsigned int i = 0; i < tasks.size(); ++i) {
+    tasks[i].set(i);
+    pool.enqueue(tasks[i]);
+  }
+  pool.wait();
+
+  for (unsigned int i = 0; i < tasks.size(); ++i)
+    ASSERT_EQ(i * (i + 1) / 2, tasks[i].sum());
+}
+
+TEST_F( ThreadPoolTest, reuse_pool) {
+  ThreadPool pool(2);
+  SumTask first, second;
+  first.set(3);
+  pool.enqueue(first);
+  pool.wait();
+  ASSERT_EQ(6U, first.sum());
+
+  second.set(4);
+  pool.enqueue(second);
+  pool.wait();
+  ASSERT_EQ(10U, second.sum());
+}